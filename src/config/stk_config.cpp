@@ -154,6 +154,11 @@ void STKConfig::load(const std::string &filename)
     CHECK_NEG(m_network_state_frequeny,    "network state-frequency"    );
     CHECK_NEG(m_max_moveable_objects,      "network max-moveable-objects");
     CHECK_NEG(m_network_steering_reduction,"network steering-reduction" );
+    CHECK_NEG(m_network_max_position_error,"network max-position-error" );
+    CHECK_NEG(m_network_max_rotation_error,"network max-rotation-error" );
+    CHECK_NEG(m_network_max_velocity_error,"network max-velocity-error" );
+    CHECK_NEG(m_network_input_redundancy,  "network input-redundancy"   );
+    CHECK_NEG(m_network_input_frequency,   "network input-frequency"    );
     CHECK_NEG(m_default_moveable_friction, "physics default-moveable-friction");
     CHECK_NEG(m_solver_iterations,         "physics: solver-iterations"       );
     CHECK_NEG(m_solver_split_impulse_thresh,"physics: solver-split-impulse-threshold");
@@ -165,8 +170,39 @@ void STKConfig::load(const std::string &filename)
 
     // Square distance to make distance checks cheaper (no sqrt)
     m_default_kart_properties->checkAllSet(filename);
+
+    m_default_physics_fps             = m_physics_fps;
+    m_default_network_state_frequency = m_network_state_frequeny;
+    m_default_network_input_frequency = m_network_input_frequency;
 }   // load
 
+// -----------------------------------------------------------------------------
+/** Changes the physics, state and input rates, which is used by a server
+ *  with different rates in its server config, and by clients connected to
+ *  such a server. Must not be called during a race.
+ *  \param physics_fps Physics steps per second.
+ *  \param state_frequency States per second sent by the server.
+ *  \param input_frequency How often per second a client sends actions
+ *         (0 with every frame).
+ */
+void STKConfig::setTickRates(int physics_fps, int state_frequency,
+                             int input_frequency)
+{
+    m_physics_fps             = physics_fps;
+    m_network_state_frequeny  = state_frequency;
+    m_network_input_frequency = input_frequency;
+    m_penalty_ticks           = time2Ticks(m_penalty_time);
+    m_item_switch_ticks       = time2Ticks(m_item_switch_time);
+}   // setTickRates
+
+// -----------------------------------------------------------------------------
+/** Restores the rates from the config file. */
+void STKConfig::resetTickRates()
+{
+    setTickRates(m_default_physics_fps, m_default_network_state_frequency,
+                 m_default_network_input_frequency);
+}   // resetTickRates
+
 // -----------------------------------------------------------------------------
 /** Init all values with invalid defaults, which are tested later. This
  * guarantees that all parameters will indeed be initialised, and helps
@@ -209,6 +245,14 @@ void STKConfig::init_defaults()
     m_solver_set_flags           = 0;
     m_solver_reset_flags         = 0;
     m_network_steering_reduction = -100;
+    m_network_partial_rewind     = false;
+    m_network_max_position_error = -100;
+    m_network_max_rotation_error = -100;
+    m_network_max_velocity_error = -100;
+    m_network_input_redundancy   = -100;
+    m_network_input_frequency    = -100;
+    m_penalty_time               = 0.0f;
+    m_item_switch_time           = 0.0f;
     m_title_music                = NULL;
     m_solver_split_impulse       = false;
     m_smooth_normals             = false;
@@ -338,9 +382,8 @@ void STKConfig::getAllData(const XMLNode * root)
 
     if (const XMLNode *startup_node= root->getNode("startup"))
     {
-        float f;
-        startup_node->get("penalty", &f);
-        m_penalty_ticks = time2Ticks(f);
+        startup_node->get("penalty", &m_penalty_time);
+        m_penalty_ticks = time2Ticks(m_penalty_time);
     }
 
     if (const XMLNode *news_node= root->getNode("news"))
@@ -421,9 +464,8 @@ void STKConfig::getAllData(const XMLNode * root)
     if(const XMLNode *switch_node= root->getNode("switch"))
     {
         switch_node->get("items", &m_switch_items    );
-        float f;
-        if( switch_node->get("time",  &f) )
-            m_item_switch_ticks = stk_config->time2Ticks(f);
+        if( switch_node->get("time",  &m_item_switch_time) )
+            m_item_switch_ticks = stk_config->time2Ticks(m_item_switch_time);
     }
 
     if(const XMLNode *bubblegum_node= root->getNode("bubblegum"))
@@ -447,6 +489,16 @@ void STKConfig::getAllData(const XMLNode * root)
         networking_node->get("state-frequency", &m_network_state_frequeny);
         networking_node->get("max-moveable-objects", &m_max_moveable_objects);
         networking_node->get("steering-reduction", &m_network_steering_reduction);
+        networking_node->get("partial-rewind", &m_network_partial_rewind);
+        networking_node->get("max-position-error",
+                             &m_network_max_position_error);
+        networking_node->get("max-rotation-error",
+                             &m_network_max_rotation_error);
+        networking_node->get("max-velocity-error",
+                             &m_network_max_velocity_error);
+        networking_node->get("input-redundancy",
+                             &m_network_input_redundancy);
+        networking_node->get("input-frequency", &m_network_input_frequency);
     }
 
     if(const XMLNode *replay_node = root->getNode("replay"))
@@ -89,6 +89,10 @@ public:
     /** How many state updates per second the server will send. */
     int m_network_state_frequeny;
 
+    /** How many times per second a client sends its kart actions to the
+     *  server, 0 to send them with every frame. */
+    int m_network_input_frequency;
+
     /** Maximum number of moveable objects in a track when networking is on. */
     int m_max_moveable_objects;
 
@@ -97,6 +101,20 @@ public:
      *  steering adjustments. */
     float m_network_steering_reduction;
 
+    /** If a client skips a rewind if no rewinder's confirmed state differs
+     *  from its predicted state. */
+    bool m_network_partial_rewind;
+
+    /** Maximum difference between the confirmed and the predicted position,
+     *  rotation and velocities for which no rewind is necessary. */
+    float m_network_max_position_error;
+    float m_network_max_rotation_error;
+    float m_network_max_velocity_error;
+
+    /** How often a client sends each kart action again with the next
+     *  actions, 0 to send all actions reliable instead. */
+    int m_network_input_redundancy;
+
     /** If the angle between a normal on a vertex and the normal of the
      *  triangle are more than this value, the physics will use the normal
      *  of the triangle in smoothing normal. */
@@ -221,6 +239,15 @@ private:
     /** Default FPS rate for physics. */
     int m_physics_fps;
 
+    /** The rates from the config file, restored by resetTickRates(). */
+    int m_default_physics_fps;
+    int m_default_network_state_frequency;
+    int m_default_network_input_frequency;
+
+    /** Penalty and item switch time in seconds, used to recompute the
+     *  ticks if the physics fps are changed. */
+    float m_penalty_time;
+    float m_item_switch_time;
 
 public:
     STKConfig();
@@ -228,6 +255,9 @@ public:
     void init_defaults();
     void getAllData(const XMLNode * root);
     void load(const std::string &filename);
+    void setTickRates(int physics_fps, int state_frequency,
+                      int input_frequency);
+    void resetTickRates();
     const std::string &getMainMenuPicture(int n);
     const std::string &getBackgroundPicture(int n);
 
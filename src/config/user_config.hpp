@@ -428,6 +428,20 @@ namespace UserConfigParams
     PARAM_PREFIX BoolUserConfigParam         m_random_arena_item
             PARAM_DEFAULT(  BoolUserConfigParam(false, "random-arena-item",
             &m_race_setup_group, "Enable random location of items in an arena.") );
+    PARAM_PREFIX IntUserConfigParam          m_physics_threads
+            PARAM_DEFAULT(  IntUserConfigParam(0, "physics-threads",
+            &m_race_setup_group, "Number of threads used to cast the wheel "
+            "and terrain rays of all karts. 1 casts all rays in the main "
+            "thread, 0 uses up to 4 threads without graphics (e.g. servers) "
+            "and 1 otherwise.") );
+    PARAM_PREFIX BoolUserConfigParam         m_parallel_ai
+            PARAM_DEFAULT(  BoolUserConfigParam(false, "parallel-ai",
+            &m_race_setup_group, "If true, the AI karts decide how to drive "
+            "before any kart is updated, using the threads of physics-threads. "
+            "All AI karts then see the same state of the world, instead of "
+            "the karts updated before them, so the AI drives differently than "
+            "without this option. The result does not depend on the number "
+            "of threads.") );
     PARAM_PREFIX IntUserConfigParam          m_difficulty
             PARAM_DEFAULT(  IntUserConfigParam(0, "difficulty",
                             &m_race_setup_group,
@@ -864,6 +878,11 @@ namespace UserConfigParams
     PARAM_PREFIX BoolUserConfigParam        m_cache_overworld
             PARAM_DEFAULT(  BoolUserConfigParam(true, "cache-overworld") );
 
+    PARAM_PREFIX IntUserConfigParam         m_max_cached_bvh_size
+            PARAM_DEFAULT(  IntUserConfigParam(256, "max-cached-bvh-size",
+            "Maximum size (in MB) of the cached bvh of track collision "
+            "meshes, the least recently used files are removed first.") );
+
     // TODO : is this used with new code? does it still work?
     PARAM_PREFIX BoolUserConfigParam        m_crashed
             PARAM_DEFAULT(  BoolUserConfigParam(false, "crashed") );
@@ -19,6 +19,7 @@
 
 #include "graphics/material_manager.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 
@@ -273,7 +274,13 @@ void MaterialManager::loadMaterial()
 }   // MaterialManager
 
 //-----------------------------------------------------------------------------
-void MaterialManager::addSharedMaterial(const std::string& filename, bool deprecated)
+/** Loads a material file, and makes all its materials permanent.
+ *  \param added If not NULL, all materials that were made permanent are
+ *         appended to this vector.
+ */
+void MaterialManager::addSharedMaterial(const std::string& filename,
+                                        bool deprecated,
+                                        std::vector<Material*> *added)
 {
     // Use temp material for reading, but then set the shared
     // material index later, so that these materials are not popped
@@ -289,7 +296,7 @@ void MaterialManager::addSharedMaterial(const std::string& filename, bool deprec
         msg <<"FATAL: Parsing error in '"<<filename<<"'\n";
         throw std::runtime_error(msg.str());
     }
-    m_shared_material_index = (int)m_materials.size();
+    makeMaterialsPermanent(added);
 }   // addSharedMaterial
 
 //-----------------------------------------------------------------------------
@@ -405,13 +412,42 @@ Material *MaterialManager::getMaterial(const std::string& fname,
 
 
 // ----------------------------------------------------------------------------
-/** Makes all materials permanent. Used for overworld.
+/** Makes all materials permanent. Used for overworld and cached tracks.
+ *  \param added If not NULL, all materials that were made permanent are
+ *         appended to this vector.
  */
-void MaterialManager::makeMaterialsPermanent()
+void MaterialManager::makeMaterialsPermanent(std::vector<Material*> *added)
 {
+    if (added)
+    {
+        added->insert(added->end(),
+                      m_materials.begin() + m_shared_material_index,
+                      m_materials.end());
+    }
     m_shared_material_index = (int) m_materials.size();
 }   // makeMaterialsPermanent
 
+// ----------------------------------------------------------------------------
+/** Removes and frees permanent materials again. This is used when a cached
+ *  track is removed from the cache. The caller must make sure that the
+ *  materials are not used anymore.
+ *  \param materials The materials to remove.
+ */
+void MaterialManager::removePermanentMaterials(
+                                     const std::vector<Material*> &materials)
+{
+    for (Material* m : materials)
+    {
+        auto it = std::find(m_materials.begin(),
+                            m_materials.begin() + m_shared_material_index, m);
+        if (it == m_materials.begin() + m_shared_material_index)
+            continue;
+        m_materials.erase(it);
+        m_shared_material_index--;
+        delete m;
+    }
+}   // removePermanentMaterials
+
 // ----------------------------------------------------------------------------
 void MaterialManager::unloadAllTextures()
 {
@@ -74,11 +74,13 @@ public:
                                 bool make_permanent=false,
                                 bool complain_if_not_found=true,
                                 bool strip_path=true, bool install=true);
-    void      addSharedMaterial(const std::string& filename, bool deprecated = false);
+    void      addSharedMaterial(const std::string& filename, bool deprecated = false,
+                                std::vector<Material*> *added = NULL);
     bool      pushTempMaterial (const std::string& filename, bool deprecated = false);
     bool      pushTempMaterial (const XMLNode *root, const std::string& filename, bool deprecated = false);
     void      popTempMaterial  ();
-    void      makeMaterialsPermanent();
+    void      makeMaterialsPermanent(std::vector<Material*> *added = NULL);
+    void      removePermanentMaterials(const std::vector<Material*> &materials);
     bool      hasMaterial(const std::string& fname);
 
     void      unloadAllTextures();
@@ -35,12 +35,14 @@
 
 #include <irrlicht.h>
 
+#include <algorithm>
 #include <stdio.h>
 #include <stdexcept>
 #include <sstream>
 #include <sys/stat.h>
 #include <iostream>
 #include <string>
+#include <tuple>
 
 namespace irr {
     namespace io
@@ -55,11 +57,13 @@ namespace irr {
 #  include <sys/types.h>
 #  include <dirent.h>
 #  include <unistd.h>
+#  include <utime.h>
 #else
 #  define WIN32_LEAN_AND_MEAN
 #  include <direct.h>
 #  include <windows.h>
 #  include <stdio.h>
+#  include <sys/utime.h>
 #  if !defined(__CYGWIN__ ) && !defined(__MINGW32__)
      /*Needed by the remove directory function */
 #    define S_ISDIR(mode)  (((mode) & S_IFMT) == S_IFDIR)
@@ -247,6 +251,7 @@ FileManager::FileManager()
     checkAndCreateScreenshotDir();
     checkAndCreateReplayDir();
     checkAndCreateCachedTexturesDir();
+    checkAndCreateCachedBVHDir();
     checkAndCreateGPDir();
 
     redirectOutput();
@@ -723,6 +728,14 @@ std::string FileManager::getCachedTexturesDir() const
     return m_cached_textures_dir;
 }   // getCachedTexturesDir
 
+//-----------------------------------------------------------------------------
+/** Returns the directory in which the bvh of collision meshes are cached.
+*/
+std::string FileManager::getCachedBVHDir() const
+{
+    return m_cached_bvh_dir;
+}   // getCachedBVHDir
+
 //-----------------------------------------------------------------------------
 /** Returns the directory in which user-defined grand prix should be stored.
  */
@@ -1061,6 +1074,31 @@ void FileManager::checkAndCreateCachedTexturesDir()
 
 }   // checkAndCreateCachedTexturesDir
 
+// ----------------------------------------------------------------------------
+/** Creates the directory for the cached bvh of track collision meshes. This
+*  will set m_cached_bvh_dir with the appropriate path.
+*/
+void FileManager::checkAndCreateCachedBVHDir()
+{
+#if defined(WIN32) || defined(__CYGWIN__)
+    m_cached_bvh_dir = m_user_config_dir + "cached-bvh/";
+#elif defined(__APPLE__)
+    m_cached_bvh_dir = getenv("HOME");
+    m_cached_bvh_dir += "/Library/Application Support/SuperTuxKart/CachedBVH/";
+#else
+    m_cached_bvh_dir = checkAndCreateLinuxDir("XDG_CACHE_HOME", "supertuxkart", ".cache/", ".");
+    m_cached_bvh_dir += "cached-bvh/";
+#endif
+
+    if (!checkAndCreateDirectory(m_cached_bvh_dir))
+    {
+        Log::error("FileManager", "Can not create cached bvh directory '%s', "
+            "falling back to '.'.", m_cached_bvh_dir.c_str());
+        m_cached_bvh_dir = "./";
+    }
+
+}   // checkAndCreateCachedBVHDir
+
 // ----------------------------------------------------------------------------
 /** Creates the directories for user-defined grand prix. This will set m_gp_dir
  *  with the appropriate path.
@@ -1484,3 +1522,52 @@ bool FileManager::fileIsNewer(const std::string& f1, const std::string& f2) cons
     return stat1.st_mtime > stat2.st_mtime;
 }   // fileIsNewer
 
+// ----------------------------------------------------------------------------
+/** Sets the modification time of a file to the current time.
+ *  \param path Full path of the file.
+ */
+void FileManager::touchFile(const std::string& path) const
+{
+#if defined(WIN32)
+    _utime(path.c_str(), NULL);
+#else
+    utime(path.c_str(), NULL);
+#endif
+}   // touchFile
+
+// ----------------------------------------------------------------------------
+/** Removes the least recently modified files of a directory until the total
+ *  size of all its files is at most max_size. Sub directories are ignored.
+ *  \param dir The directory.
+ *  \param max_size Maximum size of all files in bytes.
+ */
+void FileManager::limitDirectorySize(const std::string& dir,
+                                     uint64_t max_size) const
+{
+    std::set<std::string> files;
+    listFiles(files, dir, /*make_full_path*/true);
+
+    // Modification time, size and name of all files
+    std::vector<std::tuple<time_t, uint64_t, std::string> > all_files;
+    uint64_t total_size = 0;
+    for (const std::string& file : files)
+    {
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+            continue;
+        all_files.emplace_back(st.st_mtime, (uint64_t)st.st_size, file);
+        total_size += st.st_size;
+    }
+    if (total_size <= max_size)
+        return;
+
+    std::sort(all_files.begin(), all_files.end());
+    for (auto& f : all_files)
+    {
+        if (total_size <= max_size)
+            break;
+        if (removeFile(std::get<2>(f)))
+            total_size -= std::get<1>(f);
+    }
+}   // limitDirectorySize
+
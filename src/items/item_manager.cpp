@@ -33,6 +33,7 @@
 #include "tracks/arena_graph.hpp"
 #include "tracks/arena_node.hpp"
 #include "tracks/track.hpp"
+#include "utils/benchmark.hpp"
 #include "utils/string_utils.hpp"
 
 #include <IMesh.h>
@@ -48,24 +49,24 @@ std::vector<scene::IMesh *>  ItemManager::m_item_mesh;
 std::vector<scene::IMesh *>  ItemManager::m_item_lowres_mesh;
 std::vector<video::SColorf>  ItemManager::m_glow_color;
 bool                         ItemManager::m_disable_item_collection = false;
-std::shared_ptr<ItemManager> ItemManager::m_item_manager;
-std::mt19937                 ItemManager::m_random_engine;
+PerRoom<std::shared_ptr<ItemManager> > ItemManager::m_item_manager;
+PerRoom<std::mt19937>         ItemManager::m_random_engine;
 
 //-----------------------------------------------------------------------------
 /** Creates one instance of the item manager. */
 void ItemManager::create()
 {
-    assert(!m_item_manager);
+    assert(!m_item_manager.get());
     // Due to protected constructor use new instead of make_shared
-    m_item_manager = std::shared_ptr<ItemManager>(new ItemManager());
+    m_item_manager.get() = std::shared_ptr<ItemManager>(new ItemManager());
 }   // create
 
 //-----------------------------------------------------------------------------
 /** Destroys the one instance of the item manager. */
 void ItemManager::destroy()
 {
-    assert(m_item_manager);
-    m_item_manager = nullptr;
+    assert(m_item_manager.get());
+    m_item_manager.get() = nullptr;
 }   // destroy
 
 //-----------------------------------------------------------------------------
@@ -472,6 +473,7 @@ void ItemManager::reset()
  */
 void ItemManager::update(int ticks)
 {
+    Benchmark::Timer benchmark_timer(Benchmark::BS_ITEMS);
     // If switch time is over, switch all items back
     if(m_switch_ticks>=0)
     {
@@ -622,7 +624,7 @@ bool ItemManager::randomItemsForArena(const AlignedArray<btTransform>& pos)
                     "Use default item location.");
                 return false;
             }
-            uint32_t number = m_random_engine();
+            uint32_t number = m_random_engine.get()();
             Log::debug("[ItemManager]", "%u from random engine.", number);
             const int node = number % ALL_NODES;
 
@@ -24,6 +24,7 @@
 #include "items/item.hpp"
 #include "utils/aligned_array.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/server_room.hpp"
 #include "utils/vec3.hpp"
 
 #include <SColor.h>
@@ -51,10 +52,10 @@ private:
     /** Disable item collection (for debugging purposes). */
     static bool m_disable_item_collection;
 
-    static std::mt19937 m_random_engine;
+    static PerRoom<std::mt19937> m_random_engine;
 protected:
     /** The instance of ItemManager while a race is on. */
-    static std::shared_ptr<ItemManager> m_item_manager;
+    static PerRoom<std::shared_ptr<ItemManager> > m_item_manager;
 
 public:
     static void loadDefaultItemMeshes();
@@ -63,7 +64,7 @@ public:
     static void destroy();
     static void updateRandomSeed(uint32_t seed_number)
     {
-        m_random_engine.seed(seed_number);
+        m_random_engine.get().seed(seed_number);
     }   // updateRandomSeed
     // ------------------------------------------------------------------------
 
@@ -91,8 +92,8 @@ public:
      *  create one, call create for that). */
     static ItemManager *get()
     {
-        assert(m_item_manager);
-        return m_item_manager.get();
+        assert(m_item_manager.get());
+        return m_item_manager.get().get();
     }   // get
 
     // ========================================================================
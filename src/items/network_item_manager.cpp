@@ -32,10 +32,10 @@ bool NetworkItemManager::m_network_item_debugging = false;
 /** Creates one instance of the item manager. */
 void NetworkItemManager::create()
 {
-    assert(!m_item_manager);
+    assert(!m_item_manager.get());
     auto nim = std::shared_ptr<NetworkItemManager>(new NetworkItemManager());
     nim->rewinderAdd();
-    m_item_manager = nim;
+    m_item_manager.get() = nim;
 }   // create
 
 // ============================================================================
@@ -88,6 +88,10 @@ public:
         OVERRIDE;
     virtual void restoreState(BareNetworkString *buffer, int count) OVERRIDE;
     // ------------------------------------------------------------------------
+    /** A state without item events does not need a rewind. */
+    virtual bool hasDiverged(BareNetworkString *buffer, int count,
+                             int ticks) OVERRIDE           { return count > 0; }
+    // ------------------------------------------------------------------------
     virtual void rewindToEvent(BareNetworkString *bns) OVERRIDE {};
     // ------------------------------------------------------------------------
     virtual void saveTransform() OVERRIDE {};
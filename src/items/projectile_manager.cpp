@@ -30,8 +30,9 @@
 #include "modes/world.hpp"
 #include "network/dummy_rewinder.hpp"
 #include "network/rewind_manager.hpp"
+#include "utils/benchmark.hpp"
 
-ProjectileManager *projectile_manager=0;
+PerRoom<ProjectileManager*> projectile_manager;
 
 void ProjectileManager::loadData()
 {
@@ -74,6 +75,7 @@ void ProjectileManager::updateGraphics(float dt)
 /** General projectile update call. */
 void ProjectileManager::update(int ticks)
 {
+    Benchmark::Timer benchmark_timer(Benchmark::BS_PROJECTILES);
     updateServer(ticks);
 
     if (RewindManager::get()->isRewinding())
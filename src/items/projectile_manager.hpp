@@ -31,6 +31,7 @@ namespace irr
 
 #include "items/powerup_manager.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/server_room.hpp"
 
 class AbstractKart;
 class Flyable;
@@ -96,7 +97,7 @@ public:
                                          { m_deleted_projectiles.insert(uid); }
 };
 
-extern ProjectileManager *projectile_manager;
+extern PerRoom<ProjectileManager*> projectile_manager;
 
 #endif
 
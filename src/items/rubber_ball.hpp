@@ -79,8 +79,9 @@ private:
 
     /** If the ball overtakes its target or starts to aim at the kart which
      *  originally shot the rubber ball, after this amount of time the
-     *  ball will be deleted. */
-    static int m_st_delete_ticks;
+     *  ball will be deleted (in seconds, since the physics fps can be
+     *  changed by a server). */
+    static float m_st_delete_time;
 
     /** If the ball is closer to its target than min_offset_distance, the speed
      *  in addition to the difficulty's default max speed. */
@@ -329,6 +329,8 @@ std::string AbstractCharacteristic::getName(CharacteristicType type)
         return "ENGINE_POWER";
     case ENGINE_MAX_SPEED:
         return "ENGINE_MAX_SPEED";
+    case ENGINE_GENERIC_MAX_SPEED:
+        return "ENGINE_GENERIC_MAX_SPEED";
     case ENGINE_BRAKE_FACTOR:
         return "ENGINE_BRAKE_FACTOR";
     case ENGINE_BRAKE_TIME_INCREASE:
@@ -513,8 +515,6 @@ std::string AbstractCharacteristic::getName(CharacteristicType type)
         return "SKID_REDUCE_TURN_MAX";
     case SKID_ENABLED:
         return "SKID_ENABLED";
-    case ENGINE_GENERIC_MAX_SPEED:
-        return "ENGINE_GENERIC_MAX_SPEED";
 
     /* <characteristics-end getName> */
     }   // switch (type)
@@ -1581,7 +1581,7 @@ float AbstractCharacteristic::getSlipstreamMaxCollectTime() const
         Log::fatal("AbstractCharacteristic", "Can't get characteristic %s",
                     getName(SLIPSTREAM_MAX_COLLECT_TIME).c_str());
     return result;
-}  // getSlipstreamMaxCollecTime
+}  // getSlipstreamMaxCollectTime
 
 // ----------------------------------------------------------------------------
 float AbstractCharacteristic::getSlipstreamAddPower() const
@@ -310,8 +310,8 @@ public:
     float getAnvilSpeedFactor() const;
 
     float getParachuteFriction() const;
-    int   getParachuteDuration() const;
-    int   getParachuteDurationOther() const;
+    int getParachuteDuration() const;
+    int getParachuteDurationOther() const;
     float getParachuteDurationRankMult() const;
     float getParachuteDurationSpeedMult() const;
     float getParachuteLboundFraction() const;
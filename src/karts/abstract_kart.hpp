@@ -426,6 +426,11 @@ public:
     /** Returns the bullet vehicle which represents this kart. */
     virtual btKart* getVehicle() const = 0;
     // ------------------------------------------------------------------------
+    /** Casts the ray to determine the terrain under the kart for the next
+     *  update in advance. This is called for all karts (potentially in
+     *  parallel) before they are updated. */
+    virtual void prefetchTerrainInfo() = 0;
+    // ------------------------------------------------------------------------
     virtual btQuaternion getVisualRotation() const = 0;
     // ------------------------------------------------------------------------
     /** Returns true if the kart is 'resting', i.e. (nearly) not moving. */
@@ -18,44 +18,29 @@
 
 #include "karts/cached_characteristic.hpp"
 
-#include "utils/interpolation_array.hpp"
+#include "config/stk_config.hpp"
+#include "utils/log.hpp"
 
 CachedCharacteristic::CachedCharacteristic(const AbstractCharacteristic *origin) :
-    m_values(CHARACTERISTIC_COUNT),
     m_origin(origin)
 {
     updateSource();
-}
+}   // CachedCharacteristic
 
 // ----------------------------------------------------------------------------
-/** Deletes all allocated values. */
-CachedCharacteristic::~CachedCharacteristic()
+/** Fetches one value from the original source. If it is not set there, the
+ *  value is reset to its default.
+ *  \param type The characteristic to fetch.
+ *  \param value Where the value is saved.
+ */
+template<typename T>
+void CachedCharacteristic::cacheValue(CharacteristicType type, T *value)
 {
-    // Delete all not-null values
-    for (int i = 0; i < CHARACTERISTIC_COUNT; i++)
-    {
-        SaveValue &v = m_values[i];
-        if (v.content)
-        {
-            switch (getType(static_cast<CharacteristicType>(i)))
-            {
-            case TYPE_FLOAT:
-                delete static_cast<float*>(v.content);
-                break;
-            case TYPE_FLOAT_VECTOR:
-                delete static_cast<std::vector<float>*>(v.content);
-                break;
-            case TYPE_INTERPOLATION_ARRAY:
-                delete static_cast<InterpolationArray*>(v.content);
-                break;
-            case TYPE_BOOL:
-                delete static_cast<bool*>(v.content);
-                break;
-            }
-            v.content = nullptr;
-        }
-    }
-}   // ~CachedCharacteristic
+    bool is_set = false;
+    *value = T();
+    m_origin->process(type, value, &is_set);
+    m_is_set[type] = is_set;
+}   // cacheValue
 
 // ----------------------------------------------------------------------------
 /** Recompute the values of all characteristics based on the list of
@@ -63,115 +48,137 @@ CachedCharacteristic::~CachedCharacteristic()
  */
 void CachedCharacteristic::updateSource()
 {
+    // Script-generated content generated by tools/create_kart_properties.py cachedupdate
+    // Please don't change the following tag. It will be automatically detected
+    // by the script and replace the contained content.
+    // To update the code, use tools/update_characteristics.py
+    /* <characteristics-start cachedupdate> */
+    cacheValue(SUSPENSION_STIFFNESS, &m_values.m_suspension_stiffness);
+    cacheValue(SUSPENSION_REST, &m_values.m_suspension_rest);
+    cacheValue(SUSPENSION_TRAVEL, &m_values.m_suspension_travel);
+    cacheValue(SUSPENSION_EXP_SPRING_RESPONSE, &m_values.m_suspension_exp_spring_response);
+    cacheValue(SUSPENSION_MAX_FORCE, &m_values.m_suspension_max_force);
+    cacheValue(STABILITY_ROLL_INFLUENCE, &m_values.m_stability_roll_influence);
+    cacheValue(STABILITY_CHASSIS_LINEAR_DAMPING, &m_values.m_stability_chassis_linear_damping);
+    cacheValue(STABILITY_CHASSIS_ANGULAR_DAMPING, &m_values.m_stability_chassis_angular_damping);
+    cacheValue(STABILITY_DOWNWARD_IMPULSE_FACTOR, &m_values.m_stability_downward_impulse_factor);
+    cacheValue(STABILITY_TRACK_CONNECTION_ACCEL, &m_values.m_stability_track_connection_accel);
+    cacheValue(STABILITY_ANGULAR_FACTOR, &m_values.m_stability_angular_factor);
+    cacheValue(STABILITY_SMOOTH_FLYING_IMPULSE, &m_values.m_stability_smooth_flying_impulse);
+    cacheValue(TURN_RADIUS, &m_values.m_turn_radius);
+    cacheValue(TURN_TIME_RESET_STEER, &m_values.m_turn_time_reset_steer);
+    cacheValue(TURN_TIME_FULL_STEER, &m_values.m_turn_time_full_steer);
+    cacheValue(ENGINE_POWER, &m_values.m_engine_power);
+    cacheValue(ENGINE_MAX_SPEED, &m_values.m_engine_max_speed);
+    cacheValue(ENGINE_GENERIC_MAX_SPEED, &m_values.m_engine_generic_max_speed);
+    cacheValue(ENGINE_BRAKE_FACTOR, &m_values.m_engine_brake_factor);
+    cacheValue(ENGINE_BRAKE_TIME_INCREASE, &m_values.m_engine_brake_time_increase);
+    cacheValue(ENGINE_MAX_SPEED_REVERSE_RATIO, &m_values.m_engine_max_speed_reverse_ratio);
+    cacheValue(GEAR_SWITCH_RATIO, &m_values.m_gear_switch_ratio);
+    cacheValue(GEAR_POWER_INCREASE, &m_values.m_gear_power_increase);
+    cacheValue(MASS, &m_values.m_mass);
+    cacheValue(WHEELS_DAMPING_RELAXATION, &m_values.m_wheels_damping_relaxation);
+    cacheValue(WHEELS_DAMPING_COMPRESSION, &m_values.m_wheels_damping_compression);
+    cacheValue(CAMERA_DISTANCE, &m_values.m_camera_distance);
+    cacheValue(CAMERA_FORWARD_UP_ANGLE, &m_values.m_camera_forward_up_angle);
+    cacheValue(CAMERA_BACKWARD_UP_ANGLE, &m_values.m_camera_backward_up_angle);
+    cacheValue(JUMP_ANIMATION_TIME, &m_values.m_jump_animation_time);
+    cacheValue(LEAN_MAX, &m_values.m_lean_max);
+    cacheValue(LEAN_SPEED, &m_values.m_lean_speed);
+    cacheValue(ANVIL_DURATION, &m_values.m_anvil_duration);
+    cacheValue(ANVIL_WEIGHT, &m_values.m_anvil_weight);
+    cacheValue(ANVIL_SPEED_FACTOR, &m_values.m_anvil_speed_factor);
+    cacheValue(PARACHUTE_FRICTION, &m_values.m_parachute_friction);
+    cacheValue(PARACHUTE_DURATION, &m_values.m_parachute_duration);
+    m_values.m_parachute_duration_ticks =
+        stk_config->time2Ticks(m_values.m_parachute_duration);
+    cacheValue(PARACHUTE_DURATION_OTHER, &m_values.m_parachute_duration_other);
+    m_values.m_parachute_duration_other_ticks =
+        stk_config->time2Ticks(m_values.m_parachute_duration_other);
+    cacheValue(PARACHUTE_DURATION_RANK_MULT, &m_values.m_parachute_duration_rank_mult);
+    cacheValue(PARACHUTE_DURATION_SPEED_MULT, &m_values.m_parachute_duration_speed_mult);
+    cacheValue(PARACHUTE_LBOUND_FRACTION, &m_values.m_parachute_lbound_fraction);
+    cacheValue(PARACHUTE_UBOUND_FRACTION, &m_values.m_parachute_ubound_fraction);
+    cacheValue(PARACHUTE_MAX_SPEED, &m_values.m_parachute_max_speed);
+    cacheValue(FRICTION_KART_FRICTION, &m_values.m_friction_kart_friction);
+    cacheValue(BUBBLEGUM_DURATION, &m_values.m_bubblegum_duration);
+    cacheValue(BUBBLEGUM_SPEED_FRACTION, &m_values.m_bubblegum_speed_fraction);
+    cacheValue(BUBBLEGUM_TORQUE, &m_values.m_bubblegum_torque);
+    cacheValue(BUBBLEGUM_FADE_IN_TIME, &m_values.m_bubblegum_fade_in_time);
+    cacheValue(BUBBLEGUM_SHIELD_DURATION, &m_values.m_bubblegum_shield_duration);
+    cacheValue(ZIPPER_DURATION, &m_values.m_zipper_duration);
+    cacheValue(ZIPPER_FORCE, &m_values.m_zipper_force);
+    cacheValue(ZIPPER_SPEED_GAIN, &m_values.m_zipper_speed_gain);
+    cacheValue(ZIPPER_MAX_SPEED_INCREASE, &m_values.m_zipper_max_speed_increase);
+    cacheValue(ZIPPER_FADE_OUT_TIME, &m_values.m_zipper_fade_out_time);
+    cacheValue(SWATTER_DURATION, &m_values.m_swatter_duration);
+    cacheValue(SWATTER_DISTANCE, &m_values.m_swatter_distance);
+    cacheValue(SWATTER_SQUASH_DURATION, &m_values.m_swatter_squash_duration);
+    cacheValue(SWATTER_SQUASH_SLOWDOWN, &m_values.m_swatter_squash_slowdown);
+    cacheValue(PLUNGER_BAND_MAX_LENGTH, &m_values.m_plunger_band_max_length);
+    cacheValue(PLUNGER_BAND_FORCE, &m_values.m_plunger_band_force);
+    cacheValue(PLUNGER_BAND_DURATION, &m_values.m_plunger_band_duration);
+    cacheValue(PLUNGER_BAND_SPEED_INCREASE, &m_values.m_plunger_band_speed_increase);
+    cacheValue(PLUNGER_BAND_FADE_OUT_TIME, &m_values.m_plunger_band_fade_out_time);
+    cacheValue(PLUNGER_IN_FACE_TIME, &m_values.m_plunger_in_face_time);
+    cacheValue(STARTUP_TIME, &m_values.m_startup_time);
+    cacheValue(STARTUP_BOOST, &m_values.m_startup_boost);
+    cacheValue(RESCUE_DURATION, &m_values.m_rescue_duration);
+    cacheValue(RESCUE_VERT_OFFSET, &m_values.m_rescue_vert_offset);
+    cacheValue(RESCUE_HEIGHT, &m_values.m_rescue_height);
+    cacheValue(EXPLOSION_DURATION, &m_values.m_explosion_duration);
+    cacheValue(EXPLOSION_RADIUS, &m_values.m_explosion_radius);
+    cacheValue(EXPLOSION_INVULNERABILITY_TIME, &m_values.m_explosion_invulnerability_time);
+    cacheValue(NITRO_DURATION, &m_values.m_nitro_duration);
+    cacheValue(NITRO_ENGINE_FORCE, &m_values.m_nitro_engine_force);
+    cacheValue(NITRO_ENGINE_MULT, &m_values.m_nitro_engine_mult);
+    cacheValue(NITRO_CONSUMPTION, &m_values.m_nitro_consumption);
+    cacheValue(NITRO_SMALL_CONTAINER, &m_values.m_nitro_small_container);
+    cacheValue(NITRO_BIG_CONTAINER, &m_values.m_nitro_big_container);
+    cacheValue(NITRO_MAX_SPEED_INCREASE, &m_values.m_nitro_max_speed_increase);
+    cacheValue(NITRO_FADE_OUT_TIME, &m_values.m_nitro_fade_out_time);
+    cacheValue(NITRO_MAX, &m_values.m_nitro_max);
+    cacheValue(SLIPSTREAM_DURATION_FACTOR, &m_values.m_slipstream_duration_factor);
+    cacheValue(SLIPSTREAM_BASE_SPEED, &m_values.m_slipstream_base_speed);
+    cacheValue(SLIPSTREAM_LENGTH, &m_values.m_slipstream_length);
+    cacheValue(SLIPSTREAM_WIDTH, &m_values.m_slipstream_width);
+    cacheValue(SLIPSTREAM_INNER_FACTOR, &m_values.m_slipstream_inner_factor);
+    cacheValue(SLIPSTREAM_MIN_COLLECT_TIME, &m_values.m_slipstream_min_collect_time);
+    cacheValue(SLIPSTREAM_MAX_COLLECT_TIME, &m_values.m_slipstream_max_collect_time);
+    cacheValue(SLIPSTREAM_ADD_POWER, &m_values.m_slipstream_add_power);
+    cacheValue(SLIPSTREAM_MIN_SPEED, &m_values.m_slipstream_min_speed);
+    cacheValue(SLIPSTREAM_MAX_SPEED_INCREASE, &m_values.m_slipstream_max_speed_increase);
+    cacheValue(SLIPSTREAM_FADE_OUT_TIME, &m_values.m_slipstream_fade_out_time);
+    cacheValue(SKID_INCREASE, &m_values.m_skid_increase);
+    cacheValue(SKID_DECREASE, &m_values.m_skid_decrease);
+    cacheValue(SKID_MAX, &m_values.m_skid_max);
+    cacheValue(SKID_TIME_TILL_MAX, &m_values.m_skid_time_till_max);
+    cacheValue(SKID_VISUAL, &m_values.m_skid_visual);
+    cacheValue(SKID_VISUAL_TIME, &m_values.m_skid_visual_time);
+    cacheValue(SKID_REVERT_VISUAL_TIME, &m_values.m_skid_revert_visual_time);
+    cacheValue(SKID_MIN_SPEED, &m_values.m_skid_min_speed);
+    cacheValue(SKID_TIME_TILL_BONUS, &m_values.m_skid_time_till_bonus);
+    cacheValue(SKID_BONUS_SPEED, &m_values.m_skid_bonus_speed);
+    cacheValue(SKID_BONUS_TIME, &m_values.m_skid_bonus_time);
+    cacheValue(SKID_BONUS_FORCE, &m_values.m_skid_bonus_force);
+    cacheValue(SKID_PHYSICAL_JUMP_TIME, &m_values.m_skid_physical_jump_time);
+    cacheValue(SKID_GRAPHICAL_JUMP_TIME, &m_values.m_skid_graphical_jump_time);
+    cacheValue(SKID_POST_SKID_ROTATE_FACTOR, &m_values.m_skid_post_skid_rotate_factor);
+    cacheValue(SKID_REDUCE_TURN_MIN, &m_values.m_skid_reduce_turn_min);
+    cacheValue(SKID_REDUCE_TURN_MAX, &m_values.m_skid_reduce_turn_max);
+    cacheValue(SKID_ENABLED, &m_values.m_skid_enabled);
+
+    /* <characteristics-end cachedupdate> */
+
+    // The getters of this class can't report a missing value, so warn here
     for (int i = 0; i < CHARACTERISTIC_COUNT; i++)
     {
-        SaveValue &v = m_values[i];
-        
-        bool is_set = false;
-        switch (getType(static_cast<CharacteristicType>(i)))
-        {
-        case TYPE_FLOAT:
-        {
-            float value;
-            float *ptr = static_cast<float*>(v.content);
-            m_origin->process(static_cast<CharacteristicType>(i), &value, &is_set);
-            if (is_set)
-            {
-                if (!ptr)
-                {
-                    float *newPtr = new float();
-                    v.content = newPtr;
-                    ptr = newPtr;
-                }
-                *ptr = value;
-            }
-            else
-            {
-                if (ptr)
-                {
-                    delete ptr;
-                    v.content = nullptr;
-                }
-            }
-            break;
-        }
-        case TYPE_FLOAT_VECTOR:
+        if (!m_is_set[i])
         {
-            std::vector<float> value;
-            std::vector<float> *ptr = static_cast<std::vector<float>*>(v.content);
-            m_origin->process(static_cast<CharacteristicType>(i), &value, &is_set);
-            if (is_set)
-            {
-                if (!ptr)
-                {
-                    std::vector<float> *newPtr = new std::vector<float>();
-                    v.content = newPtr;
-                    ptr = newPtr;
-                }
-                *ptr = value;
-            }
-            else
-            {
-                if (ptr)
-                {
-                    delete ptr;
-                    v.content = nullptr;
-                }
-            }
-            break;
+            Log::warn("CachedCharacteristic", "Characteristic %s is not set",
+                      getName(static_cast<CharacteristicType>(i)).c_str());
         }
-        case TYPE_INTERPOLATION_ARRAY:
-        {
-            InterpolationArray value;
-            InterpolationArray *ptr = static_cast<InterpolationArray*>(v.content);
-            m_origin->process(static_cast<CharacteristicType>(i), &value, &is_set);
-            if (is_set)
-            {
-                if (!ptr)
-                {
-                    InterpolationArray *newPtr = new InterpolationArray();
-                    v.content = newPtr;
-                    ptr = newPtr;
-                }
-                *ptr = value;
-            }
-            else
-            {
-                if (ptr)
-                {
-                    delete ptr;
-                    v.content = nullptr;
-                }
-            }
-            break;
-        }
-        case TYPE_BOOL:
-        {
-            bool value;
-            bool *ptr = static_cast<bool*>(v.content);
-            m_origin->process(static_cast<CharacteristicType>(i), &value, &is_set);
-            if (is_set)
-            {
-                if (!ptr)
-                {
-                    bool *newPtr = new bool();
-                    v.content = newPtr;
-                    ptr = newPtr;
-                }
-                *ptr = value;
-            }
-            else
-            {
-                if (ptr)
-                {
-                    delete ptr;
-                    v.content = nullptr;
-                }
-            }
-            break;
-        }
-        }   // switch (type)
-    }   // foreach characteristic
+    }
 }   // updateSource
 
 // ----------------------------------------------------------------------------
@@ -179,25 +186,351 @@ void CachedCharacteristic::updateSource()
 void CachedCharacteristic::process(CharacteristicType type, Value value,
                                    bool *is_set) const
 {
-    void *v = m_values[type].content;
-    if (v)
+    if (!m_is_set[type])
+        return;
+
+    switch (type)
     {
-        switch (getType(type))
-        {
-        case TYPE_FLOAT:
-            *value.f = *static_cast<float*>(v);
-            break;
-        case TYPE_FLOAT_VECTOR:
-            *value.fv = *static_cast<std::vector<float>*>(v);
-            break;
-        case TYPE_INTERPOLATION_ARRAY:
-            *value.ia = *static_cast<InterpolationArray*>(v);
-            break;
-        case TYPE_BOOL:
-            *value.b = *static_cast<bool*>(v);
-            break;
-        }
-        *is_set = true;
-    }
-}   // process
+    case CHARACTERISTIC_COUNT:
+        Log::fatal("CachedCharacteristic::process", "Can't process COUNT");
+        break;
+    // Script-generated content generated by tools/create_kart_properties.py cachedprocess
+    // Please don't change the following tag. It will be automatically detected
+    // by the script and replace the contained content.
+    // To update the code, use tools/update_characteristics.py
+    /* <characteristics-start cachedprocess> */
+    case SUSPENSION_STIFFNESS:
+        *value.f = m_values.m_suspension_stiffness;
+        break;
+    case SUSPENSION_REST:
+        *value.f = m_values.m_suspension_rest;
+        break;
+    case SUSPENSION_TRAVEL:
+        *value.f = m_values.m_suspension_travel;
+        break;
+    case SUSPENSION_EXP_SPRING_RESPONSE:
+        *value.b = m_values.m_suspension_exp_spring_response;
+        break;
+    case SUSPENSION_MAX_FORCE:
+        *value.f = m_values.m_suspension_max_force;
+        break;
+    case STABILITY_ROLL_INFLUENCE:
+        *value.f = m_values.m_stability_roll_influence;
+        break;
+    case STABILITY_CHASSIS_LINEAR_DAMPING:
+        *value.f = m_values.m_stability_chassis_linear_damping;
+        break;
+    case STABILITY_CHASSIS_ANGULAR_DAMPING:
+        *value.f = m_values.m_stability_chassis_angular_damping;
+        break;
+    case STABILITY_DOWNWARD_IMPULSE_FACTOR:
+        *value.f = m_values.m_stability_downward_impulse_factor;
+        break;
+    case STABILITY_TRACK_CONNECTION_ACCEL:
+        *value.f = m_values.m_stability_track_connection_accel;
+        break;
+    case STABILITY_ANGULAR_FACTOR:
+        *value.fv = m_values.m_stability_angular_factor;
+        break;
+    case STABILITY_SMOOTH_FLYING_IMPULSE:
+        *value.f = m_values.m_stability_smooth_flying_impulse;
+        break;
+    case TURN_RADIUS:
+        *value.ia = m_values.m_turn_radius;
+        break;
+    case TURN_TIME_RESET_STEER:
+        *value.f = m_values.m_turn_time_reset_steer;
+        break;
+    case TURN_TIME_FULL_STEER:
+        *value.ia = m_values.m_turn_time_full_steer;
+        break;
+    case ENGINE_POWER:
+        *value.f = m_values.m_engine_power;
+        break;
+    case ENGINE_MAX_SPEED:
+        *value.f = m_values.m_engine_max_speed;
+        break;
+    case ENGINE_GENERIC_MAX_SPEED:
+        *value.f = m_values.m_engine_generic_max_speed;
+        break;
+    case ENGINE_BRAKE_FACTOR:
+        *value.f = m_values.m_engine_brake_factor;
+        break;
+    case ENGINE_BRAKE_TIME_INCREASE:
+        *value.f = m_values.m_engine_brake_time_increase;
+        break;
+    case ENGINE_MAX_SPEED_REVERSE_RATIO:
+        *value.f = m_values.m_engine_max_speed_reverse_ratio;
+        break;
+    case GEAR_SWITCH_RATIO:
+        *value.fv = m_values.m_gear_switch_ratio;
+        break;
+    case GEAR_POWER_INCREASE:
+        *value.fv = m_values.m_gear_power_increase;
+        break;
+    case MASS:
+        *value.f = m_values.m_mass;
+        break;
+    case WHEELS_DAMPING_RELAXATION:
+        *value.f = m_values.m_wheels_damping_relaxation;
+        break;
+    case WHEELS_DAMPING_COMPRESSION:
+        *value.f = m_values.m_wheels_damping_compression;
+        break;
+    case CAMERA_DISTANCE:
+        *value.f = m_values.m_camera_distance;
+        break;
+    case CAMERA_FORWARD_UP_ANGLE:
+        *value.f = m_values.m_camera_forward_up_angle;
+        break;
+    case CAMERA_BACKWARD_UP_ANGLE:
+        *value.f = m_values.m_camera_backward_up_angle;
+        break;
+    case JUMP_ANIMATION_TIME:
+        *value.f = m_values.m_jump_animation_time;
+        break;
+    case LEAN_MAX:
+        *value.f = m_values.m_lean_max;
+        break;
+    case LEAN_SPEED:
+        *value.f = m_values.m_lean_speed;
+        break;
+    case ANVIL_DURATION:
+        *value.f = m_values.m_anvil_duration;
+        break;
+    case ANVIL_WEIGHT:
+        *value.f = m_values.m_anvil_weight;
+        break;
+    case ANVIL_SPEED_FACTOR:
+        *value.f = m_values.m_anvil_speed_factor;
+        break;
+    case PARACHUTE_FRICTION:
+        *value.f = m_values.m_parachute_friction;
+        break;
+    case PARACHUTE_DURATION:
+        *value.f = m_values.m_parachute_duration;
+        break;
+    case PARACHUTE_DURATION_OTHER:
+        *value.f = m_values.m_parachute_duration_other;
+        break;
+    case PARACHUTE_DURATION_RANK_MULT:
+        *value.f = m_values.m_parachute_duration_rank_mult;
+        break;
+    case PARACHUTE_DURATION_SPEED_MULT:
+        *value.f = m_values.m_parachute_duration_speed_mult;
+        break;
+    case PARACHUTE_LBOUND_FRACTION:
+        *value.f = m_values.m_parachute_lbound_fraction;
+        break;
+    case PARACHUTE_UBOUND_FRACTION:
+        *value.f = m_values.m_parachute_ubound_fraction;
+        break;
+    case PARACHUTE_MAX_SPEED:
+        *value.f = m_values.m_parachute_max_speed;
+        break;
+    case FRICTION_KART_FRICTION:
+        *value.f = m_values.m_friction_kart_friction;
+        break;
+    case BUBBLEGUM_DURATION:
+        *value.f = m_values.m_bubblegum_duration;
+        break;
+    case BUBBLEGUM_SPEED_FRACTION:
+        *value.f = m_values.m_bubblegum_speed_fraction;
+        break;
+    case BUBBLEGUM_TORQUE:
+        *value.f = m_values.m_bubblegum_torque;
+        break;
+    case BUBBLEGUM_FADE_IN_TIME:
+        *value.f = m_values.m_bubblegum_fade_in_time;
+        break;
+    case BUBBLEGUM_SHIELD_DURATION:
+        *value.f = m_values.m_bubblegum_shield_duration;
+        break;
+    case ZIPPER_DURATION:
+        *value.f = m_values.m_zipper_duration;
+        break;
+    case ZIPPER_FORCE:
+        *value.f = m_values.m_zipper_force;
+        break;
+    case ZIPPER_SPEED_GAIN:
+        *value.f = m_values.m_zipper_speed_gain;
+        break;
+    case ZIPPER_MAX_SPEED_INCREASE:
+        *value.f = m_values.m_zipper_max_speed_increase;
+        break;
+    case ZIPPER_FADE_OUT_TIME:
+        *value.f = m_values.m_zipper_fade_out_time;
+        break;
+    case SWATTER_DURATION:
+        *value.f = m_values.m_swatter_duration;
+        break;
+    case SWATTER_DISTANCE:
+        *value.f = m_values.m_swatter_distance;
+        break;
+    case SWATTER_SQUASH_DURATION:
+        *value.f = m_values.m_swatter_squash_duration;
+        break;
+    case SWATTER_SQUASH_SLOWDOWN:
+        *value.f = m_values.m_swatter_squash_slowdown;
+        break;
+    case PLUNGER_BAND_MAX_LENGTH:
+        *value.f = m_values.m_plunger_band_max_length;
+        break;
+    case PLUNGER_BAND_FORCE:
+        *value.f = m_values.m_plunger_band_force;
+        break;
+    case PLUNGER_BAND_DURATION:
+        *value.f = m_values.m_plunger_band_duration;
+        break;
+    case PLUNGER_BAND_SPEED_INCREASE:
+        *value.f = m_values.m_plunger_band_speed_increase;
+        break;
+    case PLUNGER_BAND_FADE_OUT_TIME:
+        *value.f = m_values.m_plunger_band_fade_out_time;
+        break;
+    case PLUNGER_IN_FACE_TIME:
+        *value.f = m_values.m_plunger_in_face_time;
+        break;
+    case STARTUP_TIME:
+        *value.fv = m_values.m_startup_time;
+        break;
+    case STARTUP_BOOST:
+        *value.fv = m_values.m_startup_boost;
+        break;
+    case RESCUE_DURATION:
+        *value.f = m_values.m_rescue_duration;
+        break;
+    case RESCUE_VERT_OFFSET:
+        *value.f = m_values.m_rescue_vert_offset;
+        break;
+    case RESCUE_HEIGHT:
+        *value.f = m_values.m_rescue_height;
+        break;
+    case EXPLOSION_DURATION:
+        *value.f = m_values.m_explosion_duration;
+        break;
+    case EXPLOSION_RADIUS:
+        *value.f = m_values.m_explosion_radius;
+        break;
+    case EXPLOSION_INVULNERABILITY_TIME:
+        *value.f = m_values.m_explosion_invulnerability_time;
+        break;
+    case NITRO_DURATION:
+        *value.f = m_values.m_nitro_duration;
+        break;
+    case NITRO_ENGINE_FORCE:
+        *value.f = m_values.m_nitro_engine_force;
+        break;
+    case NITRO_ENGINE_MULT:
+        *value.f = m_values.m_nitro_engine_mult;
+        break;
+    case NITRO_CONSUMPTION:
+        *value.f = m_values.m_nitro_consumption;
+        break;
+    case NITRO_SMALL_CONTAINER:
+        *value.f = m_values.m_nitro_small_container;
+        break;
+    case NITRO_BIG_CONTAINER:
+        *value.f = m_values.m_nitro_big_container;
+        break;
+    case NITRO_MAX_SPEED_INCREASE:
+        *value.f = m_values.m_nitro_max_speed_increase;
+        break;
+    case NITRO_FADE_OUT_TIME:
+        *value.f = m_values.m_nitro_fade_out_time;
+        break;
+    case NITRO_MAX:
+        *value.f = m_values.m_nitro_max;
+        break;
+    case SLIPSTREAM_DURATION_FACTOR:
+        *value.f = m_values.m_slipstream_duration_factor;
+        break;
+    case SLIPSTREAM_BASE_SPEED:
+        *value.f = m_values.m_slipstream_base_speed;
+        break;
+    case SLIPSTREAM_LENGTH:
+        *value.f = m_values.m_slipstream_length;
+        break;
+    case SLIPSTREAM_WIDTH:
+        *value.f = m_values.m_slipstream_width;
+        break;
+    case SLIPSTREAM_INNER_FACTOR:
+        *value.f = m_values.m_slipstream_inner_factor;
+        break;
+    case SLIPSTREAM_MIN_COLLECT_TIME:
+        *value.f = m_values.m_slipstream_min_collect_time;
+        break;
+    case SLIPSTREAM_MAX_COLLECT_TIME:
+        *value.f = m_values.m_slipstream_max_collect_time;
+        break;
+    case SLIPSTREAM_ADD_POWER:
+        *value.f = m_values.m_slipstream_add_power;
+        break;
+    case SLIPSTREAM_MIN_SPEED:
+        *value.f = m_values.m_slipstream_min_speed;
+        break;
+    case SLIPSTREAM_MAX_SPEED_INCREASE:
+        *value.f = m_values.m_slipstream_max_speed_increase;
+        break;
+    case SLIPSTREAM_FADE_OUT_TIME:
+        *value.f = m_values.m_slipstream_fade_out_time;
+        break;
+    case SKID_INCREASE:
+        *value.f = m_values.m_skid_increase;
+        break;
+    case SKID_DECREASE:
+        *value.f = m_values.m_skid_decrease;
+        break;
+    case SKID_MAX:
+        *value.f = m_values.m_skid_max;
+        break;
+    case SKID_TIME_TILL_MAX:
+        *value.f = m_values.m_skid_time_till_max;
+        break;
+    case SKID_VISUAL:
+        *value.f = m_values.m_skid_visual;
+        break;
+    case SKID_VISUAL_TIME:
+        *value.f = m_values.m_skid_visual_time;
+        break;
+    case SKID_REVERT_VISUAL_TIME:
+        *value.f = m_values.m_skid_revert_visual_time;
+        break;
+    case SKID_MIN_SPEED:
+        *value.f = m_values.m_skid_min_speed;
+        break;
+    case SKID_TIME_TILL_BONUS:
+        *value.fv = m_values.m_skid_time_till_bonus;
+        break;
+    case SKID_BONUS_SPEED:
+        *value.fv = m_values.m_skid_bonus_speed;
+        break;
+    case SKID_BONUS_TIME:
+        *value.fv = m_values.m_skid_bonus_time;
+        break;
+    case SKID_BONUS_FORCE:
+        *value.fv = m_values.m_skid_bonus_force;
+        break;
+    case SKID_PHYSICAL_JUMP_TIME:
+        *value.f = m_values.m_skid_physical_jump_time;
+        break;
+    case SKID_GRAPHICAL_JUMP_TIME:
+        *value.f = m_values.m_skid_graphical_jump_time;
+        break;
+    case SKID_POST_SKID_ROTATE_FACTOR:
+        *value.f = m_values.m_skid_post_skid_rotate_factor;
+        break;
+    case SKID_REDUCE_TURN_MIN:
+        *value.f = m_values.m_skid_reduce_turn_min;
+        break;
+    case SKID_REDUCE_TURN_MAX:
+        *value.f = m_values.m_skid_reduce_turn_max;
+        break;
+    case SKID_ENABLED:
+        *value.b = m_values.m_skid_enabled;
+        break;
 
+    /* <characteristics-end cachedprocess> */
+    }   // switch (type)
+    *is_set = true;
+}   // process
@@ -20,37 +20,441 @@
 #define HEADER_CACHED_CHARACTERISTICS_HPP
 
 #include "karts/abstract_characteristic.hpp"
+#include "utils/interpolation_array.hpp"
 
 #include <assert.h>
+#include <bitset>
+#include <vector>
 
+/** Caches the values of another characteristic (usually a combined
+ *  characteristic), so that they don't need to be recomputed each time
+ *  they are used. All values are saved with their actual type in one
+ *  struct, so the getters of this class are plain loads. They hide the
+ *  (non-virtual) getters of AbstractCharacteristic, which go through
+ *  process().
+ */
 class CachedCharacteristic : public AbstractCharacteristic
 {
 private:
-    /** Used to store a value. */
-    struct SaveValue
+    /** The values of all characteristics. */
+    struct Values
     {
-        void *content;
+        // Script-generated content generated by tools/create_kart_properties.py cachedvalues
+        // Please don't change the following tag. It will be automatically detected
+        // by the script and replace the contained content.
+        // To update the code, use tools/update_characteristics.py
+        /* <characteristics-start cachedvalues> */
 
-        SaveValue() : content(nullptr) {}
-        SaveValue(void *content) : content(content) {}
+        float m_suspension_stiffness;
+        float m_suspension_rest;
+        float m_suspension_travel;
+        bool m_suspension_exp_spring_response;
+        float m_suspension_max_force;
+
+        float m_stability_roll_influence;
+        float m_stability_chassis_linear_damping;
+        float m_stability_chassis_angular_damping;
+        float m_stability_downward_impulse_factor;
+        float m_stability_track_connection_accel;
+        std::vector<float> m_stability_angular_factor;
+        float m_stability_smooth_flying_impulse;
+
+        InterpolationArray m_turn_radius;
+        float m_turn_time_reset_steer;
+        InterpolationArray m_turn_time_full_steer;
+
+        float m_engine_power;
+        float m_engine_max_speed;
+        float m_engine_generic_max_speed;
+        float m_engine_brake_factor;
+        float m_engine_brake_time_increase;
+        float m_engine_max_speed_reverse_ratio;
+
+        std::vector<float> m_gear_switch_ratio;
+        std::vector<float> m_gear_power_increase;
+
+        float m_mass;
+
+        float m_wheels_damping_relaxation;
+        float m_wheels_damping_compression;
+
+        float m_camera_distance;
+        float m_camera_forward_up_angle;
+        float m_camera_backward_up_angle;
+
+        float m_jump_animation_time;
+
+        float m_lean_max;
+        float m_lean_speed;
+
+        float m_anvil_duration;
+        float m_anvil_weight;
+        float m_anvil_speed_factor;
+
+        float m_parachute_friction;
+        float m_parachute_duration;
+        int m_parachute_duration_ticks;
+        float m_parachute_duration_other;
+        int m_parachute_duration_other_ticks;
+        float m_parachute_duration_rank_mult;
+        float m_parachute_duration_speed_mult;
+        float m_parachute_lbound_fraction;
+        float m_parachute_ubound_fraction;
+        float m_parachute_max_speed;
+
+        float m_friction_kart_friction;
+
+        float m_bubblegum_duration;
+        float m_bubblegum_speed_fraction;
+        float m_bubblegum_torque;
+        float m_bubblegum_fade_in_time;
+        float m_bubblegum_shield_duration;
+
+        float m_zipper_duration;
+        float m_zipper_force;
+        float m_zipper_speed_gain;
+        float m_zipper_max_speed_increase;
+        float m_zipper_fade_out_time;
+
+        float m_swatter_duration;
+        float m_swatter_distance;
+        float m_swatter_squash_duration;
+        float m_swatter_squash_slowdown;
+
+        float m_plunger_band_max_length;
+        float m_plunger_band_force;
+        float m_plunger_band_duration;
+        float m_plunger_band_speed_increase;
+        float m_plunger_band_fade_out_time;
+        float m_plunger_in_face_time;
+
+        std::vector<float> m_startup_time;
+        std::vector<float> m_startup_boost;
+
+        float m_rescue_duration;
+        float m_rescue_vert_offset;
+        float m_rescue_height;
+
+        float m_explosion_duration;
+        float m_explosion_radius;
+        float m_explosion_invulnerability_time;
+
+        float m_nitro_duration;
+        float m_nitro_engine_force;
+        float m_nitro_engine_mult;
+        float m_nitro_consumption;
+        float m_nitro_small_container;
+        float m_nitro_big_container;
+        float m_nitro_max_speed_increase;
+        float m_nitro_fade_out_time;
+        float m_nitro_max;
+
+        float m_slipstream_duration_factor;
+        float m_slipstream_base_speed;
+        float m_slipstream_length;
+        float m_slipstream_width;
+        float m_slipstream_inner_factor;
+        float m_slipstream_min_collect_time;
+        float m_slipstream_max_collect_time;
+        float m_slipstream_add_power;
+        float m_slipstream_min_speed;
+        float m_slipstream_max_speed_increase;
+        float m_slipstream_fade_out_time;
+
+        float m_skid_increase;
+        float m_skid_decrease;
+        float m_skid_max;
+        float m_skid_time_till_max;
+        float m_skid_visual;
+        float m_skid_visual_time;
+        float m_skid_revert_visual_time;
+        float m_skid_min_speed;
+        std::vector<float> m_skid_time_till_bonus;
+        std::vector<float> m_skid_bonus_speed;
+        std::vector<float> m_skid_bonus_time;
+        std::vector<float> m_skid_bonus_force;
+        float m_skid_physical_jump_time;
+        float m_skid_graphical_jump_time;
+        float m_skid_post_skid_rotate_factor;
+        float m_skid_reduce_turn_min;
+        float m_skid_reduce_turn_max;
+        bool m_skid_enabled;
+
+        /* <characteristics-end cachedvalues> */
     };
 
-    /** All values for a characteristic. A nullptr means it is not set. */
-    std::vector<SaveValue> m_values;
+    /** The cached values. */
+    Values m_values;
+
+    /** Which characteristics are set in the origin. */
+    std::bitset<CHARACTERISTIC_COUNT> m_is_set;
 
     /** The characteristics that hold the original values. */
     const AbstractCharacteristic *m_origin;
 
+    template<typename T>
+    void cacheValue(CharacteristicType type, T *value);
+
 public:
     CachedCharacteristic(const AbstractCharacteristic *origin);
     CachedCharacteristic(const CachedCharacteristic &characteristics) = delete;
-    virtual ~CachedCharacteristic();
+    virtual ~CachedCharacteristic() {}
 
     /** Fetches all cached values from the original source. */
     void updateSource();
     virtual void copyFrom(const AbstractCharacteristic *other) { assert(false); }
     virtual void process(CharacteristicType type, Value value, bool *is_set) const;
+
+    // Script-generated content generated by tools/create_kart_properties.py cacheddefs
+    // Please don't change the following tag. It will be automatically detected
+    // by the script and replace the contained content.
+    // To update the code, use tools/update_characteristics.py
+    /* <characteristics-start cacheddefs> */
+
+    float getSuspensionStiffness() const
+        { return m_values.m_suspension_stiffness; }
+    float getSuspensionRest() const
+        { return m_values.m_suspension_rest; }
+    float getSuspensionTravel() const
+        { return m_values.m_suspension_travel; }
+    bool getSuspensionExpSpringResponse() const
+        { return m_values.m_suspension_exp_spring_response; }
+    float getSuspensionMaxForce() const
+        { return m_values.m_suspension_max_force; }
+
+    float getStabilityRollInfluence() const
+        { return m_values.m_stability_roll_influence; }
+    float getStabilityChassisLinearDamping() const
+        { return m_values.m_stability_chassis_linear_damping; }
+    float getStabilityChassisAngularDamping() const
+        { return m_values.m_stability_chassis_angular_damping; }
+    float getStabilityDownwardImpulseFactor() const
+        { return m_values.m_stability_downward_impulse_factor; }
+    float getStabilityTrackConnectionAccel() const
+        { return m_values.m_stability_track_connection_accel; }
+    const std::vector<float>& getStabilityAngularFactor() const
+        { return m_values.m_stability_angular_factor; }
+    float getStabilitySmoothFlyingImpulse() const
+        { return m_values.m_stability_smooth_flying_impulse; }
+
+    const InterpolationArray& getTurnRadius() const
+        { return m_values.m_turn_radius; }
+    float getTurnTimeResetSteer() const
+        { return m_values.m_turn_time_reset_steer; }
+    const InterpolationArray& getTurnTimeFullSteer() const
+        { return m_values.m_turn_time_full_steer; }
+
+    float getEnginePower() const
+        { return m_values.m_engine_power; }
+    float getEngineMaxSpeed() const
+        { return m_values.m_engine_max_speed; }
+    float getEngineGenericMaxSpeed() const
+        { return m_values.m_engine_generic_max_speed; }
+    float getEngineBrakeFactor() const
+        { return m_values.m_engine_brake_factor; }
+    float getEngineBrakeTimeIncrease() const
+        { return m_values.m_engine_brake_time_increase; }
+    float getEngineMaxSpeedReverseRatio() const
+        { return m_values.m_engine_max_speed_reverse_ratio; }
+
+    const std::vector<float>& getGearSwitchRatio() const
+        { return m_values.m_gear_switch_ratio; }
+    const std::vector<float>& getGearPowerIncrease() const
+        { return m_values.m_gear_power_increase; }
+
+    float getMass() const
+        { return m_values.m_mass; }
+
+    float getWheelsDampingRelaxation() const
+        { return m_values.m_wheels_damping_relaxation; }
+    float getWheelsDampingCompression() const
+        { return m_values.m_wheels_damping_compression; }
+
+    float getCameraDistance() const
+        { return m_values.m_camera_distance; }
+    float getCameraForwardUpAngle() const
+        { return m_values.m_camera_forward_up_angle; }
+    float getCameraBackwardUpAngle() const
+        { return m_values.m_camera_backward_up_angle; }
+
+    float getJumpAnimationTime() const
+        { return m_values.m_jump_animation_time; }
+
+    float getLeanMax() const
+        { return m_values.m_lean_max; }
+    float getLeanSpeed() const
+        { return m_values.m_lean_speed; }
+
+    float getAnvilDuration() const
+        { return m_values.m_anvil_duration; }
+    float getAnvilWeight() const
+        { return m_values.m_anvil_weight; }
+    float getAnvilSpeedFactor() const
+        { return m_values.m_anvil_speed_factor; }
+
+    float getParachuteFriction() const
+        { return m_values.m_parachute_friction; }
+    int getParachuteDuration() const
+        { return m_values.m_parachute_duration_ticks; }
+    int getParachuteDurationOther() const
+        { return m_values.m_parachute_duration_other_ticks; }
+    float getParachuteDurationRankMult() const
+        { return m_values.m_parachute_duration_rank_mult; }
+    float getParachuteDurationSpeedMult() const
+        { return m_values.m_parachute_duration_speed_mult; }
+    float getParachuteLboundFraction() const
+        { return m_values.m_parachute_lbound_fraction; }
+    float getParachuteUboundFraction() const
+        { return m_values.m_parachute_ubound_fraction; }
+    float getParachuteMaxSpeed() const
+        { return m_values.m_parachute_max_speed; }
+
+    float getFrictionKartFriction() const
+        { return m_values.m_friction_kart_friction; }
+
+    float getBubblegumDuration() const
+        { return m_values.m_bubblegum_duration; }
+    float getBubblegumSpeedFraction() const
+        { return m_values.m_bubblegum_speed_fraction; }
+    float getBubblegumTorque() const
+        { return m_values.m_bubblegum_torque; }
+    float getBubblegumFadeInTime() const
+        { return m_values.m_bubblegum_fade_in_time; }
+    float getBubblegumShieldDuration() const
+        { return m_values.m_bubblegum_shield_duration; }
+
+    float getZipperDuration() const
+        { return m_values.m_zipper_duration; }
+    float getZipperForce() const
+        { return m_values.m_zipper_force; }
+    float getZipperSpeedGain() const
+        { return m_values.m_zipper_speed_gain; }
+    float getZipperMaxSpeedIncrease() const
+        { return m_values.m_zipper_max_speed_increase; }
+    float getZipperFadeOutTime() const
+        { return m_values.m_zipper_fade_out_time; }
+
+    float getSwatterDuration() const
+        { return m_values.m_swatter_duration; }
+    float getSwatterDistance() const
+        { return m_values.m_swatter_distance; }
+    float getSwatterSquashDuration() const
+        { return m_values.m_swatter_squash_duration; }
+    float getSwatterSquashSlowdown() const
+        { return m_values.m_swatter_squash_slowdown; }
+
+    float getPlungerBandMaxLength() const
+        { return m_values.m_plunger_band_max_length; }
+    float getPlungerBandForce() const
+        { return m_values.m_plunger_band_force; }
+    float getPlungerBandDuration() const
+        { return m_values.m_plunger_band_duration; }
+    float getPlungerBandSpeedIncrease() const
+        { return m_values.m_plunger_band_speed_increase; }
+    float getPlungerBandFadeOutTime() const
+        { return m_values.m_plunger_band_fade_out_time; }
+    float getPlungerInFaceTime() const
+        { return m_values.m_plunger_in_face_time; }
+
+    const std::vector<float>& getStartupTime() const
+        { return m_values.m_startup_time; }
+    const std::vector<float>& getStartupBoost() const
+        { return m_values.m_startup_boost; }
+
+    float getRescueDuration() const
+        { return m_values.m_rescue_duration; }
+    float getRescueVertOffset() const
+        { return m_values.m_rescue_vert_offset; }
+    float getRescueHeight() const
+        { return m_values.m_rescue_height; }
+
+    float getExplosionDuration() const
+        { return m_values.m_explosion_duration; }
+    float getExplosionRadius() const
+        { return m_values.m_explosion_radius; }
+    float getExplosionInvulnerabilityTime() const
+        { return m_values.m_explosion_invulnerability_time; }
+
+    float getNitroDuration() const
+        { return m_values.m_nitro_duration; }
+    float getNitroEngineForce() const
+        { return m_values.m_nitro_engine_force; }
+    float getNitroEngineMult() const
+        { return m_values.m_nitro_engine_mult; }
+    float getNitroConsumption() const
+        { return m_values.m_nitro_consumption; }
+    float getNitroSmallContainer() const
+        { return m_values.m_nitro_small_container; }
+    float getNitroBigContainer() const
+        { return m_values.m_nitro_big_container; }
+    float getNitroMaxSpeedIncrease() const
+        { return m_values.m_nitro_max_speed_increase; }
+    float getNitroFadeOutTime() const
+        { return m_values.m_nitro_fade_out_time; }
+    float getNitroMax() const
+        { return m_values.m_nitro_max; }
+
+    float getSlipstreamDurationFactor() const
+        { return m_values.m_slipstream_duration_factor; }
+    float getSlipstreamBaseSpeed() const
+        { return m_values.m_slipstream_base_speed; }
+    float getSlipstreamLength() const
+        { return m_values.m_slipstream_length; }
+    float getSlipstreamWidth() const
+        { return m_values.m_slipstream_width; }
+    float getSlipstreamInnerFactor() const
+        { return m_values.m_slipstream_inner_factor; }
+    float getSlipstreamMinCollectTime() const
+        { return m_values.m_slipstream_min_collect_time; }
+    float getSlipstreamMaxCollectTime() const
+        { return m_values.m_slipstream_max_collect_time; }
+    float getSlipstreamAddPower() const
+        { return m_values.m_slipstream_add_power; }
+    float getSlipstreamMinSpeed() const
+        { return m_values.m_slipstream_min_speed; }
+    float getSlipstreamMaxSpeedIncrease() const
+        { return m_values.m_slipstream_max_speed_increase; }
+    float getSlipstreamFadeOutTime() const
+        { return m_values.m_slipstream_fade_out_time; }
+
+    float getSkidIncrease() const
+        { return m_values.m_skid_increase; }
+    float getSkidDecrease() const
+        { return m_values.m_skid_decrease; }
+    float getSkidMax() const
+        { return m_values.m_skid_max; }
+    float getSkidTimeTillMax() const
+        { return m_values.m_skid_time_till_max; }
+    float getSkidVisual() const
+        { return m_values.m_skid_visual; }
+    float getSkidVisualTime() const
+        { return m_values.m_skid_visual_time; }
+    float getSkidRevertVisualTime() const
+        { return m_values.m_skid_revert_visual_time; }
+    float getSkidMinSpeed() const
+        { return m_values.m_skid_min_speed; }
+    const std::vector<float>& getSkidTimeTillBonus() const
+        { return m_values.m_skid_time_till_bonus; }
+    const std::vector<float>& getSkidBonusSpeed() const
+        { return m_values.m_skid_bonus_speed; }
+    const std::vector<float>& getSkidBonusTime() const
+        { return m_values.m_skid_bonus_time; }
+    const std::vector<float>& getSkidBonusForce() const
+        { return m_values.m_skid_bonus_force; }
+    float getSkidPhysicalJumpTime() const
+        { return m_values.m_skid_physical_jump_time; }
+    float getSkidGraphicalJumpTime() const
+        { return m_values.m_skid_graphical_jump_time; }
+    float getSkidPostSkidRotateFactor() const
+        { return m_values.m_skid_post_skid_rotate_factor; }
+    float getSkidReduceTurnMin() const
+        { return m_values.m_skid_reduce_turn_min; }
+    float getSkidReduceTurnMax() const
+        { return m_values.m_skid_reduce_turn_max; }
+    bool getSkidEnabled() const
+        { return m_values.m_skid_enabled; }
+
+    /* <characteristics-end cacheddefs> */
 };
 
 #endif
-
@@ -100,6 +100,12 @@ public:
     /** Called whan this controller's kart finishes the last lap. */
     virtual void  finishedRace(float time) = 0;
     // ------------------------------------------------------------------------
+    /** Called for all karts before any kart is updated, possibly in parallel
+     *  on several threads. A controller can compute decisions here which
+     *  only read the world (and modify nothing except this controller), and
+     *  use them in the next call to update(). Default: do nothing. */
+    virtual void  prepareUpdate(int ticks) {}
+    // ------------------------------------------------------------------------
     /** Get a pointer on the kart controls. */
     virtual KartControl* getControls() { return m_controls; }
     // ------------------------------------------------------------------------
@@ -175,6 +175,7 @@ void SkiddingAI::reset()
     m_avoid_item_close           = false;
     m_skid_probability_state     = SKID_PROBAB_NOT_YET;
     m_last_item_random           = NULL;
+    m_decisions_prepared         = false;
 
     AIBaseLapController::reset();
     m_track_node               = Graph::UNKNOWN_SECTOR;
@@ -213,6 +214,28 @@ unsigned int SkiddingAI::getNextSector(unsigned int index)
     return m_successor_index[index];
 }   // getNextSector
 
+//-----------------------------------------------------------------------------
+/** Computes the parts of the decisions of the AI which only read the world:
+ *  the nearest karts, the crashes, the direction of the track and the point
+ *  to aim at. This is called for all karts before any kart is updated (and
+ *  possibly in parallel), so all AI karts see the same state of the world.
+ *  Nothing is prepared in the cases in which update() does not use these
+ *  values, the next update() will then compute them itself.
+ *  \param ticks Number of physics time steps - should be 1.
+ */
+void SkiddingAI::prepareUpdate(int ticks)
+{
+    m_decisions_prepared = false;
+    if (m_kart->getKartAnimation() || isStuck() || m_world->isStartPhase())
+        return;
+
+    computeNearestKarts();
+    checkCrashes(m_kart->getXYZ());
+    determineTrackDirection();
+    findAimPoint(&m_prepared_aim_point, &m_prepared_last_node);
+    m_decisions_prepared = true;
+}   // prepareUpdate
+
 //-----------------------------------------------------------------------------
 /** This is the main entry point for the AI.
  *  It is called once per frame for each AI and determines the behaviour of
@@ -221,6 +244,9 @@ unsigned int SkiddingAI::getNextSector(unsigned int index)
 void SkiddingAI::update(int ticks)
 {
     float dt = stk_config->ticks2Time(ticks);
+    // Decisions from prepareUpdate() are only valid for this update.
+    const bool prepared  = m_decisions_prepared;
+    m_decisions_prepared = false;
     m_controls->setRescue(false);
 
     // This is used to enable firing an item backwards.
@@ -312,7 +338,8 @@ void SkiddingAI::update(int ticks)
     }
 
     // Get information that is needed by more than 1 of the handling funcs
-    computeNearestKarts();
+    if (!prepared)
+        computeNearestKarts();
 
     int num_ai = m_world->getNumKarts() - race_manager->getNumPlayers();
     int position_among_ai = m_kart->getPosition() - m_num_players_ahead;
@@ -328,12 +355,15 @@ void SkiddingAI::update(int ticks)
                         speed_cap, /*fade_in_time*/0);
 
     //Detect if we are going to crash with the track and/or kart
-    checkCrashes(m_kart->getXYZ());
-    determineTrackDirection();
+    if (!prepared)
+    {
+        checkCrashes(m_kart->getXYZ());
+        determineTrackDirection();
+    }
 
     /*Response handling functions*/
     handleAccelerationAndBraking(ticks);
-    handleSteering(dt);
+    handleSteering(dt, prepared);
     handleRescue(dt);
 
     // Make sure that not all AI karts use the zipper at the same
@@ -356,8 +386,10 @@ void SkiddingAI::update(int ticks)
  *  avoid item, and potentially adjust the aim-at point, before computing the
  *  steer direction to arrive at the currently aim-at point.
  *  \param dt Time step size.
+ *  \param use_prepared_aim_point True if the point to aim at was already
+ *         computed in prepareUpdate().
  */
-void SkiddingAI::handleSteering(float dt)
+void SkiddingAI::handleSteering(float dt, bool use_prepared_aim_point)
 {
     // Special behaviour if we have a bomb attached: try to hit the kart ahead
     // of us.
@@ -459,13 +491,13 @@ void SkiddingAI::handleSteering(float dt)
         Vec3 aim_point;
         int last_node = Graph::UNKNOWN_SECTOR;
 
-        switch(m_point_selection_algorithm)
+        if (use_prepared_aim_point)
         {
-        case PSA_NEW:    findNonCrashingPointNew(&aim_point, &last_node);
-                         break;
-        case PSA_DEFAULT:findNonCrashingPoint(&aim_point, &last_node);
-                         break;
+            aim_point = m_prepared_aim_point;
+            last_node = m_prepared_last_node;
         }
+        else
+            findAimPoint(&aim_point, &last_node);
 #ifdef AI_DEBUG
         m_debug_sphere[m_point_selection_algorithm]->setPosition(aim_point.toIrrVector());
 #endif
@@ -2778,6 +2810,22 @@ void SkiddingAI::findNonCrashingPointNew(Vec3 *result, int *last_node)
     *aim_position = DriveGraph::get()->getNode(*last_node)->getCenter();
 }   // findNonCrashingPoint
 
+//-----------------------------------------------------------------------------
+/** Finds the point to aim at with the selected point selection algorithm.
+ *  \param result On exit contains the point the AI should aim at.
+ *  \param last_node On exit contains the graph node the AI is aiming at.
+ */
+void SkiddingAI::findAimPoint(Vec3 *result, int *last_node)
+{
+    switch(m_point_selection_algorithm)
+    {
+    case PSA_NEW:    findNonCrashingPointNew(result, last_node);
+                     break;
+    case PSA_DEFAULT:findNonCrashingPoint(result, last_node);
+                     break;
+    }
+}   // findAimPoint
+
 //-----------------------------------------------------------------------------
 /** Determines the direction of the track ahead of the kart: 0 indicates
  *  straight, +1 right turn, -1 left turn.
@@ -231,6 +231,14 @@ private:
     enum {PSA_DEFAULT, PSA_NEW}
           m_point_selection_algorithm;
 
+    /** True if prepareUpdate() has computed the nearest karts, crashes,
+     *  track direction and the point to aim at for the next update(). */
+    bool m_decisions_prepared;
+
+    /** The point to aim at and its graph node computed in prepareUpdate(). */
+    Vec3 m_prepared_aim_point;
+    int  m_prepared_last_node;
+
 #ifdef AI_DEBUG
     /** For skidding debugging: shows the estimated turn shape. */
     ShowCurve **m_curve;
@@ -252,7 +260,7 @@ private:
      */
     void  handleRaceStart();
     void  handleAccelerationAndBraking(int ticks);
-    void  handleSteering(float dt);
+    void  handleSteering(float dt, bool use_prepared_aim_point);
     int   computeSkill(SkillType type);
     void  handleItems(const float dt, const Vec3 *aim_point,
                                 int last_node, int item_skill);
@@ -284,6 +292,7 @@ private:
     void  checkCrashes(const Vec3& pos);
     void  findNonCrashingPointNew(Vec3 *result, int *last_node);
     void  findNonCrashingPoint(Vec3 *result, int *last_node);
+    void  findAimPoint(Vec3 *result, int *last_node);
 
     void  determineTrackDirection();
     virtual bool canSkid(float steer_fraction);
@@ -297,6 +306,7 @@ public:
                  SkiddingAI(AbstractKart *kart);
                 ~SkiddingAI();
     virtual void update      (int ticks);
+    virtual void prepareUpdate(int ticks);
     virtual void reset       ();
     virtual const irr::core::stringw& getNamePostfix() const;
 };
@@ -80,6 +80,7 @@
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
 #include "tracks/track_sector.hpp"
+#include "utils/benchmark.hpp"
 #include "utils/constants.hpp"
 #include "utils/log.hpp" //TODO: remove after debugging is done
 #include "utils/vs.hpp"
@@ -720,7 +721,8 @@ void Kart::createPhysics()
     trans.setIdentity();
     createBody(mass, trans, &m_kart_chassis,
                m_kart_properties->getRestitution(0.0f));
-    std::vector<float> ang_fact = m_kart_properties->getStabilityAngularFactor();
+    const std::vector<float>& ang_fact =
+        m_kart_properties->getStabilityAngularFactor();
     // The angular factor (with X and Z values <1) helps to keep the kart
     // upright, especially in case of a collision.
     m_body->setAngularFactor(Vec3(ang_fact[0], ang_fact[1], ang_fact[2]));
@@ -1160,7 +1162,8 @@ float Kart::getStartupBoostFromStartTicks(int ticks) const
     if (ticks_since_ready < 0)
         return 0.0f;
     float t = stk_config->ticks2Time(ticks_since_ready);
-    std::vector<float> startup_times = m_kart_properties->getStartupTime();
+    const std::vector<float>& startup_times =
+        m_kart_properties->getStartupTime();
     for (unsigned int i = 0; i < startup_times.size(); i++)
     {
         if (t <= startup_times[i])
@@ -1320,6 +1323,55 @@ void Kart::eliminate()
     m_node->setVisible(false);
 }   // eliminate
 
+//-----------------------------------------------------------------------------
+/** Returns the point from which the ray to detect the terrain under the kart
+ *  is cast.
+ *  \param rotation The rotation of the kart.
+ */
+Vec3 Kart::getTerrainRayOrigin(const btMatrix3x3 &rotation) const
+{
+    // After the physics step was done, the position of the wheels (as stored
+    // in wheelInfo) is actually outdated, since the chassis was moved
+    // according to the force acting from the wheels. So the center of the
+    // chassis is not at the center of the wheels anymore, it is somewhat
+    // moved forward (depending on speed and fps). In very extreme cases
+    // (see bug 2246) the center of the chassis can actually be ahead of the
+    // front wheels. So if we do a raycast to detect the terrain from the
+    // current chassis, that raycast might be ahead of the wheels - which
+    // results in incorrect rescues (the wheels are still on the ground,
+    // but the raycast happens ahead of the front wheels and are over
+    // a rescue texture).
+    // To avoid this problem, we do the raycast for terrain detection from
+    // the center of the 4 wheel positions (in world coordinates).
+
+    Vec3 from(0.0f, 0.0f, 0.0f);
+    for (unsigned int i = 0; i < 4; i++)
+        from += m_vehicle->getWheelInfo(i).m_raycastInfo.m_hardPointWS;
+
+    // Add a certain epsilon (0.3) to the height of the kart. This avoids
+    // problems of the ray being cast from under the track (which happened
+    // e.g. on tux tollway when jumping down from the ramp, when the chassis
+    // partly tunnels through the track). While tunneling should not be
+    // happening (since Z velocity is clamped), the epsilon is left in place
+    // just to be on the safe side (it will not hit the chassis itself).
+    return from/4 + rotation * Vec3(0.0f, 0.3f, 0.0f);
+}   // getTerrainRayOrigin
+
+//-----------------------------------------------------------------------------
+/** Casts the terrain ray of the next update() in advance, see
+ *  TerrainInfo::prefetch(). The ray is cast with the transform which
+ *  Moveable::update() will take from the physics. If the kart is moved
+ *  before (e.g. by an animation), update() casts the ray again.
+ */
+void Kart::prefetchTerrainInfo()
+{
+    btTransform trans = getTrans();
+    if (m_body->getInvMass() != 0)
+        m_motion_state->getWorldTransform(trans);
+    m_terrain_info->prefetch(trans.getBasis(),
+                             getTerrainRayOrigin(trans.getBasis()));
+}   // prefetchTerrainInfo
+
 //-----------------------------------------------------------------------------
 /** Updates the kart in each time step. It updates the physics setting,
  *  particle effects, camera position, etc.
@@ -1327,6 +1379,7 @@ void Kart::eliminate()
  */
 void Kart::update(int ticks)
 {
+    Benchmark::Timer benchmark_timer(Benchmark::BS_KART_UPDATE);
     if (m_network_finish_check_ticks > 0 &&
         World::getWorld()->getTicksSinceStart() >
         m_network_finish_check_ticks &&
@@ -1495,33 +1548,8 @@ void Kart::update(int ticks)
         m_body->getBroadphaseHandle()->m_collisionFilterGroup = 0;
     }
 
-    // After the physics step was done, the position of the wheels (as stored
-    // in wheelInfo) is actually outdated, since the chassis was moved
-    // according to the force acting from the wheels. So the center of the
-    // chassis is not at the center of the wheels anymore, it is somewhat
-    // moved forward (depending on speed and fps). In very extreme cases
-    // (see bug 2246) the center of the chassis can actually be ahead of the
-    // front wheels. So if we do a raycast to detect the terrain from the
-    // current chassis, that raycast might be ahead of the wheels - which
-    // results in incorrect rescues (the wheels are still on the ground,
-    // but the raycast happens ahead of the front wheels and are over
-    // a rescue texture).
-    // To avoid this problem, we do the raycast for terrain detection from
-    // the center of the 4 wheel positions (in world coordinates).
-
-    Vec3 from(0.0f, 0.0f, 0.0f);
-    for (unsigned int i = 0; i < 4; i++)
-        from += m_vehicle->getWheelInfo(i).m_raycastInfo.m_hardPointWS;
-
-    // Add a certain epsilon (0.3) to the height of the kart. This avoids
-    // problems of the ray being cast from under the track (which happened
-    // e.g. on tux tollway when jumping down from the ramp, when the chassis
-    // partly tunnels through the track). While tunneling should not be
-    // happening (since Z velocity is clamped), the epsilon is left in place
-    // just to be on the safe side (it will not hit the chassis itself).
-    from = from/4 + (getTrans().getBasis() * Vec3(0.0f, 0.3f, 0.0f));
-
-    m_terrain_info->update(getTrans().getBasis(), from);
+    m_terrain_info->update(getTrans().getBasis(),
+                           getTerrainRayOrigin(getTrans().getBasis()));
 
     if (m_body->getBroadphaseHandle())
     {
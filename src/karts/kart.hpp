@@ -38,6 +38,7 @@
 class AbstractKartAnimation;
 class Attachment;
 class btKart;
+class btKartRaycaster;
 class btUprightConstraint;
 class Controller;
 class HitEffect;
@@ -179,7 +180,7 @@ protected:
     // Bullet physics parameters
     // -------------------------
     btCompoundShape          m_kart_chassis;
-    btVehicleRaycaster      *m_vehicle_raycaster;
+    btKartRaycaster         *m_vehicle_raycaster;
     btKart                  *m_vehicle;
 
      /** The amount of energy collected with nitro cans. Note that it
@@ -254,6 +255,7 @@ protected:
     int8_t        m_min_nitro_ticks;
 
     void          updatePhysics(int ticks);
+    Vec3          getTerrainRayOrigin(const btMatrix3x3 &rotation) const;
     void          handleMaterialSFX();
     void          handleMaterialGFX(float dt);
     void          updateFlying();
@@ -318,6 +320,7 @@ public:
     virtual void   crashed          (const Material *m, const Vec3 &normal) OVERRIDE;
     virtual float  getHoT           () const OVERRIDE;
     virtual void   update           (int ticks) OVERRIDE;
+    virtual void   prefetchTerrainInfo() OVERRIDE;
     virtual void   finishedRace     (float time, bool from_server=false) OVERRIDE;
     virtual void   setPosition      (int p) OVERRIDE;
     virtual void   beep             () OVERRIDE;
@@ -643,7 +643,7 @@ float KartProperties::getStabilityTrackConnectionAccel() const
 }  // getStabilityTrackConnectionAccel
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getStabilityAngularFactor() const
+const std::vector<float>& KartProperties::getStabilityAngularFactor() const
 {
     return m_cached_characteristic->getStabilityAngularFactor();
 }  // getStabilityAngularFactor
@@ -655,7 +655,7 @@ float KartProperties::getStabilitySmoothFlyingImpulse() const
 }  // getStabilitySmoothFlyingImpulse
 
 // ----------------------------------------------------------------------------
-InterpolationArray KartProperties::getTurnRadius() const
+const InterpolationArray& KartProperties::getTurnRadius() const
 {
     return m_cached_characteristic->getTurnRadius();
 }  // getTurnRadius
@@ -667,7 +667,7 @@ float KartProperties::getTurnTimeResetSteer() const
 }  // getTurnTimeResetSteer
 
 // ----------------------------------------------------------------------------
-InterpolationArray KartProperties::getTurnTimeFullSteer() const
+const InterpolationArray& KartProperties::getTurnTimeFullSteer() const
 {
     return m_cached_characteristic->getTurnTimeFullSteer();
 }  // getTurnTimeFullSteer
@@ -688,7 +688,7 @@ float KartProperties::getEngineMaxSpeed() const
 float KartProperties::getEngineGenericMaxSpeed() const
 {
     return m_cached_characteristic->getEngineGenericMaxSpeed();
-}  // getEngineMaxSpeed
+}  // getEngineGenericMaxSpeed
 
 // ----------------------------------------------------------------------------
 float KartProperties::getEngineBrakeFactor() const
@@ -709,13 +709,13 @@ float KartProperties::getEngineMaxSpeedReverseRatio() const
 }  // getEngineMaxSpeedReverseRatio
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getGearSwitchRatio() const
+const std::vector<float>& KartProperties::getGearSwitchRatio() const
 {
     return m_cached_characteristic->getGearSwitchRatio();
 }  // getGearSwitchRatio
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getGearPowerIncrease() const
+const std::vector<float>& KartProperties::getGearPowerIncrease() const
 {
     return m_cached_characteristic->getGearPowerIncrease();
 }  // getGearPowerIncrease
@@ -869,7 +869,7 @@ int KartProperties::getBubblegumFadeInTicks() const
 {
     return stk_config->time2Ticks(m_cached_characteristic
                                   ->getBubblegumFadeInTime());
-}  // getBubblegumFadeInTime
+}  // getBubblegumFadeInTicks
 
 // ----------------------------------------------------------------------------
 float KartProperties::getBubblegumShieldDuration() const
@@ -959,8 +959,8 @@ float KartProperties::getPlungerBandSpeedIncrease() const
 int KartProperties::getPlungerBandFadeOutTicks() const
 {
     return stk_config->time2Ticks(m_cached_characteristic
-                                   ->getPlungerBandFadeOutTime());
-}  // getPlungerBandFadeOutTime
+                                  ->getPlungerBandFadeOutTime());
+}  // getPlungerBandFadeOutTicks
 
 // ----------------------------------------------------------------------------
 float KartProperties::getPlungerInFaceTime() const
@@ -969,13 +969,13 @@ float KartProperties::getPlungerInFaceTime() const
 }  // getPlungerInFaceTime
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getStartupTime() const
+const std::vector<float>& KartProperties::getStartupTime() const
 {
     return m_cached_characteristic->getStartupTime();
 }  // getStartupTime
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getStartupBoost() const
+const std::vector<float>& KartProperties::getStartupBoost() const
 {
     return m_cached_characteristic->getStartupBoost();
 }  // getStartupBoost
@@ -1022,7 +1022,7 @@ float KartProperties::getNitroDuration() const
     return m_cached_characteristic->getNitroDuration();
 }  // getNitroDuration
 
-// ------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
 float KartProperties::getNitroEngineForce() const
 {
     return m_cached_characteristic->getNitroEngineForce();
@@ -1135,7 +1135,7 @@ int KartProperties::getSlipstreamFadeOutTicks() const
 {
     return stk_config->time2Ticks(m_cached_characteristic
                                   ->getSlipstreamFadeOutTime());
-}  // getSlipstreamFadeOutTime
+}  // getSlipstreamFadeOutTicks
 
 // ----------------------------------------------------------------------------
 float KartProperties::getSkidIncrease() const
@@ -1186,25 +1186,25 @@ float KartProperties::getSkidMinSpeed() const
 }  // getSkidMinSpeed
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getSkidTimeTillBonus() const
+const std::vector<float>& KartProperties::getSkidTimeTillBonus() const
 {
     return m_cached_characteristic->getSkidTimeTillBonus();
 }  // getSkidTimeTillBonus
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getSkidBonusSpeed() const
+const std::vector<float>& KartProperties::getSkidBonusSpeed() const
 {
     return m_cached_characteristic->getSkidBonusSpeed();
 }  // getSkidBonusSpeed
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getSkidBonusTime() const
+const std::vector<float>& KartProperties::getSkidBonusTime() const
 {
     return m_cached_characteristic->getSkidBonusTime();
 }  // getSkidBonusTime
 
 // ----------------------------------------------------------------------------
-std::vector<float> KartProperties::getSkidBonusForce() const
+const std::vector<float>& KartProperties::getSkidBonusForce() const
 {
     return m_cached_characteristic->getSkidBonusForce();
 }  // getSkidBonusForce
@@ -1245,5 +1245,6 @@ bool KartProperties::getSkidEnabled() const
     return m_cached_characteristic->getSkidEnabled();
 }  // getSkidEnabled
 
+
 /* <characteristics-end kpgetter> */
 
@@ -389,12 +389,12 @@ public:
     float getStabilityChassisAngularDamping() const;
     float getStabilityDownwardImpulseFactor() const;
     float getStabilityTrackConnectionAccel() const;
-    std::vector<float> getStabilityAngularFactor() const;
+    const std::vector<float>& getStabilityAngularFactor() const;
     float getStabilitySmoothFlyingImpulse() const;
 
-    InterpolationArray getTurnRadius() const;
+    const InterpolationArray& getTurnRadius() const;
     float getTurnTimeResetSteer() const;
-    InterpolationArray getTurnTimeFullSteer() const;
+    const InterpolationArray& getTurnTimeFullSteer() const;
 
     float getEnginePower() const;
     float getEngineMaxSpeed() const;
@@ -403,8 +403,8 @@ public:
     float getEngineBrakeTimeIncrease() const;
     float getEngineMaxSpeedReverseRatio() const;
 
-    std::vector<float> getGearSwitchRatio() const;
-    std::vector<float> getGearPowerIncrease() const;
+    const std::vector<float>& getGearSwitchRatio() const;
+    const std::vector<float>& getGearPowerIncrease() const;
 
     float getMass() const;
 
@@ -425,8 +425,8 @@ public:
     float getAnvilSpeedFactor() const;
 
     float getParachuteFriction() const;
-    int   getParachuteDuration() const;
-    int   getParachuteDurationOther() const;
+    int getParachuteDuration() const;
+    int getParachuteDurationOther() const;
     float getParachuteDurationRankMult() const;
     float getParachuteDurationSpeedMult() const;
     float getParachuteLboundFraction() const;
@@ -438,7 +438,7 @@ public:
     float getBubblegumDuration() const;
     float getBubblegumSpeedFraction() const;
     float getBubblegumTorque() const;
-    int   getBubblegumFadeInTicks() const;
+    int getBubblegumFadeInTicks() const;
     float getBubblegumShieldDuration() const;
 
     float getZipperDuration() const;
@@ -456,11 +456,11 @@ public:
     float getPlungerBandForce() const;
     float getPlungerBandDuration() const;
     float getPlungerBandSpeedIncrease() const;
-    int   getPlungerBandFadeOutTicks() const;
+    int getPlungerBandFadeOutTicks() const;
     float getPlungerInFaceTime() const;
 
-    std::vector<float> getStartupTime() const;
-    std::vector<float> getStartupBoost() const;
+    const std::vector<float>& getStartupTime() const;
+    const std::vector<float>& getStartupBoost() const;
 
     float getRescueDuration() const;
     float getRescueVertOffset() const;
@@ -479,6 +479,7 @@ public:
     float getNitroMaxSpeedIncrease() const;
     float getNitroFadeOutTime() const;
     float getNitroMax() const;
+
     float getSlipstreamDurationFactor() const;
     float getSlipstreamBaseSpeed() const;
     float getSlipstreamLength() const;
@@ -499,16 +500,19 @@ public:
     float getSkidVisualTime() const;
     float getSkidRevertVisualTime() const;
     float getSkidMinSpeed() const;
-    std::vector<float> getSkidTimeTillBonus() const;
-    std::vector<float> getSkidBonusSpeed() const;
-    std::vector<float> getSkidBonusTime() const;
-    std::vector<float> getSkidBonusForce() const;
+    const std::vector<float>& getSkidTimeTillBonus() const;
+    const std::vector<float>& getSkidBonusSpeed() const;
+    const std::vector<float>& getSkidBonusTime() const;
+    const std::vector<float>& getSkidBonusForce() const;
     float getSkidPhysicalJumpTime() const;
     float getSkidGraphicalJumpTime() const;
     float getSkidPostSkidRotateFactor() const;
     float getSkidReduceTurnMin() const;
     float getSkidReduceTurnMax() const;
     bool getSkidEnabled() const;
+
+    /* <characteristics-end kpdefs> */
+
     // ------------------------------------------------------------------------
     /** Returns minimum time during which nitro is consumed when pressing nitro
     *  key, to prevent using nitro in very short bursts
@@ -517,8 +521,6 @@ public:
                                             { return m_nitro_min_consumption; }
     // ------------------------------------------------------------------------
     bool isAddon() const                                 { return m_is_addon; }
-
-    /* <characteristics-end kpdefs> */
     
     LEAK_CHECK()
 };   // KartProperties
@@ -18,6 +18,7 @@
 
 #include "karts/kart_rewinder.hpp"
 
+#include "config/stk_config.hpp"
 #include "items/attachment.hpp"
 #include "items/powerup.hpp"
 #include "karts/abstract_kart.hpp"
@@ -48,6 +49,11 @@ KartRewinder::KartRewinder(const std::string& ident,
     m_prev_steering = m_steering_smoothing_time = 0.0f;
 }   // KartRewinder
 
+// ----------------------------------------------------------------------------
+KartRewinder::~KartRewinder()
+{
+}   // ~KartRewinder
+
 // ----------------------------------------------------------------------------
 /** Resets status in case of a resetart.
  */
@@ -56,6 +62,7 @@ void KartRewinder::reset()
     m_last_animation_end_ticks = -1;
     m_transfrom_from_network =
         btTransform(btQuaternion(0.0f, 0.0f, 0.0f, 1.0f));
+    m_predicted_states.clear();
     Kart::reset();
     Rewinder::reset();
     SmoothNetworkBody::setEnable(true);
@@ -194,6 +201,40 @@ BareNetworkString* KartRewinder::saveState(std::vector<std::string>* ru)
  *         used).
  */
 void KartRewinder::restoreState(BareNetworkString *buffer, int count)
+{
+    restoreKartState(buffer, /*restore_physics*/true);
+}   // restoreState
+
+// ----------------------------------------------------------------------------
+/** Restores a state saved locally by this client. The chassis body, the
+ *  wheels and the timed impulse and rotation were already restored from
+ *  the physics checkpoint saved at the same time, so they are skipped.
+ *  \param buffer The buffer with the state info.
+ *  \param count Number of bytes of the state (not used).
+ */
+void KartRewinder::restoreLocalState(BareNetworkString *buffer, int count)
+{
+    restoreKartState(buffer, /*restore_physics*/false);
+}   // restoreLocalState
+
+// ----------------------------------------------------------------------------
+/** The chassis body is set from a confirmed state, unless a kart animation
+ *  is shown.
+ */
+const btRigidBody* KartRewinder::getStateBody() const
+{
+    return getKartAnimation() ? NULL : getBody();
+}   // getStateBody
+
+// ----------------------------------------------------------------------------
+/** Restores a state of this kart.
+ *  \param buffer The buffer with the state info.
+ *  \param restore_physics If false the data which is part of the physics
+ *         checkpoint (the chassis body, the wheels and the timed impulse
+ *         and rotation) is only read, but not restored.
+ */
+void KartRewinder::restoreKartState(BareNetworkString *buffer,
+                                    bool restore_physics)
 {
 
     // 1) Firing and related handling
@@ -256,14 +297,17 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
     // Don't restore to phyics position if showing kart animation
     if (!getKartAnimation())
     {
-        // Clear any forces applied (like by plunger or bubble gum torque)
-        btRigidBody *body = getBody();
-        body->clearForces();
-        body->setLinearVelocity(lv);
-        body->setAngularVelocity(av);
-        // This function also reads the velocity, so it must be called
-        // after the velocities are set
-        body->proceedToTransform(m_transfrom_from_network);
+        if (restore_physics)
+        {
+            // Clear any forces applied (like by plunger or bubble gum torque)
+            btRigidBody *body = getBody();
+            body->clearForces();
+            body->setLinearVelocity(lv);
+            body->setAngularVelocity(av);
+            // This function also reads the velocity, so it must be called
+            // after the velocities are set
+            body->proceedToTransform(m_transfrom_from_network);
+        }
         // Update kart transform in case that there are access to its value
         // before Moveable::update() is called (which updates the transform)
         setTrans(m_transfrom_from_network);
@@ -271,23 +315,27 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
 
     uint16_t time_rot = buffer->getUInt16();
     float timed_rotation_y = buffer->getFloat();
-    // Set timed rotation divides by time_rot
-    m_vehicle->setTimedRotation(time_rot,
-        stk_config->ticks2Time(time_rot) * timed_rotation_y);
 
     // Collision rewind
     m_bounce_back_ticks = buffer->getUInt16();
     uint16_t central_impulse_ticks = buffer->getUInt16();
     Vec3 additional_impulse = buffer->getVec3();
-    m_vehicle->setTimedCentralImpulse(central_impulse_ticks,
-        additional_impulse, true/*rewind*/);
 
-    // For the raycast to determine the current material under the kart
-    // the m_hardPointWS of the wheels is used. So after a rewind we
-    // must restore the m_hardPointWS to the new values, otherwise they
-    // would still point at the kart position at the previous rewind
-    // (i.e. different terrain --> different slowdown).
-    m_vehicle->updateAllWheelTransformsWS();
+    if (restore_physics)
+    {
+        // Set timed rotation divides by time_rot
+        m_vehicle->setTimedRotation(time_rot,
+            stk_config->ticks2Time(time_rot) * timed_rotation_y);
+        m_vehicle->setTimedCentralImpulse(central_impulse_ticks,
+            additional_impulse, true/*rewind*/);
+
+        // For the raycast to determine the current material under the kart
+        // the m_hardPointWS of the wheels is used. So after a rewind we
+        // must restore the m_hardPointWS to the new values, otherwise they
+        // would still point at the kart position at the previous rewind
+        // (i.e. different terrain --> different slowdown).
+        m_vehicle->updateAllWheelTransformsWS();
+    }
 
     // 3) Steering and other controls
     // ------------------------------
@@ -312,7 +360,7 @@ void KartRewinder::restoreState(BareNetworkString *buffer, int count)
     // -----------
     m_skidding->rewindTo(buffer);
 
-}   // restoreState
+}   // restoreKartState
 
 // ----------------------------------------------------------------------------
 /** Called once a frame. It will add a new kart control event to the rewind
@@ -378,3 +426,92 @@ std::function<void()> KartRewinder::getLocalStateRestoreFunction()
         m_skidding->m_remaining_jump_time = remaining_jump_time;
     };
 }   // getLocalStateRestoreFunction
+
+// ----------------------------------------------------------------------------
+/** Saves the state of this kart at the given time, so it can be compared
+ *  with the confirmed state of the server for the same time later.
+ *  \param ticks Time at which the state is saved.
+ */
+std::shared_ptr<BareNetworkString> KartRewinder::savePredictedState(int ticks)
+{
+    std::vector<std::string> ru;
+    std::shared_ptr<BareNetworkString>& state = m_predicted_states[ticks];
+    state.reset(saveState(&ru));
+    std::shared_ptr<BareNetworkString> ret = state;
+    // In case that no confirmed state for this kart is received for a
+    // while (e.g. it is far away), limit the number of saved states.
+    while (m_predicted_states.size() > 64)
+        m_predicted_states.erase(m_predicted_states.begin());
+    return ret;
+}   // savePredictedState
+
+// ----------------------------------------------------------------------------
+/** Compares the confirmed state from the server with the predicted state
+ *  for the same time. The transform and velocities can differ by the
+ *  maximum errors defined in stk_config, all other data must be identical.
+ *  \param buffer The buffer with the confirmed state.
+ *  \param count Number of bytes of the confirmed state.
+ *  \param ticks Time of the confirmed state.
+ */
+bool KartRewinder::hasDiverged(BareNetworkString *buffer, int count,
+                               int ticks)
+{
+    auto it = m_predicted_states.find(ticks);
+    if (it == m_predicted_states.end() || !it->second)
+        return true;
+    // Older predicted states will not be needed anymore
+    std::shared_ptr<BareNetworkString> predicted = std::move(it->second);
+    m_predicted_states.erase(m_predicted_states.begin(), ++it);
+
+    if ((int)predicted->size() != count)
+        return true;
+    predicted->reset();
+    const int start = buffer->getCurrentOffset();
+
+    // 1) Firing and related handling
+    if (predicted->getUInt16() != buffer->getUInt16())
+        return true;
+    const uint16_t fire_and_invulnerable = buffer->getUInt16();
+    if (predicted->getUInt16() != fire_and_invulnerable)
+        return true;
+    if (((fire_and_invulnerable >> 13) & 1) == 1 &&
+        predicted->getUInt16() != buffer->getUInt16())
+        return true;
+    const bool has_animation = ((fire_and_invulnerable >> 14) & 1) == 1;
+
+    // 2) Transform and velocities
+    const float max_position_error = stk_config->m_network_max_position_error;
+    const float max_velocity_error = stk_config->m_network_max_velocity_error;
+    if ((predicted->getVec3() - buffer->getVec3()).length() >
+        max_position_error)
+        return true;
+    // q and -q are the same rotation
+    float dot = fabsf(predicted->getQuat().dot(buffer->getQuat()));
+    if (2.0f * acosf(std::min(dot, 1.0f)) >
+        stk_config->m_network_max_rotation_error)
+        return true;
+    if (has_animation && predicted->getUInt32() != buffer->getUInt32())
+        return true;
+    if ((predicted->getVec3() - buffer->getVec3()).length() >
+        max_velocity_error ||
+        (predicted->getVec3() - buffer->getVec3()).length() >
+        max_velocity_error)
+        return true;
+
+    // 3) All other data must be identical
+    const int rest = count - (buffer->getCurrentOffset() - start);
+    return rest < 0 ||
+        memcmp(predicted->getCurrentData(), buffer->getCurrentData(),
+               rest) != 0;
+}   // hasDiverged
+
+// ----------------------------------------------------------------------------
+/** Frees the predicted states up to and including the given tick, they are
+ *  not compared again once the server state of that tick is confirmed.
+ *  \param ticks The confirmed time.
+ */
+void KartRewinder::discardPredictedStates(int ticks)
+{
+    m_predicted_states.erase(m_predicted_states.begin(),
+        m_predicted_states.upper_bound(ticks));
+}   // discardPredictedStates
@@ -23,6 +23,9 @@
 #include "network/rewinder.hpp"
 #include "utils/cpp2011.hpp"
 
+#include <map>
+#include <memory>
+
 class AbstractKart;
 class BareNetworkString;
 
@@ -34,18 +37,26 @@ private:
     float m_prev_steering, m_steering_smoothing_dt, m_steering_smoothing_time;
 
     int m_last_animation_end_ticks;
+
+    /** The states predicted on a client at the time a local state was
+     *  saved, which are compared with the confirmed states from the server
+     *  to detect if a rewind is necessary. */
+    std::map<int, std::shared_ptr<BareNetworkString> > m_predicted_states;
+
+    void restoreKartState(BareNetworkString *buffer, bool restore_physics);
 public:
     KartRewinder(const std::string& ident, unsigned int world_kart_id,
                  int position, const btTransform& init_transform,
                  PerPlayerDifficulty difficulty,
                  std::shared_ptr<RenderInfo> ri);
-    ~KartRewinder() {}
+    ~KartRewinder();
     virtual void saveTransform() OVERRIDE;
     virtual void computeError() OVERRIDE;
     virtual BareNetworkString* saveState(std::vector<std::string>* ru)
         OVERRIDE;
     void reset() OVERRIDE;
     virtual void restoreState(BareNetworkString *p, int count) OVERRIDE;
+    virtual void restoreLocalState(BareNetworkString *p, int count) OVERRIDE;
     virtual void rewindToEvent(BareNetworkString *p) OVERRIDE {}
     virtual void update(int ticks) OVERRIDE;
     // -------------------------------------------------------------------------
@@ -75,6 +86,18 @@ public:
     virtual void undoEvent(BareNetworkString *p) OVERRIDE {}
     // ------------------------------------------------------------------------
     virtual std::function<void()> getLocalStateRestoreFunction() OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual std::shared_ptr<BareNetworkString>
+        savePredictedState(int ticks) OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual bool canBeOmitted() const OVERRIDE                 { return true; }
+    // ------------------------------------------------------------------------
+    virtual bool hasDiverged(BareNetworkString *buffer, int count,
+                             int ticks) OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual void discardPredictedStates(int ticks) OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual const btRigidBody* getStateBody() const OVERRIDE;
 
 
 };   // Rewinder
@@ -154,12 +154,21 @@ void Moveable::stopFlying()
  *  \param ticks Number of physics time steps - should be 1.
  */
 void Moveable::update(int ticks)
+{
+    updateTransform();
+}   // update
+
+//-----------------------------------------------------------------------------
+/** Takes the transform from the physics body (as computed by the last
+ *  physics step), and updates the values derived from it.
+ */
+void Moveable::updateTransform()
 {
     if(m_body->getInvMass()!=0)
         m_motion_state->getWorldTransform(m_transform);
     m_velocityLC = getVelocity()*m_transform.getBasis();
     updatePosition();
-}   // update
+}   // updateTransform
 
 //-----------------------------------------------------------------------------
 /** Updates the current position and rotation. This function is also called
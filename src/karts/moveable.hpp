@@ -126,6 +126,7 @@ public:
     const btTransform
                  &getTrans() const {return m_transform;}
     void          setTrans(const btTransform& t);
+    void          updateTransform();
     void          updatePosition();
     // ------------------------------------------------------------------------
     /** Called once per rendered frame. It is used to only update any graphical
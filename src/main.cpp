@@ -216,18 +216,24 @@
 #include "modes/profile_world.hpp"
 #include "network/protocols/connect_to_server.hpp"
 #include "network/protocols/client_lobby.hpp"
+#include "network/protocols/game_protocol.hpp"
 #include "network/protocols/server_lobby.hpp"
+#include "network/flood_filter.hpp"
+#include "network/ip_ban_list.hpp"
+#include "network/load_generator.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
 #include "network/rewind_manager.hpp"
 #include "network/rewind_queue.hpp"
 #include "network/server.hpp"
 #include "network/server_config.hpp"
+#include "network/server_metrics.hpp"
 #include "network/servers_manager.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
 #include "online/profile_manager.hpp"
 #include "online/request_manager.hpp"
+#include "physics/stk_dynamics_world.hpp"
 #include "race/grand_prix_manager.hpp"
 #include "race/highscore_manager.hpp"
 #include "race/history.hpp"
@@ -244,6 +250,7 @@
 #include "tracks/arena_graph.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_manager.hpp"
+#include "utils/benchmark.hpp"
 #include "utils/command_line.hpp"
 #include "utils/constants.hpp"
 #include "utils/crash_reporting.hpp"
@@ -251,6 +258,7 @@
 #include "utils/log.hpp"
 #include "utils/mini_glm.hpp"
 #include "utils/profiler.hpp"
+#include "utils/server_room.hpp"
 #include "utils/translation.hpp"
 
 static void cleanSuperTuxKart();
@@ -584,6 +592,12 @@ void cmdLineHelp()
                               "laps.\n"
     "       --profile-time=n   Enable automatic driven profile mode for n "
                               "seconds.\n"
+    "       --benchmark=n      Run a race of AI karts only for n physics ticks without\n"
+    "                          graphics (use --track, --numkarts and --seed, default\n"
+    "                          seed is 1) and print ticks/s and the median and 99th\n"
+    "                          percentile of the time of the main updates per tick.\n"
+    "                          The rewind queue is also timed, without a race.\n"
+    "       --benchmark-json=file Also write the --benchmark results as JSON.\n"
     "       --unlock-all       Permanently unlock all karts and tracks for testing.\n"
     "       --no-unlock-all    Disable unlock-all (i.e. base unlocking on player achievement).\n"
     "       --no-graphics      Do not display the actual race.\n"
@@ -603,7 +617,15 @@ void cmdLineHelp()
     // "    --network-item-debugging Print item handling debug information.\n"
     "       --server-config=file Specify the server_config.xml for server hosting, it will create\n"
     "                            one if not found.\n"
+    "       --server-rooms=n   Host n rooms (at most 16) with the --server-config in this\n"
+    "                          process, they share the port and players join a room with\n"
+    "                          free space. The rooms are updated one after the other.\n"
     "       --network-console  Enable network console.\n"
+    "       --rewind-benchmark=latency[,jitter] Client only: replace the states\n"
+    "                          from the server with local states, received after\n"
+    "                          latency (+ random jitter) ms, and print rewind\n"
+    "                          statistics at the end of the race. Needs a server,\n"
+    "                          results depend on the live race.\n"
     "       --wan-server=name  Start a Wan server (not a playing client).\n"
     "       --public-server    Allow direct connection to the server (without stk server)\n"
     "       --lan-server=name  Start a LAN server (not a playing client).\n"
@@ -614,6 +636,13 @@ void cmdLineHelp()
     "       --server-id=n      Server id in stk addons for --connect-now.\n"
     "       --network-ai=n     Numbers of AI for connecting to linear race server, used\n"
     "                          together with --connect-now.\n"
+    "       --load-test=n      Connect n bot clients to the server of --connect-now\n"
+    "                          (LAN only), run races and print state and action\n"
+    "                          statistics (not client rewinds). The choices of the bots\n"
+    "                          use the --seed, their timing differs between runs.\n"
+    "       --load-test-races=n Number of races of --load-test (default 1).\n"
+    "       --load-test-time=s Maximum duration of a --load-test race in seconds\n"
+    "                          (default 60).\n"
     "       --login=s          Automatically log in (set the login).\n"
     "       --password=s       Automatically log in (set the password).\n"
     "       --init-user        Save the above login and password (if set) in config.\n"
@@ -1192,6 +1221,24 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
 
     if (CommandLine::has("--network-item-debugging"))
         NetworkItemManager::m_network_item_debugging = true;
+
+    if (CommandLine::has("--rewind-benchmark", &s))
+    {
+        std::vector<std::string> l = StringUtils::split(s, ',');
+        int latency = 0, jitter = 0;
+        if (l.empty() || !StringUtils::fromString(l[0], latency) ||
+            latency < 0 ||
+            (l.size() > 1 && (!StringUtils::fromString(l[1], jitter) ||
+                              jitter < 0)))
+        {
+            Log::warn("main", "Invalid --rewind-benchmark '%s' ignored.",
+                      s.c_str());
+        }
+        else
+        {
+            RewindManager::setRewindBenchmark(latency, jitter);
+        }
+    }
     
     std::string server_password;
     if (CommandLine::has("--server-password", &s))
@@ -1308,6 +1355,19 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         }
     }
 
+    if (CommandLine::has("--connect-now", &s) &&
+        CommandLine::has("--load-test", &n) && n > 0)
+    {
+        int races = 1, duration = 60, seed = 0;
+        CommandLine::has("--load-test-races", &races);
+        CommandLine::has("--load-test-time", &duration);
+        CommandLine::has("--seed", &seed);
+        LoadGenerator generator(TransportAddress(s), n,
+            std::max(races, 1), std::max(duration, 1), seed);
+        generator.run();
+        return 0;
+    }
+
     if (CommandLine::has("--connect-now", &s))
     {
         NetworkConfig::get()->setIsServer(false);
@@ -1345,6 +1405,30 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         NetworkingLobby::getInstance()->setJoinedServer(server);
     }
 
+    if (NetworkConfig::get()->isServer() &&
+        CommandLine::has("--server-rooms", &n) && n > 1)
+    {
+        if (!has_server_config || has_parent_process)
+        {
+            Log::warn("main", "--server-rooms requires --server-config, "
+                "ignored.");
+        }
+        else if ((unsigned)n > ServerRoom::MAX_ROOMS)
+        {
+            // All rooms are updated in turn by the main thread, so each
+            // room slows down the others
+            Log::error("main", "--server-rooms supports at most %u rooms.",
+                ServerRoom::MAX_ROOMS);
+            return 0;
+        }
+        else
+        {
+            ServerRoom::setCount(n);
+            Log::info("main", "Hosting %d server rooms.",
+                ServerRoom::getCount());
+        }
+    }
+
     if (NetworkConfig::get()->isServer())
     {
         const std::string& server_name = ServerConfig::m_server_name;
@@ -1369,6 +1453,7 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
             Log::info("main", "Creating a LAN server '%s'.",
                 server_name.c_str());
         }
+        ServerMetrics::init();
     }
 
     if (CommandLine::has("--auto-connect"))
@@ -1563,6 +1648,28 @@ int handleCmdLine(bool has_server_config, bool has_parent_process)
         race_manager->setNumLaps(999999); // profile end depends on time
     }   // --profile-time
 
+    if(CommandLine::has("--benchmark",  &n))
+    {
+        if (n <= 0)
+        {
+            Log::error("main", "Invalid number of benchmark ticks: %i.", n);
+            return 0;
+        }
+        std::string json_file;
+        CommandLine::has("--benchmark-json", &json_file);
+        Log::verbose("main", "Benchmark: %d ticks.", n);
+        UserConfigParams::m_no_start_screen = true;
+        ProfileWorld::setBenchmarkMode(n, json_file);
+        race_manager->setNumLaps(999999); // benchmark end depends on ticks
+        // The rewind queue is only used in networked races, so it is
+        // measured on its own
+        RewindQueue::benchmark();
+        // The scenario must be the same in each run
+        int seed;
+        if (!CommandLine::has("--seed", &seed))
+            srand(1);
+    }   // --benchmark
+
     if(CommandLine::has("--history"))
     {
         history->setReplayHistory(true);
@@ -1877,7 +1984,8 @@ int main(int argc, char *argv[] )
             FileManager::setStdoutDir(s);
 
 #ifndef SERVER_ONLY
-        if(CommandLine::has("--no-graphics") || CommandLine::has("-l"))
+        if(CommandLine::has("--no-graphics") || CommandLine::has("-l") ||
+           CommandLine::has("--benchmark"))
 #endif
             ProfileWorld::disableGraphics();
 
@@ -2300,7 +2408,6 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
  */
 static void cleanSuperTuxKart()
 {
-
     delete main_loop;
 
     if(Online::RequestManager::isRunning())
@@ -2313,6 +2420,14 @@ static void cleanSuperTuxKart()
     irr_driver->updateConfigIfRelevant();
     AchievementsManager::destroy();
     Referee::cleanup();
+    // The managers of the other server rooms, their worlds and protocols
+    // are gone at this point
+    for (unsigned room = 1; room < ServerRoom::getCount(); room++)
+    {
+        ServerRoomScope scope(room);
+        delete race_manager;
+        delete projectile_manager;
+    }
     if(race_manager)            delete race_manager;
     if(grand_prix_manager)      delete grand_prix_manager;
     if(highscore_manager)       delete highscore_manager;
@@ -2468,7 +2583,20 @@ void runUnitTests()
     Log::info("UnitTest", "RewindQueue");
     RewindQueue::unitTesting();
 
+    Log::info("UnitTest", "Delta state");
+    GameProtocol::unitTesting();
+
+    Log::info("UnitTest", "Physics checkpoint");
+    STKDynamicsWorld::unitTesting();
+
+    Log::info("UnitTest", "Benchmark percentiles");
+    Benchmark::unitTesting();
+
+    Log::info("UnitTest", "Flood filter");
+    FloodFilter::unitTesting();
+
     Log::info("UnitTest", "IP ban");
+    IPBanList::unitTesting();
     NetworkConfig::get()->unsetNetworking();
     ServerLobby sl;
     sl.setSaveServerConfig(false);
@@ -2533,6 +2661,21 @@ void runUnitTests()
     assert(sl.isBannedForIP(TransportAddress("234.123.56.127")));
     assert(!sl.isBannedForIP(TransportAddress("234.123.56.128")));
 
+    // Overlapping ranges with different expire times and IPv6 ranges
+    ServerConfig::m_server_ip_ban_list =
+        {
+            { "12.13.0.0/16", 1 },
+            { "12.13.14.0/24", std::numeric_limits<uint32_t>::max() },
+            { "2001:db8::/32", std::numeric_limits<uint32_t>::max() },
+            { "2001:db8::1/129", std::numeric_limits<uint32_t>::max() }
+        };
+    sl.updateBanList();
+    std::map<std::string, uint32_t> ip_ban_list =
+        ServerConfig::m_server_ip_ban_list;
+    assert(ip_ban_list.size() == 3);
+    assert(!sl.isBannedForIP(TransportAddress("12.13.13.255")));
+    assert(sl.isBannedForIP(TransportAddress("12.13.14.0")));
+
     Log::info("UnitTest", "=====================");
     Log::info("UnitTest", "Testing successful   ");
     Log::info("UnitTest", "=====================");
@@ -34,9 +34,12 @@
 #include "modes/world.hpp"
 #include "network/network_config.hpp"
 #include "network/protocols/game_protocol.hpp"
+#include "network/protocols/server_lobby.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/race_event_manager.hpp"
 #include "network/rewind_manager.hpp"
+#include "network/server_config.hpp"
+#include "network/server_metrics.hpp"
 #include "network/stk_host.hpp"
 #include "online/request_manager.hpp"
 #include "race/history.hpp"
@@ -45,6 +48,8 @@
 #include "utils/profiler.hpp"
 #include "utils/time.hpp"
 
+#include <chrono>
+
 #ifndef WIN32
 #include <unistd.h>
 #endif
@@ -73,7 +78,7 @@ MainLoop::MainLoop(unsigned parent_pid)
     m_prev_time       = 0;
     m_throttle_fps    = true;
     m_allow_large_dt  = false;
-    m_frame_before_loading_world = false;
+    m_idle_wakeup     = false;
 #ifdef WIN32
     if (parent_pid != 0)
     {
@@ -195,6 +200,56 @@ float MainLoop::getLimitedDt()
     return dt;
 }   // getLimitedDt
 
+//-----------------------------------------------------------------------------
+/** Returns true if this is a server without graphics which has nothing to
+ *  do: no peer is connected, and in all server rooms no world is loaded and
+ *  the lobby is waiting for players.
+ */
+bool MainLoop::isIdleServer() const
+{
+    if (!ServerConfig::m_low_power_idle || !ProfileWorld::isNoGraphics() ||
+        !NetworkConfig::get()->isServer() ||
+        !STKHost::existHost() || STKHost::get()->getTotalPeerCount() > 0)
+        return false;
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+    {
+        ServerRoomScope scope(room);
+        auto sl = LobbyProtocol::get<ServerLobby>();
+        if (World::getWorld() || !sl ||
+            sl->getCurrentState() != ServerLobby::WAITING_FOR_START_GAME)
+            return false;
+    }
+    return true;
+}   // isIdleServer
+
+//-----------------------------------------------------------------------------
+/** Called on an idle server instead of running at full frame rate. Waits
+ *  until a peer connects or the main loop is aborted, but at most a second
+ *  so that online requests, shutdown requests and the parent process are
+ *  still checked.
+ */
+void MainLoop::waitWhileIdle()
+{
+    PROFILER_PUSH_CPU_MARKER("Idle", 0, 0, 0);
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    m_idle_cv.wait_for(lock, std::chrono::milliseconds(1000),
+        [this]() { return m_idle_wakeup; });
+    m_idle_wakeup = false;
+    PROFILER_POP_CPU_MARKER();
+}   // waitWhileIdle
+
+//-----------------------------------------------------------------------------
+/** Makes an idle server continue at full frame rate immediately, e.g. when
+ *  a peer connects. Can be called from any thread.
+ */
+void MainLoop::wakeUp()
+{
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    m_idle_wakeup = true;
+    lock.unlock();
+    m_idle_cv.notify_one();
+}   // wakeUp
+
 //-----------------------------------------------------------------------------
 /** Updates all race related objects.
  *  \param ticks Number of ticks (physics steps) to simulate - should be 1.
@@ -331,6 +386,9 @@ void MainLoop::run()
 
         PROFILER_PUSH_CPU_MARKER("Main loop", 0xFF, 0x00, 0xF7);
 
+        if (isIdleServer())
+            waitWhileIdle();
+
         left_over_time += getLimitedDt();
         int num_steps   = stk_config->time2Ticks(left_over_time);
         float dt = stk_config->ticks2Time(1);
@@ -377,10 +435,14 @@ void MainLoop::run()
             GUIEngine::ModalDialog::dismiss();
             GUIEngine::ScreenKeyboard::dismiss();
 
-            if (World::getWorld())
+            for (unsigned room = 0; room < ServerRoom::getCount(); room++)
             {
-                race_manager->clearNetworkGrandPrixResult();
-                race_manager->exitRace();
+                ServerRoomScope scope(room);
+                if (World::getWorld())
+                {
+                    race_manager->clearNetworkGrandPrixResult();
+                    race_manager->exitRace();
+                }
             }
 
             if (exist_host == true)
@@ -454,52 +516,73 @@ void MainLoop::run()
             }
             m_ticks_adjustment.unlock();
     
-            for (int i = 0; i < num_steps; i++)
+            // The rooms of a server are updated one after the other
+            for (unsigned room = 0; room < ServerRoom::getCount(); room++)
             {
-                if (World::getWorld() && history->replayHistory())
+                ServerRoom::setCurrent(room);
+                for (int i = 0; i < num_steps; i++)
                 {
-                    history->updateReplay(
-                                       World::getWorld()->getTicksSinceStart());
-                }
+                    const auto tick_start = std::chrono::steady_clock::now();
+                    if (World::getWorld() && history->replayHistory())
+                    {
+                        history->updateReplay(
+                                   World::getWorld()->getTicksSinceStart());
+                    }
     
-                PROFILER_PUSH_CPU_MARKER("Protocol manager update",
-                                         0x7F, 0x00, 0x7F);
-                if (auto pm = ProtocolManager::lock())
-                {
-                    pm->update(1);
-                }
-                PROFILER_POP_CPU_MARKER();
+                    PROFILER_PUSH_CPU_MARKER("Protocol manager update",
+                                             0x7F, 0x00, 0x7F);
+                    if (auto pm = ProtocolManager::lock())
+                    {
+                        pm->update(1);
+                    }
+                    PROFILER_POP_CPU_MARKER();
     
-                PROFILER_PUSH_CPU_MARKER("Update race", 0, 255, 255);
-                if (World::getWorld())
-                {
-                    updateRace(1);
-                }
-                PROFILER_POP_CPU_MARKER();
+                    PROFILER_PUSH_CPU_MARKER("Update race", 0, 255, 255);
+                    if (World::getWorld())
+                    {
+                        updateRace(1);
+                    }
+                    PROFILER_POP_CPU_MARKER();
     
-                // We need to check again because update_race may have requested
-                // the main loop to abort; and it's not a good idea to continue
-                // since the GUI engine is no more to be called then.
-                if (m_abort || m_request_abort) 
-                    break;
+                    // We need to check again because update_race may have
+                    // requested the main loop to abort; and it's not a good
+                    // idea to continue since the GUI engine is no more to be
+                    // called then.
+                    if (m_abort || m_request_abort) 
+                        break;
     
-                if (m_frame_before_loading_world)
-                {
-                    m_frame_before_loading_world = false;
-                    break;
-                }
+                    if (m_frame_before_loading_world.get())
+                    {
+                        m_frame_before_loading_world.get() = false;
+                        break;
+                    }
                 
-                if (World::getWorld())
-                {
-                    if (World::getWorld()->getPhase()==WorldStatus::SETUP_PHASE)
+                    if (World::getWorld())
                     {
-                        // Skip the large num steps contributed by loading time
+                        if (World::getWorld()->getPhase() ==
+                            WorldStatus::SETUP_PHASE)
+                        {
+                            // Skip the large num steps contributed by loading
+                            // time
+                            World::getWorld()->updateTime(1);
+                            break;
+                        }
                         World::getWorld()->updateTime(1);
-                        break;
                     }
-                    World::getWorld()->updateTime(1);
-                }
-            }   // for i < num_steps
+                    if (ServerMetrics::isEnabled())
+                    {
+                        ServerMetrics::addTickTime((uint32_t)
+                            std::chrono::duration_cast
+                            <std::chrono::microseconds>
+                            (std::chrono::steady_clock::now() - tick_start)
+                            .count());
+                    }
+                }   // for i < num_steps
+                if (m_abort || m_request_abort)
+                    break;
+            }   // for room < ServerRoom::getCount()
+            ServerRoom::setCurrent(0);
+            ServerMetrics::update();
 
             // Handle controller the last to avoid slow PC sending actions too 
             // late
@@ -20,9 +20,12 @@
 #ifndef HEADER_MAIN_LOOP_HPP
 #define HEADER_MAIN_LOOP_HPP
 
+#include "utils/server_room.hpp"
 #include "utils/synchronised.hpp"
 #include "utils/types.hpp"
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 /** Management class for the whole gameflow, this is where the
     main-loop is */
@@ -40,29 +43,44 @@ private:
     /** True if dt is not decreased for low fps */
     bool m_allow_large_dt;
 
-    bool m_frame_before_loading_world;
+    /** Set for each server room before its world is loaded, so that the
+     *  time spent loading is not simulated afterwards. */
+    PerRoom<bool> m_frame_before_loading_world;
 
     Synchronised<int> m_ticks_adjustment;
 
+    /** Used by an idle server to wait until a peer connects. */
+    std::condition_variable m_idle_cv;
+
+    /** Protects m_idle_wakeup. */
+    std::mutex m_idle_mutex;
+
+    /** Set if an idle server should stop waiting. */
+    bool m_idle_wakeup;
+
     uint64_t m_curr_time;
     uint64_t m_prev_time;
     unsigned m_parent_pid;
     float    getLimitedDt();
     void     updateRace(int ticks);
+    bool     isIdleServer() const;
+    void     waitWhileIdle();
 public:
          MainLoop(unsigned parent_pid);
         ~MainLoop();
     void run();
     /** Set the abort flag, causing the mainloop to be left. */
-    void abort() { m_abort = true; }
-    void requestAbort() { m_request_abort = true; }
+    void abort() { m_abort = true; wakeUp(); }
+    void requestAbort() { m_request_abort = true; wakeUp(); }
+    void wakeUp();
     void setThrottleFPS(bool throttle) { m_throttle_fps = throttle; }
     void setAllowLargeDt(bool enable) { m_allow_large_dt = enable; }
     // ------------------------------------------------------------------------
     /** Returns true if STK is to be stoppe. */
     bool isAborted() const { return m_abort; }
     // ------------------------------------------------------------------------
-    void setFrameBeforeLoadingWorld()  { m_frame_before_loading_world = true; }
+    void setFrameBeforeLoadingWorld()
+                                   { m_frame_before_loading_world.get() = true; }
     // ------------------------------------------------------------------------
     void setTicksAdjustment(int ticks)
     {
@@ -39,6 +39,7 @@
 #include "tracks/drive_node.hpp"
 #include "tracks/track_sector.hpp"
 #include "tracks/track.hpp"
+#include "utils/benchmark.hpp"
 #include "utils/constants.hpp"
 #include "utils/string_utils.hpp"
 #include "utils/translation.hpp"
@@ -805,6 +806,7 @@ btTransform LinearWorld::getRescueTransform(unsigned int index) const
  */
 void LinearWorld::updateRacePosition()
 {
+    Benchmark::Timer benchmark_timer(Benchmark::BS_RACE_POSITION);
     // Mostly for debugging:
     beginSetKartPositions();
     const unsigned int kart_amount = (unsigned int) m_karts.size();
@@ -24,6 +24,7 @@
 #include "karts/kart_with_stats.hpp"
 #include "karts/controller/controller.hpp"
 #include "tracks/track.hpp"
+#include "utils/benchmark.hpp"
 
 #include <ISceneManager.h>
 
@@ -34,6 +35,8 @@ ProfileWorld::ProfileType ProfileWorld::m_profile_mode=PROFILE_NONE;
 int   ProfileWorld::m_num_laps    = 0;
 float ProfileWorld::m_time        = 0.0f;
 bool  ProfileWorld::m_no_graphics = false;
+int   ProfileWorld::m_benchmark_ticks = 0;
+std::string ProfileWorld::m_benchmark_json;
 
 //-----------------------------------------------------------------------------
 /** The constructor sets the number of (local) players to 0, since only AI
@@ -92,6 +95,24 @@ void ProfileWorld::setProfileModeLaps(int laps)
     m_num_laps     = laps;
 }   // setProfileModeLaps
 
+//-----------------------------------------------------------------------------
+/** Enables the benchmark mode: the race runs for a fixed number of physics
+ *  ticks, and the time spent in the main updates of each tick is measured
+ *  and printed at the end. Like time based profiling the number of laps is
+ *  set to a high number.
+ *  \param ticks The number of physics ticks to run.
+ *  \param json_file If not empty, the results are also written as JSON to
+ *         this file.
+ */
+void ProfileWorld::setBenchmarkMode(int ticks, const std::string &json_file)
+{
+    m_profile_mode    = PROFILE_BENCHMARK;
+    m_num_laps        = 99999;
+    m_benchmark_ticks = ticks;
+    m_benchmark_json  = json_file;
+    Benchmark::enable();
+}   // setBenchmarkMode
+
 //-----------------------------------------------------------------------------
 /** Creates a kart, having a certain position, starting location, and local
  *  and global player id (if applicable).
@@ -136,6 +157,9 @@ bool ProfileWorld::isRaceOver()
     if(m_profile_mode==PROFILE_TIME)
         return getTime()>m_time;
 
+    if(m_profile_mode==PROFILE_BENCHMARK)
+        return (int)Benchmark::getNumTicks() >= m_benchmark_ticks;
+
     if(m_profile_mode == PROFILE_LAPS )
     {
         // Now it must be laps based profiling:
@@ -152,7 +176,12 @@ bool ProfileWorld::isRaceOver()
  */
 void ProfileWorld::update(int ticks)
 {
-    StandardRace::update(ticks);
+    {
+        Benchmark::Timer benchmark_timer(Benchmark::BS_TICK);
+        StandardRace::update(ticks);
+    }
+    if (Benchmark::isEnabled())
+        Benchmark::endTick();
 
     m_frame_count++;
     video::IVideoDriver *driver = irr_driver->getVideoDriver();
@@ -178,7 +207,7 @@ void ProfileWorld::enterRaceOverState()
     // aborting too early). So in this case determine the maximum number
     // of laps and set this +1 as the number of laps to get more meaningful
     // time estimations.
-    if(m_profile_mode==PROFILE_TIME)
+    if(m_profile_mode==PROFILE_TIME || m_profile_mode==PROFILE_BENCHMARK)
     {
         int max_laps = -2;
         for(unsigned int i=0; i<race_manager->getNumberOfKarts(); i++)
@@ -345,6 +374,11 @@ void ProfileWorld::enterRaceOverState()
                off_track_count, energy);
         Log::verbose("profile", "");
     }   // for it !=all_groups.end
+    if (m_profile_mode==PROFILE_BENCHMARK)
+    {
+        Benchmark::printResults(Track::getCurrentTrack()->getIdent(),
+                                getNumKarts(), m_benchmark_json);
+    }
     delete this;
     main_loop->abort();
 }   // enterRaceOverState
@@ -31,7 +31,8 @@ class ProfileWorld : public StandardRace
 {
 private:
     /** Profiling modes. */
-    enum        ProfileType {PROFILE_NONE, PROFILE_TIME, PROFILE_LAPS};
+    enum        ProfileType {PROFILE_NONE, PROFILE_TIME, PROFILE_LAPS,
+                             PROFILE_BENCHMARK};
 
     /** If profiling is done, and if so, which mode. */
     static ProfileType m_profile_mode;
@@ -43,6 +44,13 @@ private:
     /** In time based profiling only: time to run. */
     static float m_time;
 
+    /** In benchmark mode only: number of physics ticks to run. */
+    static int   m_benchmark_ticks;
+
+    /** In benchmark mode only: file to write the results to as JSON, or
+     *  empty to only print them. */
+    static std::string m_benchmark_json;
+
     /** Return value of real time at start of race. */
     unsigned int m_start_time;
 
@@ -88,10 +96,15 @@ public:
 
     static   void setProfileModeTime(float time);
     static   void setProfileModeLaps(int laps);
+    static   void setBenchmarkMode(int ticks, const std::string &json_file);
     // ------------------------------------------------------------------------
     /** Returns true if profile mode was selected. */
     static   bool isProfileMode() {return m_profile_mode!=PROFILE_NONE; }
     // ------------------------------------------------------------------------
+    /** Returns true if benchmark mode was selected. */
+    static   bool isBenchmarkMode()
+                                {return m_profile_mode==PROFILE_BENCHMARK; }
+    // ------------------------------------------------------------------------
     /** Switches off graphics. */
     static   void disableGraphics() { m_no_graphics = true; }
     // ------------------------------------------------------------------------
@@ -77,6 +77,7 @@
 #include "utils/profiler.hpp"
 #include "utils/translation.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/worker_pool.hpp"
 
 #include <algorithm>
 #include <assert.h>
@@ -85,7 +86,7 @@
 #include <stdexcept>
 
 
-World* World::m_world = NULL;
+PerRoom<World*> World::m_world;
 
 /** The main world class is used to handle the track and the karts.
  *  The end of the race is detected in two phases: first the (abstract)
@@ -130,6 +131,7 @@ World::World() : WorldStatus()
 
     m_race_gui           = NULL;
     m_saved_race_gui     = NULL;
+    m_track_clone        = NULL;
     m_use_highscores     = true;
     m_schedule_pause     = false;
     m_schedule_unpause   = false;
@@ -181,6 +183,11 @@ void World::init()
             << "' not found.\n";
         throw std::runtime_error(msg.str());
     }
+    if (track->isInUse())
+    {
+        m_track_clone = track->clone();
+        track = m_track_clone;
+    }
 
     std::string script_path = track->getTrackFile("scripting.as");
     Scripting::ScriptEngine::getInstance()->loadScript(script_path, true);
@@ -513,6 +520,7 @@ World::~World()
     // In case that a race is aborted (e.g. track not found) track is 0.
     if(Track::getCurrentTrack())
         Track::getCurrentTrack()->cleanup();
+    delete m_track_clone;
 
     // Delete the in-race-gui:
     if(m_saved_race_gui)
@@ -559,9 +567,14 @@ World::~World()
 
     Scripting::ScriptEngine::kill();
 
-    m_world = NULL;
+    m_world.get() = NULL;
 
-    irr_driver->getSceneManager()->clear();
+    // Other rooms of this server may still be racing in the same scene
+    bool other_room_racing = false;
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+        other_room_racing |= m_world.get(room) != NULL;
+    if (!other_room_racing)
+        irr_driver->getSceneManager()->clear();
 
 #ifdef DEBUG
     m_magic_number = 0xDEADBEEF;
@@ -1033,18 +1046,74 @@ void World::update(int ticks)
     Track::getCurrentTrack()->getTrackObjectManager()->update(stk_config->ticks2Time(ticks));
     PROFILER_POP_CPU_MARKER();
 
+    // Cast the terrain rays of all karts together before updating them,
+    // which only reads the track and can therefore be done in parallel.
+    PROFILER_PUSH_CPU_MARKER("World::update (terrain rays)", 0x40, 0x7F, 0x40);
+    const unsigned num_karts = (unsigned)m_karts.size();
+    auto prefetch = [this](unsigned i)
+    {
+        if (!m_karts[i]->isEliminated())
+            m_karts[i]->prefetchTerrainInfo();
+    };
+    WorkerPool* pool = Physics::getInstance()->getWorkerPool();
+    if (pool)
+        pool->parallelFor(num_karts, prefetch);
+    else
+    {
+        for (unsigned i = 0; i < num_karts; i++)
+            prefetch(i);
+    }
+    PROFILER_POP_CPU_MARKER();
+
+    // Update all karts that are not eliminated, and spare tire karts
+    // (which are eliminated while not in use) while they are moving.
+    auto needs_update = [this](unsigned i)
+    {
+        if (!m_karts[i]->isEliminated())
+            return true;
+        SpareTireAI* sta =
+            dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
+        return sta && sta->isMoving();
+    };
+
+    // Let the controllers decide how to drive before any kart is updated.
+    // Each controller only reads the world and modifies itself, so this can
+    // be done in parallel, and the karts then apply the decisions in the
+    // (serial) kart update below in a fixed order.
+    if (UserConfigParams::m_parallel_ai)
+    {
+        PROFILER_PUSH_CPU_MARKER("World::update (controllers)", 0x40, 0x7F, 0x20);
+        // The karts only take over the result of the last physics step in
+        // Kart::update, so do this first for all karts. Otherwise the
+        // controllers would see the positions of one step before.
+        for (unsigned i = 0; i < num_karts; i++)
+        {
+            if (needs_update(i) && !m_karts[i]->isGhostKart())
+                m_karts[i]->updateTransform();
+        }
+        auto prepare = [this, &needs_update, ticks](unsigned i)
+        {
+            if (needs_update(i))
+                m_karts[i]->getController()->prepareUpdate(ticks);
+        };
+        if (pool)
+            pool->parallelFor(num_karts, prepare);
+        else
+        {
+            for (unsigned i = 0; i < num_karts; i++)
+                prepare(i);
+        }
+        PROFILER_POP_CPU_MARKER();
+    }
+
     PROFILER_PUSH_CPU_MARKER("World::update (Kart::upate)", 0x40, 0x7F, 0x00);
 
     // Update all the karts. This in turn will also update the controller,
     // which causes all AI steering commands set. So in the following 
     // physics update the new steering is taken into account.
-    const int kart_amount = (int)m_karts.size();
-    for (int i = 0 ; i < kart_amount; ++i)
+    for (unsigned i = 0 ; i < num_karts; ++i)
     {
-        SpareTireAI* sta =
-            dynamic_cast<SpareTireAI*>(m_karts[i]->getController());
-        // Update all karts that are not eliminated
-        if(!m_karts[i]->isEliminated() || (sta && sta->isMoving()))
+        if (needs_update(i))
             m_karts[i]->update(ticks);
         if (isStartPhase())
             m_karts[i]->makeKartRest();
@@ -37,6 +37,7 @@
 #include "states_screens/race_gui_base.hpp"
 #include "states_screens/state_manager.hpp"
 #include "utils/random_generator.hpp"
+#include "utils/server_room.hpp"
 
 #include "LinearMath/btTransform.h"
 
@@ -45,6 +46,7 @@ class btRigidBody;
 class Controller;
 class ItemState;
 class PhysicalObject;
+class Track;
 
 namespace Scripting
 {
@@ -85,8 +87,9 @@ class World : public WorldStatus
 public:
     typedef std::vector<std::shared_ptr<AbstractKart> > KartList;
 private:
-    /** A pointer to the global world object for a race. */
-    static World *m_world;
+    /** A pointer to the global world object for a race (one per server
+     *  room). */
+    static PerRoom<World*> m_world;
     // ------------------------------------------------------------------------
     void setAITeam();
     // ------------------------------------------------------------------------
@@ -150,6 +153,10 @@ protected:
         there are scene nodes). */
     RaceGUIBase *m_saved_race_gui;
 
+    /** A copy of the track, used if another server room already races on
+     *  the same track. NULL otherwise. */
+    Track *m_track_clone;
+
     /** Pausing/unpausing are not done immediately, but at next udpdate. The
      *  use of this is when switching between screens : if we leave a screen
      *  that paused the game, only to go to another screen that pauses back
@@ -206,16 +213,20 @@ public:
     // =================================
     // ------------------------------------------------------------------------
     /** Returns a pointer to the (singleton) world object. */
-    static World*   getWorld() { return m_world; }
+    static World*   getWorld() { return m_world.get(); }
     // ------------------------------------------------------------------------
     /** Delete the )singleton) world object, if it exists, and sets the
       * singleton pointer to NULL. It's harmless to call this if the world
       *  has been deleted already. */
-    static void     deleteWorld() { delete m_world; m_world = NULL; }
+    static void     deleteWorld()
+    {
+        delete m_world.get();
+        m_world.get() = NULL;
+    }
     // ------------------------------------------------------------------------
     /** Sets the pointer to the world object. This is only used by
      *  the race_manager.*/
-    static void     setWorld(World *world) {m_world = world; }
+    static void     setWorld(World *world) { m_world.get() = world; }
     // ------------------------------------------------------------------------
 
     // Pure virtual functions
@@ -0,0 +1,122 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/flood_filter.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+/** Creates the filter.
+ *  \param rate Number of packets per second accepted from one IP.
+ *  \param burst Number of packets which can be accepted at once from an IP
+ *         which did not send packets for a while.
+ *  \param size Number of buckets, rounded up to a power of 2 (and at least
+ *         one set).
+ */
+FloodFilter::FloodFilter(unsigned rate, unsigned burst, unsigned size)
+{
+    unsigned sets = 1;
+    while (sets * WAYS < size)
+        sets *= 2;
+    m_set_mask = sets - 1;
+    Bucket empty;
+    empty.m_ip = 0;
+    empty.m_tokens = 0.0f;
+    empty.m_last_time = 0;
+    m_buckets.resize(sets * WAYS, empty);
+    m_rate = (float)rate / 1000.0f;
+    m_burst = (float)std::max(burst, 1u);
+    m_dropped = 0;
+}   // FloodFilter
+
+// ----------------------------------------------------------------------------
+/** Takes a token from the bucket of the given IP.
+ *  \param ip Source IP in host byte order.
+ *  \param now Current time in ms.
+ *  \return True if the packet should be accepted, false if the IP has sent
+ *          too many packets and it should be dropped.
+ */
+bool FloodFilter::allow(uint32_t ip, uint64_t now)
+{
+    // Multiplicative hash, so that addresses of the same subnet are spread
+    // over all sets
+    const uint32_t set = ((ip * 2654435761u) >> 16) & m_set_mask;
+    Bucket* b = &m_buckets[set * WAYS];
+    Bucket* bucket = NULL;
+    Bucket* oldest = b;
+    for (unsigned i = 0; i < WAYS; i++)
+    {
+        if (b[i].m_ip == ip)
+        {
+            bucket = &b[i];
+            break;
+        }
+        if (b[i].m_last_time < oldest->m_last_time)
+            oldest = &b[i];
+    }
+
+    if (!bucket)
+    {
+        bucket = oldest;
+        bucket->m_ip = ip;
+        bucket->m_tokens = m_burst;
+    }
+    else if (now > bucket->m_last_time)
+    {
+        bucket->m_tokens = std::min(m_burst, bucket->m_tokens +
+            (float)(now - bucket->m_last_time) * m_rate);
+    }
+    bucket->m_last_time = now;
+
+    if (bucket->m_tokens < 1.0f)
+    {
+        m_dropped++;
+        return false;
+    }
+    bucket->m_tokens -= 1.0f;
+    return true;
+}   // allow
+
+// ----------------------------------------------------------------------------
+void FloodFilter::unitTesting()
+{
+    FloodFilter ff(/*rate*/10, /*burst*/5, /*size*/8);
+    const uint32_t ip = 0x01020304;
+    for (unsigned i = 0; i < 5; i++)
+        assert(ff.allow(ip, 1000));
+    assert(!ff.allow(ip, 1000));
+    // Other sources are not affected
+    assert(ff.allow(ip + 1, 1000));
+    // One token every 100ms
+    assert(!ff.allow(ip, 1050));
+    assert(ff.allow(ip, 1100));
+    assert(!ff.allow(ip, 1100));
+    assert(ff.getAndResetDropped() == 3);
+    assert(ff.getAndResetDropped() == 0);
+    // The bucket never holds more than burst tokens
+    for (unsigned i = 0; i < 5; i++)
+        assert(ff.allow(ip, 100000));
+    assert(!ff.allow(ip, 100000));
+
+    // Many sources fill the table, which replaces the least recently used
+    // buckets, the table does not grow
+    for (uint32_t i = 0; i < 1000; i++)
+        assert(ff.allow(0x0a000000 + i, 200000 + i));
+    assert(ff.m_buckets.size() == 8);
+}   // unitTesting
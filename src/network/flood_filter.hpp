@@ -0,0 +1,86 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_FLOOD_FILTER_HPP
+#define HEADER_FLOOD_FILTER_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <vector>
+
+/** Limits the number of packets accepted from each source IP with a token
+ *  bucket per IP: a bucket holds up to burst tokens, is refilled with rate
+ *  tokens per second, and each accepted packet takes one token. The buckets
+ *  are kept in a fixed size 4-way set associative hash table, so memory
+ *  usage and lookup cost are constant no matter how many addresses send
+ *  packets. If all entries of a set are used, the least recently used one is
+ *  replaced, which only gives that source a new full bucket.
+ *  This class is not thread-safe, it is meant to be used by the listening
+ *  thread only.
+ */
+class FloodFilter : public NoCopy
+{
+private:
+    struct Bucket
+    {
+        /** Source IP in host byte order, 0 if unused. */
+        uint32_t m_ip;
+        /** Tokens left in this bucket. */
+        float m_tokens;
+        /** Time in ms when the bucket was last used. */
+        uint64_t m_last_time;
+    };   // Bucket
+
+    static const unsigned WAYS = 4;
+
+    std::vector<Bucket> m_buckets;
+
+    /** Number of sets minus 1 (the number of sets is a power of 2). */
+    uint32_t m_set_mask;
+
+    /** Tokens added per ms. */
+    float m_rate;
+
+    /** Maximum number of tokens in a bucket. */
+    float m_burst;
+
+    /** Number of packets dropped since the last call to
+     *  getAndResetDropped. */
+    uint32_t m_dropped;
+
+public:
+    // ------------------------------------------------------------------------
+    FloodFilter(unsigned rate, unsigned burst, unsigned size = 4096);
+    // ------------------------------------------------------------------------
+    bool allow(uint32_t ip, uint64_t now);
+    // ------------------------------------------------------------------------
+    /** Returns the number of dropped packets since the last call, and resets
+     *  the counter. */
+    uint32_t getAndResetDropped()
+    {
+        uint32_t dropped = m_dropped;
+        m_dropped = 0;
+        return dropped;
+    }   // getAndResetDropped
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // FloodFilter
+
+#endif
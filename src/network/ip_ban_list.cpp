@@ -0,0 +1,277 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/ip_ban_list.hpp"
+
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+// ----------------------------------------------------------------------------
+IPBanList::IPBanList()
+{
+    Node root;
+    root.m_children[0] = root.m_children[1] = 0;
+    root.m_ban = -1;
+    m_nodes.push_back(root);
+}   // IPBanList
+
+// ----------------------------------------------------------------------------
+/** Returns the IPv4-mapped IPv6 address (::ffff:a.b.c.d) of an IPv4 address.
+ *  \param ipv4 The IPv4 address in host byte order.
+ */
+IPBanList::IPv6Address IPBanList::mapIPv4(uint32_t ipv4)
+{
+    IPv6Address ip = {};
+    ip[10] = ip[11] = 0xff;
+    ip[12] = (uint8_t)(ipv4 >> 24);
+    ip[13] = (uint8_t)(ipv4 >> 16);
+    ip[14] = (uint8_t)(ipv4 >> 8);
+    ip[15] = (uint8_t)ipv4;
+    return ip;
+}   // mapIPv4
+
+// ----------------------------------------------------------------------------
+/** Parses an IPv4 address in dotted decimal notation.
+ *  \param ip The string to parse.
+ *  \param out The address in host byte order.
+ *  \return False if the string is not a valid address.
+ */
+bool IPBanList::parseIPv4(const std::string& ip, uint32_t* out)
+{
+    std::vector<std::string> parts = StringUtils::split(ip, '.');
+    if (parts.size() != 4)
+        return false;
+    *out = 0;
+    for (const std::string& part : parts)
+    {
+        unsigned value = 0;
+        if (part.empty() || part.size() > 3 ||
+            part.find_first_not_of("0123456789") != std::string::npos ||
+            !StringUtils::fromString(part, value) || value > 255)
+            return false;
+        *out = (*out << 8) | value;
+    }
+    return true;
+}   // parseIPv4
+
+// ----------------------------------------------------------------------------
+/** Parses an IPv6 address, including the :: shortcut for zero groups and
+ *  a dotted IPv4 address as last two groups (e.g. ::ffff:1.2.3.4).
+ *  \param ip The string to parse.
+ *  \param out The address.
+ *  \return False if the string is not a valid address.
+ */
+bool IPBanList::parseIPv6(const std::string& ip, IPv6Address* out)
+{
+    // Parses the groups on one side of '::'
+    auto parse_groups = [](const std::string& s,
+                           std::vector<uint16_t>* groups) -> bool
+    {
+        if (s.empty())
+            return true;
+        std::vector<std::string> parts = StringUtils::split(s, ':');
+        for (unsigned i = 0; i < parts.size(); i++)
+        {
+            const std::string& part = parts[i];
+            if (i == parts.size() - 1 && part.find('.') != std::string::npos)
+            {
+                uint32_t ipv4 = 0;
+                if (!parseIPv4(part, &ipv4))
+                    return false;
+                groups->push_back((uint16_t)(ipv4 >> 16));
+                groups->push_back((uint16_t)ipv4);
+                continue;
+            }
+            if (part.empty() || part.size() > 4 ||
+                part.find_first_not_of("0123456789abcdefABCDEF") !=
+                std::string::npos)
+                return false;
+            groups->push_back((uint16_t)std::stoul(part, NULL, 16));
+        }
+        return true;
+    };
+
+    std::vector<uint16_t> left, right;
+    const size_t shortcut = ip.find("::");
+    if (shortcut == std::string::npos)
+    {
+        if (!parse_groups(ip, &left) || left.size() != 8)
+            return false;
+    }
+    else
+    {
+        if (ip.find("::", shortcut + 1) != std::string::npos ||
+            !parse_groups(ip.substr(0, shortcut), &left) ||
+            !parse_groups(ip.substr(shortcut + 2), &right) ||
+            left.size() + right.size() > 7)
+            return false;
+    }
+    left.resize(8 - right.size(), 0);
+    left.insert(left.end(), right.begin(), right.end());
+    for (unsigned i = 0; i < 8; i++)
+    {
+        (*out)[i * 2] = (uint8_t)(left[i] >> 8);
+        (*out)[i * 2 + 1] = (uint8_t)left[i];
+    }
+    return true;
+}   // parseIPv6
+
+// ----------------------------------------------------------------------------
+/** Adds a ban for an IP range. If the same range is banned more than once,
+ *  the latest expire time is used.
+ *  \param cidr The range in CIDR notation, e.g. 1.2.3.0/24 or 2001:db8::/32.
+ *  \param expired_time Time (seconds since epoch) when the ban expires.
+ *  \return False if the CIDR is invalid.
+ */
+bool IPBanList::add(const std::string& cidr, uint32_t expired_time)
+{
+    std::vector<std::string> ip_and_netbits = StringUtils::split(cidr, '/');
+    unsigned netbits = 0;
+    if (ip_and_netbits.size() != 2 ||
+        !StringUtils::fromString(ip_and_netbits[1], netbits))
+        return false;
+
+    IPv6Address ip;
+    if (ip_and_netbits[0].find(':') != std::string::npos)
+    {
+        if (netbits > 128 || !parseIPv6(ip_and_netbits[0], &ip))
+            return false;
+    }
+    else
+    {
+        uint32_t ipv4 = 0;
+        if (netbits > 32 || !parseIPv4(ip_and_netbits[0], &ipv4))
+            return false;
+        ip = mapIPv4(ipv4);
+        netbits += 96;
+    }
+
+    uint32_t node = 0;
+    for (unsigned bit = 0; bit < netbits; bit++)
+    {
+        const unsigned b = (ip[bit / 8] >> (7 - bit % 8)) & 1;
+        if (m_nodes[node].m_children[b] == 0)
+        {
+            Node child;
+            child.m_children[0] = child.m_children[1] = 0;
+            child.m_ban = -1;
+            m_nodes[node].m_children[b] = (uint32_t)m_nodes.size();
+            m_nodes.push_back(child);
+        }
+        node = m_nodes[node].m_children[b];
+    }
+
+    if (m_nodes[node].m_ban == -1)
+    {
+        m_nodes[node].m_ban = (int)m_bans.size();
+        Ban ban;
+        ban.m_cidr = cidr;
+        ban.m_expired_time = expired_time;
+        m_bans.push_back(ban);
+    }
+    else
+    {
+        Ban& ban = m_bans[m_nodes[node].m_ban];
+        ban.m_expired_time = std::max(ban.m_expired_time, expired_time);
+    }
+    return true;
+}   // add
+
+// ----------------------------------------------------------------------------
+/** Returns the CIDR of an active ban which contains the given address, or
+ *  NULL if the address is not banned.
+ *  \param ip The address to check.
+ *  \param now Current time in seconds since epoch.
+ */
+const std::string* IPBanList::findBan(const IPv6Address& ip,
+                                      uint32_t now) const
+{
+    uint32_t node = 0;
+    for (unsigned bit = 0; ; bit++)
+    {
+        const int ban = m_nodes[node].m_ban;
+        if (ban != -1 && now < m_bans[ban].m_expired_time)
+            return &m_bans[ban].m_cidr;
+        if (bit == 128)
+            return NULL;
+        node = m_nodes[node].m_children[(ip[bit / 8] >> (7 - bit % 8)) & 1];
+        if (node == 0)
+            return NULL;
+    }
+}   // findBan
+
+// ----------------------------------------------------------------------------
+void IPBanList::unitTesting()
+{
+    const uint32_t forever = std::numeric_limits<uint32_t>::max();
+    IPBanList list;
+    // The calls are not done in the asserts, which are removed with NDEBUG
+    bool result;
+    result = list.add("1.2.3.4", forever);
+    assert(!result);
+    result = list.add("1.2.3/24", forever);
+    assert(!result);
+    result = list.add("1.2.3.256/24", forever);
+    assert(!result);
+    result = list.add("1.2.3.4/33", forever);
+    assert(!result);
+    result = list.add("1:2:3/48", forever);
+    assert(!result);
+    result = list.add("1::2::3/48", forever);
+    assert(!result);
+    result = list.add("::/129", forever);
+    assert(!result);
+    assert(list.size() == 0);
+
+    // Overlapping ranges and expired bans
+    result = list.add("10.0.0.0/8", 1000);
+    assert(result);
+    result = list.add("10.1.0.0/16", forever);
+    assert(result);
+    assert(list.findBan((10u << 24) + 5, 999) != NULL);
+    assert(list.findBan((10u << 24) + 5, 1000) == NULL);
+    assert(*list.findBan((10u << 24) + (1u << 16) + 5, 1000) ==
+           "10.1.0.0/16");
+    assert(list.findBan((11u << 24), 0) == NULL);
+
+    // IPv6
+    result = list.add("2001:db8::/32", forever);
+    assert(result);
+    IPv6Address ip;
+    result = parseIPv6("2001:db8:ffff::1", &ip);
+    assert(result);
+    assert(*list.findBan(ip, 0) == "2001:db8::/32");
+    result = parseIPv6("2001:db9::1", &ip);
+    assert(result);
+    assert(list.findBan(ip, 0) == NULL);
+    result = parseIPv6("::ffff:10.1.2.3", &ip);
+    assert(result);
+    assert(ip == mapIPv4((10u << 24) + (1u << 16) + (2u << 8) + 3));
+    assert(list.findBan(ip, 0) != NULL);
+
+    // Banning everything
+    result = list.add("::/0", forever);
+    assert(result);
+    result = parseIPv6("1:2:3:4:5:6:7:8", &ip);
+    assert(result);
+    assert(*list.findBan(ip, 0) == "::/0");
+    assert(list.size() == 4);
+}   // unitTesting
@@ -0,0 +1,94 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_IP_BAN_LIST_HPP
+#define HEADER_IP_BAN_LIST_HPP
+
+#include "utils/types.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+/** A list of banned IP ranges (IPv4 and IPv6 CIDRs), stored in a binary
+ *  prefix trie: each bit of an address selects one of the two children of
+ *  a node, and a ban is stored at the node reached by the prefix of its
+ *  CIDR. So a lookup needs at most 128 steps independent of the number of
+ *  bans, and overlapping ranges are simply stored at different depths of
+ *  the same path. IPv4 addresses are stored as IPv4-mapped IPv6 addresses
+ *  (::ffff:a.b.c.d). The nodes are kept in one vector to keep the trie
+ *  compact. A list is not modified after it was built, so it can be shared
+ *  between threads.
+ */
+class IPBanList
+{
+public:
+    /** An IPv6 address (or an IPv4-mapped one) in network byte order. */
+    typedef std::array<uint8_t, 16> IPv6Address;
+
+private:
+    struct Node
+    {
+        /** Index of the child nodes for bit 0 and 1, 0 if there is no child
+         *  (the root node is never a child). */
+        uint32_t m_children[2];
+        /** Index of the ban of this prefix, -1 if none. */
+        int m_ban;
+    };   // Node
+
+    struct Ban
+    {
+        std::string m_cidr;
+        /** Time (seconds since epoch) when the ban expires. */
+        uint32_t m_expired_time;
+    };   // Ban
+
+    std::vector<Node> m_nodes;
+
+    std::vector<Ban> m_bans;
+
+    // ------------------------------------------------------------------------
+    static bool parseIPv4(const std::string& ip, uint32_t* out);
+    // ------------------------------------------------------------------------
+    static bool parseIPv6(const std::string& ip, IPv6Address* out);
+
+public:
+    // ------------------------------------------------------------------------
+    IPBanList();
+    // ------------------------------------------------------------------------
+    bool add(const std::string& cidr, uint32_t expired_time);
+    // ------------------------------------------------------------------------
+    const std::string* findBan(const IPv6Address& ip, uint32_t now) const;
+    // ------------------------------------------------------------------------
+    /** Returns the CIDR of an active ban for the given IPv4 address (in host
+     *  byte order), or NULL if the address is not banned. */
+    const std::string* findBan(uint32_t ipv4, uint32_t now) const
+    {
+        return findBan(mapIPv4(ipv4), now);
+    }   // findBan
+    // ------------------------------------------------------------------------
+    static IPv6Address mapIPv4(uint32_t ipv4);
+    // ------------------------------------------------------------------------
+    /** Returns the number of bans. */
+    unsigned size() const                    { return (unsigned)m_bans.size(); }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+
+};   // IPBanList
+
+#endif
@@ -0,0 +1,669 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/load_generator.hpp"
+
+#include "network/event.hpp"
+#include "network/network.hpp"
+#include "network/network_string.hpp"
+#include "network/network_player_profile.hpp"
+#include "network/protocols/client_lobby.hpp"
+#include "network/protocols/game_protocol.hpp"
+#include "network/remote_kart_info.hpp"
+#include "network/stk_peer.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+namespace
+{
+    /** Returns the p-th percentile of the values. */
+    uint32_t getPercentile(std::vector<uint32_t> values, unsigned p)
+    {
+        if (values.empty())
+            return 0;
+        std::sort(values.begin(), values.end());
+        return values[(values.size() - 1) * p / 100];
+    }   // getPercentile
+
+    // ------------------------------------------------------------------------
+    /** Returns the average of the values. */
+    uint32_t getAverage(const std::vector<uint32_t>& values)
+    {
+        if (values.empty())
+            return 0;
+        uint64_t sum = 0;
+        for (uint32_t v : values)
+            sum += v;
+        return (uint32_t)(sum / values.size());
+    }   // getAverage
+
+    // ------------------------------------------------------------------------
+    /** Tests if a packet is a ping packet of the server (see STKHost). */
+    bool isPingPacket(const unsigned char* data, size_t length)
+    {
+        return length > 5 && data[0] == 255 && data[1] == 'p' &&
+            data[2] == 'i' && data[3] == 'n' && data[4] == 'g';
+    }   // isPingPacket
+}
+
+// ============================================================================
+/** Creates a load generator.
+ *  \param server Address of the server.
+ *  \param bots Number of bot clients.
+ *  \param races Number of races to run.
+ *  \param race_duration Maximum duration of a race in seconds.
+ *  \param seed Seed for the actions and selections of the bots.
+ */
+LoadGenerator::LoadGenerator(const TransportAddress& server, unsigned bots,
+                             unsigned races, unsigned race_duration,
+                             uint32_t seed)
+             : m_server_address(server)
+{
+    m_races         = races;
+    m_race_duration = race_duration;
+    m_seed          = seed;
+    m_race          = 0;
+    m_statistics.m_remote_actions = 0;
+    m_statistics.m_late_actions   = 0;
+    m_statistics.m_actions_sent   = 0;
+    m_statistics.m_racing_time    = 0;
+    m_statistics.m_rtt_sum        = 0;
+    m_statistics.m_rtt_count      = 0;
+    m_statistics.m_failures       = 0;
+    m_bots.resize(bots);
+    for (unsigned i = 0; i < bots; i++)
+    {
+        m_bots[i].m_index   = i;
+        m_bots[i].m_network = NULL;
+        m_bots[i].m_server  = NULL;
+        m_bots[i].m_state   = BS_DISCONNECTED;
+        m_bots[i].m_random.seed(seed + i);
+    }
+}   // LoadGenerator
+
+// ----------------------------------------------------------------------------
+LoadGenerator::~LoadGenerator()
+{
+    for (Bot& bot : m_bots)
+        delete bot.m_network;
+}   // ~LoadGenerator
+
+// ----------------------------------------------------------------------------
+/** Runs all races and prints the statistics at the end. Each race ends if
+ *  all bots received the race result, if the race duration is over, or if
+ *  the race did not start within a minute.
+ */
+void LoadGenerator::run()
+{
+    if (enet_initialize() != 0)
+    {
+        Log::error("LoadGenerator", "Could not initialize enet.");
+        return;
+    }
+    Log::info("LoadGenerator", "Running %d races of at most %d seconds "
+        "with %d bots on %s, seed %d.", m_races, m_race_duration,
+        (int)m_bots.size(), m_server_address.toString().c_str(), m_seed);
+
+    for (m_race = 0; m_race < m_races; m_race++)
+    {
+        connectBots();
+        const uint64_t start_timeout = StkTime::getRealTimeMs() + 60000;
+        uint64_t race_end = std::numeric_limits<uint64_t>::max();
+        while (true)
+        {
+            for (Bot& bot : m_bots)
+                updateBot(bot);
+
+            unsigned connected = 0, lobby = 0, racing = 0, finished = 0;
+            bool has_owner = false, begin_requested = false;
+            for (const Bot& bot : m_bots)
+            {
+                if (bot.m_state == BS_DISCONNECTED)
+                    continue;
+                connected++;
+                if (bot.m_state == BS_LOBBY)
+                    lobby++;
+                else if (bot.m_state == BS_RACING)
+                    racing++;
+                else if (bot.m_state == BS_FINISHED)
+                    finished++;
+                has_owner |= bot.m_owner;
+                begin_requested |= bot.m_begin_requested;
+            }
+
+            // Start the race when all bots joined: either the server owner
+            // starts it, or on an owner-less server all bots are ready
+            if (lobby > 0 && lobby == connected && !begin_requested)
+            {
+                for (Bot& bot : m_bots)
+                {
+                    if (bot.m_state != BS_LOBBY ||
+                        (has_owner && !bot.m_owner))
+                        continue;
+                    NetworkString start(PROTOCOL_LOBBY_ROOM);
+                    start.addUInt8(LobbyProtocol::LE_REQUEST_BEGIN);
+                    sendToServer(bot, start, /*reliable*/true);
+                    bot.m_begin_requested = true;
+                }
+            }
+
+            const uint64_t now = StkTime::getRealTimeMs();
+            if (racing > 0 && race_end == std::numeric_limits<uint64_t>::max())
+            {
+                Log::info("LoadGenerator", "Race %d started.", m_race + 1);
+                race_end = now + (uint64_t)m_race_duration * 1000;
+            }
+            if (connected == 0 || (finished > 0 && finished == connected) ||
+                now > race_end)
+                break;
+            if (race_end == std::numeric_limits<uint64_t>::max() &&
+                now > start_timeout)
+            {
+                Log::warn("LoadGenerator", "Race %d did not start.",
+                    m_race + 1);
+                break;
+            }
+            StkTime::sleep(1);
+        }
+        disconnectBots();
+        // Give the server time to reset its lobby
+        if (m_race + 1 < m_races)
+            StkTime::sleep(2000);
+    }
+
+    printStatistics();
+    enet_deinitialize();
+}   // run
+
+// ----------------------------------------------------------------------------
+/** Creates a new enet host for each bot and connects it to the server. */
+void LoadGenerator::connectBots()
+{
+    for (Bot& bot : m_bots)
+    {
+        bot.m_server                  = NULL;
+        bot.m_state                   = BS_DISCONNECTED;
+        bot.m_host_id                 = 0;
+        bot.m_kart_id                 = -1;
+        bot.m_owner                   = false;
+        bot.m_begin_requested         = false;
+        bot.m_physics_fps             = 120;
+        bot.m_input_frequency         = 0;
+        bot.m_timer_offset            = 0;
+        bot.m_timer_synced            = false;
+        bot.m_start_time              = 0;
+        bot.m_racing_since            = 0;
+        bot.m_last_state_time         = 0;
+        bot.m_next_action_ticks       = 0;
+        bot.m_last_actions_sent_ticks = -1;
+        bot.m_next_sequence           = 0;
+
+        ENetAddress address;
+        address.host = 0;
+        address.port = 0;
+        bot.m_network = new Network(/*peer_count*/1,
+            /*channel_limit*/EVENT_CHANNEL_COUNT, /*max_in_bandwidth*/0,
+            /*max_out_bandwidth*/0, &address);
+        if (!bot.m_network->getENetHost())
+        {
+            Log::error("LoadGenerator", "Bot %d could not create a socket.",
+                bot.m_index);
+            m_statistics.m_failures++;
+            continue;
+        }
+        bot.m_server = bot.m_network->connectTo(m_server_address);
+        if (bot.m_server)
+            bot.m_state = BS_CONNECTING;
+        else
+            m_statistics.m_failures++;
+    }
+}   // connectBots
+
+// ----------------------------------------------------------------------------
+/** Disconnects all bots from the server and destroys their enet hosts. */
+void LoadGenerator::disconnectBots()
+{
+    const uint64_t now = StkTime::getRealTimeMs();
+    for (Bot& bot : m_bots)
+    {
+        if (bot.m_racing_since != 0 && now > bot.m_racing_since)
+            m_statistics.m_racing_time += now - bot.m_racing_since;
+        bot.m_racing_since = 0;
+        if (bot.m_server && bot.m_state != BS_DISCONNECTED)
+            enet_peer_disconnect(bot.m_server, PDI_NORMAL);
+    }
+
+    // Wait (at most a second) till the server confirmed the disconnects
+    const uint64_t timeout = StkTime::getRealTimeMs() + 1000;
+    bool waiting = true;
+    while (waiting && StkTime::getRealTimeMs() < timeout)
+    {
+        waiting = false;
+        for (Bot& bot : m_bots)
+        {
+            if (!bot.m_network || !bot.m_network->getENetHost() ||
+                bot.m_state == BS_DISCONNECTED)
+                continue;
+            ENetEvent event;
+            while (enet_host_service(bot.m_network->getENetHost(), &event,
+                0) > 0)
+            {
+                if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                    enet_packet_destroy(event.packet);
+                else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+                    bot.m_state = BS_DISCONNECTED;
+            }
+            waiting |= bot.m_state != BS_DISCONNECTED;
+        }
+        StkTime::sleep(1);
+    }
+
+    for (Bot& bot : m_bots)
+    {
+        delete bot.m_network;
+        bot.m_network = NULL;
+        bot.m_server = NULL;
+        bot.m_state = BS_DISCONNECTED;
+    }
+}   // disconnectBots
+
+// ----------------------------------------------------------------------------
+/** Handles all packets received by a bot and sends its actions.
+ */
+void LoadGenerator::updateBot(Bot& bot)
+{
+    if (!bot.m_network || !bot.m_network->getENetHost())
+        return;
+
+    ENetEvent event;
+    while (enet_host_service(bot.m_network->getENetHost(), &event, 0) > 0)
+    {
+        switch (event.type)
+        {
+        case ENET_EVENT_TYPE_CONNECT:
+            sendConnectionRequest(bot);
+            break;
+        case ENET_EVENT_TYPE_DISCONNECT:
+            if (bot.m_state != BS_DISCONNECTED)
+            {
+                Log::warn("LoadGenerator", "Bot %d was disconnected.",
+                    bot.m_index);
+                m_statistics.m_failures++;
+            }
+            bot.m_state = BS_DISCONNECTED;
+            break;
+        case ENET_EVENT_TYPE_RECEIVE:
+            handlePacket(bot, event);
+            enet_packet_destroy(event.packet);
+            break;
+        case ENET_EVENT_TYPE_NONE:
+            break;
+        }
+    }
+
+    if (bot.m_state == BS_RACING)
+        sendActions(bot, StkTime::getRealTimeMs());
+}   // updateBot
+
+// ----------------------------------------------------------------------------
+/** Sends the connection request (see ClientLobby) for a single player
+ *  without online account.
+ */
+void LoadGenerator::sendConnectionRequest(Bot& bot)
+{
+    // One player, no online id and no encrypted data
+    std::vector<std::tuple<core::stringw, float, PerPlayerDifficulty> >
+        players;
+    players.emplace_back(StringUtils::utf8ToWide("Bot " +
+        StringUtils::toString(bot.m_index + 1)), 0.0f,
+        PLAYER_DIFFICULTY_NORMAL);
+    NetworkString request(PROTOCOL_LOBBY_ROOM);
+    BareNetworkString rest;
+    ClientLobby::encodeConnectionRequest(&request, &rest, players,
+        /*online_id*/0, core::stringw(), /*encryption*/false);
+    request += rest;
+    sendToServer(bot, request, /*reliable*/true);
+    bot.m_state = BS_REQUESTING;
+}   // sendConnectionRequest
+
+// ----------------------------------------------------------------------------
+/** Handles a packet received by a bot.
+ */
+void LoadGenerator::handlePacket(Bot& bot, const ENetEvent& event)
+{
+    const uint64_t now = StkTime::getRealTimeMs();
+    const unsigned char* data = event.packet->data;
+    const size_t length = event.packet->dataLength;
+    try
+    {
+        if (isPingPacket(data, length))
+        {
+            // Synchronise with the network timer of the server
+            BareNetworkString ping((const char*)data, (int)length);
+            ping.skip(5);
+            const uint64_t server_time = ping.getUInt64();
+            const uint32_t rtt = bot.m_server->roundTripTime;
+            bot.m_timer_offset = (int64_t)(server_time + rtt / 2) -
+                (int64_t)now;
+            bot.m_timer_synced = true;
+            m_statistics.m_rtt_sum += rtt;
+            m_statistics.m_rtt_count++;
+            return;
+        }
+        if (length < 2)
+            return;
+
+        NetworkString message(data, (int)length);
+        if (message.getProtocolType() == PROTOCOL_LOBBY_ROOM)
+            handleLobbyMessage(bot, message);
+        else if (message.getProtocolType() == PROTOCOL_CONTROLLER_EVENTS)
+            handleGameMessage(bot, message, now);
+    }
+    catch (std::exception& e)
+    {
+        Log::warn("LoadGenerator", "Bot %d received an invalid message: %s",
+            bot.m_index, e.what());
+    }
+}   // handlePacket
+
+// ----------------------------------------------------------------------------
+/** Handles the lobby messages needed to join the server and to start and
+ *  finish a race.
+ */
+void LoadGenerator::handleLobbyMessage(Bot& bot, NetworkString& data)
+{
+    switch (data.getUInt8())
+    {
+    case LobbyProtocol::LE_CONNECTION_ACCEPTED:
+    {
+        bot.m_host_id = data.getUInt32();
+        data.getUInt32();   // server version
+        data.getFloat();    // auto start timer
+        bot.m_physics_fps = data.getUInt16();
+        data.getUInt16();   // state frequency
+        bot.m_input_frequency = data.getUInt16();
+        if (bot.m_physics_fps <= 0)
+            bot.m_physics_fps = 120;
+        bot.m_state = BS_LOBBY;
+        break;
+    }
+    case LobbyProtocol::LE_CONNECTION_REFUSED:
+    {
+        Log::warn("LoadGenerator", "Bot %d was refused, reason %d.",
+            bot.m_index, data.getUInt8());
+        m_statistics.m_failures++;
+        bot.m_state = BS_DISCONNECTED;
+        break;
+    }
+    case LobbyProtocol::LE_SERVER_OWNERSHIP:
+        bot.m_owner = true;
+        break;
+    case LobbyProtocol::LE_START_SELECTION:
+    {
+        data.getUInt8();    // grand prix started
+        data.getUInt8();    // auto game time ratio used
+        std::set<std::string> karts, tracks;
+        ClientLobby::decodeAvailableAssets(data, &karts, &tracks);
+        if (karts.empty() || tracks.empty())
+            break;
+
+        NetworkString kart(PROTOCOL_LOBBY_ROOM);
+        ClientLobby::encodeKartSelection(&kart, std::vector<std::string>(1,
+            *std::next(karts.begin(), bot.m_random() % karts.size())));
+        sendToServer(bot, kart, /*reliable*/true);
+
+        // All bots vote for the same track, so the result does not depend
+        // on the order in which the votes are counted
+        std::mt19937 race_random(m_seed + m_race);
+        NetworkString vote(PROTOCOL_LOBBY_ROOM);
+        ClientLobby::encodeVote(&vote,
+            *std::next(tracks.begin(), race_random() % tracks.size()),
+            /*laps*/1, /*reverse*/false);
+        sendToServer(bot, vote, /*reliable*/true);
+        bot.m_state = BS_SELECTING;
+        break;
+    }
+    case LobbyProtocol::LE_LOAD_WORLD:
+    {
+        std::string name;
+        data.decodeString(&name);   // track
+        data.getUInt8();            // laps
+        data.getUInt8();            // reverse
+        const unsigned player_count = data.getUInt8();
+        for (unsigned i = 0; i < player_count; i++)
+        {
+            auto player = ClientLobby::decodePlayer(data, nullptr);
+            if (player->getHostId() == bot.m_host_id)
+                bot.m_kart_id = i;
+        }
+        NetworkString loaded(PROTOCOL_LOBBY_ROOM);
+        loaded.addUInt8(LobbyProtocol::LE_CLIENT_LOADED_WORLD);
+        sendToServer(bot, loaded, /*reliable*/true);
+        bot.m_state = BS_LOADING;
+        break;
+    }
+    case LobbyProtocol::LE_START_RACE:
+    {
+        bot.m_start_time = data.getUInt64();
+        const uint64_t now = StkTime::getRealTimeMs();
+        const int64_t start = (int64_t)bot.m_start_time - bot.m_timer_offset;
+        bot.m_racing_since = std::max((int64_t)now, start);
+        bot.m_state = BS_RACING;
+        break;
+    }
+    case LobbyProtocol::LE_RACE_FINISHED:
+    {
+        NetworkString ack(PROTOCOL_LOBBY_ROOM);
+        ack.setSynchronous(true);
+        ack.addUInt8(LobbyProtocol::LE_RACE_FINISHED_ACK);
+        sendToServer(bot, ack, /*reliable*/true);
+        const uint64_t now = StkTime::getRealTimeMs();
+        if (bot.m_racing_since != 0 && now > bot.m_racing_since)
+            m_statistics.m_racing_time += now - bot.m_racing_since;
+        bot.m_racing_since = 0;
+        bot.m_state = BS_FINISHED;
+        break;
+    }
+    default:
+        break;
+    }
+}   // handleLobbyMessage
+
+// ----------------------------------------------------------------------------
+/** Handles states and forwarded actions of other clients during a race, and
+ *  records how late the actions of other clients arrive.
+ */
+void LoadGenerator::handleGameMessage(Bot& bot, NetworkString& data,
+                                      uint64_t now)
+{
+    if (bot.m_state != BS_RACING)
+        return;
+    const int client_ticks = getClientTicks(bot, now);
+    const uint8_t type = data.getUInt8();
+    if (type == GameProtocol::GP_STATE ||
+        type == GameProtocol::GP_DELTA_STATE)
+    {
+        const int ticks = data.getUInt32();
+        m_statistics.m_state_sizes.push_back(data.getTotalSize());
+        if (bot.m_last_state_time != 0)
+        {
+            m_statistics.m_state_intervals.push_back(
+                (uint32_t)(now - bot.m_last_state_time));
+        }
+        bot.m_last_state_time = now;
+
+        if (type == GameProtocol::GP_DELTA_STATE)
+        {
+            NetworkString ack(PROTOCOL_CONTROLLER_EVENTS);
+            GameProtocol::encodeStateAck(&ack, ticks);
+            sendToServer(bot, ack, /*reliable*/false);
+        }
+    }
+    else if (type == GameProtocol::GP_CONTROLLER_ACTION)
+    {
+        std::vector<GameProtocol::Action> actions;
+        if (!GameProtocol::decodeActions(data, &actions))
+            return;
+        m_statistics.m_remote_actions += actions.size();
+        for (const GameProtocol::Action& a : actions)
+        {
+            if (a.m_ticks >= client_ticks)
+                continue;
+            m_statistics.m_late_actions++;
+            m_statistics.m_late_action_ticks.push_back(
+                client_ticks - a.m_ticks);
+        }
+    }
+}   // handleGameMessage
+
+// ----------------------------------------------------------------------------
+/** Returns the world ticks a client would be at now, or -1 if the race has
+ *  not started yet. Like on a real client the race starts at the network
+ *  time sent by the server.
+ */
+int LoadGenerator::getClientTicks(const Bot& bot, uint64_t now) const
+{
+    const int64_t time = (int64_t)now + bot.m_timer_offset -
+        (int64_t)bot.m_start_time;
+    if (bot.m_start_time == 0 || !bot.m_timer_synced || time < 0)
+        return -1;
+    return (int)(time * bot.m_physics_fps / 1000);
+}   // getClientTicks
+
+// ----------------------------------------------------------------------------
+/** Sends the next seeded random action of a bot if it is due: the kart
+ *  always accelerates, and changes its steering every 0.1 to 1.5 seconds,
+ *  sometimes using nitro or firing. Like a client, the number of action
+ *  messages is limited to the input frequency of the server.
+ */
+void LoadGenerator::sendActions(Bot& bot, uint64_t now)
+{
+    const int ticks = getClientTicks(bot, now);
+    if (ticks < 0 || bot.m_kart_id < 0 || ticks < bot.m_next_action_ticks)
+        return;
+    if (bot.m_input_frequency > 0 && bot.m_last_actions_sent_ticks >= 0 &&
+        ticks - bot.m_last_actions_sent_ticks <
+        bot.m_physics_fps / bot.m_input_frequency)
+        return;
+
+    GameProtocol::Action a;
+    a.m_ticks      = ticks;
+    a.m_kart_id    = bot.m_kart_id;
+    a.m_value_l    = 0;
+    a.m_value_r    = 0;
+    a.m_sends_left = 0;
+    const unsigned choice = bot.m_random() % 10;
+    const int steer = (int)(bot.m_random() % 32769);
+    if (bot.m_next_sequence == 0)
+    {
+        a.m_action = PA_ACCEL;
+        a.m_value  = 32768;
+    }
+    else if (choice == 0)
+    {
+        a.m_action = PA_NITRO;
+        a.m_value  = 32768;
+    }
+    else if (choice == 1)
+    {
+        a.m_action = PA_FIRE;
+        a.m_value  = 32768;
+    }
+    else if (choice < 6)
+    {
+        a.m_action  = PA_STEER_LEFT;
+        a.m_value   = steer;
+        a.m_value_l = steer;
+    }
+    else
+    {
+        a.m_action  = PA_STEER_RIGHT;
+        a.m_value   = steer;
+        a.m_value_r = steer;
+    }
+    a.m_sequence = bot.m_next_sequence++;
+
+    NetworkString message(PROTOCOL_CONTROLLER_EVENTS);
+    message.addUInt8(GameProtocol::GP_CONTROLLER_ACTION);
+    GameProtocol::encodeActions(std::vector<GameProtocol::Action>(1, a),
+        &message);
+    sendToServer(bot, message, /*reliable*/true);
+    m_statistics.m_actions_sent++;
+
+    bot.m_last_actions_sent_ticks = ticks;
+    bot.m_next_action_ticks = ticks +
+        (int)(100 + bot.m_random() % 1400) * bot.m_physics_fps / 1000;
+}   // sendActions
+
+// ----------------------------------------------------------------------------
+/** Sends a message of a bot to the server, unencrypted on the normal channel
+ *  like a client without encryption.
+ */
+void LoadGenerator::sendToServer(Bot& bot, const BareNetworkString& data,
+                                 bool reliable)
+{
+    if (!bot.m_server)
+        return;
+    ENetPacket* packet = enet_packet_create(data.getData(),
+        data.getTotalSize(), (reliable ?
+        ENET_PACKET_FLAG_RELIABLE :
+        (ENET_PACKET_FLAG_UNSEQUENCED |
+        ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT)));
+    if (enet_peer_send(bot.m_server, EVENT_CHANNEL_NORMAL, packet) < 0)
+        enet_packet_destroy(packet);
+}   // sendToServer
+
+// ----------------------------------------------------------------------------
+/** Prints the statistics of all races. */
+void LoadGenerator::printStatistics() const
+{
+    const Statistics& s = m_statistics;
+    Log::info("LoadGenerator", "%d bots, %d races, %d failed connections, "
+        "average round trip time %d ms.", (int)m_bots.size(), m_races,
+        s.m_failures,
+        s.m_rtt_count > 0 ? (int)(s.m_rtt_sum / s.m_rtt_count) : 0);
+    Log::info("LoadGenerator", "States received: %d, size average %d, "
+        "p50 %d, p99 %d, max %d bytes.", (int)s.m_state_sizes.size(),
+        getAverage(s.m_state_sizes), getPercentile(s.m_state_sizes, 50),
+        getPercentile(s.m_state_sizes, 99),
+        getPercentile(s.m_state_sizes, 100));
+    Log::info("LoadGenerator", "Time between states: average %d, p50 %d, "
+        "p99 %d, max %d ms.", getAverage(s.m_state_intervals),
+        getPercentile(s.m_state_intervals, 50),
+        getPercentile(s.m_state_intervals, 99),
+        getPercentile(s.m_state_intervals, 100));
+    Log::info("LoadGenerator", "Actions sent: %d, received from other "
+        "clients: %d, %d of them late by p50 %d, p99 %d, max %d ticks.",
+        (int)s.m_actions_sent, (int)s.m_remote_actions,
+        (int)s.m_late_actions, getPercentile(s.m_late_action_ticks, 50),
+        getPercentile(s.m_late_action_ticks, 99),
+        getPercentile(s.m_late_action_ticks, 100));
+    const float racing_seconds = s.m_racing_time / 1000.0f;
+    Log::info("LoadGenerator", "Late actions per client: %.2f per second.",
+        racing_seconds > 0.0f ?
+        (float)s.m_late_actions / racing_seconds : 0.0f);
+    Log::info("LoadGenerator", "Client rewinds are not measured, the bots "
+        "do not simulate the race.");
+}   // printStatistics
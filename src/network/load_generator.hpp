@@ -0,0 +1,166 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_LOAD_GENERATOR_HPP
+#define HEADER_LOAD_GENERATOR_HPP
+
+#include "network/transport_address.hpp"
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <enet/enet.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+class BareNetworkString;
+class Network;
+class NetworkString;
+
+/** \ingroup network
+ *  Generates network load on a server with lightweight bot clients, all
+ *  running in one thread of a single process. The bots do not load a world
+ *  or simulate anything, they only speak the lobby and game protocol: they
+ *  join the server, start the race, send random controller actions and
+ *  acknowledge the states of the server. All messages are built with the
+ *  encoders of ClientLobby and GameProtocol. Each race ends when
+ *  the server sends the race result or after the race duration, in which
+ *  case the bots disconnect so the server resets its lobby.
+ *  At the end statistics are printed: the size of the states, the interval
+ *  between states (which grows if the server cannot keep up with its tick
+ *  rate), and how many actions of other clients arrive after the tick a
+ *  client would be at, and by how many ticks.
+ *  Client rewind rates are not measured: the bots do not simulate, so they
+ *  never rewind. They are reported by real clients at the end of a race
+ *  (see RewindManager::getStatistics()). The kart, track and action choices
+ *  of the bots depend only on the seed, but their timing depends on the
+ *  network and the server, so the results of two runs differ.
+ *  The bots only support LAN servers without password and encryption.
+ */
+class LoadGenerator : public NoCopy
+{
+private:
+    enum BotState
+    {
+        BS_CONNECTING,        //!< Waiting for the enet connection
+        BS_REQUESTING,        //!< Connection request sent
+        BS_LOBBY,             //!< Accepted, waiting in the lobby
+        BS_SELECTING,         //!< Kart and track selected
+        BS_LOADING,           //!< Waiting for the race to start
+        BS_RACING,            //!< Sending actions and receiving states
+        BS_FINISHED,          //!< Race result received
+        BS_DISCONNECTED       //!< Refused or disconnected by the server
+    };
+
+    /** Statistics collected by all bots. */
+    struct Statistics
+    {
+        /** Size of each received state in bytes. */
+        std::vector<uint32_t> m_state_sizes;
+        /** Time between two consecutive states received by a bot, in ms. */
+        std::vector<uint32_t> m_state_intervals;
+        /** For each late action of another client, how many ticks it
+         *  arrived after the tick of the action. */
+        std::vector<uint32_t> m_late_action_ticks;
+        /** Number of remote actions received, and how many of them arrived
+         *  after the tick a client would be at. */
+        uint64_t m_remote_actions;
+        uint64_t m_late_actions;
+        /** Number of actions sent by all bots. */
+        uint64_t m_actions_sent;
+        /** Sum of the time all bots spent racing in ms. */
+        uint64_t m_racing_time;
+        /** Sum and count of round trip time samples in ms. */
+        uint64_t m_rtt_sum;
+        uint64_t m_rtt_count;
+        /** Number of refused or lost connections. */
+        unsigned m_failures;
+    };   // Statistics
+
+    /** A single bot client. */
+    struct Bot
+    {
+        unsigned        m_index;
+        Network*        m_network;
+        ENetPeer*       m_server;
+        BotState        m_state;
+        uint32_t        m_host_id;
+        int             m_kart_id;
+        bool            m_owner;
+        bool            m_begin_requested;
+        /** Tick rates of the server. */
+        int             m_physics_fps;
+        int             m_input_frequency;
+        /** Offset of the network timer of the server to the local time. */
+        int64_t         m_timer_offset;
+        bool            m_timer_synced;
+        /** Network time of the server at which the race starts. */
+        uint64_t        m_start_time;
+        /** Local time in ms at which racing started and the last state
+         *  was received. */
+        uint64_t        m_racing_since;
+        uint64_t        m_last_state_time;
+        /** Ticks at which the next action is triggered. */
+        int             m_next_action_ticks;
+        int             m_last_actions_sent_ticks;
+        uint32_t        m_next_sequence;
+        std::mt19937    m_random;
+    };   // Bot
+
+    /** Address of the server. */
+    TransportAddress m_server_address;
+
+    std::vector<Bot> m_bots;
+
+    /** Number of races and maximum duration of a race in seconds. */
+    unsigned m_races;
+    unsigned m_race_duration;
+
+    /** Seed for the actions and selections of the bots. */
+    uint32_t m_seed;
+
+    /** Number of the current race. */
+    unsigned m_race;
+
+    Statistics m_statistics;
+
+    void connectBots();
+    void disconnectBots();
+    void updateBot(Bot& bot);
+    void handlePacket(Bot& bot, const ENetEvent& event);
+    void handleLobbyMessage(Bot& bot, NetworkString& data);
+    void handleGameMessage(Bot& bot, NetworkString& data, uint64_t now);
+    void sendConnectionRequest(Bot& bot);
+    void sendActions(Bot& bot, uint64_t now);
+    void sendToServer(Bot& bot, const BareNetworkString& data,
+                      bool reliable);
+    int getClientTicks(const Bot& bot, uint64_t now) const;
+    void printStatistics() const;
+
+public:
+    LoadGenerator(const TransportAddress& server, unsigned bots,
+                  unsigned races, unsigned race_duration, uint32_t seed);
+    // ------------------------------------------------------------------------
+    ~LoadGenerator();
+    // ------------------------------------------------------------------------
+    void run();
+
+};   // class LoadGenerator
+
+#endif
@@ -18,9 +18,12 @@
 
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
+#include "network/protocol_manager.hpp"
+#include "network/rewind_manager.hpp"
 #include "network/server_config.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
+#include "network/protocols/game_protocol.hpp"
 #include "network/protocols/server_lobby.hpp"
 #include "utils/time.hpp"
 #include "utils/vs.hpp"
@@ -42,6 +45,12 @@ void showHelp()
     std::cout << "kickban #, kick and ban # peer of STKHost." << std::endl;
     std::cout << "listpeers, List all peers with host ID and IP." << std::endl;
     std::cout << "listban, List IP ban list of server." << std::endl;
+    std::cout << "statebytes, Show game state bytes sent in current game."
+        << std::endl;
+    std::cout << "eventqueues, Show network events received and how often "
+        "the event queues were full." << std::endl;
+    std::cout << "rewindstats, Show rewind statistics of current game "
+        "(client only)." << std::endl;
 }   // showHelp
 
 // ----------------------------------------------------------------------------
@@ -128,6 +137,39 @@ void mainLoop(STKHost* host)
                     ban.second << std::endl;
             }
         }
+        else if (str == "statebytes" && NetworkConfig::get()->isServer())
+        {
+            auto gp = GameProtocol::lock();
+            if (!gp)
+            {
+                std::cout << "No game running" << std::endl;
+                continue;
+            }
+            const uint64_t full = gp->getFullStateBytes();
+            const uint64_t sent = gp->getSentStateBytes();
+            std::cout << "Full state bytes: " << full << ", sent: " << sent
+                << ", saved: " << (full > sent ? full - sent : 0)
+                << std::endl;
+            std::cout << "Network buffers allocated: "
+                << BareNetworkString::getBufferAllocations() << ", reused: "
+                << BareNetworkString::getBufferReuses() << std::endl;
+        }
+        else if (str == "eventqueues")
+        {
+            auto pm = ProtocolManager::lock();
+            if (!pm)
+                continue;
+            std::cout << "Synchronous events: " << pm->getEventCount(true)
+                << ", queue full: " << pm->getEventOverflowCount(true)
+                << std::endl;
+            std::cout << "Asynchronous events: " << pm->getEventCount(false)
+                << ", queue full: " << pm->getEventOverflowCount(false)
+                << std::endl;
+        }
+        else if (str == "rewindstats" && NetworkConfig::get()->isClient())
+        {
+            std::cout << RewindManager::getStatistics() << std::endl;
+        }
         else
         {
             std::cout << "Unknown command: " << str << std::endl;
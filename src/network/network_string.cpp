@@ -23,6 +23,42 @@
 #include <iomanip>
 #include <ostream>
 
+std::atomic<uint64_t> BareNetworkString::m_buffer_allocations(0);
+std::atomic<uint64_t> BareNetworkString::m_buffer_reuses(0);
+
+namespace
+{
+    /** Maximum number of free buffers kept in the pool of each thread. */
+    const unsigned MAX_POOLED_BUFFERS = 1024;
+    /** Buffers with a larger capacity (e.g. from big lobby messages) are
+     *  freed instead of being kept in the pool. */
+    const size_t MAX_POOLED_CAPACITY = 16384;
+
+    /** Set when the pool of this thread is destroyed at thread exit, after
+     *  which network strings (e.g. in static objects) free their buffers
+     *  instead of using the pool. */
+    thread_local bool g_buffer_pool_destroyed = false;
+
+    /** The free buffers of one thread. */
+    struct BufferPool
+    {
+        std::vector<std::vector<uint8_t> > m_buffers;
+        ~BufferPool() { g_buffer_pool_destroyed = true; }
+    };
+
+    // ------------------------------------------------------------------------
+    /** Returns the pool of free buffers of the current thread, or NULL if it
+     *  was already destroyed. Each thread has its own pool, so taking and
+     *  returning a buffer does not need any locking. */
+    BufferPool* getBufferPool()
+    {
+        if (g_buffer_pool_destroyed)
+            return NULL;
+        thread_local BufferPool pool;
+        return &pool;
+    }   // getBufferPool
+}
+
 // ============================================================================
 /** Unit testing function.
  */
@@ -44,8 +80,110 @@ void NetworkString::unitTesting()
     std::string log = slog.getLogMessage();
     assert(log=="0x000 | 00 01 02 03 04 05 06 07  08 09 0a 0b 0c 0d 0e 0f   | ................\n"
                 "0x010 | 10 11 12 13 14 15 16 17  18 19 1a 1b               | ............\n");
+
+    // Check that buffers are reused: after a warm-up pass no new buffer
+    // should be allocated, and no buffer should grow while it is filled
+    for (int pass = 0; pass < 3; pass++)
+    {
+        const uint64_t allocations = getBufferAllocations();
+        for (int j = 0; j < 10; j++)
+        {
+            BareNetworkString* state = new BareNetworkString(64);
+            const size_t state_capacity = state->getBuffer().capacity();
+            for (int k = 0; k < 64; k++)
+                state->addUInt8(k);
+            assert(state->getBuffer().capacity() == state_capacity);
+            NetworkString copy(PROTOCOL_GAME_EVENTS, 64);
+            const size_t copy_capacity = copy.getBuffer().capacity();
+            copy += *state;
+            assert(copy.getBuffer().capacity() == copy_capacity);
+            delete state;
+            // The copy contains the protocol type as well
+            assert(copy.getTotalSize() == 64 + 1);
+        }
+        // The first pass is the warm-up which fills the pool
+        if (pass > 0)
+            assert(getBufferAllocations() == allocations);
+    }
+
+    // A reused buffer must not contain data of its previous user
+    {
+        BareNetworkString used(4);
+        used.addUInt32(0xdeadbeef);
+    }
+    BareNetworkString fresh(4);
+    assert(fresh.size() == 0);
+    fresh.addUInt8(7);
+    assert(fresh.getUInt8() == 7);
+
+    // Moving a string takes over its buffer without using the pool
+    {
+        BareNetworkString moved(4);
+        moved.addUInt32(42);
+        const uint64_t allocations = getBufferAllocations();
+        const uint64_t reuses = getBufferReuses();
+        BareNetworkString target(std::move(moved));
+        assert(target.getUInt32() == 42);
+        assert(moved.getTotalSize() == 0);
+        assert(getBufferAllocations() == allocations);
+        assert(getBufferReuses() == reuses);
+    }
+
+    // Variable length integers
+    BareNetworkString var;
+    var.addVarUInt(0).addVarUInt(127).addVarUInt(128).addVarUInt(300)
+       .addVarUInt(0xffffffff);
+    assert(var.size() == 1 + 1 + 2 + 2 + 5);
+    assert(var.getVarUInt() == 0);
+    assert(var.getVarUInt() == 127);
+    assert(var.getVarUInt() == 128);
+    assert(var.getVarUInt() == 300);
+    assert(var.getVarUInt() == 0xffffffff);
+    assert(var.size() == 0);
 }   // unitTesting
 
+// ----------------------------------------------------------------------------
+/** Takes a free buffer from the pool (or allocates a new one if the pool is
+ *  empty), and makes sure it can store the requested number of bytes.
+ *  Growing a pooled buffer which is too small counts as an allocation.
+ *  \param capacity Number of bytes to reserve.
+ */
+void BareNetworkString::takePooledBuffer(int capacity)
+{
+    BufferPool* pool = getBufferPool();
+    if (pool && !pool->m_buffers.empty())
+    {
+        std::swap(m_buffer, pool->m_buffers.back());
+        pool->m_buffers.pop_back();
+        // A pooled buffer which is too small has to be reallocated
+        if (m_buffer.capacity() < (size_t)capacity)
+            m_buffer_allocations.fetch_add(1, std::memory_order_relaxed);
+        else
+            m_buffer_reuses.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+        m_buffer_allocations.fetch_add(1, std::memory_order_relaxed);
+    m_buffer.reserve(capacity);
+}   // takePooledBuffer
+
+// ----------------------------------------------------------------------------
+/** Gives the buffer back to the pool of the current thread, so it can be
+ *  used by another network string without allocating memory. Buffers are
+ *  often freed by another thread than the one which allocated them, so each
+ *  pool is limited in size.
+ */
+void BareNetworkString::returnPooledBuffer()
+{
+    if (m_buffer.capacity() == 0 || m_buffer.capacity() > MAX_POOLED_CAPACITY)
+        return;
+    BufferPool* pool = getBufferPool();
+    if (!pool || pool->m_buffers.size() >= MAX_POOLED_BUFFERS)
+        return;
+    m_buffer.clear();
+    pool->m_buffers.push_back(std::vector<uint8_t>());
+    std::swap(pool->m_buffers.back(), m_buffer);
+}   // returnPooledBuffer
+
 // ============================================================================
 
 // ----------------------------------------------------------------------------
@@ -33,6 +33,7 @@
 #include "irrString.h"
 
 #include <assert.h>
+#include <atomic>
 #include <stdarg.h>
 #include <stdexcept>
 #include <string>
@@ -55,6 +56,16 @@ friend class Crypto;
 private:
     LEAK_CHECK();
 
+    /** Number of buffers which had to be allocated, i.e. could not be taken
+     *  from the buffer pool. */
+    static std::atomic<uint64_t> m_buffer_allocations;
+
+    /** Number of buffers which were reused from the buffer pool. */
+    static std::atomic<uint64_t> m_buffer_reuses;
+
+    void takePooledBuffer(int capacity);
+    void returnPooledBuffer();
+
 protected:
     /** The actual buffer. */
     std::vector<uint8_t> m_buffer;
@@ -123,13 +134,14 @@ public:
     /** Constructor, sets the protocol type of this message. */
     BareNetworkString(int capacity=16)
     {
-        m_buffer.reserve(capacity);
+        takePooledBuffer(capacity);
         m_current_offset = 0;
     }   // BareNetworkString
 
     // ------------------------------------------------------------------------
     BareNetworkString(const std::string &s)
     {
+        takePooledBuffer((int)s.size() + 1);
         m_current_offset = 0;
         encodeString(s);
     }   // BareNetworkString
@@ -137,10 +149,52 @@ public:
     /** Initialises the string with a sequence of characters. */
     BareNetworkString(const char *data, int len)
     {
+        takePooledBuffer(len);
         m_current_offset = 0;
         m_buffer.resize(len);
         memcpy(m_buffer.data(), data, len);
     }   // BareNetworkString
+    // ------------------------------------------------------------------------
+    BareNetworkString(const BareNetworkString& other)
+    {
+        takePooledBuffer((int)other.m_buffer.size());
+        m_buffer = other.m_buffer;
+        m_current_offset = other.m_current_offset;
+    }   // BareNetworkString
+    // ------------------------------------------------------------------------
+    /** Takes over the buffer of another string without copying it. */
+    BareNetworkString(BareNetworkString&& other)
+    {
+        std::swap(m_buffer, other.m_buffer);
+        m_current_offset = other.m_current_offset;
+        other.m_current_offset = 0;
+    }   // BareNetworkString
+    // ------------------------------------------------------------------------
+    BareNetworkString& operator=(const BareNetworkString& other)
+    {
+        m_buffer = other.m_buffer;
+        m_current_offset = other.m_current_offset;
+        return *this;
+    }   // operator=
+    // ------------------------------------------------------------------------
+    /** Swaps the buffers, so the buffer of this string is given back to the
+     *  pool when the other string is destroyed. */
+    BareNetworkString& operator=(BareNetworkString&& other)
+    {
+        std::swap(m_buffer, other.m_buffer);
+        std::swap(m_current_offset, other.m_current_offset);
+        return *this;
+    }   // operator=
+    // ------------------------------------------------------------------------
+    /** The buffer is given back to the pool, so that the next network string
+     *  can use it without any allocation. */
+    ~BareNetworkString()                             { returnPooledBuffer(); }
+    // ------------------------------------------------------------------------
+    /** Returns the number of buffers which had to be allocated. */
+    static uint64_t getBufferAllocations()   { return m_buffer_allocations; }
+    // ------------------------------------------------------------------------
+    /** Returns the number of buffers reused from the buffer pool. */
+    static uint64_t getBufferReuses()             { return m_buffer_reuses; }
 
     // ------------------------------------------------------------------------
     /** Allows to read a buffer from the beginning again. */
@@ -256,6 +310,21 @@ public:
         return *this;
     }   // addUInt32
 
+    // ------------------------------------------------------------------------
+    /** Adds an unsigned 32 bit integer using a variable number of bytes: 7
+     *  bits are stored per byte, and the highest bit is set if more bytes
+     *  follow. So values below 128 only need 1 byte. */
+    BareNetworkString& addVarUInt(uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_buffer.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back((uint8_t)value);
+        return *this;
+    }   // addVarUInt
+
     // ------------------------------------------------------------------------
     /** Adds unsigned 64 bit integer. */
     BareNetworkString& addUInt64(const uint64_t& value)
@@ -328,6 +397,20 @@ public:
     /** Returns a unsigned 32 bit integer. */
     inline uint32_t getUInt32() const { return get<uint32_t, 4>(); }
     // ------------------------------------------------------------------------
+    /** Returns an unsigned 32 bit integer added with addVarUInt. */
+    uint32_t getVarUInt() const
+    {
+        uint32_t value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7)
+        {
+            const uint8_t c = getUInt8();
+            value |= (uint32_t)(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+                break;
+        }
+        return value;
+    }   // getVarUInt
+    // ------------------------------------------------------------------------
     /** Returns a unsigned 32 bit integer. */
     inline uint32_t getTime() const { return get<uint32_t, 4>(); }
     // ------------------------------------------------------------------------
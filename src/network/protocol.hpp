@@ -26,6 +26,7 @@
 #include "utils/no_copy.hpp"
 #include "utils/types.hpp"
 
+#include <limits>
 #include <memory>
 #include <stddef.h>
 
@@ -122,6 +123,12 @@ public:
      *  Must be re-defined. */
     virtual void asynchronousUpdate() = 0;
 
+    /** \brief Returns the time in ms after which asynchronousUpdate() must
+     *  be called again, even if no event or request arrived in the
+     *  meantime. Protocols which only react to events can return
+     *  std::numeric_limits<unsigned>::max(). */
+    virtual unsigned getAsynchronousUpdateDelay()          { return 2; }
+
     /// functions to check incoming data easily
     NetworkString* getNetworkString(size_t capacity = 16);
     bool checkDataSize(Event* event, unsigned int minimum_size);
@@ -28,13 +28,15 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <cstdlib>
 #include <errno.h>
 #include <functional>
+#include <limits>
 #include <typeinfo>
 
 // ============================================================================
-std::weak_ptr<ProtocolManager> ProtocolManager::m_protocol_manager;
+PerRoom<std::weak_ptr<ProtocolManager> > ProtocolManager::m_protocol_manager;
 // ============================================================================
 std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
 {
@@ -45,18 +47,20 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
         return NULL;
     }
     auto pm = std::make_shared<ProtocolManager>();
-    pm->m_asynchronous_update_thread = std::thread([pm]()
+    const unsigned room = ServerRoom::getCurrent();
+    pm->m_asynchronous_update_thread = std::thread([pm, room]()
         {
             VS::setThreadName("ProtocolManager");
+            ServerRoom::setCurrent(room);
             while(!pm->m_exit.load())
             {
                 pm->asynchronousUpdate();
                 PROFILER_PUSH_CPU_MARKER("sleep", 0, 255, 255);
-                StkTime::sleep(2);
+                pm->waitForAsynchronousUpdate();
                 PROFILER_POP_CPU_MARKER();
             }
         });
-    m_protocol_manager = pm;
+    m_protocol_manager.get() = pm;
     return pm;
 }   // createInstance
 
@@ -64,6 +68,10 @@ std::shared_ptr<ProtocolManager> ProtocolManager::createInstance()
 ProtocolManager::ProtocolManager()
 {
     m_exit.store(false);
+    m_async_wakeup.store(false);
+    m_async_sleeping.store(false);
+    m_max_event_queue_depth[0].store(0);
+    m_max_event_queue_depth[1].store(0);
     m_all_protocols.resize(PROTOCOL_MAX);
 }   // ProtocolManager
 
@@ -76,19 +84,15 @@ ProtocolManager::~ProtocolManager()
         m_all_protocols[i].abort();
     }
 
-    m_sync_events_to_process.lock();
-    for (EventList::iterator i =m_sync_events_to_process.getData().begin();
-                             i!=m_sync_events_to_process.getData().end(); ++i)
-        delete *i;
-    m_sync_events_to_process.getData().clear();
-    m_sync_events_to_process.unlock();
+    m_sync_events_to_process.popAll(&m_sync_events);
+    for (Event* event : m_sync_events)
+        delete event;
+    m_sync_events.clear();
 
-    m_async_events_to_process.lock();
-    for (EventList::iterator i = m_async_events_to_process.getData().begin();
-                             i!= m_async_events_to_process.getData().end(); ++i)
-        delete *i;
-    m_async_events_to_process.getData().clear();
-    m_async_events_to_process.unlock();
+    m_async_events_to_process.popAll(&m_async_events);
+    for (Event* event : m_async_events)
+        delete event;
+    m_async_events.clear();
 
     m_requests.lock();
     m_requests.getData().clear();
@@ -108,6 +112,7 @@ void ProtocolManager::OneProtocolType::abort()
 void ProtocolManager::abort()
 {
     m_exit.store(true);
+    wakeUpAsynchronousUpdate();
     // wait the thread to finish
     m_asynchronous_update_thread.join();
 }   // abort
@@ -115,24 +120,69 @@ void ProtocolManager::abort()
 // ----------------------------------------------------------------------------
 /** \brief Function that processes incoming events.
  *  This function is called by the network manager each time there is an
- *  incoming packet.
+ *  incoming packet. It must only be called from one thread at a time (the
+ *  network listening thread), since the event queues are single-producer
+ *  queues.
  */
 void ProtocolManager::propagateEvent(Event* event)
 {
     if (event->isSynchronous())
+        m_sync_events_to_process.push(event);
+    else
+    {
+        m_async_events_to_process.push(event);
+        wakeUpAsynchronousUpdate();
+    }
+}   // propagateEvent
+
+// ----------------------------------------------------------------------------
+/** Wakes up the ProtocolManager thread if it is waiting, so that the
+ *  asynchronous update is done now. Called when an asynchronous event or a
+ *  request arrives, and can be used by protocols when another thread
+ *  changed something their asynchronous update has to react to.
+ */
+void ProtocolManager::wakeUpAsynchronousUpdate()
+{
+    // Either the thread sees m_async_wakeup before it waits, or it set
+    // m_async_sleeping before we test it (both are sequentially consistent)
+    m_async_wakeup.store(true);
+    if (!m_async_sleeping.load())
+        return;
+    // Taking the lock makes sure that the thread is in wait() already
+    std::unique_lock<std::mutex> lock(m_async_wakeup_mutex);
+    lock.unlock();
+    m_async_wakeup_cv.notify_one();
+}   // wakeUpAsynchronousUpdate
+
+// ----------------------------------------------------------------------------
+/** Called from the ProtocolManager thread after each asynchronous update.
+ *  Waits until an asynchronous event or a request arrives, or until the
+ *  next running protocol needs to be updated.
+ */
+void ProtocolManager::waitForAsynchronousUpdate()
+{
+    // Events which could not be delivered yet are retried at the old
+    // polling rate
+    unsigned delay = m_async_events.empty() ?
+        std::numeric_limits<unsigned>::max() : 2;
+    for (OneProtocolType& opt : m_all_protocols)
+        delay = std::min(delay, opt.getAsynchronousUpdateDelay());
+
+    std::unique_lock<std::mutex> lock(m_async_wakeup_mutex);
+    m_async_sleeping.store(true);
+    if (delay == std::numeric_limits<unsigned>::max())
     {
-        m_sync_events_to_process.lock();
-        m_sync_events_to_process.getData().push_back(event);
-        m_sync_events_to_process.unlock();
+        m_async_wakeup_cv.wait(lock,
+            [this]() { return m_async_wakeup.load(); });
     }
     else
     {
-        m_async_events_to_process.lock();
-        m_async_events_to_process.getData().push_back(event);
-        m_async_events_to_process.unlock();
+        m_async_wakeup_cv.wait_for(lock, std::chrono::milliseconds(delay),
+            [this]() { return m_async_wakeup.load(); });
     }
-    return;
-}   // propagateEvent
+    m_async_sleeping.store(false);
+    m_async_wakeup.store(false);
+}   // waitForAsynchronousUpdate
 
 // ----------------------------------------------------------------------------
 /** \brief Asks the manager to start a protocol.
@@ -149,6 +199,7 @@ void ProtocolManager::requestStart(std::shared_ptr<Protocol> protocol)
     m_requests.lock();
     m_requests.getData().push_back(req);
     m_requests.unlock();
+    wakeUpAsynchronousUpdate();
 }   // requestStart
 
 // ----------------------------------------------------------------------------
@@ -167,6 +218,7 @@ void ProtocolManager::requestPause(std::shared_ptr<Protocol> protocol)
     m_requests.lock();
     m_requests.getData().push_back(req);
     m_requests.unlock();
+    wakeUpAsynchronousUpdate();
 }   // requestPause
 
 // ----------------------------------------------------------------------------
@@ -185,6 +237,7 @@ void ProtocolManager::requestUnpause(std::shared_ptr<Protocol> protocol)
     m_requests.lock();
     m_requests.getData().push_back(req);
     m_requests.unlock();
+    wakeUpAsynchronousUpdate();
 }   // requestUnpause
 
 // ----------------------------------------------------------------------------
@@ -212,6 +265,7 @@ void ProtocolManager::requestTerminate(std::shared_ptr<Protocol> protocol)
     }
     m_requests.getData().push_back(req);
     m_requests.unlock();
+    wakeUpAsynchronousUpdate();
 }   // requestTerminate
 
 // ----------------------------------------------------------------------------
@@ -412,6 +466,23 @@ void ProtocolManager::OneProtocolType::update(int ticks, bool async)
     }
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Returns the time in ms until the running protocols of this type need an
+ *  asynchronous update. Only called from the ProtocolManager thread, which
+ *  is the only thread that changes the protocols, so no lock is needed.
+ */
+unsigned ProtocolManager::OneProtocolType::getAsynchronousUpdateDelay()
+{
+    unsigned delay = std::numeric_limits<unsigned>::max();
+    for (unsigned int i = 0; i < m_protocols.getData().size(); i++)
+    {
+        Protocol* p = m_protocols.getData()[i].get();
+        if (p->getState() == PROTOCOL_STATE_RUNNING)
+            delay = std::min(delay, p->getAsynchronousUpdateDelay());
+    }
+    return delay;
+}   // getAsynchronousUpdateDelay
+
 // ----------------------------------------------------------------------------
 /** \brief Updates the manager.
  *
@@ -428,37 +499,33 @@ void ProtocolManager::update(int ticks)
     assert(std::this_thread::get_id() != m_asynchronous_update_thread.get_id());
 
     // before updating, notify protocols that they have received events
-    m_sync_events_to_process.lock();
-    EventList::iterator i = m_sync_events_to_process.getData().begin();
-
-    while (i != m_sync_events_to_process.getData().end())
+    m_sync_events_to_process.popAll(&m_sync_events);
+    updateMaxEventQueueDepth(0, (uint32_t)m_sync_events.size());
+    unsigned kept = 0;
+    for (unsigned n = 0; n < m_sync_events.size(); n++)
     {
-        m_sync_events_to_process.unlock();
+        Event* event = m_sync_events[n];
         bool can_be_deleted = true;
         try
         {
-            can_be_deleted = sendEvent(*i);
+            can_be_deleted = sendEvent(event);
         }
         catch (std::exception& e)
         {
-            const std::string& name = (*i)->getPeer()->getAddress().toString();
+            const std::string& name = event->getPeer()->getAddress().toString();
             Log::error("ProtocolManager",
                 "Synchronous event error from %s: %s", name.c_str(), e.what());
-            Log::error("ProtocolManager", (*i)->data().getLogMessage().c_str());
+            Log::error("ProtocolManager", event->data().getLogMessage().c_str());
         }
-        m_sync_events_to_process.lock();
         if (can_be_deleted)
-        {
-            delete *i;
-            i = m_sync_events_to_process.getData().erase(i);
-        }
+            delete event;
         else
         {
             // This should only happen if the protocol has not been started
-            ++i;
+            m_sync_events[kept++] = event;
         }
     }
-    m_sync_events_to_process.unlock();
+    m_sync_events.resize(kept);
 
     // Now update all protocols.
     for (unsigned int i = 0; i < m_all_protocols.size(); i++)
@@ -484,42 +551,38 @@ void ProtocolManager::asynchronousUpdate()
     PROFILER_PUSH_CPU_MARKER("Message delivery", 255, 0, 0);
     // First deliver asynchronous messages for all protocols
     // =====================================================
-    m_async_events_to_process.lock();
-    EventList::iterator i = m_async_events_to_process.getData().begin();
-    while (i != m_async_events_to_process.getData().end())
+    m_async_events_to_process.popAll(&m_async_events);
+    updateMaxEventQueueDepth(1, (uint32_t)m_async_events.size());
+    unsigned kept = 0;
+    for (unsigned n = 0; n < m_async_events.size(); n++)
     {
-        m_async_events_to_process.unlock();
-
-        m_all_protocols[(*i)->getType()].lock();
+        Event* event = m_async_events[n];
+        m_all_protocols[event->getType()].lock();
         bool result = true;
         try
         {
-            result = sendEvent(*i);
+            result = sendEvent(event);
         }
         catch (std::exception& e)
         {
-            const std::string& name = (*i)->getPeer()->getAddress().toString();
+            const std::string& name = event->getPeer()->getAddress().toString();
             Log::error("ProtocolManager", "Asynchronous event "
                 "error from %s: %s", name.c_str(), e.what());
             Log::error("ProtocolManager",
-                (*i)->data().getLogMessage().c_str());
+                event->data().getLogMessage().c_str());
         }
-        m_all_protocols[(*i)->getType()].unlock();
+        m_all_protocols[event->getType()].unlock();
 
-        m_async_events_to_process.lock();
         if (result)
-        {
-            delete *i;
-            i = m_async_events_to_process.getData().erase(i);
-        }
+            delete event;
         else
         {
             // This should only happen if the protocol has not been started
             // or already terminated (e.g. late ping answer)
-            ++i;
+            m_async_events[kept++] = event;
         }
-    }   // while i != m_events_to_process.end()
-    m_async_events_to_process.unlock();
+    }   // for n < m_async_events.size()
+    m_async_events.resize(kept);
 
     PROFILER_POP_CPU_MARKER();
     PROFILER_PUSH_CPU_MARKER("Message delivery", 255, 0, 0);
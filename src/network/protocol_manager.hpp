@@ -26,13 +26,16 @@
 #include "network/network_string.hpp"
 #include "network/protocol.hpp"
 #include "utils/no_copy.hpp"
+#include "utils/server_room.hpp"
 #include "utils/singleton.hpp"
+#include "utils/spsc_queue.hpp"
 #include "utils/synchronised.hpp"
 #include "utils/types.hpp"
 
 #include <atomic>
-#include <list>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <thread>
 
@@ -96,7 +99,10 @@ public:
  *     A separate threads runs that delivers asynchronous events 
  *     (i.e. messages), updates each protocol, and handles new requests
  *     (start/stop protocol etc). Protocols are updated using the
- *     Protocol::asynchronousUpdate() function.
+ *     Protocol::asynchronousUpdate() function. The thread sleeps until an
+ *     asynchronous event or a request arrives, or until the time returned
+ *     by Protocol::getAsynchronousUpdateDelay() of a running protocol has
+ *     passed, so it uses no cpu while nothing happens.
  
  *  2) Synchronous updates:
  *     This is called from the main game thread, and will deliver synchronous
@@ -150,6 +156,7 @@ private:
         void requestTerminateAll();
         bool notifyEvent(Event *event);
         void update(int ticks, bool async);
+        unsigned getAsynchronousUpdateDelay();
         void abort();
         // --------------------------------------------------------------------
         /** Returns the first protocol of a given type. It is assumed that
@@ -199,19 +206,51 @@ private:
     std::vector<OneProtocolType> m_all_protocols;
 
     /** A list of network events - messages, disconnect and disconnects. */
-    typedef std::list<Event*> EventList;
+    typedef std::vector<Event*> EventList;
 
     /** Contains the network events to pass synchronously to protocols
-     *  (i.e. from the main thread). */
-    Synchronised<EventList> m_sync_events_to_process;
+     *  (i.e. from the main thread). The network listening thread is the
+     *  only producer, the main thread the only consumer. */
+    SPSCQueue<Event*> m_sync_events_to_process;
 
     /** Contains the network events to pass asynchronously to protocols
     *  (i.e. from the separate ProtocolManager thread). */
-    Synchronised<EventList> m_async_events_to_process;
+    SPSCQueue<Event*> m_async_events_to_process;
+
+    /** Synchronous events taken from m_sync_events_to_process which could
+     *  not be delivered yet. Only accessed from the main thread. */
+    EventList m_sync_events;
+
+    /** Asynchronous events taken from m_async_events_to_process which could
+     *  not be delivered yet. Only accessed from the ProtocolManager thread.
+     */
+    EventList m_async_events;
+
+    /** Largest number of events waiting to be delivered synchronously
+     *  (index 0) or asynchronously (index 1) in one update since the last
+     *  call to getAndResetMaxEventQueueDepth. Each is written by the thread
+     *  consuming the corresponding events only. */
+    std::atomic<uint32_t> m_max_event_queue_depth[2];
 
     /** Contains the requests to start/pause etc... protocols. */
     Synchronised< std::vector<ProtocolRequest> > m_requests;
 
+    /** The ProtocolManager thread waits on this condition variable until
+     *  an asynchronous event or a request arrives, or a protocol needs to
+     *  be updated. */
+    std::condition_variable m_async_wakeup_cv;
+
+    /** Used with m_async_wakeup_cv. */
+    std::mutex m_async_wakeup_mutex;
+
+    /** Set if the ProtocolManager thread should not wait before the next
+     *  asynchronous update. */
+    std::atomic_bool m_async_wakeup;
+
+    /** Set while the ProtocolManager thread waits, so that the mutex only
+     *  needs to be locked to wake it up if it is actually waiting. */
+    std::atomic_bool m_async_sleeping;
+
     /** When set to true, the main thread will exit. */
     std::atomic_bool m_exit;
 
@@ -219,13 +258,21 @@ private:
     std::thread m_asynchronous_update_thread;
 
     /*! Single instance of protocol manager.*/
-    static std::weak_ptr<ProtocolManager> m_protocol_manager;
+    static PerRoom<std::weak_ptr<ProtocolManager> > m_protocol_manager;
 
     bool         sendEvent(Event* event);
+    // ------------------------------------------------------------------------
+    void updateMaxEventQueueDepth(int index, uint32_t depth)
+    {
+        if (depth > m_max_event_queue_depth[index].load())
+            m_max_event_queue_depth[index].store(depth);
+    }   // updateMaxEventQueueDepth
+    // ------------------------------------------------------------------------
 
     virtual void startProtocol(std::shared_ptr<Protocol> protocol);
     virtual void terminateProtocol(std::shared_ptr<Protocol> protocol);
     virtual void asynchronousUpdate();
+    void         waitForAsynchronousUpdate();
     virtual void pauseProtocol(std::shared_ptr<Protocol> protocol);
     virtual void unpauseProtocol(std::shared_ptr<Protocol> protocol);
 
@@ -243,9 +290,35 @@ public:
     void      requestTerminate(std::shared_ptr<Protocol> protocol);
     void      findAndTerminate(ProtocolType type);
     void      update(int ticks);
+    void      wakeUpAsynchronousUpdate();
     // ------------------------------------------------------------------------
     bool isExiting() const                            { return m_exit.load(); }
     // ------------------------------------------------------------------------
+    /** Returns the number of events received for synchronous (if sync is
+     *  true) or asynchronous processing. */
+    uint64_t getEventCount(bool sync) const
+    {
+        return sync ? m_sync_events_to_process.getPushCount() :
+                      m_async_events_to_process.getPushCount();
+    }   // getEventCount
+    // ------------------------------------------------------------------------
+    /** Returns how often the network thread found the synchronous (if sync
+     *  is true) or asynchronous event queue full, i.e. had to fall back to
+     *  a locked list. */
+    uint64_t getEventOverflowCount(bool sync) const
+    {
+        return sync ? m_sync_events_to_process.getOverflowCount() :
+                      m_async_events_to_process.getOverflowCount();
+    }   // getEventOverflowCount
+    // ------------------------------------------------------------------------
+    /** Returns the largest number of events waiting to be delivered
+     *  synchronously (if sync is true) or asynchronously at once since the
+     *  last call, and resets it. */
+    uint32_t getAndResetMaxEventQueueDepth(bool sync)
+    {
+        return m_max_event_queue_depth[sync ? 0 : 1].exchange(0);
+    }   // getAndResetMaxEventQueueDepth
+    // ------------------------------------------------------------------------
     const std::thread& getThread() const
     {
         return m_asynchronous_update_thread; 
@@ -255,12 +328,12 @@ public:
     // ------------------------------------------------------------------------
     static bool emptyInstance()
     {
-        return m_protocol_manager.expired();
+        return m_protocol_manager.get().expired();
     }   // emptyInstance
     // ------------------------------------------------------------------------
     static std::shared_ptr<ProtocolManager> lock()
     {
-        return m_protocol_manager.lock();
+        return m_protocol_manager.get().lock();
     }   // lock
 
 };   // class ProtocolManager
@@ -19,6 +19,7 @@
 #include "network/protocols/client_lobby.hpp"
 
 #include "audio/sfx_manager.hpp"
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "config/player_manager.hpp"
 #include "guiengine/modaldialog.hpp"
@@ -93,6 +94,7 @@ ClientLobby::ClientLobby(const TransportAddress& a, std::shared_ptr<Server> s)
 //-----------------------------------------------------------------------------
 ClientLobby::~ClientLobby()
 {
+    stk_config->resetTickRates();
     if (m_server->supportsEncryption())
     {
         Online::XMLRequest* request =
@@ -242,19 +244,7 @@ void ClientLobby::addAllPlayers(Event* event)
 
     for (unsigned i = 0; i < player_count; i++)
     {
-        core::stringw player_name;
-        data.decodeStringW(&player_name);
-        uint32_t host_id = data.getUInt32();
-        float kart_color = data.getFloat();
-        uint32_t online_id = data.getUInt32();
-        PerPlayerDifficulty ppd = (PerPlayerDifficulty)data.getUInt8();
-        uint8_t local_id = data.getUInt8();
-        KartTeam team = (KartTeam)data.getUInt8();
-        auto player = std::make_shared<NetworkPlayerProfile>(peer, player_name,
-            host_id, kart_color, online_id, ppd, local_id, team);
-        std::string kart_name;
-        data.decodeString(&kart_name);
-        player->setKartName(kart_name);
+        auto player = decodePlayer(data, peer);
         peer->addPlayer(player);
         m_game_setup->addPlayer(player);
         players.push_back(player);
@@ -286,59 +276,24 @@ void ClientLobby::update(int ticks)
         break;
     case LINKED:
     {
-        NetworkString* ns = getNetworkString();
-        ns->addUInt8(LE_CONNECTION_REQUESTED)
-            .addUInt32(ServerConfig::m_server_version)
-            .encodeString(StringUtils::getUserAgentString());
-
-        auto all_k = kart_properties_manager->getAllAvailableKarts();
-        auto all_t = track_manager->getAllTrackIdentifiers();
-        if (all_k.size() >= 65536)
-            all_k.resize(65535);
-        if (all_t.size() >= 65536)
-            all_t.resize(65535);
-        ns->addUInt16((uint16_t)all_k.size()).addUInt16((uint16_t)all_t.size());
-        for (const std::string& kart : all_k)
-        {
-            ns->encodeString(kart);
-        }
-        for (const std::string& track : all_t)
-        {
-            ns->encodeString(track);
-        }
         assert(!NetworkConfig::get()->isAddingNetworkPlayers());
-        const uint8_t player_count =
-            (uint8_t)NetworkConfig::get()->getNetworkPlayers().size();
-        ns->addUInt8(player_count);
-
-        bool encryption = false;
-        uint32_t id = PlayerManager::getCurrentOnlineId();
-
-        BareNetworkString* rest = new BareNetworkString();
-        if (m_server->supportsEncryption() && id != 0)
-        {
-            ns->addUInt32(id);
-            encryption = true;
-        }
-        else
-        {
-            ns->addUInt32(id).addUInt32(0);
-            if (id != 0)
-                ns->encodeString(PlayerManager::getCurrentOnlineUserName());
-        }
-
-        rest->encodeString(ServerConfig::m_private_server_password)
-            .addUInt8(player_count);
+        std::vector<std::tuple<core::stringw, float, PerPlayerDifficulty> >
+            players;
         for (auto& p : NetworkConfig::get()->getNetworkPlayers())
         {
-            core::stringw name;
             PlayerProfile* player = std::get<1>(p);
-            rest->encodeString(player->getName()).
-                addFloat(player->getDefaultKartColor());
-            // Per-player handicap
-            rest->addUInt8(std::get<2>(p));
+            players.emplace_back(player->getName(),
+                player->getDefaultKartColor(), std::get<2>(p));
         }
 
+        uint32_t id = PlayerManager::getCurrentOnlineId();
+        const bool encryption = m_server->supportsEncryption() && id != 0;
+        NetworkString* ns = getNetworkString();
+        BareNetworkString* rest = new BareNetworkString();
+        encodeConnectionRequest(ns, rest, players, id,
+            id != 0 ? PlayerManager::getCurrentOnlineUserName() :
+            core::stringw(),
+            encryption);
         finalizeConnectionRequest(ns, rest, encryption);
         m_state.store(REQUESTING_CONNECTION);
     }
@@ -386,6 +341,132 @@ void ClientLobby::update(int ticks)
     }
 }   // update
 
+//-----------------------------------------------------------------------------
+/** Writes a connection request, the part sent in plain to \p header and the
+ *  part which is encrypted if \p encryption is set to \p rest, see
+ *  finalizeConnectionRequest.
+ *  \param players Name, kart color and handicap of each local player.
+ *  \param online_id Online id of the first player, 0 if not logged in.
+ *  \param online_name Online user name, only sent without encryption.
+ */
+void ClientLobby::encodeConnectionRequest(NetworkString* header,
+    BareNetworkString* rest,
+    const std::vector<std::tuple<core::stringw, float,
+    PerPlayerDifficulty> >& players, uint32_t online_id,
+    const core::stringw& online_name, bool encryption)
+{
+    header->addUInt8(LE_CONNECTION_REQUESTED)
+        .addUInt32(ServerConfig::m_server_version)
+        .encodeString(StringUtils::getUserAgentString());
+
+    auto all_k = kart_properties_manager->getAllAvailableKarts();
+    auto all_t = track_manager->getAllTrackIdentifiers();
+    if (all_k.size() >= 65536)
+        all_k.resize(65535);
+    if (all_t.size() >= 65536)
+        all_t.resize(65535);
+    header->addUInt16((uint16_t)all_k.size()).addUInt16((uint16_t)all_t.size());
+    for (const std::string& kart : all_k)
+    {
+        header->encodeString(kart);
+    }
+    for (const std::string& track : all_t)
+    {
+        header->encodeString(track);
+    }
+    const uint8_t player_count = (uint8_t)players.size();
+    header->addUInt8(player_count);
+
+    if (encryption)
+    {
+        header->addUInt32(online_id);
+    }
+    else
+    {
+        header->addUInt32(online_id).addUInt32(0);
+        if (online_id != 0)
+            header->encodeString(online_name);
+    }
+
+    rest->encodeString(ServerConfig::m_private_server_password)
+        .addUInt8(player_count);
+    for (auto& p : players)
+    {
+        rest->encodeString(std::get<0>(p)).addFloat(std::get<1>(p));
+        // Per-player handicap
+        rest->addUInt8(std::get<2>(p));
+    }
+}   // encodeConnectionRequest
+
+//-----------------------------------------------------------------------------
+/** Writes the kart selection of all local players. If the server receives an
+ *  invalid name, it will auto correct it to a random kart.
+ */
+void ClientLobby::encodeKartSelection(NetworkString* ns,
+                                      const std::vector<std::string>& karts)
+{
+    ns->addUInt8(LE_KART_SELECTION).addUInt8((uint8_t)karts.size());
+    for (const std::string& kart : karts)
+        ns->encodeString(kart);
+}   // encodeKartSelection
+
+//-----------------------------------------------------------------------------
+/** Writes a track vote. */
+void ClientLobby::encodeVote(NetworkString* ns, const std::string& track,
+                             uint8_t laps, bool reverse)
+{
+    ns->addUInt8(LE_VOTE).encodeString(track).addUInt8(laps)
+        .addUInt8(reverse ? 1 : 0);
+}   // encodeVote
+
+//-----------------------------------------------------------------------------
+/** Reads the karts and tracks available on the server from a start selection
+ *  message.
+ */
+void ClientLobby::decodeAvailableAssets(const NetworkString& data,
+                                        std::set<std::string>* karts,
+                                        std::set<std::string>* tracks)
+{
+    const unsigned kart_num = data.getUInt16();
+    const unsigned track_num = data.getUInt16();
+    karts->clear();
+    tracks->clear();
+    for (unsigned i = 0; i < kart_num; i++)
+    {
+        std::string kart;
+        data.decodeString(&kart);
+        karts->insert(kart);
+    }
+    for (unsigned i = 0; i < track_num; i++)
+    {
+        std::string track;
+        data.decodeString(&track);
+        tracks->insert(track);
+    }
+}   // decodeAvailableAssets
+
+//-----------------------------------------------------------------------------
+/** Reads a player (including the selected kart) of a load world message. */
+std::shared_ptr<NetworkPlayerProfile>
+    ClientLobby::decodePlayer(const NetworkString& data,
+                              std::shared_ptr<STKPeer> peer)
+{
+    core::stringw player_name;
+    data.decodeStringW(&player_name);
+    uint32_t host_id = data.getUInt32();
+    float kart_color = data.getFloat();
+    uint32_t online_id = data.getUInt32();
+    PerPlayerDifficulty ppd = (PerPlayerDifficulty)data.getUInt8();
+    uint8_t local_id = data.getUInt8();
+    KartTeam team = (KartTeam)data.getUInt8();
+    auto player = std::make_shared<NetworkPlayerProfile>(peer, player_name,
+        host_id, kart_color, online_id, ppd, local_id, team);
+    std::string kart_name;
+    data.decodeString(&kart_name);
+    player->setKartName(kart_name);
+    return player;
+}   // decodePlayer
+
 //-----------------------------------------------------------------------------
 void ClientLobby::finalizeConnectionRequest(NetworkString* header,
                                             BareNetworkString* rest,
@@ -530,8 +611,8 @@ void ClientLobby::disconnectedPlayer(Event* event)
  */
 void ClientLobby::connectionAccepted(Event* event)
 {
-    // At least 8 bytes should remain now
-    if (!checkDataSize(event, 8)) return;
+    // At least 18 bytes should remain now
+    if (!checkDataSize(event, 18)) return;
 
     NetworkString &data = event->data();
     // Accepted
@@ -559,6 +640,21 @@ void ClientLobby::connectionAccepted(Event* event)
     float auto_start_timer = data.getFloat();
     if (auto_start_timer != std::numeric_limits<float>::max())
         NetworkingLobby::getInstance()->setStartingTimerTo(auto_start_timer);
+
+    // Use the same physics, state and input rates as the server
+    const int physics_fps = data.getUInt16();
+    const int state_frequency = data.getUInt16();
+    const int input_frequency = data.getUInt16();
+    if (physics_fps < 30 || physics_fps > 250 || state_frequency <= 0 ||
+        state_frequency > physics_fps || input_frequency > physics_fps)
+    {
+        Log::error("ClientLobby", "Invalid tick rates %d %d %d from server.",
+            physics_fps, state_frequency, input_frequency);
+        STKHost::get()->disconnectAllPeers(false/*timeout_waiting*/);
+        STKHost::get()->requestShutdown();
+        return;
+    }
+    stk_config->setTickRates(physics_fps, state_frequency, input_frequency);
 }   // connectionAccepted
 
 //-----------------------------------------------------------------------------
@@ -854,22 +950,7 @@ void ClientLobby::startSelection(Event* event)
     const NetworkString& data = event->data();
     bool skip_kart_screen = data.getUInt8() == 1;
     m_server_auto_game_time = data.getUInt8() == 1;
-    const unsigned kart_num = data.getUInt16();
-    const unsigned track_num = data.getUInt16();
-    m_available_karts.clear();
-    m_available_tracks.clear();
-    for (unsigned i = 0; i < kart_num; i++)
-    {
-        std::string kart;
-        data.decodeString(&kart);
-        m_available_karts.insert(kart);
-    }
-    for (unsigned i = 0; i < track_num; i++)
-    {
-        std::string track;
-        data.decodeString(&track);
-        m_available_tracks.insert(track);
-    }
+    decodeAvailableAssets(data, &m_available_karts, &m_available_tracks);
 
     // In case the user opened a user info dialog
     GUIEngine::ModalDialog::dismiss();
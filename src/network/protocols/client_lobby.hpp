@@ -27,11 +27,18 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <tuple>
+#include <vector>
 
 enum PeerDisconnectInfo : unsigned int;
+enum PerPlayerDifficulty : uint8_t;
 
 class BareNetworkString;
+class NetworkPlayerProfile;
+class NetworkString;
 class Server;
+class STKPeer;
 
 class ClientLobby : public LobbyProtocol
 {
@@ -111,6 +118,8 @@ public:
     virtual void setup() OVERRIDE;
     virtual void update(int ticks) OVERRIDE;
     virtual void asynchronousUpdate() OVERRIDE {}
+    virtual unsigned getAsynchronousUpdateDelay() OVERRIDE
+                               { return std::numeric_limits<unsigned>::max(); }
     virtual bool allPlayersReady() const OVERRIDE
                                            { return m_state.load() >= RACING; }
     bool waitingForServerRespond() const
@@ -119,6 +128,25 @@ public:
     bool isWaitingForGame() const                { return m_waiting_for_game; }
     bool isServerAutoGameTime() const       { return m_server_auto_game_time; }
     virtual bool isRacing() const OVERRIDE { return m_state.load() == RACING; }
+    // ------------------------------------------------------------------------
+    static void encodeConnectionRequest(NetworkString* header,
+        BareNetworkString* rest,
+        const std::vector<std::tuple<irr::core::stringw, float,
+        PerPlayerDifficulty> >& players, uint32_t online_id,
+        const irr::core::stringw& online_name, bool encryption);
+    // ------------------------------------------------------------------------
+    static void encodeKartSelection(NetworkString* ns,
+                                    const std::vector<std::string>& karts);
+    // ------------------------------------------------------------------------
+    static void encodeVote(NetworkString* ns, const std::string& track,
+                           uint8_t laps, bool reverse);
+    // ------------------------------------------------------------------------
+    static void decodeAvailableAssets(const NetworkString& data,
+                                      std::set<std::string>* karts,
+                                      std::set<std::string>* tracks);
+    // ------------------------------------------------------------------------
+    static std::shared_ptr<NetworkPlayerProfile>
+        decodePlayer(const NetworkString& data, std::shared_ptr<STKPeer> peer);
 };
 
 #endif // CLIENT_LOBBY_HPP
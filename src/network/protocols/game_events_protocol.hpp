@@ -37,6 +37,9 @@ public:
     virtual void update(int ticks) OVERRIDE {};
     virtual void asynchronousUpdate() OVERRIDE{}
     // ------------------------------------------------------------------------
+    virtual unsigned getAsynchronousUpdateDelay() OVERRIDE
+                               { return std::numeric_limits<unsigned>::max(); }
+    // ------------------------------------------------------------------------
     virtual bool notifyEventAsynchronous(Event* event) OVERRIDE 
     {
         return false;
@@ -17,10 +17,12 @@
 
 #include "network/protocols/game_protocol.hpp"
 
+#include "config/stk_config.hpp"
 #include "items/item_manager.hpp"
 #include "items/network_item_manager.hpp"
 #include "karts/abstract_kart.hpp"
 #include "karts/controller/player_controller.hpp"
+#include "modes/linear_world.hpp"
 #include "modes/world.hpp"
 #include "network/event.hpp"
 #include "network/network_config.hpp"
@@ -30,14 +32,22 @@
 #include "network/protocol_manager.hpp"
 #include "network/rewind_info.hpp"
 #include "network/rewind_manager.hpp"
+#include "network/server_config.hpp"
+#include "network/server_metrics.hpp"
 #include "network/stk_host.hpp"
 #include "network/stk_peer.hpp"
+#include "race/race_manager.hpp"
+#include "tracks/arena_graph.hpp"
+#include "tracks/track.hpp"
 #include "utils/log.hpp"
+#include "utils/string_utils.hpp"
 #include "utils/time.hpp"
 #include "main_loop.hpp"
 
+#include <algorithm>
+
 // ============================================================================
-std::weak_ptr<GameProtocol> GameProtocol::m_game_protocol;
+PerRoom<std::weak_ptr<GameProtocol> > GameProtocol::m_game_protocol;
 // ============================================================================
 std::shared_ptr<GameProtocol> GameProtocol::createInstance()
 {
@@ -47,7 +57,7 @@ std::shared_ptr<GameProtocol> GameProtocol::createInstance()
         return NULL;
     }
     auto gm = std::make_shared<GameProtocol>();
-    m_game_protocol = gm;
+    m_game_protocol.get() = gm;
     return gm;
 }   // createInstance
 
@@ -57,57 +67,196 @@ GameProtocol::GameProtocol()
             : Protocol( PROTOCOL_CONTROLLER_EVENTS)
 {
     m_data_to_send = getNetworkString();
-
+    m_delta_state = NetworkConfig::get()->isServer() &&
+        ServerConfig::m_delta_state;
+    m_interest_distance = NetworkConfig::get()->isServer() ?
+        ServerConfig::m_state_interest_distance : -1.0f;
+    m_per_peer_state = m_delta_state || m_interest_distance > 0.0f;
+    m_state_count = 0;
+    m_reserved_names_size = 0;
+    m_current_state_ticks = 0;
+    m_next_action_sequence = 0;
+    m_last_actions_sent_ticks = -1;
+    m_full_state_bytes.store(0);
+    m_sent_state_bytes.store(0);
 }   // GameProtocol
 
 //-----------------------------------------------------------------------------
 GameProtocol::~GameProtocol()
 {
+    if (m_per_peer_state && m_full_state_bytes.load() > 0)
+    {
+        const uint64_t full = m_full_state_bytes.load();
+        const uint64_t sent = m_sent_state_bytes.load();
+        Log::info("GameProtocol", "Per client state sent %s of %s bytes, "
+            "saved %2.1f%%.", StringUtils::toString(sent).c_str(),
+            StringUtils::toString(full).c_str(),
+            100.0f * float(full - std::min(full, sent)) / float(full));
+    }
     delete m_data_to_send;
 }   // ~GameProtocol
 
 //-----------------------------------------------------------------------------
 /** Synchronous update - will send all commands collected during the last
- *  frame (and could optional only send messages every N frames).
+ *  frame (and could optional only send messages every N frames). If input
+ *  redundancy is enabled, the actions are sent unreliable, and each action
+ *  is sent again with the next input-redundancy messages, so a lost packet
+ *  does not need to be resent.
  */
 void GameProtocol::sendActions()
 {
-    if (m_all_actions.size() == 0) return;   // nothing to do
+    // nothing to do
+    if ((m_all_actions.empty() && m_resend_actions.empty()) ||
+        !World::getWorld())
+        return;
+
+    // Collect the actions of several frames if the server limits the number
+    // of action messages
+    const int input_frequency = stk_config->m_network_input_frequency;
+    const int ticks = World::getWorld()->getTicksSinceStart();
+    if (input_frequency > 0 && m_last_actions_sent_ticks >= 0 &&
+        ticks - m_last_actions_sent_ticks <
+        stk_config->getPhysicsFPS() / input_frequency)
+        return;
+    m_last_actions_sent_ticks = ticks;
 
-    // Clear left-over data from previous frame. This way the network
-    // string will increase till it reaches maximum size necessary
-    m_data_to_send->clear();
     if (m_all_actions.size() > 255)
     {
         Log::warn("GameProtocol",
             "Too many actions unsent %d.", (int)m_all_actions.size());
         m_all_actions.resize(255);
     }
-    m_data_to_send->addUInt8(GP_CONTROLLER_ACTION)
-                   .addUInt8(uint8_t(m_all_actions.size()));
+    const int redundancy = stk_config->m_network_input_redundancy;
+    for (Action& a : m_all_actions)
+    {
+        a.m_sequence = m_next_action_sequence++;
+        a.m_sends_left = redundancy;
+    }
+    // Drop the oldest actions to be sent again if there is not enough space
+    const size_t resend_count = std::min(m_resend_actions.size(),
+                                         255 - m_all_actions.size());
+    m_resend_actions.erase(m_resend_actions.begin(),
+        m_resend_actions.end() - resend_count);
 
-    // Add all actions
-    for (auto& a : m_all_actions)
+    // Only print new actions, not the ones which are sent again
+    if (Network::m_connection_debug)
     {
-        if (Network::m_connection_debug)
+        for (const Action& a : m_all_actions)
         {
             Log::verbose("GameProtocol",
                 "Controller action: %d %d %d %d %d %d",
                 a.m_ticks, a.m_kart_id, a.m_action, a.m_value, a.m_value_l,
                 a.m_value_r);
         }
-        m_data_to_send->addUInt32(a.m_ticks);
-        m_data_to_send->addUInt8(a.m_kart_id);
-        const auto& c = compressAction(a);
-        m_data_to_send->addUInt8(std::get<0>(c)).addUInt16(std::get<1>(c))
-            .addUInt16(std::get<2>(c)).addUInt16(std::get<3>(c));
-    }   // for a in m_all_actions
-
-    // FIXME: for now send reliable
-    sendToServer(m_data_to_send, /*reliable*/ true);
+    }
+    m_resend_actions.insert(m_resend_actions.end(), m_all_actions.begin(),
+        m_all_actions.end());
     m_all_actions.clear();
+
+    // Clear left-over data from previous frame. This way the network
+    // string will increase till it reaches maximum size necessary
+    m_data_to_send->clear();
+    m_data_to_send->addUInt8(GP_CONTROLLER_ACTION);
+    encodeActions(m_resend_actions, m_data_to_send);
+    sendToServer(m_data_to_send, /*reliable*/ redundancy == 0);
+
+    // Remove the actions which were sent often enough
+    for (Action& a : m_resend_actions)
+        a.m_sends_left--;
+    m_resend_actions.erase(std::remove_if(m_resend_actions.begin(),
+        m_resend_actions.end(), [](const Action& a)
+        {
+            return a.m_sends_left < 0;
+        }), m_resend_actions.end());
 }   // sendActions
 
+// ----------------------------------------------------------------------------
+/** Encodes a list of actions with consecutive sequence numbers: the number
+ *  of actions, the smallest ticks and the sequence number of the first
+ *  action, followed by each action using the tick difference to the
+ *  smallest ticks, kart id, action type, and the values (which are often 0
+ *  or the maximum value and only need 2 bits in this case).
+ *  \param actions The actions to encode (at most 255).
+ *  \param out The network string to add the actions to.
+ */
+void GameProtocol::encodeActions(const std::vector<Action>& actions,
+                                 BareNetworkString* out)
+{
+    assert(actions.size() <= 255);
+    int base_ticks = actions.empty() ? 0 : actions[0].m_ticks;
+    for (const Action& a : actions)
+        base_ticks = std::min(base_ticks, a.m_ticks);
+    out->addUInt8(uint8_t(actions.size())).addUInt32(base_ticks)
+        .addVarUInt(actions.empty() ? 0 : actions[0].m_sequence);
+
+    for (const Action& a : actions)
+    {
+        const auto& c = compressAction(a);
+        const uint16_t values[3] =
+            { std::get<1>(c), std::get<2>(c), std::get<3>(c) };
+        // 2 bits for each value: 0 = value is 0, 1 = value is 32768,
+        // 2 = value follows as 16 bit number
+        uint8_t flags = 0;
+        for (unsigned i = 0; i < 3; i++)
+        {
+            if (values[i] == 32768)
+                flags |= 1 << (i * 2);
+            else if (values[i] != 0)
+                flags |= 2 << (i * 2);
+        }
+        out->addVarUInt(a.m_ticks - base_ticks).addUInt8(a.m_kart_id)
+            .addUInt8(std::get<0>(c)).addUInt8(flags);
+        for (unsigned i = 0; i < 3; i++)
+        {
+            if (((flags >> (i * 2)) & 3) == 2)
+                out->addUInt16(values[i]);
+        }
+    }
+}   // encodeActions
+
+// ----------------------------------------------------------------------------
+/** Decodes actions encoded by encodeActions.
+ *  \param in The network string to read from.
+ *  \param actions On return contains the decoded actions.
+ *  \return False if the data is invalid.
+ */
+bool GameProtocol::decodeActions(const BareNetworkString& in,
+                                 std::vector<Action>* actions)
+{
+    actions->clear();
+    const unsigned count = in.getUInt8();
+    const int base_ticks = in.getUInt32();
+    const uint32_t first_sequence = in.getVarUInt();
+    for (unsigned i = 0; i < count; i++)
+    {
+        Action a;
+        a.m_ticks = base_ticks + (int)in.getVarUInt();
+        a.m_kart_id = in.getUInt8();
+        const uint8_t w = in.getUInt8();
+        const uint8_t flags = in.getUInt8();
+        uint16_t values[3];
+        for (unsigned j = 0; j < 3; j++)
+        {
+            switch ((flags >> (j * 2)) & 3)
+            {
+            case 0:  values[j] = 0;               break;
+            case 1:  values[j] = 32768;           break;
+            case 2:  values[j] = in.getUInt16();  break;
+            default: return false;
+            }
+        }
+        const auto& d = decompressAction(w, values[0], values[1], values[2]);
+        a.m_action     = std::get<0>(d);
+        a.m_value      = std::get<1>(d);
+        a.m_value_l    = std::get<2>(d);
+        a.m_value_r    = std::get<3>(d);
+        a.m_sequence   = first_sequence + i;
+        a.m_sends_left = 0;
+        actions->push_back(a);
+    }
+    return true;
+}   // decodeActions
+
 //-----------------------------------------------------------------------------
 /** Called when a message from a remote GameProtocol is received.
  */
@@ -122,6 +271,8 @@ bool GameProtocol::notifyEventAsynchronous(Event* event)
     case GP_CONTROLLER_ACTION: handleControllerAction(event); break;
     case GP_STATE:             handleState(event);            break;
     case GP_ADJUST_TIME:       handleAdjustTime(event);       break;
+    case GP_DELTA_STATE:       handleDeltaState(event);       break;
+    case GP_STATE_ACK:         handleStateAck(event);         break;
     //case GP_ITEM_UPDATE:       handleItemUpdate(event);       break;
     case GP_ITEM_CONFIRMATION: handleItemEventConfirmation(event); break;
     default: Log::error("GameProtocol",
@@ -174,48 +325,94 @@ void GameProtocol::controllerAction(int kart_id, PlayerAction action,
 void GameProtocol::handleControllerAction(Event *event)
 {
     NetworkString &data = event->data();
-    uint8_t count = data.getUInt8();
+    std::vector<Action> actions;
+    if (!decodeActions(data, &actions))
+    {
+        Log::warn("GameProtocol", "Received invalid controller data.");
+        return;
+    }
+
+    // Actions are sent more than once (if input redundancy is used by the
+    // client), so the server ignores the actions it received before. The
+    // server forwards only new actions, so this is not needed on a client.
+    if (NetworkConfig::get()->isServer() && !actions.empty())
+    {
+        std::weak_ptr<STKPeer> peer = event->getPeerSP();
+        auto it = m_expected_action_sequence.find(peer);
+        if (it == m_expected_action_sequence.end())
+        {
+            // Remove disconnected peers before adding a new one
+            for (auto i = m_expected_action_sequence.begin();
+                 i != m_expected_action_sequence.end();)
+            {
+                if (i->first.expired())
+                    i = m_expected_action_sequence.erase(i);
+                else
+                    i++;
+            }
+            it = m_expected_action_sequence.insert(
+                std::make_pair(peer, actions[0].m_sequence)).first;
+        }
+        const uint32_t expected = it->second;
+        if (actions[0].m_sequence > expected)
+        {
+            Log::warn("GameProtocol", "%d actions from %s were lost.",
+                actions[0].m_sequence - expected,
+                event->getPeer()->getAddress().toString().c_str());
+        }
+        actions.erase(actions.begin(), std::find_if(actions.begin(),
+            actions.end(), [expected](const Action& a)
+            {
+                return a.m_sequence >= expected;
+            }));
+        if (actions.empty())
+            return;
+        // Only accept the sequence numbers of a valid message, otherwise
+        // the following valid actions would be ignored
+        for (const Action& a : actions)
+        {
+            if (!event->getPeer()->availableKartID(a.m_kart_id))
+            {
+                Log::warn("GameProtocol", "Wrong kart id %d from %s.",
+                    a.m_kart_id,
+                    event->getPeer()->getAddress().toString().c_str());
+                return;
+            }
+        }
+        it->second = actions.back().m_sequence + 1;
+    }
+
     bool will_trigger_rewind = false;
     //int rewind_delta = 0;
-    int cur_ticks = 0;
     const int not_rewound = RewindManager::get()->getNotRewoundWorldTicks();
-    for (unsigned int i = 0; i < count; i++)
+    for (const Action& a : actions)
     {
-        cur_ticks = data.getUInt32();
         // Since this is running in a thread, it might be called during
         // a rewind, i.e. with an incorrect world time. So the event
         // time needs to be compared with the World time independent
         // of any rewinding.
-        if (cur_ticks < not_rewound && !will_trigger_rewind)
+        if (a.m_ticks < not_rewound && !will_trigger_rewind)
         {
             will_trigger_rewind = true;
-            //rewind_delta = not_rewound - cur_ticks;
-        }
-        uint8_t kart_id = data.getUInt8();
-        if (NetworkConfig::get()->isServer() &&
-            !event->getPeer()->availableKartID(kart_id))
-        {
-            Log::warn("GameProtocol", "Wrong kart id %d from %s.",
-                kart_id, event->getPeer()->getAddress().toString().c_str());
-            return;
+            //rewind_delta = not_rewound - a.m_ticks;
         }
+    }
 
-        uint8_t w = data.getUInt8();
-        uint16_t x = data.getUInt16();
-        uint16_t y = data.getUInt16();
-        uint16_t z = data.getUInt16();
+    for (const Action& a : actions)
+    {
         if (Network::m_connection_debug)
         {
-            const auto& a = decompressAction(w, x, y, z);
             Log::verbose("GameProtocol",
                 "Controller action: %d %d %d %d %d %d",
-                cur_ticks, kart_id, std::get<0>(a), std::get<1>(a),
-                std::get<2>(a), std::get<3>(a));
+                a.m_ticks, a.m_kart_id, a.m_action, a.m_value, a.m_value_l,
+                a.m_value_r);
         }
-        BareNetworkString *s = new BareNetworkString(3);
-        s->addUInt8(kart_id).addUInt8(w).addUInt16(x).addUInt16(y)
-            .addUInt16(z);
-        RewindManager::get()->addNetworkEvent(this, s, cur_ticks);
+        const auto& c = compressAction(a);
+        BareNetworkString *s = new BareNetworkString(8);
+        s->addUInt8(a.m_kart_id).addUInt8(std::get<0>(c))
+            .addUInt16(std::get<1>(c)).addUInt16(std::get<2>(c))
+            .addUInt16(std::get<3>(c));
+        RewindManager::get()->addNetworkEvent(this, s, a.m_ticks);
     }
 
     if (data.size() > 0)
@@ -229,7 +426,13 @@ void GameProtocol::handleControllerAction(Event *event)
         // is after the server time
         event->getPeer()->updateLastActivity();
         if (!will_trigger_rewind)
-            STKHost::get()->sendPacketExcept(event->getPeer(), &data, false);
+        {
+            NetworkString forward(PROTOCOL_CONTROLLER_EVENTS);
+            forward.addUInt8(GP_CONTROLLER_ACTION);
+            encodeActions(actions, &forward);
+            STKHost::get()->sendPacketExcept(event->getPeer(), &forward,
+                false);
+        }
 
         // FIXME unless there is a network jitter more than 100ms (more than
         // server delay), time adjust is not necessary
@@ -339,8 +542,15 @@ void GameProtocol::startNewState()
 {
     assert(NetworkConfig::get()->isServer());
     m_data_to_send->clear();
-    m_data_to_send->addUInt8(GP_STATE)
-        .addUInt32(World::getWorld()->getTicksSinceStart());
+    m_current_state_ticks = World::getWorld()->getTicksSinceStart();
+    m_current_state_data.clear();
+    m_state_count++;
+    m_data_to_send->addUInt8(GP_STATE).addUInt32(m_current_state_ticks);
+    // Reserve the space used by the rewinder names of the previous state,
+    // which are usually the same, so finalizeState can write the names in
+    // place without moving all state data
+    auto& buffer = m_data_to_send->getBuffer();
+    buffer.resize(buffer.size() + m_reserved_names_size);
 }   // startNewState
 
 // ----------------------------------------------------------------------------
@@ -353,6 +563,11 @@ void GameProtocol::addState(BareNetworkString *buffer)
     assert(NetworkConfig::get()->isServer());
     m_data_to_send->addUInt16(buffer->size());
     (*m_data_to_send) += *buffer;
+    if (m_per_peer_state)
+    {
+        const uint8_t* data = (const uint8_t*)buffer->getCurrentData();
+        m_current_state_data.emplace_back(data, data + buffer->size());
+    }
 }   // addState
 
 // ----------------------------------------------------------------------------
@@ -364,21 +579,65 @@ void GameProtocol::finalizeState(std::vector<std::string>& cur_rewinder)
 {
     assert(NetworkConfig::get()->isServer());
     auto& buffer = m_data_to_send->getBuffer();
-    auto pos = buffer.begin() + 1/*protocol type*/ + 1 /*gp event type*/+
+    const unsigned pos = 1/*protocol type*/ + 1 /*gp event type*/+
         4/*time*/;
 
     m_data_to_send->reset();
-    std::vector<uint8_t> names;
-    names.push_back((uint8_t)cur_rewinder.size());
+    unsigned names_size = 1;
     for (std::string& name : cur_rewinder)
+        names_size += 1 + (unsigned)name.size();
+    // Only if the rewinders changed since the last state the data has to
+    // be moved
+    if (names_size > m_reserved_names_size)
     {
-        names.push_back((uint8_t)name.size());
-        std::vector<uint8_t> rewinder(name.begin(), name.end());
-        names.insert(names.end(), rewinder.begin(), rewinder.end());
+        buffer.insert(buffer.begin() + pos + m_reserved_names_size,
+            names_size - m_reserved_names_size, 0);
     }
-    buffer.insert(pos, names.begin(), names.end());
+    else if (names_size < m_reserved_names_size)
+    {
+        buffer.erase(buffer.begin() + pos + names_size,
+            buffer.begin() + pos + m_reserved_names_size);
+    }
+    m_reserved_names_size = names_size;
+
+    uint8_t* names = buffer.data() + pos;
+    *names++ = (uint8_t)cur_rewinder.size();
+    for (std::string& name : cur_rewinder)
+    {
+        *names++ = (uint8_t)name.size();
+        memcpy(names, name.data(), name.size());
+        names += name.size();
+    }
+
+    if (!m_per_peer_state)
+        return;
+    m_current_rewinder_using = cur_rewinder;
+    if (cur_rewinder.size() != m_current_state_data.size())
+    {
+        Log::warn("GameProtocol", "Rewinder names do not match state data, "
+            "state at %d can not be used as baseline.",
+            m_current_state_ticks);
+        return;
+    }
+    StateSnapshot& snapshot = m_state_history[m_current_state_ticks];
+    snapshot.clear();
+    for (unsigned i = 0; i < cur_rewinder.size(); i++)
+        std::swap(snapshot[cur_rewinder[i]], m_current_state_data[i]);
+    trimStateHistory();
 }   // finalizeState
 
+// ----------------------------------------------------------------------------
+/** Removes old states which will not be used as baseline anymore. About two
+ *  seconds of states are kept, which covers the maximum ping allowed.
+ */
+void GameProtocol::trimStateHistory()
+{
+    const unsigned max_states =
+        std::max(stk_config->m_network_state_frequeny * 2, 4);
+    while (m_state_history.size() > max_states)
+        m_state_history.erase(m_state_history.begin());
+}   // trimStateHistory
+
 // ----------------------------------------------------------------------------
 /** Called when the last state information has been added and the message
  *  can be sent to the clients.
@@ -386,9 +645,323 @@ void GameProtocol::finalizeState(std::vector<std::string>& cur_rewinder)
 void GameProtocol::sendState()
 {
     assert(NetworkConfig::get()->isServer());
-    sendMessageToPeers(m_data_to_send, /*reliable*/false);
+    if (!m_per_peer_state ||
+        m_state_history.find(m_current_state_ticks) == m_state_history.end())
+    {
+        sendMessageToPeers(m_data_to_send, /*reliable*/false);
+        if (ServerMetrics::isEnabled())
+        {
+            const unsigned size = m_data_to_send->getTotalSize();
+            ServerMetrics::addState(size,
+                size * STKHost::get()->getPeerCount());
+        }
+        return;
+    }
+
+    // Look up the state acknowledged by each client, instead of copying
+    // the acknowledged states of all clients
+    std::vector<std::shared_ptr<STKPeer> > peers = STKHost::get()->getPeers();
+    std::vector<int> baselines(peers.size(), -1);
+    if (m_delta_state)
+    {
+        m_last_acked_state.lock();
+        auto& all_acked = m_last_acked_state.getData();
+        for (auto it = all_acked.begin(); it != all_acked.end();)
+        {
+            if (it->first.expired())
+                it = all_acked.erase(it);
+            else
+                it++;
+        }
+        for (unsigned i = 0; i < peers.size(); i++)
+        {
+            auto it = all_acked.find(peers[i]);
+            if (it != all_acked.end() &&
+                m_state_history.find(it->second) != m_state_history.end() &&
+                it->second != m_current_state_ticks)
+                baselines[i] = it->second;
+        }
+        m_last_acked_state.unlock();
+    }
+
+    // Remove information about states which can not be used as baseline
+    // anymore
+    const int oldest_ticks = m_state_history.begin()->first;
+    for (auto it = m_omitted_rewinders.begin();
+         it != m_omitted_rewinders.end();)
+    {
+        if (it->first.expired())
+        {
+            it = m_omitted_rewinders.erase(it);
+            continue;
+        }
+        it->second.erase(it->second.begin(),
+            it->second.lower_bound(oldest_ticks));
+        it++;
+    }
+
+    // Clients which acknowledged the same state and need the same rewinders
+    // share one encoded message, -1 is used for the state without baseline.
+    // The sets of rewinders are only referenced, not copied for each client.
+    struct SharedDelta
+    {
+        int m_baseline;
+        const std::set<std::string>* m_omitted;
+        const std::set<std::string>* m_omitted_in_baseline;
+        NetworkString* m_message;
+    };
+    std::vector<SharedDelta> encoded;
+    const std::set<std::string> none;
+    unsigned sent_bytes = 0;
+    for (unsigned i = 0; i < peers.size(); i++)
+    {
+        STKPeer* peer = peers[i].get();
+        if (!peer->isValidated() || peer->isWaitingForGame())
+            continue;
+        auto& peer_omitted = m_omitted_rewinders[peers[i]];
+        const int baseline = baselines[i];
+        const std::set<std::string>* omitted_in_baseline = &none;
+        auto omitted_it = peer_omitted.find(baseline);
+        if (omitted_it != peer_omitted.end())
+            omitted_in_baseline = &omitted_it->second;
+
+        std::set<std::string>& omitted =
+            peer_omitted[m_current_state_ticks];
+        omitted = getFarAwayRewinders(peer);
+
+        NetworkString* ns = NULL;
+        for (const SharedDelta& delta : encoded)
+        {
+            if (delta.m_baseline == baseline &&
+                *delta.m_omitted == omitted &&
+                *delta.m_omitted_in_baseline == *omitted_in_baseline)
+            {
+                ns = delta.m_message;
+                break;
+            }
+        }
+        if (!ns)
+        {
+            ns = encodeDeltaState(baseline, omitted, *omitted_in_baseline);
+            SharedDelta delta = { baseline, &omitted, omitted_in_baseline,
+                ns };
+            encoded.push_back(delta);
+        }
+        peer->sendPacket(ns, /*reliable*/false);
+        m_full_state_bytes.fetch_add(m_data_to_send->getTotalSize());
+        m_sent_state_bytes.fetch_add(ns->getTotalSize());
+        sent_bytes += ns->getTotalSize();
+    }
+    if (ServerMetrics::isEnabled())
+        ServerMetrics::addState(m_data_to_send->getTotalSize(), sent_bytes);
+    for (SharedDelta& delta : encoded)
+        delete delta.m_message;
 }   // sendState
 
+// ----------------------------------------------------------------------------
+/** Returns the name of all kart rewinders which are too far away from the
+ *  karts of a client to be sent in the current state. All karts are sent
+ *  in every m_far_state_interval state, so far away karts are still updated
+ *  at a reduced rate.
+ *  \param peer The client to check.
+ */
+std::set<std::string> GameProtocol::getFarAwayRewinders(STKPeer* peer) const
+{
+    std::set<std::string> far_away;
+    const int interval = ServerConfig::m_far_state_interval;
+    if (m_interest_distance <= 0.0f || interval <= 1 ||
+        m_state_count % interval == 0)
+        return far_away;
+
+    World* world = World::getWorld();
+    std::vector<const AbstractKart*> own_karts;
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        if (race_manager->getKartInfo(i).getHostId() ==
+            (int)peer->getHostId())
+            own_karts.push_back(world->getKart(i));
+    }
+    // Spectators get all karts
+    if (own_karts.empty())
+        return far_away;
+
+    for (unsigned i = 0; i < world->getNumKarts(); i++)
+    {
+        const AbstractKart* kart = world->getKart(i);
+        bool near = false;
+        for (const AbstractKart* own_kart : own_karts)
+        {
+            if (own_kart == kart ||
+                getKartDistance(own_kart, kart) < m_interest_distance)
+            {
+                near = true;
+                break;
+            }
+        }
+        if (!near)
+            far_away.insert(std::string("K") + StringUtils::toString(i));
+    }
+    return far_away;
+}   // getFarAwayRewinders
+
+// ----------------------------------------------------------------------------
+/** Returns the distance between two karts used for interest management:
+ *  the distance along the track in linear races, the distance on the
+ *  navmesh in arenas, and the straight distance otherwise.
+ */
+float GameProtocol::getKartDistance(const AbstractKart* a,
+                                    const AbstractKart* b) const
+{
+    LinearWorld* lw = dynamic_cast<LinearWorld*>(World::getWorld());
+    if (lw)
+    {
+        const float length = Track::getCurrentTrack()->getTrackLength();
+        float d = fabsf(
+            lw->getDistanceDownTrackForKart(a->getWorldKartId(), false) -
+            lw->getDistanceDownTrackForKart(b->getWorldKartId(), false));
+        if (length > 0.0f)
+        {
+            d = fmodf(d, length);
+            d = std::min(d, length - d);
+        }
+        return d;
+    }
+    WorldWithRank* wwr = dynamic_cast<WorldWithRank*>(World::getWorld());
+    if (wwr && ArenaGraph::get())
+    {
+        return ArenaGraph::get()->getDistance(wwr->getSectorForKart(a),
+            wwr->getSectorForKart(b));
+    }
+    return (a->getXYZ() - b->getXYZ()).length();
+}   // getKartDistance
+
+// ----------------------------------------------------------------------------
+/** Encodes the current state as delta against the given baseline.
+ *  \param baseline_ticks Ticks of the state acknowledged by a client, or -1
+ *         to send the full data of all rewinders.
+ *  \param omitted Rewinders which are not sent in this state.
+ *  \param omitted_in_baseline Rewinders which were not sent to the client
+ *         in the baseline state, so the client does not have them.
+ *  \return A newly allocated message, which must be freed by the caller.
+ */
+NetworkString* GameProtocol::encodeDeltaState(int baseline_ticks,
+                              const std::set<std::string>& omitted,
+                              const std::set<std::string>& omitted_in_baseline)
+{
+    std::vector<const std::string*> rewinder_using, rewinder_omitted;
+    for (const std::string& name : m_current_rewinder_using)
+    {
+        if (omitted.find(name) == omitted.end())
+            rewinder_using.push_back(&name);
+        else
+            rewinder_omitted.push_back(&name);
+    }
+
+    NetworkString* ns = getNetworkString(m_data_to_send->getTotalSize() + 5);
+    ns->addUInt8(GP_DELTA_STATE).addUInt32(m_current_state_ticks)
+        .addUInt32(baseline_ticks);
+    ns->addUInt8((uint8_t)rewinder_using.size());
+    for (const std::string* name : rewinder_using)
+        ns->encodeString(*name);
+    // The client restores the omitted rewinders from its own local state
+    ns->addUInt8((uint8_t)rewinder_omitted.size());
+    for (const std::string* name : rewinder_omitted)
+        ns->encodeString(*name);
+
+    const StateSnapshot& current = m_state_history.at(m_current_state_ticks);
+    const StateSnapshot* baseline = baseline_ticks == -1 ?
+        NULL : &m_state_history.at(baseline_ticks);
+    BareNetworkString xor_data;
+    for (const std::string* name : rewinder_using)
+    {
+        const std::vector<uint8_t>& data = current.at(*name);
+        if (baseline &&
+            omitted_in_baseline.find(*name) == omitted_in_baseline.end())
+        {
+            auto it = baseline->find(*name);
+            if (it != baseline->end() && it->second.size() == data.size())
+            {
+                if (it->second == data)
+                {
+                    ns->addUInt8(DS_SAME);
+                    continue;
+                }
+                xor_data.getBuffer().clear();
+                encodeXorDelta(it->second, data, &xor_data);
+                if (xor_data.getTotalSize() < data.size())
+                {
+                    ns->addUInt8(DS_XOR)
+                        .addUInt16((uint16_t)xor_data.getTotalSize());
+                    (*ns) += xor_data;
+                    continue;
+                }
+            }
+        }
+        ns->addUInt8(DS_FULL).addUInt16((uint16_t)data.size());
+        ns->getBuffer().insert(ns->getBuffer().end(), data.begin(),
+            data.end());
+    }
+    return ns;
+}   // encodeDeltaState
+
+// ----------------------------------------------------------------------------
+/** Encodes data as xor against baseline (which must have the same size),
+ *  storing the result as pairs of (number of unchanged bytes, number of
+ *  changed bytes) followed by the xor-ed changed bytes.
+ */
+void GameProtocol::encodeXorDelta(const std::vector<uint8_t>& baseline,
+                                  const std::vector<uint8_t>& data,
+                                  BareNetworkString* out)
+{
+    assert(baseline.size() == data.size());
+    size_t i = 0;
+    while (i < data.size())
+    {
+        uint8_t same = 0;
+        while (i < data.size() && same < 255 && baseline[i] == data[i])
+        {
+            same++;
+            i++;
+        }
+        size_t changed_start = i;
+        uint8_t changed = 0;
+        while (i < data.size() && changed < 255 && baseline[i] != data[i])
+        {
+            changed++;
+            i++;
+        }
+        out->addUInt8(same).addUInt8(changed);
+        for (size_t j = changed_start; j < i; j++)
+            out->addUInt8(baseline[j] ^ data[j]);
+    }
+}   // encodeXorDelta
+
+// ----------------------------------------------------------------------------
+/** Reverses encodeXorDelta.
+ *  \param baseline The data the delta was computed against.
+ *  \param in The message, positioned at the start of the encoded data.
+ *  \param encoded_size Number of encoded bytes in the message.
+ *  \param data Will be set to the decoded data.
+ */
+void GameProtocol::decodeXorDelta(const std::vector<uint8_t>& baseline,
+                                  const BareNetworkString& in,
+                                  int encoded_size,
+                                  std::vector<uint8_t>* data)
+{
+    *data = baseline;
+    const int end = in.getCurrentOffset() + encoded_size;
+    size_t i = 0;
+    while (in.getCurrentOffset() < end)
+    {
+        i += in.getUInt8();
+        uint8_t changed = in.getUInt8();
+        if (i + changed > data->size())
+            throw std::out_of_range("Delta state exceeds baseline size.");
+        for (unsigned j = 0; j < changed; j++, i++)
+            (*data)[i] ^= in.getUInt8();
+    }
+}   // decodeXorDelta
+
 // ----------------------------------------------------------------------------
 /** Called when a new full state is received form the server.
  */
@@ -418,6 +991,149 @@ void GameProtocol::handleState(Event *event)
     RewindManager::get()->addNetworkRewindInfo(ris);
 }   // handleState
 
+// ----------------------------------------------------------------------------
+/** Called when a delta state is received from the server. The full state is
+ *  rebuilt using the baseline state, stored for later deltas and then
+ *  handled like a full state. The client acknowledges the state so the
+ *  server can use it as new baseline.
+ */
+void GameProtocol::handleDeltaState(Event *event)
+{
+    if (!World::getWorld())
+        return;
+
+    assert(NetworkConfig::get()->isClient());
+    NetworkString &data = event->data();
+    int ticks          = data.getUInt32();
+    int baseline_ticks = data.getUInt32();
+
+    unsigned rewinder_size = data.getUInt8();
+    std::vector<std::string> rewinder_using;
+    for (unsigned i = 0; i < rewinder_size; i++)
+    {
+        std::string name;
+        data.decodeString(&name);
+        rewinder_using.push_back(name);
+    }
+    unsigned omitted_size = data.getUInt8();
+    std::vector<std::string> rewinder_omitted;
+    for (unsigned i = 0; i < omitted_size; i++)
+    {
+        std::string name;
+        data.decodeString(&name);
+        rewinder_omitted.push_back(name);
+    }
+
+    const StateSnapshot* baseline = NULL;
+    if (baseline_ticks != -1)
+    {
+        auto it = m_state_history.find(baseline_ticks);
+        if (it == m_state_history.end())
+        {
+            Log::warn("GameProtocol", "Missing baseline %d for state %d, "
+                "state ignored.", baseline_ticks, ticks);
+            return;
+        }
+        baseline = &it->second;
+    }
+
+    StateSnapshot snapshot;
+    BareNetworkString state;
+    try
+    {
+        for (const std::string& name : rewinder_using)
+        {
+            std::vector<uint8_t>& rewinder_data = snapshot[name];
+            uint8_t type = data.getUInt8();
+            if (type != DS_FULL && !baseline)
+            {
+                throw std::invalid_argument(
+                    "Delta state without baseline.");
+            }
+            switch (type)
+            {
+            case DS_FULL:
+            {
+                uint16_t size = data.getUInt16();
+                if (size > data.size())
+                    throw std::out_of_range("Delta state too short.");
+                const uint8_t* p = (const uint8_t*)data.getCurrentData();
+                rewinder_data.assign(p, p + size);
+                data.skip(size);
+                break;
+            }
+            case DS_SAME:
+                rewinder_data = baseline->at(name);
+                break;
+            case DS_XOR:
+            {
+                uint16_t size = data.getUInt16();
+                decodeXorDelta(baseline->at(name), data, size,
+                    &rewinder_data);
+                break;
+            }
+            default:
+                throw std::invalid_argument("Unknown delta state type.");
+            }
+            state.addUInt16((uint16_t)rewinder_data.size());
+            state.getBuffer().insert(state.getBuffer().end(),
+                rewinder_data.begin(), rewinder_data.end());
+        }
+    }
+    catch (std::exception& e)
+    {
+        Log::error("GameProtocol", "Invalid delta state %d: %s", ticks,
+            e.what());
+        return;
+    }
+
+    // The server never uses a baseline older than the one acknowledged
+    // last, so older states can be discarded
+    m_state_history.erase(m_state_history.begin(),
+        m_state_history.lower_bound(baseline_ticks));
+    std::swap(m_state_history[ticks], snapshot);
+    trimStateHistory();
+
+    RewindInfoState* ris = new RewindInfoState(ticks, 0, rewinder_using,
+        state.getBuffer());
+    if (!rewinder_omitted.empty())
+        RewindManager::get()->setRewindersOmitted();
+    ris->setRewinderOmitted(rewinder_omitted);
+    RewindManager::get()->addNetworkRewindInfo(ris);
+
+    NetworkString* ns = getNetworkString(5);
+    encodeStateAck(ns, ticks);
+    // An ack can get lost, the server will then keep using an older baseline
+    sendToServer(ns, /*reliable*/false);
+    delete ns;
+}   // handleDeltaState
+
+// ----------------------------------------------------------------------------
+/** Writes the acknowledgement of the delta state with the given ticks, which
+ *  the server then uses as baseline for the next delta states.
+ */
+void GameProtocol::encodeStateAck(BareNetworkString* out, int ticks)
+{
+    out->addUInt8(GP_STATE_ACK).addUInt32(ticks);
+}   // encodeStateAck
+
+// ----------------------------------------------------------------------------
+/** Called on the server when a client acknowledged a delta state.
+ */
+void GameProtocol::handleStateAck(Event *event)
+{
+    assert(NetworkConfig::get()->isServer());
+    int ticks = event->data().getUInt32();
+    m_last_acked_state.lock();
+    auto& acked = m_last_acked_state.getData();
+    auto it = acked.find(event->getPeerSP());
+    if (it == acked.end())
+        acked[event->getPeerSP()] = ticks;
+    else if (ticks > it->second)
+        it->second = ticks;
+    m_last_acked_state.unlock();
+}   // handleStateAck
+
 // ----------------------------------------------------------------------------
 /** Called from the RewindManager when rolling back.
  *  \param buffer Pointer to the saved state information.
@@ -457,3 +1173,62 @@ void GameProtocol::addInitialTicks(STKPeer* p, int ticks)
         p->getHostId(), ticks);
     m_initial_ticks[p] = ticks;
 }   // addInitialTicks
+
+// ----------------------------------------------------------------------------
+void GameProtocol::unitTesting()
+{
+    std::vector<uint8_t> baseline = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::vector<uint8_t> data     = { 1, 2, 9, 4, 5, 6, 0, 0 };
+    BareNetworkString encoded;
+    encodeXorDelta(baseline, data, &encoded);
+    // 2 unchanged, 1 changed, 3 unchanged, 2 changed
+    assert(encoded.getTotalSize() == 2 + 1 + 2 + 2);
+    std::vector<uint8_t> decoded;
+    decodeXorDelta(baseline, encoded, encoded.getTotalSize(), &decoded);
+    assert(decoded == data);
+
+    // Identical data only needs the run length of unchanged bytes
+    encoded.getBuffer().clear();
+    encoded.reset();
+    encodeXorDelta(baseline, baseline, &encoded);
+    assert(encoded.getTotalSize() == 2);
+    decodeXorDelta(baseline, encoded, encoded.getTotalSize(), &decoded);
+    assert(decoded == baseline);
+
+    // Runs longer than 255 bytes are split
+    baseline.assign(600, 7);
+    data = baseline;
+    data[599] = 8;
+    encoded.getBuffer().clear();
+    encoded.reset();
+    encodeXorDelta(baseline, data, &encoded);
+    decodeXorDelta(baseline, encoded, encoded.getTotalSize(), &decoded);
+    assert(decoded == data);
+
+    // Actions: digital actions only need 4 bytes (tick delta, kart id,
+    // action and value flags), other values 2 bytes more for each value,
+    // and tick deltas >= 128 one more byte
+    std::vector<Action> actions(3);
+    actions[0] = { 1000, 0, PA_ACCEL,        32768,     0,      0, 7, 0 };
+    actions[1] = { 1001, 1, PA_STEER_LEFT,   12345, 12345,      0, 8, 0 };
+    actions[2] = { 1200, 0, PA_STEER_RIGHT,  32768, 12345, -32768, 9, 0 };
+    encoded.getBuffer().clear();
+    encoded.reset();
+    encodeActions(actions, &encoded);
+    assert(encoded.getTotalSize() == 1 + 4 + 1 + 4 + (4 + 2 + 2) + (5 + 2));
+    std::vector<Action> decoded_actions;
+    const bool decoded_ok = decodeActions(encoded, &decoded_actions);
+    assert(decoded_ok);
+    assert(encoded.size() == 0);
+    assert(decoded_actions.size() == actions.size());
+    for (unsigned i = 0; i < actions.size(); i++)
+    {
+        assert(decoded_actions[i].m_ticks    == actions[i].m_ticks   );
+        assert(decoded_actions[i].m_kart_id  == actions[i].m_kart_id );
+        assert(decoded_actions[i].m_action   == actions[i].m_action  );
+        assert(decoded_actions[i].m_value    == actions[i].m_value   );
+        assert(decoded_actions[i].m_value_l  == actions[i].m_value_l );
+        assert(decoded_actions[i].m_value_r  == actions[i].m_value_r );
+        assert(decoded_actions[i].m_sequence == actions[i].m_sequence);
+    }
+}   // unitTesting
@@ -24,13 +24,20 @@
 
 #include "input/input.hpp"                // for PlayerAction
 #include "utils/cpp2011.hpp"
+#include "utils/server_room.hpp"
 #include "utils/singleton.hpp"
+#include "utils/synchronised.hpp"
 
+#include <atomic>
 #include <cstdlib>
 #include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <vector>
 #include <tuple>
 
+class AbstractKart;
 class BareNetworkString;
 class NetworkString;
 class STKPeer;
@@ -38,24 +45,17 @@ class STKPeer;
 class GameProtocol : public Protocol
                    , public EventRewinder
 {
-private:
-
+public:
     /** The type of game events to be forwarded to the server. */
     enum { GP_CONTROLLER_ACTION,
            GP_STATE,
            GP_ITEM_UPDATE,
            GP_ITEM_CONFIRMATION,
-           GP_ADJUST_TIME
+           GP_ADJUST_TIME,
+           GP_DELTA_STATE,
+           GP_STATE_ACK
     };
 
-    /** A network string that collects all information from the server to be sent
-     *  next. */
-    NetworkString *m_data_to_send;
-
-    /** The server might request that the world clock of a client is adjusted
-     *  to reduce number of rollbacks. */
-    std::vector<int8_t> m_adjust_time;
-
     // Dummy data structure to save all kart actions.
     struct Action
     {
@@ -65,20 +65,132 @@ private:
         int          m_value;
         int          m_value_l;
         int          m_value_r;
+        /** Consecutive number of this action on the client. */
+        uint32_t     m_sequence;
+        /** How often this action will still be sent again. */
+        int          m_sends_left;
     };   // struct Action
 
+    // ------------------------------------------------------------------------
+    static void encodeActions(const std::vector<Action>& actions,
+                              BareNetworkString* out);
+    // ------------------------------------------------------------------------
+    static bool decodeActions(const BareNetworkString& in,
+                              std::vector<Action>* actions);
+    // ------------------------------------------------------------------------
+    static void encodeStateAck(BareNetworkString* out, int ticks);
+
+private:
+    /** How the data of a single rewinder is stored in a delta state. */
+    enum DeltaStateType : uint8_t
+    {
+        DS_FULL = 0, //!< Complete data, no baseline used.
+        DS_SAME = 1, //!< Identical to the data in the baseline.
+        DS_XOR  = 2  //!< Run length encoded xor against the baseline.
+    };
+
+    /** The data of each rewinder in a state, indexed by rewinder name. */
+    typedef std::map<std::string, std::vector<uint8_t> > StateSnapshot;
+
+    /** A network string that collects all information from the server to be sent
+     *  next. */
+    NetworkString *m_data_to_send;
+
+    /** The server might request that the world clock of a client is adjusted
+     *  to reduce number of rollbacks. */
+    std::vector<int8_t> m_adjust_time;
+
     // List of all kart actions to send to the server
     std::vector<Action> m_all_actions;
 
+    /** On a client the already sent actions, which are sent again with the
+     *  next actions so that a lost (unreliable) packet does not lose them. */
+    std::vector<Action> m_resend_actions;
+
+    /** Sequence number of the next action on a client. */
+    uint32_t m_next_action_sequence;
+
+    /** World ticks when a client sent actions the last time, used to limit
+     *  the number of messages to input-frequency. */
+    int m_last_actions_sent_ticks;
+
+    /** On the server the sequence number of the next action expected from
+     *  each client, to ignore actions that were received before. Only used
+     *  in the asynchronous protocol manager thread. */
+    std::map<std::weak_ptr<STKPeer>, uint32_t,
+        std::owner_less<std::weak_ptr<STKPeer> > > m_expected_action_sequence;
+
+    /** True if the server sends states as delta against the state last
+     *  acknowledged by each client. */
+    bool m_delta_state;
+
+    /** Karts further away than this from all karts of a client are only
+     *  sent to that client in every m_far_state_interval state. */
+    float m_interest_distance;
+
+    /** True if the server encodes the state for each client separately. */
+    bool m_per_peer_state;
+
+    /** Number of states saved on the server in the current game. */
+    unsigned m_state_count;
+
+    /** Ticks of the state currently being assembled on the server. */
+    int m_current_state_ticks;
+
+    /** Number of bytes reserved for the rewinder names at the beginning of
+     *  the state on the server (the size of the names of the last state). */
+    unsigned m_reserved_names_size;
+
+    /** On the server the data of each rewinder added to the current state,
+     *  in the same order as the rewinder names in finalizeState. */
+    std::vector<std::vector<uint8_t> > m_current_state_data;
+
+    /** Names of the rewinders in the current state. */
+    std::vector<std::string> m_current_rewinder_using;
+
+    /** Recent states, used as baseline for delta states. On the server
+     *  these are the sent states, on the client the received ones. */
+    std::map<int, StateSnapshot> m_state_history;
+
+    /** Stores on the server for each client the rewinders which were left
+     *  out of a state, indexed by state ticks. */
+    std::map<std::weak_ptr<STKPeer>, std::map<int, std::set<std::string> >,
+        std::owner_less<std::weak_ptr<STKPeer> > > m_omitted_rewinders;
+
+    /** Stores on the server the latest state ticks acknowledged by each
+     *  client. */
+    Synchronised<std::map<std::weak_ptr<STKPeer>, int,
+        std::owner_less<std::weak_ptr<STKPeer> > > > m_last_acked_state;
+
+    /** Number of bytes which would have been sent with full states. */
+    std::atomic<uint64_t> m_full_state_bytes;
+
+    /** Number of state bytes actually sent. */
+    std::atomic<uint64_t> m_sent_state_bytes;
+
     void handleControllerAction(Event *event);
     void handleState(Event *event);
+    void handleDeltaState(Event *event);
+    void handleStateAck(Event *event);
+    NetworkString* encodeDeltaState(int baseline_ticks,
+                                    const std::set<std::string>& omitted,
+                                    const std::set<std::string>& omitted_in_baseline);
+    std::set<std::string> getFarAwayRewinders(STKPeer* peer) const;
+    float getKartDistance(const AbstractKart* a, const AbstractKart* b) const;
+    void trimStateHistory();
+    static void encodeXorDelta(const std::vector<uint8_t>& baseline,
+                               const std::vector<uint8_t>& data,
+                               BareNetworkString* out);
+    static void decodeXorDelta(const std::vector<uint8_t>& baseline,
+                               const BareNetworkString& in, int encoded_size,
+                               std::vector<uint8_t>* data);
     void handleAdjustTime(Event *event);
     void handleItemEventConfirmation(Event *event);
-    static std::weak_ptr<GameProtocol> m_game_protocol;
+    static PerRoom<std::weak_ptr<GameProtocol> > m_game_protocol;
     std::map<STKPeer*, int> m_initial_ticks;
     std::map<STKPeer*, double> m_last_adjustments;
     // Maximum value of values are only 32768
-    std::tuple<uint8_t, uint16_t, uint16_t, uint16_t>
+    static std::tuple<uint8_t, uint16_t, uint16_t, uint16_t>
                                                 compressAction(const Action& a)
     {
         uint8_t w = (uint8_t)(a.m_action & 63) |
@@ -88,7 +200,7 @@ private:
         uint16_t z = (uint16_t)std::abs(a.m_value_r);
         return std::make_tuple(w, x, y, z);
     }
-    std::tuple<PlayerAction, int, int, int>
+    static std::tuple<PlayerAction, int, int, int>
                decompressAction(uint8_t w, uint16_t x, uint16_t y , uint16_t z)
     {
         PlayerAction a = (PlayerAction)(w & 63);
@@ -122,22 +234,33 @@ public:
     // ------------------------------------------------------------------------
     virtual void asynchronousUpdate() OVERRIDE {}
     // ------------------------------------------------------------------------
+    virtual unsigned getAsynchronousUpdateDelay() OVERRIDE
+                               { return std::numeric_limits<unsigned>::max(); }
+    // ------------------------------------------------------------------------
     static std::shared_ptr<GameProtocol> createInstance();
     // ------------------------------------------------------------------------
     static bool emptyInstance()
     {
-        return m_game_protocol.expired();
+        return m_game_protocol.get().expired();
     }   // emptyInstance
     // ------------------------------------------------------------------------
     static std::shared_ptr<GameProtocol> lock()
     {
-        return m_game_protocol.lock();
+        return m_game_protocol.get().lock();
     }   // lock
     // ------------------------------------------------------------------------
     /** Returns the NetworkString in which a state was saved. */
     NetworkString* getState() const { return m_data_to_send;  }
     // ------------------------------------------------------------------------
     void addInitialTicks(STKPeer* p, int ticks);
+    // ------------------------------------------------------------------------
+    /** Returns the number of state bytes that full states would have used. */
+    uint64_t getFullStateBytes() const      { return m_full_state_bytes.load(); }
+    // ------------------------------------------------------------------------
+    /** Returns the number of state bytes sent to all clients. */
+    uint64_t getSentStateBytes() const      { return m_sent_state_bytes.load(); }
+    // ------------------------------------------------------------------------
+    static void unitTesting();
 
 };   // class GameProtocol
 
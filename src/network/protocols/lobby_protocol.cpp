@@ -31,7 +31,7 @@
 #include "race/race_manager.hpp"
 #include "states_screens/state_manager.hpp"
 
-std::weak_ptr<LobbyProtocol> LobbyProtocol::m_lobby;
+PerRoom<std::weak_ptr<LobbyProtocol> > LobbyProtocol::m_lobby;
 
 LobbyProtocol::LobbyProtocol(CallbackObject* callback_object)
                  : Protocol(PROTOCOL_LOBBY_ROOM, callback_object)
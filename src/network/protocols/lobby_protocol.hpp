@@ -20,6 +20,7 @@
 #define LOBBY_PROTOCOL_HPP
 
 #include "network/protocol.hpp"
+#include "utils/server_room.hpp"
 
 class GameSetup;
 class NetworkPlayerProfile;
@@ -81,7 +82,8 @@ public:
 protected:
     std::thread m_start_game_thread;
 
-    static std::weak_ptr<LobbyProtocol> m_lobby;
+    /** The lobby of each server room. */
+    static PerRoom<std::weak_ptr<LobbyProtocol> > m_lobby;
 
     /** Estimated current started game remaining time,
      *  uint32_t max if not available. */
@@ -109,9 +111,9 @@ public:
     template<typename Singleton, typename... Types>
         static std::shared_ptr<Singleton> create(Types ...args)
     {
-        assert(m_lobby.expired());
+        assert(m_lobby.get().expired());
         auto ret = std::make_shared<Singleton>(args...);
-        m_lobby = ret;
+        m_lobby.get() = ret;
         return std::dynamic_pointer_cast<Singleton>(ret);
     }   // create
 
@@ -119,7 +121,14 @@ public:
     /** Returns the singleton client or server lobby protocol. */
     template<class T> static std::shared_ptr<T> get()
     {
-        if (std::shared_ptr<LobbyProtocol> lp = m_lobby.lock())
+        return get<T>(ServerRoom::getCurrent());
+    }   // get
+
+    // ------------------------------------------------------------------------
+    /** Returns the server lobby protocol of the given server room. */
+    template<class T> static std::shared_ptr<T> get(unsigned room)
+    {
+        if (std::shared_ptr<LobbyProtocol> lp = m_lobby.get(room).lock())
         {
             std::shared_ptr<T> new_type = std::dynamic_pointer_cast<T>(lp);
             if (new_type)
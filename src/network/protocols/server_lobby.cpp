@@ -18,6 +18,7 @@
 
 #include "network/protocols/server_lobby.hpp"
 
+#include "config/stk_config.hpp"
 #include "config/user_config.hpp"
 #include "items/item_manager.hpp"
 #include "items/powerup_manager.hpp"
@@ -29,6 +30,7 @@
 #include "network/crypto.hpp"
 #include "network/event.hpp"
 #include "network/game_setup.hpp"
+#include "network/ip_ban_list.hpp"
 #include "network/network_config.hpp"
 #include "network/network_player_profile.hpp"
 #include "network/protocol_manager.hpp"
@@ -48,6 +50,7 @@
 #include "tracks/track_manager.hpp"
 #include "utils/log.hpp"
 #include "utils/random_generator.hpp"
+#include "utils/server_room.hpp"
 #include "utils/time.hpp"
 
 #include <algorithm>
@@ -93,7 +96,8 @@
  *  It starts with detecting the public ip address and port of this
  *  host (GetPublicAddress).
  */
-ServerLobby::ServerLobby() : LobbyProtocol(NULL)
+ServerLobby::ServerLobby() : LobbyProtocol(NULL),
+                             m_room(ServerRoom::getCurrent())
 {
     std::vector<int> all_k =
         kart_properties_manager->getKartsInGroup("standard");
@@ -122,12 +126,17 @@ ServerLobby::ServerLobby() : LobbyProtocol(NULL)
     m_last_success_poll_time.store(StkTime::getRealTimeMs() + 30000);
     m_waiting_players_counts.store(0);
     m_server_owner_id.store(-1);
+    m_player_list_pending.store(false);
+    m_player_list_reset_pending.store(false);
+    m_last_lobby_update_time = 0;
     m_registered_for_once_only = false;
     m_has_created_server_id_file = false;
     setHandleDisconnections(true);
     m_state = SET_PUBLIC_ADDRESS;
-    m_save_server_config = true;
+    // All rooms share the server config, only the first one saves it
+    m_save_server_config = m_room == 0;
     updateBanList();
+    applyTickRates();
     if (ServerConfig::m_ranked)
     {
         Log::info("ServerLobby", "This server will submit ranking scores to "
@@ -148,15 +157,45 @@ ServerLobby::ServerLobby() : LobbyProtocol(NULL)
 ServerLobby::~ServerLobby()
 {
     if (NetworkConfig::get()->isNetworking() &&
-        NetworkConfig::get()->isWAN())
+        NetworkConfig::get()->isWAN() && m_room == 0)
     {
         unregisterServer(true/*now*/);
     }
     delete m_result_ns;
+    clearPendingVotes();
     if (m_save_server_config)
         ServerConfig::writeServerConfigToDisk();
+    if (m_room == 0)
+        stk_config->resetTickRates();
 }   // ~ServerLobby
 
+//-----------------------------------------------------------------------------
+/** Uses the physics, state and input rates of the server config (if set)
+ *  instead of the ones in stk_config. They are sent to clients when they
+ *  connect, so that they use the same rates.
+ */
+void ServerLobby::applyTickRates()
+{
+    int physics_fps = stk_config->getPhysicsFPS();
+    if (ServerConfig::m_physics_fps > 0)
+    {
+        physics_fps = std::min(std::max((int)ServerConfig::m_physics_fps, 30),
+            250);
+    }
+    int state_frequency = stk_config->m_network_state_frequeny;
+    if (ServerConfig::m_state_frequency > 0)
+        state_frequency = ServerConfig::m_state_frequency;
+    int input_frequency = stk_config->m_network_input_frequency;
+    if (ServerConfig::m_input_frequency >= 0)
+        input_frequency = ServerConfig::m_input_frequency;
+    state_frequency = std::min(state_frequency, physics_fps);
+    input_frequency = std::min(input_frequency, physics_fps);
+    stk_config->setTickRates(physics_fps, state_frequency, input_frequency);
+    Log::info("ServerLobby", "Physics fps %d, %d states per second, "
+        "clients send actions %d times per second.", physics_fps,
+        state_frequency, input_frequency);
+}   // applyTickRates
+
 //-----------------------------------------------------------------------------
 void ServerLobby::updateTracksForMode()
 {
@@ -411,6 +450,9 @@ void ServerLobby::asynchronousUpdate()
     // Check if server owner has left
     updateServerOwner();
 
+    // Send the player list and votes changed by the events handled so far
+    sendPendingLobbyUpdates();
+
     if (ServerConfig::m_ranked && m_state.load() == WAITING_FOR_START_GAME)
         clearDisconnectedRankedPlayer();
 
@@ -419,13 +461,20 @@ void ServerLobby::asynchronousUpdate()
     {
         updateWaitingPlayers();
         // Only poll the STK server if this is a WAN server.
-        if (NetworkConfig::get()->isWAN())
+        if (NetworkConfig::get()->isWAN() && ServerRoom::getCount() == 1)
             checkIncomingConnectionRequests();
         handlePendingConnection();
     }
 
-    if (NetworkConfig::get()->isWAN() &&
-        allowJoinedPlayersWaiting() && m_server_recovering.expired() &&
+    // With several rooms the first one polls for the players of all rooms,
+    // as they join whichever room has space left
+    if (NetworkConfig::get()->isWAN() && ServerRoom::getCount() > 1 &&
+        m_room == 0)
+        checkIncomingConnectionRequests();
+
+    if (NetworkConfig::get()->isWAN() && m_room == 0 &&
+        (allowJoinedPlayersWaiting() || ServerRoom::getCount() > 1) &&
+        m_server_recovering.expired() &&
         StkTime::getRealTimeMs() > m_last_success_poll_time.load() + 30000)
     {
         Log::warn("ServerLobby", "Trying auto server recovery.");
@@ -441,10 +490,18 @@ void ServerLobby::asynchronousUpdate()
         if (NetworkConfig::get()->isLAN())
         {
             m_state = WAITING_FOR_START_GAME;
+            if (m_room != 0)
+                return;
             STKHost::get()->startListening();
             createServerIdFile();
             return;
         }
+        // The other rooms use the socket and registration of the first room
+        if (m_room != 0)
+        {
+            m_state = WAITING_FOR_START_GAME;
+            break;
+        }
         STKHost::get()->setPublicAddress();
         if (STKHost::get()->getPublicAddress().isUnset())
         {
@@ -460,7 +517,8 @@ void ServerLobby::asynchronousUpdate()
     }
     case REGISTER_SELF_ADDRESS:
     {
-        if (m_game_setup->isGrandPrixStarted() || m_registered_for_once_only)
+        if (m_game_setup->isGrandPrixStarted() ||
+            m_registered_for_once_only || m_room != 0)
         {
             m_state = WAITING_FOR_START_GAME;
             break;
@@ -507,6 +565,8 @@ void ServerLobby::asynchronousUpdate()
                 (checkPeersReady() &&
                 player_size >= ServerConfig::m_min_start_game_players))
             {
+                // Clients see the last ready state before it is reset
+                sendPendingLobbyUpdates(/*force*/true);
                 resetPeersReady();
                 startSelection();
                 return;
@@ -597,6 +657,9 @@ void ServerLobby::asynchronousUpdate()
 
             // Reset for next state usage
             resetPeersReady();
+            // Send the votes which were not sent yet, so that all clients
+            // see the last vote of each player before the world is loaded
+            sendPendingLobbyUpdates(/*force*/true);
             m_state = LOAD_WORLD;
             sendMessageToPeers(load_world);
             delete load_world;
@@ -609,6 +672,55 @@ void ServerLobby::asynchronousUpdate()
 
 }   // asynchronousUpdate
 
+//-----------------------------------------------------------------------------
+/** Returns the time in ms until the next asynchronous update is needed if
+ *  no event arrives. Players joining or leaving, votes and ready messages
+ *  are events which wake up the protocol manager anyway, so while waiting
+ *  for players or racing only the start game timeout, pending lobby updates
+ *  and the polling of the STK server need an update. States which wait for
+ *  the STK server or for the main thread keep the normal polling rate.
+ */
+unsigned ServerLobby::getAsynchronousUpdateDelay()
+{
+    // Upper limit for the idle delay, e.g. for polling the STK server
+    unsigned idle_delay = 1000;
+    if (m_player_list_pending.load() || !m_pending_votes.empty())
+    {
+        const uint64_t next = m_last_lobby_update_time +
+            getLobbyUpdateInterval();
+        const uint64_t now = StkTime::getRealTimeMs();
+        if (next <= now)
+            return 0;
+        idle_delay = (unsigned)std::min(next - now, (uint64_t)idle_delay);
+    }
+    switch (m_state.load())
+    {
+    // LOAD_WORLD is changed by the main thread (without waking up the
+    // asynchronous update), so it uses the short default delay
+    case WAITING_FOR_START_GAME:
+    case WAIT_FOR_RACE_STARTED:
+    case RACING:
+    case WAIT_FOR_RACE_STOPPED:
+    case RESULT_DISPLAY:
+    {
+        std::unique_lock<std::mutex> lock(m_keys_mutex);
+        if (!m_pending_connection.empty())
+            return Protocol::getAsynchronousUpdateDelay();
+        lock.unlock();
+        if (m_state.load() != WAITING_FOR_START_GAME ||
+            !ServerConfig::m_owner_less)
+            return idle_delay;
+        const int64_t timeout = m_timeout.load() -
+            (int64_t)StkTime::getRealTimeMs();
+        if (timeout < 0)
+            return 0;
+        return (unsigned)std::min(timeout, (int64_t)idle_delay);
+    }
+    default:
+        return Protocol::getAsynchronousUpdateDelay();
+    }
+}   // getAsynchronousUpdateDelay
+
 //-----------------------------------------------------------------------------
 /** Simple finite state machine.  Once this
  *  is known, register the server and its address with the stk server so that
@@ -935,7 +1047,8 @@ void ServerLobby::startSelection(const Event *event)
     if (!allowJoinedPlayersWaiting())
     {
         ProtocolManager::lock()->findAndTerminate(PROTOCOL_CONNECTION);
-        if (NetworkConfig::get()->isWAN())
+        // Other rooms still accept players while this one is racing
+        if (NetworkConfig::get()->isWAN() && ServerRoom::getCount() == 1)
         {
             unregisterServer(false/*now*/);
         }
@@ -995,6 +1108,9 @@ void ServerLobby::startSelection(const Event *event)
         ns->encodeString(track);
     }
 
+    // Send the player list which was not sent yet (e.g. a ready toggle), it
+    // is not sent anymore once the lobby left WAITING_FOR_START_GAME
+    sendPendingLobbyUpdates(/*force*/true);
     sendMessageToPeers(ns, /*reliable*/true);
     delete ns;
 
@@ -1069,7 +1185,8 @@ void ServerLobby::checkIncomingConnectionRequests()
             if (!sl)
                 return;
             sl->m_last_success_poll_time.store(StkTime::getRealTimeMs());
-            if (sl->m_state.load() != WAITING_FOR_START_GAME &&
+            if (ServerRoom::getCount() == 1 &&
+                sl->m_state.load() != WAITING_FOR_START_GAME &&
                 !sl->allowJoinedPlayersWaiting())
             {
                 sl->replaceKeys(keys);
@@ -1101,6 +1218,15 @@ void ServerLobby::checkIncomingConnectionRequests()
                     sl->addPeerConnection(peer_addr_str);
                 }
             }
+            // Players can join any room, so each one gets the same keys
+            for (unsigned room = 1; room < ServerRoom::getCount(); room++)
+            {
+                auto room_sl = LobbyProtocol::get<ServerLobby>(room);
+                if (!room_sl)
+                    continue;
+                std::map<uint32_t, KeyData> room_keys = keys;
+                room_sl->replaceKeys(room_keys);
+            }
             sl->replaceKeys(keys);
         }
     public:
@@ -1753,7 +1879,10 @@ void ServerLobby::handleUnencryptedConnection(std::shared_ptr<STKPeer> peer,
             (m_timeout.load() - (int64_t)StkTime::getRealTimeMs()) / 1000.0f;
     }
     message_ack->addUInt8(LE_CONNECTION_ACCEPTED).addUInt32(peer->getHostId())
-        .addUInt32(ServerConfig::m_server_version).addFloat(auto_start_timer);
+        .addUInt32(ServerConfig::m_server_version).addFloat(auto_start_timer)
+        .addUInt16((uint16_t)stk_config->getPhysicsFPS())
+        .addUInt16((uint16_t)stk_config->m_network_state_frequeny)
+        .addUInt16((uint16_t)stk_config->m_network_input_frequency);
 
     if (game_started)
     {
@@ -1791,12 +1920,31 @@ void ServerLobby::handleUnencryptedConnection(std::shared_ptr<STKPeer> peer,
 
 //-----------------------------------------------------------------------------
 /** Called when any players change their setting (team for example), or
- *  connection / disconnection, it will use the game_started parameter to
- *  determine if this should be send to all peers in server or just in game.
+ *  connection / disconnection. The player list is not sent immediately but
+ *  with the next lobby updates (see sendPendingLobbyUpdates), so that many
+ *  changes at the same time only send the latest list once.
  *  \param update_when_reset_server If true, this message will be sent to
  *  all peers.
  */
 void ServerLobby::updatePlayerList(bool update_when_reset_server)
+{
+    if (update_when_reset_server)
+        m_player_list_reset_pending.store(true);
+    m_player_list_pending.store(true);
+    // This can be called from the main thread too
+    if (auto pm = ProtocolManager::lock())
+        pm->wakeUpAsynchronousUpdate();
+}   // updatePlayerList
+
+//-----------------------------------------------------------------------------
+/** Sends the player list, it will use the game_started parameter to
+ *  determine if this should be send to all peers in server or just in game.
+ *  A list identical to the one sent before is only sent to peers which did
+ *  not receive it yet.
+ *  \param update_when_reset_server If true, this message will be sent to
+ *  all peers.
+ */
+void ServerLobby::sendPlayerList(bool update_when_reset_server)
 {
     const bool game_started = m_state.load() != WAITING_FOR_START_GAME &&
         !update_when_reset_server;
@@ -1836,18 +1984,70 @@ void ServerLobby::updatePlayerList(bool update_when_reset_server)
         pl->addUInt8(ready);
     }
 
+    // Clients clear their player list when they return to the lobby
+    if (update_when_reset_server)
+        m_last_player_list_peers.clear();
+    const bool same_list = pl->getBuffer() == m_last_player_list;
+    if (!same_list)
+        m_last_player_list_peers.clear();
+    std::set<uint32_t>& received = m_last_player_list_peers;
+
     // Don't send this message to in-game players
-    STKHost::get()->sendPacketToAllPeersWith([game_started]
+    STKHost::get()->sendPacketToAllPeersWith([game_started, &received]
         (STKPeer* p)
         {
             if (!p->isValidated())
                 return false;
             if (!p->isWaitingForGame() && game_started)
                 return false;
-            return true;
+            return received.insert(p->getHostId()).second;
         }, pl);
+    m_last_player_list.swap(pl->getBuffer());
     delete pl;
-}   // updatePlayerList
+}   // sendPlayerList
+
+//-----------------------------------------------------------------------------
+/** Returns the minimum time in ms between two lobby updates. */
+uint64_t ServerLobby::getLobbyUpdateInterval()
+{
+    return (uint64_t)(std::max(0.0f,
+        (float)ServerConfig::m_lobby_update_interval) * 1000.0f);
+}   // getLobbyUpdateInterval
+
+//-----------------------------------------------------------------------------
+/** Sends the pending player list and votes, if the lobby update interval has
+ *  passed since they were sent last. Called in the protocol manager thread
+ *  after events were handled, so all changes done by these events are merged.
+ *  \param force Send the pending updates now, even if the interval has not
+ *         passed yet.
+ */
+void ServerLobby::sendPendingLobbyUpdates(bool force)
+{
+    if (!m_player_list_pending.load() && m_pending_votes.empty())
+        return;
+    const uint64_t now = StkTime::getRealTimeMs();
+    if (!force && now < m_last_lobby_update_time + getLobbyUpdateInterval())
+        return;
+    m_last_lobby_update_time = now;
+
+    if (m_player_list_pending.exchange(false))
+        sendPlayerList(m_player_list_reset_pending.exchange(false));
+    if (m_state.load() == SELECTING)
+    {
+        for (auto& vote : m_pending_votes)
+            sendMessageToPeers(vote.second);
+    }
+    clearPendingVotes();
+}   // sendPendingLobbyUpdates
+
+//-----------------------------------------------------------------------------
+/** Discards the votes which were not sent yet. */
+void ServerLobby::clearPendingVotes()
+{
+    for (auto& vote : m_pending_votes)
+        delete vote.second;
+    m_pending_votes.clear();
+}   // clearPendingVotes
 
 //-----------------------------------------------------------------------------
 void ServerLobby::updateServerOwner()
@@ -2000,18 +2200,21 @@ void ServerLobby::playerVote(Event* event)
         }
     }
 
-    NetworkString other = NetworkString(PROTOCOL_LOBBY_ROOM);
+    NetworkString* other = getNetworkString();
     std::string name = StringUtils::wideToUtf8(event->getPeer()
         ->getPlayerProfiles()[0]->getName());
-    other.setSynchronous(true);
-    other.addUInt8(LE_VOTE).addFloat(ServerConfig::m_voting_timeout)
+    other->setSynchronous(true);
+    other->addUInt8(LE_VOTE).addFloat(ServerConfig::m_voting_timeout)
         .encodeString(name).addUInt32(event->getPeer()->getHostId())
         .encodeString(track_name).addUInt8(lap).addUInt8(reverse);
 
     m_peers_votes[event->getPeerSP()] =
         std::make_tuple(track_name, lap, reverse == 1);
-    sendMessageToPeers(&other);
 
+    // Only the latest vote of each host is sent with the next lobby updates
+    NetworkString*& pending = m_pending_votes[event->getPeer()->getHostId()];
+    delete pending;
+    pending = other;
 }   // playerVote
 
 // ----------------------------------------------------------------------------
@@ -2200,57 +2403,34 @@ void ServerLobby::playerFinishedResult(Event *event)
 }   // playerFinishedResult
 
 //-----------------------------------------------------------------------------
+/** Rebuilds the ban lists from the server config, removing expired and
+ *  invalid entries. Overlapping IP ranges are kept, an address is banned as
+ *  long as any of its ranges is. The new IP ban list is built before it
+ *  replaces the old one, so isBannedForIP can be used during a reload.
+ */
 void ServerLobby::updateBanList()
 {
-    m_ip_ban_list.clear();
     m_online_id_ban_list.clear();
 
+    auto ip_ban_list = std::make_shared<IPBanList>();
+    std::map<std::string, uint32_t> final_ip_ban_list;
     for (auto& ban : ServerConfig::m_server_ip_ban_list)
     {
         if (ban.first == "0.0.0.0/0" ||
             (uint32_t)StkTime::getTimeSinceEpoch() > ban.second)
             continue;
-        uint32_t netbits = 0;
-        std::vector<std::string> ip_and_netbits =
-            StringUtils::split(ban.first, '/');
-        if (ip_and_netbits.size() != 2 ||
-            !StringUtils::fromString(ip_and_netbits[1], netbits) ||
-            netbits > 32)
-        {
-            Log::error("STKHost", "Wrong CIDR: %s", ban.first.c_str());
-            continue;
-        }
-        TransportAddress addr(ip_and_netbits[0]);
-        if (addr.getIP() == 0)
+        if (!ip_ban_list->add(ban.first, ban.second))
         {
-            Log::error("STKHost", "Wrong CIDR: %s", ban.first.c_str());
+            Log::error("ServerLobby", "Wrong CIDR: %s", ban.first.c_str());
             continue;
         }
-        uint32_t mask = ~((1 << (32 - netbits)) - 1);
-        uint32_t ip_start = addr.getIP() & mask;
-        uint32_t ip_end = (addr.getIP() & mask) | ~mask;
-        m_ip_ban_list[ip_start] =
-            std::make_tuple(ip_end, ban.first, ban.second);
+        final_ip_ban_list[ban.first] = ban.second;
     }
+    std::unique_lock<std::mutex> ul(m_ip_ban_list_mutex);
+    m_ip_ban_list = ip_ban_list;
+    ul.unlock();
+    Log::info("ServerLobby", "%u IP ban(s) loaded.", ip_ban_list->size());
 
-    std::map<std::string, uint32_t> final_ip_ban_list;
-    for (auto it = m_ip_ban_list.begin();
-        it != m_ip_ban_list.end();)
-    {
-        auto next_itr = std::next(it);
-        if (next_itr != m_ip_ban_list.end() &&
-            next_itr->first <= std::get<0>(it->second))
-        {
-            Log::warn("ServerLobby", "%s overlaps %s, removing the first one.",
-                std::get<1>(next_itr->second).c_str(),
-                std::get<1>(it->second).c_str());
-            m_ip_ban_list.erase(next_itr);
-            continue;
-        }
-        final_ip_ban_list[std::get<1>(it->second)] =
-            ServerConfig::m_server_ip_ban_list.at(std::get<1>(it->second));
-        it++;
-    }
     ServerConfig::m_server_ip_ban_list = final_ip_ban_list;
     // Default guided entry
     ServerConfig::m_server_ip_ban_list["0.0.0.0/0"] = 0;
@@ -2565,6 +2745,9 @@ void ServerLobby::resetServer()
     resetPeersReady();
     m_state = NetworkConfig::get()->isLAN() ?
         WAITING_FOR_START_GAME : REGISTER_SELF_ADDRESS;
+    // The lobby state is changed by the main thread here
+    if (auto pm = ProtocolManager::lock())
+        pm->wakeUpAsynchronousUpdate();
     updatePlayerList(true/*update_when_reset_server*/);
     NetworkString* server_info = getNetworkString();
     server_info->setSynchronous(true);
@@ -2578,30 +2761,20 @@ void ServerLobby::resetServer()
 //-----------------------------------------------------------------------------
 bool ServerLobby::isBannedForIP(const TransportAddress& addr) const
 {
-    uint32_t ip_decimal = addr.getIP();
-    auto lb = m_ip_ban_list.lower_bound(addr.getIP());
-    bool is_banned = false;
-    if (lb != m_ip_ban_list.end() && ip_decimal >= lb->first/*ip_start*/)
-    {
-        if (ip_decimal <= std::get<0>(lb->second)/*ip_end*/ &&
-            (uint32_t)StkTime::getTimeSinceEpoch() < std::get<2>(lb->second))
-            is_banned = true;
-    }
-    else if (lb != m_ip_ban_list.begin())
-    {
-        lb--;
-        if (ip_decimal>= lb->first/*ip_start*/ &&
-            ip_decimal <= std::get<0>(lb->second)/*ip_end*/ &&
-            (uint32_t)StkTime::getTimeSinceEpoch() < std::get<2>(lb->second))
-            is_banned = true;
-    }
-    if (is_banned)
+    std::unique_lock<std::mutex> ul(m_ip_ban_list_mutex);
+    std::shared_ptr<const IPBanList> ip_ban_list = m_ip_ban_list;
+    ul.unlock();
+    if (!ip_ban_list)
+        return false;
+
+    const std::string* cidr = ip_ban_list->findBan(addr.getIP(),
+        (uint32_t)StkTime::getTimeSinceEpoch());
+    if (cidr)
     {
         Log::info("ServerLobby", "%s is banned by CIDR %s",
-            addr.toString(false/*show_port*/).c_str(),
-            std::get<1>(lb->second).c_str());
+            addr.toString(false/*show_port*/).c_str(), cidr->c_str());
     }
-    return is_banned;
+    return cidr != NULL;
 }   // isBannedForIP
 
 //-----------------------------------------------------------------------------
@@ -35,6 +35,7 @@
 #include <tuple>
 
 class BareNetworkString;
+class IPBanList;
 class NetworkString;
 class NetworkPlayerProfile;
 class STKPeer;
@@ -93,6 +94,26 @@ private:
     std::map<std::weak_ptr<STKPeer>, std::tuple<std::string, uint8_t, bool>,
         std::owner_less<std::weak_ptr<STKPeer> > > m_peers_votes;
 
+    /** Vote messages which were not sent yet, only the latest vote of each
+     *  host is kept. Only used in the protocol manager thread. */
+    std::map<uint32_t, NetworkString*> m_pending_votes;
+
+    /** True if the player list changed since it was sent last. */
+    std::atomic_bool m_player_list_pending;
+
+    /** True if the pending player list is sent after the server was reset,
+     *  see updatePlayerList. */
+    std::atomic_bool m_player_list_reset_pending;
+
+    /** Real time in ms when the pending lobby updates were sent last. Only
+     *  used in the protocol manager thread. */
+    uint64_t m_last_lobby_update_time;
+
+    /** The last player list sent and the host ids of the peers which
+     *  received it, so an unchanged list is only sent to new peers. */
+    std::vector<uint8_t> m_last_player_list;
+    std::set<uint32_t> m_last_player_list_peers;
+
     bool m_has_created_server_id_file;
 
     /** It indicates if this server is unregistered with the stk server. */
@@ -107,10 +128,13 @@ private:
      *  starting race. */
     mutable std::mutex m_connection_mutex;
 
-    /** Ban list of ip ranges. */
-    std::map</*ip_start*/uint32_t, std::tuple</*ip_end*/uint32_t,
-        /*CIDR*/std::string, /*expired time epoch*/uint32_t> >
-        m_ip_ban_list;
+    /** Ban list of ip ranges, replaced as a whole in updateBanList, so a
+     *  reload never blocks the lookups done for connection requests. */
+    std::shared_ptr<const IPBanList> m_ip_ban_list;
+
+    /** Protects the m_ip_ban_list pointer (not the list itself, which is
+     *  not modified after creation). */
+    mutable std::mutex m_ip_ban_list_mutex;
 
     /** Ban list of online user id. */
     std::map<uint32_t, /*expired time epoch*/uint32_t> m_online_id_ban_list;
@@ -167,6 +191,9 @@ private:
 
     bool m_save_server_config;
 
+    /** The server room this lobby belongs to. */
+    const unsigned m_room;
+
     // connection management
     void clientDisconnected(Event* event);
     void connectionRequested(Event* event);
@@ -183,6 +210,10 @@ private:
     void unregisterServer(bool now);
     void createServerIdFile();
     void updatePlayerList(bool update_when_reset_server = false);
+    void sendPlayerList(bool update_when_reset_server);
+    void sendPendingLobbyUpdates(bool force = false);
+    void clearPendingVotes();
+    static uint64_t getLobbyUpdateInterval();
     void updateServerOwner();
     void handleServerConfiguration(Event* event);
     void updateTracksForMode();
@@ -260,6 +291,7 @@ private:
     void checkRaceFinished();
     std::pair<int, float> getHitCaptureLimit(float num_karts);
     void configPeersStartTime();
+    void applyTickRates();
     void updateWaitingPlayers();
     void resetServer();
     void addWaitingPlayersToGame();
@@ -273,6 +305,7 @@ public:
     virtual void setup() OVERRIDE;
     virtual void update(int ticks) OVERRIDE;
     virtual void asynchronousUpdate() OVERRIDE;
+    virtual unsigned getAsynchronousUpdateDelay() OVERRIDE;
 
     void startSelection(const Event *event=NULL);
     void checkIncomingConnectionRequests();
@@ -34,7 +34,8 @@ class Item;
  *  server to all clients. This object then triggers the right message
  *  from the various running protocols.
 */
-class RaceEventManager : public AbstractSingleton<RaceEventManager>
+class RaceEventManager
+    : public AbstractSingleton<RaceEventManager, /*per_room*/true>
 {
 private:
     bool m_running;
@@ -42,7 +43,7 @@ private:
 
     std::weak_ptr<GameEventsProtocol> m_game_events_protocol;
 
-    friend class AbstractSingleton<RaceEventManager>;
+    friend class AbstractSingleton<RaceEventManager, /*per_room*/true>;
 
              RaceEventManager();
     virtual ~RaceEventManager();
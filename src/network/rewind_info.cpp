@@ -23,6 +23,169 @@
 #include "network/rewind_manager.hpp"
 #include "items/projectile_manager.hpp"
 
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+// ----------------------------------------------------------------------------
+/** Rewind infos are created for every event and state of every time step,
+ *  and freed again when they are older than the oldest confirmed state. To
+ *  avoid a heap allocation for each of them, they are taken from a pool of
+ *  fixed size blocks, which are carved out of large contiguous chunks. The
+ *  chunks are never released, so the pool only grows to the peak number of
+ *  rewind infos alive at the same time.
+ *  Events and states are created on the network thread and freed on the
+ *  main thread, so each thread has its own free list, and blocks are only
+ *  moved between threads in batches through a central (locked) list. */
+const std::size_t BLOCK_SIZE =
+    (std::max(std::max(sizeof(RewindInfoState), sizeof(RewindInfoEvent)),
+              sizeof(RewindInfoEventFunction)) + alignof(std::max_align_t) - 1)
+    / alignof(std::max_align_t) * alignof(std::max_align_t);
+const int BLOCKS_PER_CHUNK = 512;
+const int BATCH_SIZE       = 64;
+
+struct FreeBlock
+{
+    FreeBlock* m_next;
+};
+
+struct CentralPool
+{
+    std::mutex m_mutex;
+    /** Batches of free blocks (linked list and its length). */
+    std::vector<std::pair<FreeBlock*, int> > m_batches;
+    /** All chunks allocated, kept so that the memory stays reachable. */
+    std::vector<char*> m_chunks;
+};
+
+// ----------------------------------------------------------------------------
+CentralPool& getCentralPool()
+{
+    // Never destroyed, blocks might be freed by static destructors
+    static CentralPool* pool = new CentralPool();
+    return *pool;
+}   // getCentralPool
+
+// ----------------------------------------------------------------------------
+/** Set once the pool of this thread has been destroyed at thread exit. */
+thread_local bool g_local_pool_destroyed = false;
+
+struct LocalPool
+{
+    FreeBlock* m_free = NULL;
+    int        m_count = 0;
+    // ------------------------------------------------------------------------
+    /** Hands back all free blocks of an exiting thread. */
+    ~LocalPool()
+    {
+        g_local_pool_destroyed = true;
+        if (!m_free)
+            return;
+        CentralPool& central = getCentralPool();
+        std::lock_guard<std::mutex> lock(central.m_mutex);
+        central.m_batches.emplace_back(m_free, m_count);
+    }   // ~LocalPool
+};
+
+thread_local LocalPool g_local_pool;
+
+}   // anonymous namespace
+
+// ----------------------------------------------------------------------------
+/** Takes a block from the free list of the calling thread. If it is empty,
+ *  a batch of blocks is taken from the central pool, or a new chunk is
+ *  allocated if no free blocks are left at all.
+ */
+void* RewindInfo::operator new(std::size_t size)
+{
+    if (size > BLOCK_SIZE)
+        return ::operator new(size);
+    // Only possible in destructors of static objects
+    if (g_local_pool_destroyed)
+        return ::operator new(BLOCK_SIZE);
+
+    LocalPool& local = g_local_pool;
+    if (!local.m_free)
+    {
+        CentralPool& central = getCentralPool();
+        std::lock_guard<std::mutex> lock(central.m_mutex);
+        if (!central.m_batches.empty())
+        {
+            local.m_free  = central.m_batches.back().first;
+            local.m_count = central.m_batches.back().second;
+            central.m_batches.pop_back();
+        }
+        else
+        {
+            char* chunk = static_cast<char*>
+                (::operator new(BLOCK_SIZE * BLOCKS_PER_CHUNK));
+            central.m_chunks.push_back(chunk);
+            for (int i = BLOCKS_PER_CHUNK - 1; i >= 0; i--)
+            {
+                FreeBlock* b = reinterpret_cast<FreeBlock*>
+                    (chunk + i * BLOCK_SIZE);
+                b->m_next = local.m_free;
+                local.m_free = b;
+            }
+            local.m_count = BLOCKS_PER_CHUNK;
+        }
+    }
+    FreeBlock* b = local.m_free;
+    local.m_free = b->m_next;
+    local.m_count--;
+    return b;
+}   // operator new
+
+// ----------------------------------------------------------------------------
+/** Returns a block to the free list of the calling thread. If this thread
+ *  only frees rewind infos (which the main thread does for all infos
+ *  received from the network), a batch of blocks is handed back to the
+ *  central pool so that the network thread can reuse them.
+ */
+void RewindInfo::operator delete(void* p, std::size_t size)
+{
+    if (!p)
+        return;
+    if (size > BLOCK_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    if (g_local_pool_destroyed)
+    {
+        b->m_next = NULL;
+        CentralPool& central = getCentralPool();
+        std::lock_guard<std::mutex> lock(central.m_mutex);
+        central.m_batches.emplace_back(b, 1);
+        return;
+    }
+
+    LocalPool& local = g_local_pool;
+    b->m_next = local.m_free;
+    local.m_free = b;
+    local.m_count++;
+    if (local.m_count < 2 * BATCH_SIZE)
+        return;
+
+    FreeBlock* batch = local.m_free;
+    FreeBlock* last = batch;
+    for (int i = 1; i < BATCH_SIZE; i++)
+        last = last->m_next;
+    local.m_free = last->m_next;
+    local.m_count -= BATCH_SIZE;
+    last->m_next = NULL;
+
+    CentralPool& central = getCentralPool();
+    std::lock_guard<std::mutex> lock(central.m_mutex);
+    central.m_batches.emplace_back(batch, BATCH_SIZE);
+}   // operator delete
+
+// ============================================================================
+
 /** Constructor for a state: it only takes the size, and allocates a buffer
  *  for all state info.
  *  \param size Necessary buffer size for a state.
@@ -120,6 +283,54 @@ void RewindInfoState::restore()
     }   // for all rewinder
 }   // restore
 
+// ------------------------------------------------------------------------
+/** Tests if this (confirmed) state differs from the state each rewinder
+ *  predicted locally at the same time, i.e. if a rewind is necessary.
+ *  Rewinders which the server deliberately left out of this state (karts
+ *  far away from the receiving client) are not compared and never count
+ *  as diverged: the client keeps their predicted state, and if a rewind
+ *  is done they are restored from the local state at this time.
+ */
+bool RewindInfoState::hasDiverged()
+{
+    for (const std::string& name : m_rewinder_omitted)
+    {
+        std::shared_ptr<Rewinder> r =
+            RewindManager::get()->getRewinder(name);
+        if (r)
+            r->discardPredictedStates(getTicks());
+    }
+
+    m_buffer->reset();
+    m_buffer->skip(m_start_offset);
+    for (const std::string& name : m_rewinder_using)
+    {
+        const uint16_t data_size = m_buffer->getUInt16();
+        const unsigned current_offset_now = m_buffer->getCurrentOffset();
+        std::shared_ptr<Rewinder> r =
+            RewindManager::get()->getRewinder(name);
+        // A missing rewinder (e.g. a projectile) needs to be created
+        if (!r)
+            return true;
+
+        bool diverged = true;
+        try
+        {
+            diverged = r->hasDiverged(m_buffer, data_size, getTicks());
+        }
+        catch (std::exception& e)
+        {
+            Log::error("RewindInfoState", "Compare state error: %s",
+                e.what());
+        }
+        if (diverged)
+            return true;
+        m_buffer->reset();
+        m_buffer->skip(current_offset_now + data_size);
+    }   // for all rewinder
+    return false;
+}   // hasDiverged
+
 // ============================================================================
 RewindInfoEvent::RewindInfoEvent(int ticks, EventRewinder *event_rewinder,
                                  BareNetworkString *buffer, bool is_confirmed)
@@ -26,6 +26,7 @@
 #include "utils/ptr_vector.hpp"
 
 #include <assert.h>
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <vector>
@@ -69,6 +70,11 @@ public:
     // ------------------------------------------------------------------------
     virtual ~RewindInfo() { }
     // ------------------------------------------------------------------------
+    /** All rewind infos are allocated from a block pool, see
+     *  rewind_info.cpp. */
+    static void* operator new(std::size_t size);
+    static void  operator delete(void* p, std::size_t size);
+    // ------------------------------------------------------------------------
     /** Returns the time at which this RewindInfo was saved. */
     int getTicks() const { return m_ticks; }
     // ------------------------------------------------------------------------
@@ -94,6 +100,11 @@ class RewindInfoState: public RewindInfo
 private:
     std::vector<std::string> m_rewinder_using;
 
+    /** Rewinders which the server deliberately left out of this state
+     *  (e.g. far away karts). They are restored from the state saved
+     *  locally at the same time on a rewind. */
+    std::vector<std::string> m_rewinder_omitted;
+
     int m_start_offset;
 
     /** Pointer to the buffer which stores all states. */
@@ -111,9 +122,22 @@ public:
     // ------------------------------------------------------------------------
     virtual void restore();
     // ------------------------------------------------------------------------
+    bool hasDiverged();
+    // ------------------------------------------------------------------------
     /** Returns a pointer to the state buffer. */
     BareNetworkString *getBuffer() const { return m_buffer; }
     // ------------------------------------------------------------------------
+    void setRewinderOmitted(std::vector<std::string>& omitted)
+                                       { std::swap(m_rewinder_omitted, omitted); }
+    // ------------------------------------------------------------------------
+    /** Returns the rewinders whose data is in this state. */
+    const std::vector<std::string>& getRewinderUsing() const
+                                                  { return m_rewinder_using; }
+    // ------------------------------------------------------------------------
+    /** Returns the rewinders which were left out of this state. */
+    const std::vector<std::string>& getRewinderOmitted() const
+                                                { return m_rewinder_omitted; }
+    // ------------------------------------------------------------------------
     virtual bool isState() const { return true; }
     // ------------------------------------------------------------------------
     /** Called when going back in time to undo any rewind information.
@@ -18,6 +18,7 @@
 
 #include "network/rewind_manager.hpp"
 
+#include "config/stk_config.hpp"
 #include "graphics/irr_driver.hpp"
 #include "modes/world.hpp"
 #include "network/network_config.hpp"
@@ -29,27 +30,47 @@
 #include "race/history.hpp"
 #include "utils/log.hpp"
 #include "utils/profiler.hpp"
+#include "utils/string_utils.hpp"
+#include "utils/time.hpp"
 
 #include <algorithm>
+#include <chrono>
 
-RewindManager* RewindManager::m_rewind_manager = NULL;
+PerRoom<RewindManager*> RewindManager::m_rewind_manager;
 bool           RewindManager::m_enable_rewind_manager = false;
+RewindManager::RewindStatistics RewindManager::m_statistics;
+int            RewindManager::m_benchmark_latency_ms = -1;
+int            RewindManager::m_benchmark_jitter_ms = 0;
+
+// ----------------------------------------------------------------------------
+/** Returns the number of microseconds since the given time point. */
+static uint64_t getMicrosecondsSince(
+                           const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>
+        (std::chrono::steady_clock::now() - start).count();
+}   // getMicrosecondsSince
 
 /** Creates the singleton. */
 RewindManager *RewindManager::create()
 {
-    assert(!m_rewind_manager);
-    m_rewind_manager = new RewindManager();
-    return m_rewind_manager;
+    assert(!m_rewind_manager.get());
+    m_rewind_manager.get() = new RewindManager();
+    return m_rewind_manager.get();
 }   // create
 
 // ----------------------------------------------------------------------------
 /** Destroys the singleton. */
 void RewindManager::destroy()
 {
-    assert(m_rewind_manager);
-    delete m_rewind_manager;
-    m_rewind_manager = NULL;
+    assert(m_rewind_manager.get());
+    if (m_statistics.m_rewinds.load() > 0 ||
+        m_statistics.m_skipped_rewinds.load() > 0)
+    {
+        Log::info("RewindManager", "%s", getStatistics().c_str());
+    }
+    delete m_rewind_manager.get();
+    m_rewind_manager.get() = NULL;
 }   // destroy
 
 // ============================================================================
@@ -69,6 +90,7 @@ RewindManager::~RewindManager()
     for (RewindInfoEventFunction* rief : m_pending_rief)
         delete rief;
     m_pending_rief.clear();
+    clearBenchmarkStates();
 }   // ~RewindManager
 
 // ----------------------------------------------------------------------------
@@ -83,6 +105,24 @@ void RewindManager::reset()
     m_state_frequency =
         stk_config->getPhysicsFPS() / stk_config->m_network_state_frequeny;
 
+    m_statistics.m_rewinds.store(0);
+    m_statistics.m_skipped_rewinds.store(0);
+    m_statistics.m_replayed_ticks.store(0);
+    m_statistics.m_rewind_time.store(0);
+    m_statistics.m_replay_time.store(0);
+    m_statistics.m_restored_state_bytes.store(0);
+    m_statistics.m_start_time.store(StkTime::getRealTimeMs());
+    clearBenchmarkStates();
+    m_benchmark_random = 0;
+    m_benchmark_latency =
+        stk_config->time2Ticks(m_benchmark_latency_ms / 1000.0f);
+    m_benchmark_jitter =
+        stk_config->time2Ticks(m_benchmark_jitter_ms / 1000.0f);
+    m_local_kart_states.clear();
+    m_local_checkpoints.clear();
+    m_free_checkpoints.clear();
+    m_rewinders_omitted.store(false);
+
     if (!m_enable_rewind_manager) return;
 
     clearExpiredRewinder();
@@ -114,7 +154,8 @@ void RewindManager::addEvent(EventRewinder *event_rewinder,
 
 // ----------------------------------------------------------------------------
 /** Adds an event to the list of network rewind data. This function is
- *  threadsafe so can be called by the network thread. The data is synched
+ *  threadsafe so can be called by the ProtocolManager asynchronous thread
+ *  of this room. The data is synched
  *  to m_rewind_info by the main thread. The data to be stored must be
  *  allocated and not freed by the caller!
  *  \param time Time at which the event was recorded.
@@ -128,7 +169,8 @@ void RewindManager::addNetworkEvent(EventRewinder *event_rewinder,
 
 // ----------------------------------------------------------------------------
 /** Adds a state to the list of network rewind data. This function is
- *  threadsafe so can be called by the network thread. The data is synched
+ *  threadsafe so can be called by the ProtocolManager asynchronous thread
+ *  of this room. The data is synched
  *  to m_rewind_info by the main thread. The data to be stored must be
  *  allocated and not freed by the caller!
  *  \param time Time at which the event was recorded.
@@ -137,9 +179,33 @@ void RewindManager::addNetworkEvent(EventRewinder *event_rewinder,
 void RewindManager::addNetworkState(BareNetworkString *buffer, int ticks)
 {
     assert(NetworkConfig::get()->isClient());
+    // The rewind benchmark replaces the server states with its own states
+    if (isRewindBenchmark())
+    {
+        delete buffer;
+        return;
+    }
     m_rewind_queue.addNetworkState(buffer, ticks);
 }   // addNetworkState
 
+// ----------------------------------------------------------------------------
+/** Adds a state or event received from the server. This is called by the
+ *  ProtocolManager asynchronous thread of this room, which is the only
+ *  producer of the network rewind data.
+ *  In the rewind benchmark states received from a server are dropped, they
+ *  are replaced by the states of the benchmark.
+ *  \param ri The rewind info, the rewind queue takes over ownership.
+ */
+void RewindManager::addNetworkRewindInfo(RewindInfo* ri)
+{
+    if (isRewindBenchmark() && ri->isState())
+    {
+        delete ri;
+        return;
+    }
+    m_rewind_queue.addNetworkRewindInfo(ri);
+}   // addNetworkRewindInfo
+
 // ----------------------------------------------------------------------------
 /** Saves a state using the GameProtocol function to combine several
  *  independent rewinders to write one state.
@@ -207,6 +273,9 @@ void RewindManager::update(int ticks_not_used)
 
     m_not_rewound_ticks.store(ticks, std::memory_order_relaxed);
 
+    if (isRewindBenchmark())
+        deliverBenchmarkStates(ticks);
+
     if (ticks - m_last_saved_state < m_state_frequency)
         return;
 
@@ -214,12 +283,9 @@ void RewindManager::update(int ticks_not_used)
     clearExpiredRewinder();
     if (NetworkConfig::get()->isClient())
     {
-        auto& ret = m_local_state[ticks];
-        for (auto& p : m_all_rewinder)
-        {
-            if (auto r = p.second.lock())
-                ret.push_back(r->getLocalStateRestoreFunction());
-        }
+        saveLocalState(ticks);
+        if (isRewindBenchmark())
+            saveBenchmarkState(ticks);
     }
     else
     {
@@ -232,6 +298,53 @@ void RewindManager::update(int ticks_not_used)
     m_last_saved_state = ticks;
 }   // update
 
+// ----------------------------------------------------------------------------
+/** Saves the local state of a client at the given time: the local state of
+ *  each rewinder, the physics checkpoint, the states used to restore karts
+ *  left out of a confirmed state and the predicted states. A rewind replays
+ *  the ticks after a correction, so it saves them again for the ticks which
+ *  have a local state, otherwise a later rewind to such a tick would restore
+ *  the prediction from before the correction.
+ *  \param ticks Time at which the state is saved.
+ */
+void RewindManager::saveLocalState(int ticks)
+{
+    auto& ret = m_local_state[ticks];
+    ret.clear();
+    std::vector<uint8_t>& checkpoint = m_local_checkpoints[ticks];
+    if (checkpoint.empty() && !m_free_checkpoints.empty())
+    {
+        checkpoint.swap(m_free_checkpoints.back());
+        m_free_checkpoints.pop_back();
+    }
+    Physics::getInstance()->getPhysicsWorld()->saveCheckpoint(&checkpoint);
+    auto& kart_states = m_local_kart_states[ticks];
+    kart_states.clear();
+    const bool rewinders_omitted =
+        m_rewinders_omitted.load(std::memory_order_relaxed);
+    for (auto& p : m_all_rewinder)
+    {
+        if (auto r = p.second.lock())
+        {
+            ret.push_back(r->getLocalStateRestoreFunction());
+            std::shared_ptr<BareNetworkString> state;
+            if (stk_config->m_network_partial_rewind)
+                state = r->savePredictedState(ticks);
+            // Only needed once the server leaves rewinders out of its
+            // states, the predicted state is shared if there is one
+            if (!rewinders_omitted || !r->canBeOmitted())
+                continue;
+            if (!state)
+            {
+                std::vector<std::string> ru;
+                state.reset(r->saveState(&ru));
+            }
+            if (state)
+                kart_states[p.first] = state;
+        }
+    }
+}   // saveLocalState
+
 // ----------------------------------------------------------------------------
 /** Replays all events from the last event played till the specified time.
  *  \param world_ticks Up to (and inclusive) which time events will be replayed.
@@ -252,6 +365,9 @@ void RewindManager::playEventsTill(int world_ticks, int *ticks)
     // be getTime()+dt - world time has not been updated yet).
     m_rewind_queue.mergeNetworkData(world_ticks, &needs_rewind, &rewind_ticks);
 
+    if (needs_rewind && canSkipRewind(rewind_ticks))
+        needs_rewind = false;
+
     if (needs_rewind)
     {
         Log::setPrefix("Rewind");
@@ -276,6 +392,78 @@ void RewindManager::playEventsTill(int world_ticks, int *ticks)
     m_is_rewinding = false;
 }   // playEventsTill
 
+// ----------------------------------------------------------------------------
+/** Tests on a client if a rewind to the confirmed state at the given time
+ *  can be skipped. This is the case if the state of every rewinder in it
+ *  matches the state predicted locally at the same time, and no network
+ *  event was received in the past which has not been replayed yet. Karts
+ *  left out of the state (see RewindInfoState::hasDiverged()) do not
+ *  prevent skipping the rewind.
+ *  \param rewind_ticks Time of the confirmed state to rewind to.
+ */
+bool RewindManager::canSkipRewind(int rewind_ticks)
+{
+    // The benchmark feeds back the client's own states, which never diverge
+    if (!stk_config->m_network_partial_rewind || isRewindBenchmark() ||
+        m_rewind_queue.getLatestPastEvent() >= rewind_ticks)
+        return false;
+
+    RewindInfoState *state = m_rewind_queue.getConfirmedState(rewind_ticks);
+    if (!state || state->hasDiverged())
+        return false;
+
+    // All events before the state are included in the state
+    m_rewind_queue.resetLatestPastEvent();
+    m_statistics.m_skipped_rewinds.fetch_add(1, std::memory_order_relaxed);
+    clearLocalStatesUntil(rewind_ticks);
+    return true;
+}   // canSkipRewind
+
+// ----------------------------------------------------------------------------
+/** Removes all local states up to (and including) the given time, which
+ *  will not be needed anymore.
+ */
+void RewindManager::clearLocalStatesUntil(int ticks)
+{
+    m_local_state.erase(m_local_state.begin(),
+        m_local_state.upper_bound(ticks));
+    m_local_kart_states.erase(m_local_kart_states.begin(),
+        m_local_kart_states.upper_bound(ticks));
+    auto end = m_local_checkpoints.upper_bound(ticks);
+    for (auto it = m_local_checkpoints.begin(); it != end; it++)
+        m_free_checkpoints.push_back(std::move(it->second));
+    m_local_checkpoints.erase(m_local_checkpoints.begin(), end);
+}   // clearLocalStatesUntil
+
+// ----------------------------------------------------------------------------
+/** Restores the rewinders which the server left out of a confirmed state
+ *  from the states saved locally at the same time. Otherwise they would be
+ *  replayed from their current (future) state.
+ *  \param state The confirmed state.
+ */
+void RewindManager::restoreOmittedRewinders(const RewindInfoState* state)
+{
+    if (state->getRewinderOmitted().empty())
+        return;
+    auto it = m_local_kart_states.find(state->getTicks());
+    if (it == m_local_kart_states.end())
+    {
+        Log::warn("RewindManager", "Missing local kart states at ticks %d",
+            state->getTicks());
+        return;
+    }
+    for (const std::string& name : state->getRewinderOmitted())
+    {
+        auto kart_state = it->second.find(name);
+        std::shared_ptr<Rewinder> r = getRewinder(name);
+        if (kart_state == it->second.end() || !r)
+            continue;
+        BareNetworkString* buffer = kart_state->second.get();
+        buffer->reset();
+        r->restoreLocalState(buffer, buffer->size());
+    }
+}   // restoreOmittedRewinders
+
 // ----------------------------------------------------------------------------
 /** Adds a Rewinder to the list of all rewinders.
  *  \return true If successfully added, false otherwise.
@@ -302,6 +490,8 @@ bool RewindManager::addRewinder(std::shared_ptr<Rewinder> rewinder)
 void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
 {
     assert(!m_is_rewinding);
+    const auto rewind_start = std::chrono::steady_clock::now();
+    PROFILER_PUSH_CPU_MARKER("Rewind restore", 0x80, 0x80, 0xC0);
     bool is_history = history->replayHistory();
     history->setReplayHistory(false);
 
@@ -338,6 +528,24 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
 
     // Restore states from the exact rewind time
     // -----------------------------------------
+    // The physics checkpoint is restored first. It restores everything that
+    // is not part of a state, e.g. the wheels and contacts, and the karts
+    // left out of a state. The bodies which the state sets anyway are
+    // skipped.
+    auto checkpoint = m_local_checkpoints.find(exact_rewind_ticks);
+    if (checkpoint != m_local_checkpoints.end())
+    {
+        std::set<const btRigidBody*> state_bodies;
+        for (const std::string& name :
+             static_cast<RewindInfoState*>(current)->getRewinderUsing())
+        {
+            std::shared_ptr<Rewinder> r = getRewinder(name);
+            if (r && r->getStateBody())
+                state_bodies.insert(r->getStateBody());
+        }
+        Physics::getInstance()->getPhysicsWorld()
+            ->restoreCheckpoint(checkpoint->second, state_bodies);
+    }
     auto it = m_local_state.find(exact_rewind_ticks);
     if (it != m_local_state.end())
     {
@@ -346,13 +554,6 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
             if (restore_local_state)
                 restore_local_state();
         }
-        for (auto it = m_local_state.begin(); it != m_local_state.end();)
-        {
-            if (it->first <= exact_rewind_ticks)
-                it = m_local_state.erase(it);
-            else
-                break;
-        }
     }
     else
     {
@@ -364,10 +565,26 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
     while (current && current->getTicks() == exact_rewind_ticks && 
            current->isState()                                        )
     {
+        BareNetworkString *buffer =
+            static_cast<RewindInfoState*>(current)->getBuffer();
+        if (buffer)
+        {
+            m_statistics.m_restored_state_bytes.fetch_add(buffer->size(),
+                std::memory_order_relaxed);
+        }
         current->restore();
+        restoreOmittedRewinders(static_cast<RewindInfoState*>(current));
         m_rewind_queue.next();
         current = m_rewind_queue.getCurrent();
     }
+    clearLocalStatesUntil(exact_rewind_ticks);
+
+    PROFILER_POP_CPU_MARKER();
+    PROFILER_PUSH_CPU_MARKER("Rewind replay", 0x80, 0xC0, 0x80);
+    const auto replay_start = std::chrono::steady_clock::now();
+    m_statistics.m_replayed_ticks.fetch_add(
+        std::max(now_ticks - world->getTicksSinceStart(), 0),
+        std::memory_order_relaxed);
 
     // Now go forward through the list of rewind infos till we reach 'now':
     while (world->getTicksSinceStart() < now_ticks)
@@ -382,7 +599,16 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
 #endif
         world->updateTime(1);
 
+        // Update the local states with the corrected prediction, they are
+        // used by the next rewind and to test if it is needed
+        if (m_local_state.find(world->getTicksSinceStart()) !=
+            m_local_state.end())
+            saveLocalState(world->getTicksSinceStart());
     }   // while (world->getTicks() < current_ticks)
+    m_rewind_queue.resetLatestPastEvent();
+    m_statistics.m_replay_time.fetch_add(getMicrosecondsSince(replay_start),
+        std::memory_order_relaxed);
+    PROFILER_POP_CPU_MARKER();
 
     // Now compute the errors which need to be visually smoothed
     for (auto& p : m_all_rewinder)
@@ -394,8 +620,99 @@ void RewindManager::rewindTo(int rewind_ticks, int now_ticks)
     history->setReplayHistory(is_history);
     m_is_rewinding = false;
     mergeRewindInfoEventFunction();
+
+    m_statistics.m_rewinds.fetch_add(1, std::memory_order_relaxed);
+    m_statistics.m_rewind_time.fetch_add(getMicrosecondsSince(rewind_start),
+        std::memory_order_relaxed);
 }   // rewindTo
 
+// ----------------------------------------------------------------------------
+/** Returns a printable summary of the rewind statistics of the current
+ *  race. Can be called from any thread.
+ */
+std::string RewindManager::getStatistics()
+{
+    const uint64_t rewinds = m_statistics.m_rewinds.load();
+    const uint64_t replayed_ticks = m_statistics.m_replayed_ticks.load();
+    const uint64_t rewind_time = m_statistics.m_rewind_time.load();
+    const uint64_t replay_time = m_statistics.m_replay_time.load();
+    const uint64_t elapsed =
+        StkTime::getRealTimeMs() - m_statistics.m_start_time.load();
+    return StringUtils::insertValues(
+        "%s rewinds (%s/s), %s skipped, %s ticks replayed (%s per rewind), "
+        "%s us per replayed tick, %s state bytes restored, "
+        "%s%% of time spent rewinding.",
+        (unsigned)rewinds,
+        elapsed > 0 ? rewinds * 1000.0f / elapsed : 0.0f,
+        (unsigned)m_statistics.m_skipped_rewinds.load(),
+        (unsigned)replayed_ticks,
+        rewinds > 0 ? (float)replayed_ticks / rewinds : 0.0f,
+        replayed_ticks > 0 ? (float)replay_time / replayed_ticks : 0.0f,
+        (unsigned)m_statistics.m_restored_state_bytes.load(),
+        elapsed > 0 ? rewind_time / (10.0f * elapsed) : 0.0f);
+}   // getStatistics
+
+// ----------------------------------------------------------------------------
+/** Used in the rewind benchmark: saves the state of all rewinders like a
+ *  server would do, and schedules it to be received after the benchmark
+ *  latency (plus a random jitter).
+ *  \param ticks Time of the state.
+ */
+void RewindManager::saveBenchmarkState(int ticks)
+{
+    std::vector<std::string> rewinder_using;
+    BareNetworkString state;
+    for (auto& p : m_all_rewinder)
+    {
+        // The item events of a client are only predictions, which can not
+        // be restored like the confirmed events from a server
+        if (p.first == "N") continue;
+        auto r = p.second.lock();
+        BareNetworkString *buffer = r ? r->saveState(&rewinder_using) : NULL;
+        if (!buffer)
+            continue;
+        state.addUInt16((uint16_t)buffer->size());
+        state.getBuffer().insert(state.getBuffer().end(),
+            buffer->getBuffer().begin(), buffer->getBuffer().end());
+        delete buffer;
+    }
+
+    // A simple linear congruential generator, so that the benchmark does
+    // not depend on the (platform dependent) rand()
+    m_benchmark_random = m_benchmark_random * 1664525u + 1013904223u;
+    int jitter = m_benchmark_jitter > 0 ?
+        (m_benchmark_random >> 8) % (m_benchmark_jitter + 1) : 0;
+    RewindInfoState *ris = new RewindInfoState(ticks, 0, rewinder_using,
+        state.getBuffer());
+    m_benchmark_states.insert(
+        std::make_pair(ticks + m_benchmark_latency + jitter, ris));
+}   // saveBenchmarkState
+
+// ----------------------------------------------------------------------------
+/** Used in the rewind benchmark: adds all states which are 'received' at
+ *  the given time to the rewind queue, as if they came from the network.
+ *  \param ticks Current world time.
+ */
+void RewindManager::deliverBenchmarkStates(int ticks)
+{
+    while (!m_benchmark_states.empty() &&
+           m_benchmark_states.begin()->first <= ticks)
+    {
+        m_rewind_queue.addLocalNetworkRewindInfo(
+            m_benchmark_states.begin()->second);
+        m_benchmark_states.erase(m_benchmark_states.begin());
+    }
+}   // deliverBenchmarkStates
+
+// ----------------------------------------------------------------------------
+/** Frees all states of the rewind benchmark which were not delivered. */
+void RewindManager::clearBenchmarkStates()
+{
+    for (auto& p : m_benchmark_states)
+        delete p.second;
+    m_benchmark_states.clear();
+}   // clearBenchmarkStates
+
 // ----------------------------------------------------------------------------
 bool RewindManager::useLocalEvent() const
 {
@@ -21,6 +21,7 @@
 
 #include "network/rewind_queue.hpp"
 #include "utils/ptr_vector.hpp"
+#include "utils/server_room.hpp"
 #include "utils/synchronised.hpp"
 
 #include <assert.h>
@@ -35,6 +36,7 @@
 class Rewinder;
 class RewindInfo;
 class RewindInfoEventFunction;
+class RewindInfoState;
 class EventRewinder;
 
 /** \ingroup network
@@ -86,14 +88,66 @@ class RewindManager
 {
 private:
     /** Singleton pointer. */
-    static RewindManager *m_rewind_manager;
+    static PerRoom<RewindManager*> m_rewind_manager;
 
     /** En- or Disable the rewind manager. This is used to disable storing
      *  rewind data in case of local races only. */
     static bool           m_enable_rewind_manager;
 
+    /** Statistics about the rewinds of the current race. They are atomic
+     *  so they can be read from other threads (e.g. the network console). */
+    struct RewindStatistics
+    {
+        std::atomic<uint64_t> m_rewinds;
+        std::atomic<uint64_t> m_skipped_rewinds;
+        std::atomic<uint64_t> m_replayed_ticks;
+        /** Overall time spent in rewindTo, in microseconds. */
+        std::atomic<uint64_t> m_rewind_time;
+        /** Time spent replaying time steps, in microseconds. */
+        std::atomic<uint64_t> m_replay_time;
+        std::atomic<uint64_t> m_restored_state_bytes;
+        /** Real time at which the statistics were reset, in ms. */
+        std::atomic<uint64_t> m_start_time;
+    };
+    static RewindStatistics m_statistics;
+
+    /** Latency and maximum jitter (in ms) of the simulated server in the
+     *  rewind benchmark, latency is -1 if the benchmark is not used. */
+    static int m_benchmark_latency_ms;
+    static int m_benchmark_jitter_ms;
+
+    /** Latency and jitter of the rewind benchmark in ticks. They are
+     *  converted at each reset, since the physics rate can change when
+     *  connecting to a server. */
+    int m_benchmark_latency;
+    int m_benchmark_jitter;
+
+    /** In the rewind benchmark, the confirmed states waiting to be
+     *  'received', sorted by the time at which they will arrive. */
+    std::multimap<int, RewindInfoState*> m_benchmark_states;
+
+    /** Random generator for the jitter of the rewind benchmark, which is
+     *  seeded at each reset. */
+    uint32_t m_benchmark_random;
+
     std::map<int, std::vector<std::function<void()> > > m_local_state;
 
+    /** The states of the karts saved locally by a client at the same time
+     *  as m_local_state, once the server leaves karts out of its states.
+     *  They are used to restore these karts (see state-interest-distance),
+     *  and share the buffers of the predicted states of the karts. */
+    std::map<int, std::map<std::string, std::shared_ptr<BareNetworkString> > >
+        m_local_kart_states;
+
+    /** The physics checkpoints saved by a client at the same time as
+     *  m_local_state. */
+    std::map<int, std::vector<uint8_t> > m_local_checkpoints;
+
+    /** Buffers of checkpoints which are not needed anymore. They are reused
+     *  for the next checkpoints, so that saving a checkpoint does not need
+     *  to allocate memory. */
+    std::vector<std::vector<uint8_t> > m_free_checkpoints;
+
     /** A list of all objects that can be rewound. */
     std::map<std::string, std::weak_ptr<Rewinder> > m_all_rewinder;
 
@@ -117,6 +171,11 @@ private:
      *  rewinds. */
     std::atomic<int> m_not_rewound_ticks;
 
+    /** Set once the server left a rewinder out of a state, before that no
+     *  states to restore such rewinders are saved (see
+     *  state-interest-distance). */
+    std::atomic<bool> m_rewinders_omitted;
+
     std::vector<RewindInfoEventFunction*> m_pending_rief;
 
     RewindManager();
@@ -136,6 +195,13 @@ private:
     }
     // ------------------------------------------------------------------------
     void mergeRewindInfoEventFunction();
+    void saveLocalState(int ticks);
+    void clearLocalStatesUntil(int ticks);
+    void restoreOmittedRewinders(const RewindInfoState* state);
+    bool canSkipRewind(int rewind_ticks);
+    void saveBenchmarkState(int ticks);
+    void deliverBenchmarkStates(int ticks);
+    void clearBenchmarkStates();
 
 public:
     // First static functions to manage rewinding.
@@ -149,12 +215,28 @@ public:
     /** Returns if rewinding is enabled or not. */
     static bool isEnabled() { return m_enable_rewind_manager; }
     // ------------------------------------------------------------------------
+    /** Enables the rewind benchmark, in which a local race is rewound by
+     *  feeding its own states back to the rewind manager, as if they were
+     *  sent by a server with the given latency and jitter (in ms). The
+     *  rewind manager only runs in networked races, so the client still has
+     *  to be connected to a server, and the results depend on that race.
+     *  Replaying a recorded session without a server is not supported. */
+    static void setRewindBenchmark(int latency_ms, int jitter_ms)
+    {
+        m_benchmark_latency_ms = latency_ms;
+        m_benchmark_jitter_ms  = jitter_ms;
+    }   // setRewindBenchmark
+    // ------------------------------------------------------------------------
+    static bool isRewindBenchmark()     { return m_benchmark_latency_ms >= 0; }
+    // ------------------------------------------------------------------------
+    static std::string getStatistics();
+    // ------------------------------------------------------------------------
     /** Returns the singleton. This function will not automatically create
      *  the singleton. */
     static RewindManager *get()
     {
-        assert(m_rewind_manager);
-        return m_rewind_manager;
+        assert(m_rewind_manager.get());
+        return m_rewind_manager.get();
     }   // get
 
     // Non-static function declarations:
@@ -186,6 +268,13 @@ public:
     /** Returns true if currently a rewind is happening. */
     bool isRewinding() const { return m_is_rewinding; }
 
+    // ------------------------------------------------------------------------
+    /** Called by a client when it receives a state in which the server left
+     *  out rewinders. */
+    void setRewindersOmitted()
+    {
+        m_rewinders_omitted.store(true, std::memory_order_relaxed);
+    }   // setRewindersOmitted
     // ------------------------------------------------------------------------
     int getNotRewoundWorldTicks() const
     {
@@ -203,8 +292,7 @@ public:
     void addRewindInfoEventFunction(RewindInfoEventFunction* rief)
                                             { m_pending_rief.push_back(rief); }
     // ------------------------------------------------------------------------
-    void addNetworkRewindInfo(RewindInfo* ri)
-                                   { m_rewind_queue.addNetworkRewindInfo(ri); }
+    void addNetworkRewindInfo(RewindInfo* ri);
 
 };   // RewindManager
 
@@ -25,6 +25,7 @@
 #include "network/rewinder.hpp"
 #include "network/rewind_info.hpp"
 #include "network/rewind_manager.hpp"
+#include "utils/time.hpp"
 
 #include <algorithm>
 
@@ -44,6 +45,11 @@
  */
 RewindQueue::RewindQueue()
 {
+    m_all_rewind_info.resize(64);
+    m_first_ticks = m_end_ticks = 0;
+#ifdef DEBUG
+    m_network_producer.store(std::thread::id());
+#endif
     reset();
 }   // RewindQueue
 
@@ -62,54 +68,112 @@ RewindQueue::~RewindQueue()
  */
 void RewindQueue::reset()
 {
-    m_network_events.lock();
-
-    AllNetworkRewindInfo &info = m_network_events.getData();
-    for (AllNetworkRewindInfo::const_iterator i  = info.begin(); 
-                                              i != info.end(); ++i)
+    m_network_events.popAll(&m_pending_network_events);
+    for (RewindInfo *ri : m_pending_network_events)
+        delete ri;
+    m_pending_network_events.clear();
+    if (m_network_events.getOverflowCount() > 0)
     {
-        delete *i;
+        Log::info("RewindQueue", "%llu of %llu network events did not fit "
+                  "in the network event queue.",
+                  (unsigned long long)m_network_events.getOverflowCount(),
+                  (unsigned long long)m_network_events.getPushCount());
     }
-    m_network_events.getData().clear();
-    m_network_events.unlock();
 
-    AllRewindInfo::const_iterator i;
-    for (i = m_all_rewind_info.begin(); i != m_all_rewind_info.end(); ++i)
-        delete *i;
+    for (int ticks = m_first_ticks; ticks < m_end_ticks; ticks++)
+    {
+        TickRewindInfo &tri = getTickRewindInfo(ticks);
+        for (RewindInfo *ri : tri)
+            delete ri;
+        tri.clear();
+    }
 
-    m_all_rewind_info.clear();
-    m_current = m_all_rewind_info.end();
+    m_first_ticks   = m_end_ticks = 0;
+    m_current_ticks = 0;
+    m_current_index = 0;
     m_latest_confirmed_state_time = -1;
+    resetLatestPastEvent();
 }   // reset
 
+// ----------------------------------------------------------------------------
+/** If the current index is past the last rewind info of the current time
+ *  step, moves the current position to the next time step which contains a
+ *  rewind info (or to the end of the queue).
+ */
+void RewindQueue::skipEmptyTicks()
+{
+    while (m_current_ticks < m_end_ticks &&
+           m_current_index >= getTickRewindInfo(m_current_ticks).size())
+    {
+        m_current_ticks++;
+        m_current_index = 0;
+    }
+}   // skipEmptyTicks
+
+// ----------------------------------------------------------------------------
+/** Makes sure that the ring buffer can store at least min_size consecutive
+ *  time steps. The size is always kept at a power of 2 so that the slot for
+ *  a time step can be computed with a simple mask.
+ *  \param min_size Minimum number of time steps that must fit in the ring.
+ */
+void RewindQueue::resizeRing(unsigned min_size)
+{
+    unsigned size = (unsigned)m_all_rewind_info.size();
+    if (size >= min_size)
+        return;
+    while (size < min_size)
+        size *= 2;
+
+    std::vector<TickRewindInfo> ring(size);
+    for (int ticks = m_first_ticks; ticks < m_end_ticks; ticks++)
+        std::swap(ring[ticks & (size - 1)], getTickRewindInfo(ticks));
+    std::swap(ring, m_all_rewind_info);
+}   // resizeRing
+
 // ----------------------------------------------------------------------------
 /** Inserts a RewindInfo object in the list of all events at the correct time.
  *  If there are several RewindInfo at the exact same time, state RewindInfo
  *  will be insert at the front, and event info at the end of the RewindInfo
  *  with the same time.
+ *  If the current pointer is at the end of the queue, it will be set to
+ *  the new rewind info.
  *  \param ri The RewindInfo object to insert.
- *  \param update_current If set, the current pointer will be updated if
- *         necessary to point to the new event
  */
 void RewindQueue::insertRewindInfo(RewindInfo *ri)
 {
-    AllRewindInfo::iterator i = m_all_rewind_info.end();
+    const int ticks = ri->getTicks();
+    const bool at_end = m_current_ticks >= m_end_ticks;
+
+    if (m_first_ticks == m_end_ticks)
+    {
+        m_first_ticks = ticks;
+        m_end_ticks   = ticks + 1;
+    }
+    else if (ticks < m_first_ticks)
+    {
+        resizeRing(m_end_ticks - ticks);
+        m_first_ticks = ticks;
+    }
+    else if (ticks >= m_end_ticks)
+    {
+        resizeRing(ticks + 1 - m_first_ticks);
+        m_end_ticks = ticks + 1;
+    }
 
-    while (i != m_all_rewind_info.begin())
+    TickRewindInfo &tri = getTickRewindInfo(ticks);
+    const unsigned index = ri->isEvent() ? (unsigned)tri.size() : 0;
+    tri.insert(tri.begin() + index, ri);
+
+    if (at_end)
+    {
+        m_current_ticks = ticks;
+        m_current_index = index;
+    }
+    else if (ticks == m_current_ticks && index <= m_current_index)
     {
-        AllRewindInfo::iterator i_prev = i;
-        i_prev--;
-        // Now test if 'ri' needs to be inserted after the
-        // previous element, i.e. before the current element:
-        if ((*i_prev)->getTicks() < ri->getTicks()) break;
-        if ((*i_prev)->getTicks() == ri->getTicks() &&
-            ri->isEvent()                              ) break;
-        i = i_prev;
+        // Keep current pointing to the same rewind info
+        m_current_index++;
     }
-    if(m_current == m_all_rewind_info.end())
-        m_current = m_all_rewind_info.insert(i, ri);
-    else
-        m_all_rewind_info.insert(i, ri);  
 }   // insertRewindInfo
 
 // ----------------------------------------------------------------------------
@@ -152,8 +216,9 @@ void RewindQueue::addLocalState(BareNetworkString *buffer,
 
 // ----------------------------------------------------------------------------
 /** Adds an event to the list of network rewind data. This function is
- *  threadsafe so can be called by the network thread. The data is synched
- *  to m_tRewindInformation list by the main thread. The data to be stored
+ *  threadsafe so can be called by the ProtocolManager asynchronous thread,
+ *  which must be the only thread adding network data. The data is synched
+ *  to m_all_rewind_info by the main thread. The data to be stored
  *  must be allocated and not freed by the caller!
  *  \param buffer Pointer to the event data.
  *  \param ticks Time at which the event happened.
@@ -163,15 +228,14 @@ void RewindQueue::addNetworkEvent(EventRewinder *event_rewinder,
 {
     RewindInfo *ri = new RewindInfoEvent(ticks, event_rewinder,
                                          buffer, /*confirmed*/true);
-
-    m_network_events.lock();
-    m_network_events.getData().push_back(ri);
-    m_network_events.unlock();
+    checkNetworkProducer();
+    m_network_events.push(ri);
 }   // addNetworkEvent
 
 // ----------------------------------------------------------------------------
 /** Adds a state to the list of network rewind data. This function is
- *  threadsafe so can be called by the network thread. The data is synched
+ *  threadsafe so can be called by the ProtocolManager asynchronous thread,
+ *  which must be the only thread adding network data. The data is synched
  *  to RewindInfo list by the main thread. The data to be stored must be
  *  allocated and not freed by the caller!
  *  \param buffer Pointer to the event data.
@@ -180,10 +244,8 @@ void RewindQueue::addNetworkEvent(EventRewinder *event_rewinder,
 void RewindQueue::addNetworkState(BareNetworkString *buffer, int ticks)
 {
     RewindInfo *ri = new RewindInfoState(ticks, buffer, /*confirmed*/true);
-
-    m_network_events.lock();
-    m_network_events.getData().push_back(ri);
-    m_network_events.unlock();
+    checkNetworkProducer();
+    m_network_events.push(ri);
 }   // addNetworkState
 
 // ----------------------------------------------------------------------------
@@ -201,12 +263,9 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
                                    int *rewind_ticks)
 {
     *needs_rewind = false;
-    m_network_events.lock();
-    if(m_network_events.getData().empty())
-    {
-        m_network_events.unlock();
+    m_network_events.popAll(&m_pending_network_events);
+    if (m_pending_network_events.empty())
         return;
-    }
 
     // Merge all newly received network events into the main event list.
     // Only a client ever rewinds. So the rewind time should be the latest
@@ -216,8 +275,8 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
     // FIXME: making m_network_events sorted would prevent the need to 
     // go through the whole list of events
     int latest_confirmed_state = -1;
-    AllNetworkRewindInfo::iterator i = m_network_events.getData().begin();
-    while (i != m_network_events.getData().end())
+    AllNetworkRewindInfo::iterator i = m_pending_network_events.begin();
+    while (i != m_pending_network_events.end())
     {
         // Ignore any events that will happen in the future. The current
         // time step is world_ticks.
@@ -236,7 +295,7 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
                       (*i)->getTicks(),
                       m_latest_confirmed_state_time);
             delete *i;
-            i = m_network_events.getData().erase(i);
+            i = m_pending_network_events.erase(i);
             continue;
         }
 
@@ -277,6 +336,13 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
             if ((*i)->getTicks() > *rewind_ticks)
                 *rewind_ticks = (*i)->getTicks();
         }   // if client and ticks < world_ticks
+        else if (NetworkConfig::get()->isClient() &&
+                 (*i)->getTicks() < world_ticks && (*i)->isEvent() &&
+                 (*i)->getTicks() > m_latest_past_event_ticks)
+        {
+            // This event will only be replayed by the next rewind
+            m_latest_past_event_ticks = (*i)->getTicks();
+        }
 
         if ((*i)->isState() && (*i)->getTicks() > latest_confirmed_state &&
             (*i)->isConfirmed())
@@ -284,10 +350,8 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
             latest_confirmed_state = (*i)->getTicks();
         }
 
-        i = m_network_events.getData().erase(i);
-    }   // for i in m_network_events
-
-    m_network_events.unlock();
+        i = m_pending_network_events.erase(i);
+    }   // for i in m_pending_network_events
 
     if (latest_confirmed_state > m_latest_confirmed_state_time)
     {
@@ -319,21 +383,50 @@ void RewindQueue::mergeNetworkData(int world_ticks, bool *needs_rewind,
  */
 void RewindQueue::cleanupOldRewindInfo(int ticks)
 {
-    auto i = m_all_rewind_info.begin();
+    const int last = std::min(ticks, m_end_ticks);
+    if (last <= m_first_ticks)
+        return;
 
-    while ( (*i)->getTicks() < ticks)
+    for (int t = m_first_ticks; t < last; t++)
     {
-        if (m_current == i) next();
-        delete *i;
-        i = m_all_rewind_info.erase(i);
+        TickRewindInfo &tri = getTickRewindInfo(t);
+        for (RewindInfo *ri : tri)
+            delete ri;
+        tri.clear();
     }
 
+    if (m_current_ticks < last)
+    {
+        m_current_ticks = last;
+        m_current_index = 0;
+        skipEmptyTicks();
+    }
+    m_first_ticks = last;
 }   // cleanupOldRewindInfo
 
+// ----------------------------------------------------------------------------
+/** Returns the confirmed state at the given time, or NULL if there is none.
+ *  \param ticks Time of the state.
+ */
+RewindInfoState* RewindQueue::getConfirmedState(int ticks)
+{
+    if (ticks < m_first_ticks || ticks >= m_end_ticks)
+        return NULL;
+    // States are stored before events
+    for (RewindInfo *ri : getTickRewindInfo(ticks))
+    {
+        if (!ri->isState())
+            break;
+        if (ri->isConfirmed())
+            return static_cast<RewindInfoState*>(ri);
+    }
+    return NULL;
+}   // getConfirmedState
+
 // ----------------------------------------------------------------------------
 bool RewindQueue::isEmpty() const
 {
-    return m_current == m_all_rewind_info.end();
+    return m_current_ticks >= m_end_ticks;
 }   // isEmpty
 
 // ----------------------------------------------------------------------------
@@ -341,9 +434,24 @@ bool RewindQueue::isEmpty() const
  */
 bool RewindQueue::hasMoreRewindInfo() const
 {
-    return m_current != m_all_rewind_info.end();
+    return m_current_ticks < m_end_ticks;
 }   // hasMoreRewindInfo
 
+// ----------------------------------------------------------------------------
+/** Returns all rewind infos in the order in which they are stored. Only used
+ *  for testing.
+ */
+std::vector<RewindInfo*> RewindQueue::getAllRewindInfo() const
+{
+    std::vector<RewindInfo*> all;
+    for (int ticks = m_first_ticks; ticks < m_end_ticks; ticks++)
+    {
+        const TickRewindInfo &tri = getTickRewindInfo(ticks);
+        all.insert(all.end(), tri.begin(), tri.end());
+    }
+    return all;
+}   // getAllRewindInfo
+
 // ----------------------------------------------------------------------------
 /** Rewinds the rewind queue and undos all events/states stored. It stops
  *  when the first confirmed state is reached that was recorded before the
@@ -353,29 +461,43 @@ bool RewindQueue::hasMoreRewindInfo() const
  */
 int RewindQueue::undoUntil(int undo_ticks)
 {
-    // A rewind is done after a state in the past is inserted. This function
-    // makes sure that m_current is not end()
-    //assert(m_current != m_all_rewind_info.end());
-    assert(!m_all_rewind_info.empty());
-    m_current = m_all_rewind_info.end();
-    m_current--;
-    while((*m_current)->getTicks() > undo_ticks ||
-        (*m_current)->isEvent() || !(*m_current)->isConfirmed())
+    // A rewind is done after a state in the past is inserted, so the
+    // queue is not empty, and the last time step always contains at least
+    // one rewind info.
+    assert(m_first_ticks < m_end_ticks);
+    m_current_ticks = m_end_ticks - 1;
+    m_current_index = (unsigned)getTickRewindInfo(m_current_ticks).size() - 1;
+    RewindInfo *current = getCurrent();
+    while (current->getTicks() > undo_ticks ||
+           current->isEvent() || !current->isConfirmed())
     {
         // Undo all events and states from the current time
-        (*m_current)->undo();
-        if(m_current == m_all_rewind_info.begin())
+        current->undo();
+        if (m_current_index > 0)
         {
-            // This shouldn't happen, but add some debug info just in case
-            Log::error("undoUntil",
-                       "At %d rewinding to %d current = %d = begin",
-                       World::getWorld()->getTicksSinceStart(), undo_ticks, 
-                       (*m_current)->getTicks());
+            m_current_index--;
         }
-        m_current--;
+        else
+        {
+            int ticks = m_current_ticks - 1;
+            while (ticks >= m_first_ticks && getTickRewindInfo(ticks).empty())
+                ticks--;
+            if (ticks < m_first_ticks)
+            {
+                // This shouldn't happen, but add some debug info just in case
+                Log::error("undoUntil",
+                           "At %d rewinding to %d current = %d = begin",
+                           World::getWorld()->getTicksSinceStart(),
+                           undo_ticks, current->getTicks());
+                break;
+            }
+            m_current_ticks = ticks;
+            m_current_index = (unsigned)getTickRewindInfo(ticks).size() - 1;
+        }
+        current = getCurrent();
     }
 
-    return (*m_current)->getTicks();
+    return current->getTicks();
 }   // undoUntil
 
 // ----------------------------------------------------------------------------
@@ -385,11 +507,12 @@ int RewindQueue::undoUntil(int undo_ticks)
 void RewindQueue::replayAllEvents(int ticks)
 {
     // Replay all events that happened at the current time step
-    while ( hasMoreRewindInfo() && (*m_current)->getTicks() == ticks )
+    while (hasMoreRewindInfo() && m_current_ticks == ticks)
     {
-        if ((*m_current)->isEvent())
-            (*m_current)->replay();
-        m_current++;
+        RewindInfo *ri = getCurrent();
+        if (ri->isEvent())
+            ri->replay();
+        next();
     }   // while current->getTIcks == ticks
 
 }   // replayAllEvents
@@ -415,57 +538,52 @@ void RewindQueue::unitTesting()
     assert(!q0.hasMoreRewindInfo());
 
     q0.addLocalState(NULL, /*confirmed*/true, 0);
-    assert(q0.m_all_rewind_info.front()->isState());
-    assert(!q0.m_all_rewind_info.front()->isEvent());
+    assert(q0.getAllRewindInfo().front()->isState());
+    assert(!q0.getAllRewindInfo().front()->isEvent());
     assert(q0.hasMoreRewindInfo());
     assert(q0.undoUntil(0) == 0);
 
     q0.addNetworkEvent(dummy_rewinder.get(), NULL, 0);
     // Network events are not immediately merged
-    assert(q0.m_all_rewind_info.size() == 1);
+    assert(q0.getAllRewindInfo().size() == 1);
 
     bool needs_rewind;
     int rewind_ticks;
     int world_ticks = 0;
     q0.mergeNetworkData(world_ticks, &needs_rewind, &rewind_ticks);
     assert(q0.hasMoreRewindInfo());
-    assert(q0.m_all_rewind_info.size() == 2);
-    AllRewindInfo::iterator rii = q0.m_all_rewind_info.begin();
-    assert((*rii)->isState());
-    rii++;
-    assert((*rii)->isEvent());
+    std::vector<RewindInfo*> all = q0.getAllRewindInfo();
+    assert(all.size() == 2);
+    assert(all[0]->isState());
+    assert(all[1]->isEvent());
 
     // Another state must be sorted before the event:
     q0.addNetworkState(NULL, 0);
     assert(q0.hasMoreRewindInfo());
     q0.mergeNetworkData(world_ticks, &needs_rewind, &rewind_ticks);
-    assert(q0.m_all_rewind_info.size() == 3);
-    rii = q0.m_all_rewind_info.begin();
-    assert((*rii)->isState());
-    rii++;
-    assert((*rii)->isState());
-    rii++;
-    assert((*rii)->isEvent());
+    all = q0.getAllRewindInfo();
+    assert(all.size() == 3);
+    assert(all[0]->isState());
+    assert(all[1]->isState());
+    assert(all[2]->isEvent());
 
     // Test time base comparisons: adding an event to the end
     q0.addLocalEvent(dummy_rewinder.get(), NULL, true, 4);
     // Then adding an earlier event
     q0.addLocalEvent(dummy_rewinder.get(), NULL, false, 1);
-    // rii points to the 3rd element, the ones added just now
-    // should be elements4 and 5:
-    rii++;
-    assert((*rii)->getTicks()==1);
-    rii++;
-    assert((*rii)->getTicks()==4);
+    // The ones added just now should be elements 4 and 5:
+    all = q0.getAllRewindInfo();
+    assert(all.size() == 5);
+    assert(all[3]->getTicks()==1);
+    assert(all[4]->getTicks()==4);
 
     // Now test inserting an event first, then the state
     RewindQueue q1;
     q1.addLocalEvent(NULL, NULL, true, 5);
     q1.addLocalState(NULL, true, 5);
-    rii = q1.m_all_rewind_info.begin();
-    assert((*rii)->isState());
-    rii++;
-    assert((*rii)->isEvent());
+    all = q1.getAllRewindInfo();
+    assert(all[0]->isState());
+    assert(all[1]->isEvent());
 
     // Bugs seen before
     // ----------------
@@ -484,11 +602,11 @@ void RewindQueue::unitTesting()
     //    event, that m_current pooints to the first event, otherwise
     //    events with same time stamp will not be handled correctly.
     //    At this stage current points to the event at time 2 from above
-    AllRewindInfo::iterator current_old = b1.m_current;
+    RewindInfo *current_old = b1.getCurrent();
     b1.addLocalEvent(NULL, NULL, true, 2);
     // Make sure that current was not modified, i.e. the new event at time
     // 2 was added at the end of the list:
-    if (current_old != b1.m_current)
+    if (current_old != b1.getCurrent())
         Log::fatal("RewindQueue", "current_old != b1.m_current");
 
     // This should not trigger an exception, now current points to the
@@ -497,7 +615,7 @@ void RewindQueue::unitTesting()
     assert(ri->getTicks() == 2);
     assert(ri->isEvent());
     b1.next();
-    assert(b1.m_current == b1.m_all_rewind_info.end());
+    assert(!b1.hasMoreRewindInfo());
 
     // 3) Test that if cleanupOldRewindInfo is called, it will if necessary
     //    adjust m_current to point to the latest confirmed state.
@@ -506,7 +624,88 @@ void RewindQueue::unitTesting()
     b2.addNetworkState(NULL, 2);
     b2.addNetworkState(NULL, 3);
     b2.mergeNetworkData(4, &needs_rewind, &rewind_ticks);
-    assert((*b2.m_current)->getTicks() == 3);
-
+    assert(b2.getCurrent()->getTicks() == 3);
+
+    // 4) Test that the order is kept when the ring buffer grows and wraps
+    //    around, and that undoing and cleaning up old time steps works
+    //    across several time steps.
+    RewindQueue b3;
+    b3.addLocalState(NULL, /*confirmed*/true, 100);
+    for (int ticks = 100; ticks < 400; ticks++)
+    {
+        b3.addLocalEvent(dummy_rewinder.get(), new BareNetworkString(),
+                         /*confirmed*/true, ticks);
+        if (ticks % 10 == 5)
+            b3.addLocalState(NULL, /*confirmed*/false, ticks);
+    }
+    all = b3.getAllRewindInfo();
+    assert(all.size() == 331);
+    for (unsigned i = 1; i < all.size(); i++)
+    {
+        assert(all[i - 1]->getTicks() <= all[i]->getTicks());
+        if (all[i - 1]->getTicks() == all[i]->getTicks())
+            assert(all[i - 1]->isState() && all[i]->isEvent());
+    }
+    // The only confirmed state is at time 100
+    assert(b3.undoUntil(250) == 100);
+    assert(b3.getCurrent()->isState());
+    b3.addLocalState(NULL, /*confirmed*/true, 300);
+    assert(b3.getCurrent()->getTicks() == 300);
+    assert(b3.getCurrent()->isState());
+    assert(b3.getAllRewindInfo().size() == 111);
+
+    // Rewind infos are pooled: a freed block is reused for the next info
+    RewindInfo* pooled = new RewindInfoEventFunction(0);
+    void* block = pooled;
+    delete pooled;
+    pooled = new RewindInfoEvent(0, dummy_rewinder.get(), NULL, true);
+    assert(pooled == block);
+    delete pooled;
 
 }   // unitTesting
+
+// ----------------------------------------------------------------------------
+/** A microbenchmark for the rewind queue, based on the scenarios of the
+ *  unit tests above: a client with a high ping adds an event and a local
+ *  state in each time step, and every few time steps receives a confirmed
+ *  state from the server which is in the past. This triggers the same
+ *  sequence of merging, undoing and replaying the queue that the
+ *  RewindManager does.
+ */
+void RewindQueue::benchmark()
+{
+    auto dummy_rewinder = std::make_shared<DummyRewinder>();
+    const int ping_ticks     = 60;
+    const int state_interval = 6;
+    const int total_ticks    = 20000;
+
+    RewindQueue q;
+    uint64_t start = StkTime::getRealTimeMs();
+    for (int world_ticks = 0; world_ticks < total_ticks; world_ticks++)
+    {
+        q.addLocalEvent(dummy_rewinder.get(), new BareNetworkString(4),
+                        /*confirmed*/true, world_ticks);
+        q.addLocalState(NULL, /*confirmed*/false, world_ticks);
+        if (world_ticks % state_interval == 0)
+        {
+            q.addNetworkState(NULL, std::max(0, world_ticks - ping_ticks));
+            q.addNetworkEvent(dummy_rewinder.get(), new BareNetworkString(4),
+                              std::max(0, world_ticks - ping_ticks + 1));
+        }
+
+        bool needs_rewind;
+        int rewind_ticks;
+        q.mergeNetworkData(world_ticks, &needs_rewind, &rewind_ticks);
+        if (needs_rewind)
+        {
+            int ticks = q.undoUntil(rewind_ticks);
+            while (ticks < world_ticks)
+                q.replayAllEvents(ticks++);
+        }
+        q.replayAllEvents(world_ticks);
+    }
+    uint64_t duration = StkTime::getRealTimeMs() - start;
+    Log::info("RewindQueue", "Benchmark: %d ticks with %d ticks ping in "
+              "%d ms, %f microseconds per tick.", total_ticks, ping_ticks,
+              (int)duration, duration * 1000.0f / total_ticks);
+}   // benchmark
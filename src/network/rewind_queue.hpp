@@ -19,15 +19,17 @@
 #ifndef HEADER_REWIND_QUEUE_HPP
 #define HEADER_REWIND_QUEUE_HPP
 
-#include "utils/synchronised.hpp"
+#include "utils/spsc_queue.hpp"
 
 #include <assert.h>
-#include <list>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 class BareNetworkString;
 class EventRewinder;
 class RewindInfo;
+class RewindInfoState;
 class TimeStepInfo;
 
 /** \ingroup network
@@ -37,29 +39,87 @@ class RewindQueue
 {
 private:
 
-    typedef std::list<RewindInfo*> AllRewindInfo;
-
-    AllRewindInfo m_all_rewind_info;
+    /** All rewind infos of one time step. States are always stored before
+     *  the events of the same time step. */
+    typedef std::vector<RewindInfo*> TickRewindInfo;
+
+    /** A ring buffer indexed by ticks (modulo its size, which is always a
+     *  power of 2), so the rewind infos of a time step can be found without
+     *  walking through all rewind infos. It stores the time steps from
+     *  m_first_ticks up to (excluding) m_end_ticks. */
+    std::vector<TickRewindInfo> m_all_rewind_info;
+
+    /** The oldest time step stored. */
+    int m_first_ticks;
+
+    /** One after the latest time step stored, the queue is empty if this is
+     *  equal to m_first_ticks. */
+    int m_end_ticks;
+
+    /** All events received from the network. They are added by the
+     *  ProtocolManager asynchronous thread of the room of this queue (which
+     *  is the only producer), and merged into m_all_rewind_info from the
+     *  main thread. This design (as opposed to locking m_all_rewind_info)
+     *  avoids any locking between main thread and protocol thread. */
+    SPSCQueue<RewindInfo*> m_network_events;
+
+#ifdef DEBUG
+    /** The thread which pushed to m_network_events first, all later pushes
+     *  must be done by the same thread. */
+    std::atomic<std::thread::id> m_network_producer;
+#endif
 
-    /** The list of all events received from the network. They are stored
-     *  in a separate thread (so this data structure is thread-save), and
-     *  merged into m_rewind_info from the main thread. This design (as
-     *  opposed to locking m_rewind_info) reduces the synchronisation
-     *  between main thread and network thread. */
+    /** Network events taken from m_network_events which are not merged yet
+     *  (since they are in the future). Only accessed from the main thread.
+     */
     typedef std::vector<RewindInfo*> AllNetworkRewindInfo;
-    Synchronised<AllNetworkRewindInfo> m_network_events;
+    AllNetworkRewindInfo m_pending_network_events;
 
-    /** Iterator to the curren time step info to be handled. */
-    AllRewindInfo::iterator m_current;
+    /** Time step and index in this time step of the current rewind info to
+     *  be handled. If there is no more rewind info, m_current_ticks is
+     *  m_end_ticks. */
+    int m_current_ticks;
+    unsigned m_current_index;
 
     /** Time at which the latest confirmed state is at. */
     int m_latest_confirmed_state_time;
 
+    /** The latest time of a network event that was merged in the past of
+     *  a client, and which has not been replayed by a rewind yet. */
+    int m_latest_past_event_ticks;
 
+    // ------------------------------------------------------------------------
+    /** Returns the rewind infos of the given time step. */
+    TickRewindInfo& getTickRewindInfo(int ticks)
+    {
+        return m_all_rewind_info[ticks & (m_all_rewind_info.size() - 1)];
+    }   // getTickRewindInfo
+    // ------------------------------------------------------------------------
+    const TickRewindInfo& getTickRewindInfo(int ticks) const
+    {
+        return m_all_rewind_info[ticks & (m_all_rewind_info.size() - 1)];
+    }   // getTickRewindInfo
+    // ------------------------------------------------------------------------
+    /** In debug builds checks that m_network_events has only one producer,
+     *  i.e. that it is always the same thread adding network data. */
+    void checkNetworkProducer()
+    {
+#ifdef DEBUG
+        std::thread::id producer;
+        const std::thread::id self = std::this_thread::get_id();
+        if (!m_network_producer.compare_exchange_strong(producer, self))
+            assert(producer == self);
+#endif
+    }   // checkNetworkProducer
+    // ------------------------------------------------------------------------
+    void skipEmptyTicks();
+    void resizeRing(unsigned min_size);
+    std::vector<RewindInfo*> getAllRewindInfo() const;
     void cleanupOldRewindInfo(int ticks);
 
 public:
         static void unitTesting();
+        static void benchmark();
 
          RewindQueue();
         ~RewindQueue();
@@ -72,9 +132,17 @@ public:
     void addNetworkState(BareNetworkString *buffer, int ticks);
     void addNetworkRewindInfo(RewindInfo* ri)
     {
-        m_network_events.lock();
-        m_network_events.getData().push_back(ri);
-        m_network_events.unlock();
+        checkNetworkProducer();
+        m_network_events.push(ri);
+    }
+    // ------------------------------------------------------------------------
+    /** Adds network rewind data which was created on the main thread (by
+     *  the rewind benchmark). It bypasses m_network_events, which only the
+     *  protocol thread may push to, and is merged with the next call of
+     *  mergeNetworkData(). */
+    void addLocalNetworkRewindInfo(RewindInfo* ri)
+    {
+        m_pending_network_events.push_back(ri);
     }
     void mergeNetworkData(int world_ticks,  bool *needs_rewind, 
                           int *rewind_ticks);
@@ -83,6 +151,7 @@ public:
     bool hasMoreRewindInfo() const;
     int  undoUntil(int undo_ticks);
     void insertRewindInfo(RewindInfo *ri);
+    RewindInfoState* getConfirmedState(int ticks);
 
     // ------------------------------------------------------------------------
     /** Returns the time of the latest confirmed state. */
@@ -91,13 +160,21 @@ public:
         return m_latest_confirmed_state_time;
     }
     // ------------------------------------------------------------------------
+    /** Returns the latest time of a network event that was merged in the
+     *  past and has not been replayed yet, or -1 if there is none. */
+    int getLatestPastEvent() const { return m_latest_past_event_ticks; }
+    // ------------------------------------------------------------------------
+    /** Called after a rewind (or if a rewind is not necessary), at which
+     *  point all events in the past are taken into account. */
+    void resetLatestPastEvent()              { m_latest_past_event_ticks = -1; }
+    // ------------------------------------------------------------------------
     /** Sets the current element to be the next one and returns the next
      *  RewindInfo element. */
     void next()
     {
-        assert(m_current != m_all_rewind_info.end());
-        m_current++;
-        return;
+        assert(m_current_ticks < m_end_ticks);
+        m_current_index++;
+        skipEmptyTicks();
     }   // operator++
 
     // ------------------------------------------------------------------------
@@ -105,7 +182,8 @@ public:
      *  least one more RewindInfo (see hasMoreRewindInfo()). */
     RewindInfo* getCurrent()
     {
-        return (m_current != m_all_rewind_info.end() ) ? *m_current : NULL;
+        return m_current_ticks < m_end_ticks ?
+            getTickRewindInfo(m_current_ticks)[m_current_index] : NULL;
     }   // getNext
 
 };   // RewindQueue
@@ -26,6 +26,7 @@
 #include <vector>
 
 class BareNetworkString;
+class btRigidBody;
 
 class Rewinder : public std::enable_shared_from_this<Rewinder>
 {
@@ -84,6 +85,54 @@ public:
     virtual std::function<void()> getLocalStateRestoreFunction()
                                                              { return nullptr; }
     // -------------------------------------------------------------------------
+    /** Called on a client each time a local state is saved. A rewinder can
+     *  save its predicted state here, so that it can later be compared with
+     *  the confirmed state from the server (see hasDiverged()).
+     *  \param ticks Time at which the state is saved.
+     *  \return The saved state (as written by saveState()) or NULL, the
+     *          rewind manager keeps it to restore a rewinder which the server
+     *          left out of a state. */
+    virtual std::shared_ptr<BareNetworkString> savePredictedState(int ticks)
+                                                             { return nullptr; }
+    // -------------------------------------------------------------------------
+    /** Returns true if the server can leave this rewinder out of a state
+     *  (see state-interest-distance). A client then keeps its local state to
+     *  restore it in a rewind (see restoreLocalState()). */
+    virtual bool canBeOmitted() const                          { return false; }
+    // -------------------------------------------------------------------------
+    /** Called on a client before a rewind to test if the confirmed state
+     *  from the server differs from the state predicted at the same time.
+     *  If no rewinder has diverged the rewind can be skipped. The default
+     *  implementation assumes the state has diverged, so a rewind is done.
+     *  \param buffer The buffer with the confirmed state, which does not
+     *         need to be read completely.
+     *  \param count Number of bytes of this rewinder's state.
+     *  \param ticks Time of the state. */
+    virtual bool hasDiverged(BareNetworkString *buffer, int count, int ticks)
+                                                                { return true; }
+    // -------------------------------------------------------------------------
+    /** Called on a client for a rewinder that the server deliberately left
+     *  out of the confirmed state at the given time. It is not compared
+     *  with this state, so the predicted states up to this time are not
+     *  needed anymore.
+     *  \param ticks Time of the state. */
+    virtual void discardPredictedStates(int ticks) {}
+    // -------------------------------------------------------------------------
+    /** Called on a client for a rewinder that the server left out of a
+     *  confirmed state, to restore the state it saved locally at the same
+     *  time. The physics checkpoint of that time was restored before, so
+     *  a rewinder does not need to restore the data of its rigid body
+     *  again. The default implementation restores the complete state.
+     *  \param buffer The buffer with the local state.
+     *  \param count Number of bytes of this rewinder's state. */
+    virtual void restoreLocalState(BareNetworkString *buffer, int count)
+                                               { restoreState(buffer, count); }
+    // -------------------------------------------------------------------------
+    /** Returns the rigid body which restoreState() sets completely from a
+     *  confirmed state, or NULL. The physics checkpoint does not restore
+     *  this body if a confirmed state of this rewinder is restored. */
+    virtual const btRigidBody* getStateBody() const            { return NULL; }
+    // -------------------------------------------------------------------------
     const std::string& getUniqueIdentity() const
     {
         assert(!m_unique_identity.empty() && m_unique_identity.size() < 255);
@@ -33,10 +33,13 @@ static std::vector<UserConfigParam*> g_server_params;
 #include "network/server_config.hpp"
 #include "config/stk_config.hpp"
 #include "io/file_manager.hpp"
+#include "items/projectile_manager.hpp"
 #include "network/game_setup.hpp"
-#include "network/protocols/lobby_protocol.hpp"
+#include "network/protocol_manager.hpp"
+#include "network/protocols/server_lobby.hpp"
 #include "network/stk_host.hpp"
 #include "race/race_manager.hpp"
+#include "utils/server_room.hpp"
 #include "utils/string_utils.hpp"
 
 #include <fstream>
@@ -295,19 +298,7 @@ void loadServerLobbyFromConfig()
         race_manager->getMajorMode() == RaceManager::MAJOR_MODE_GRAND_PRIX;
     const bool is_battle = race_manager->isBattleMode();
 
-    std::shared_ptr<LobbyProtocol> server_lobby;
-    server_lobby = STKHost::create();
-
-    if (is_soccer)
-    {
-        server_lobby->getGameSetup()
-            ->setSoccerGoalTarget(m_soccer_goal_target);
-    }
-    else if (is_gp)
-    {
-        server_lobby->getGameSetup()->setGrandPrixTrack(m_gp_track_count);
-    }
-    else if (is_battle)
+    if (is_battle)
     {
         if (m_hit_limit_threshold < 0.0f &&
             m_time_limit_threshold_ffa < 0.0f)
@@ -325,9 +316,43 @@ void loadServerLobbyFromConfig()
         }
     }
 
-    // The extra server info has to be set before server lobby started
-    if (server_lobby)
+    std::vector<std::shared_ptr<LobbyProtocol> > server_lobbies;
+    server_lobbies.push_back(STKHost::create());
+
+    // The other rooms share the host (and its socket) of the first room, but
+    // each has its own race manager, protocol manager and lobby
+    for (unsigned room = 1; STKHost::existHost() &&
+        room < ServerRoom::getCount(); room++)
+    {
+        ServerRoomScope scope(room);
+        race_manager = new RaceManager();
+        race_manager->setMinorMode(modes.first);
+        race_manager->setMajorMode(modes.second);
+        race_manager->setDifficulty(RaceManager::Difficulty(difficulty));
+        projectile_manager = new ProjectileManager();
+        ProtocolManager::createInstance();
+        server_lobbies.push_back(LobbyProtocol::create<ServerLobby>());
+    }
+
+    for (unsigned room = 0; room < server_lobbies.size(); room++)
+    {
+        std::shared_ptr<LobbyProtocol> server_lobby = server_lobbies[room];
+        if (!server_lobby)
+            continue;
+        if (is_soccer)
+        {
+            server_lobby->getGameSetup()
+                ->setSoccerGoalTarget(m_soccer_goal_target);
+        }
+        else if (is_gp)
+        {
+            server_lobby->getGameSetup()
+                ->setGrandPrixTrack(m_gp_track_count);
+        }
+        // The extra server info has to be set before server lobby started
+        ServerRoomScope scope(room);
         server_lobby->requestStart();
+    }
 }   // loadServerLobbyFromConfig
 
 // ----------------------------------------------------------------------------
@@ -295,10 +295,92 @@ namespace ServerConfig
         "Negative value to disable, and this option will always be disabled "
         "for LAN server."));
 
+    SERVER_CFG_PREFIX BoolServerConfigParam m_delta_state
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(false, "delta-state",
+        "Send game states as delta against the last state acknowledged by "
+        "each client instead of a full state, which reduces upload "
+        "bandwidth of server. A full state is sent if a client has not "
+        "acknowledged any recent state."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_state_interest_distance
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(-1.0f,
+        "state-interest-distance",
+        "Karts further away (in meters along the track or arena) than this "
+        "from all karts of a player are only sent to that player in every "
+        "far-state-interval game state, which reduces upload bandwidth of "
+        "server with many players. Negative value to disable."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_far_state_interval
+        SERVER_CFG_DEFAULT(IntServerConfigParam(3, "far-state-interval",
+        "Far away karts (see state-interest-distance) are only sent in every "
+        "this number of game states."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_physics_fps
+        SERVER_CFG_DEFAULT(IntServerConfigParam(0, "physics-fps",
+        "Number of physics steps per second (30 to 250), clients will use "
+        "the same value. 0 to use the default of stk_config.xml."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_max_cached_tracks
+        SERVER_CFG_DEFAULT(IntServerConfigParam(20, "max-cached-tracks",
+        "Maximum number of tracks whose collision meshes, graphs and "
+        "materials are kept in memory after a race (server only builds), "
+        "the least recently used tracks are freed first."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_state_frequency
+        SERVER_CFG_DEFAULT(IntServerConfigParam(0, "state-frequency",
+        "Number of game states sent per second (at most physics-fps), lower "
+        "values reduce cpu and upload bandwidth usage of server, higher "
+        "values reduce the prediction errors of clients. 0 to use the "
+        "default of stk_config.xml."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_input_frequency
+        SERVER_CFG_DEFAULT(IntServerConfigParam(-1, "input-frequency",
+        "Number of times per second clients send their kart actions (at "
+        "most physics-fps), 0 to send them with every frame, -1 to use the "
+        "default of stk_config.xml."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_max_packets_per_second
+        SERVER_CFG_DEFAULT(IntServerConfigParam(1000,
+        "max-packets-per-second", "Maximum number of packets per second "
+        "accepted from one IP address, excess packets are dropped before "
+        "they are processed. Players behind the same NAT share this limit. "
+        "0 to disable."));
+
+    SERVER_CFG_PREFIX IntServerConfigParam m_max_requests_per_second
+        SERVER_CFG_DEFAULT(IntServerConfigParam(5,
+        "max-requests-per-second", "Maximum number of LAN server queries and "
+        "direct connection requests per second accepted from one IP "
+        "address. 0 to disable."));
+
+    SERVER_CFG_PREFIX BoolServerConfigParam m_low_power_idle
+        SERVER_CFG_DEFAULT(BoolServerConfigParam(true, "low-power-idle",
+        "If no player is connected, the server waits for incoming packets "
+        "instead of running at full frame rate, to save cpu on hosts "
+        "running many servers."));
+
+    SERVER_CFG_PREFIX StringServerConfigParam m_metrics_file
+        SERVER_CFG_DEFAULT(StringServerConfigParam("", "metrics-file",
+        "File to which the server writes its metrics (tick time, bandwidth "
+        "and messages per peer and protocol, event queues, encryption time "
+        "and state size) in JSON format, relative paths are relative to "
+        "the server config file. Empty to disable."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_metrics_interval
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(10.0f, "metrics-interval",
+        "Time in seconds between two updates of the metrics file."));
+
+    SERVER_CFG_PREFIX FloatServerConfigParam m_lobby_update_interval
+        SERVER_CFG_DEFAULT(FloatServerConfigParam(0.1f,
+        "lobby-update-interval", "Minimum time in seconds between two "
+        "player list and vote updates sent to clients, changes in between "
+        "are merged and only the latest version is sent. 0 to merge only "
+        "changes which happen at the same time."));
+
     SERVER_CFG_PREFIX StringToUIntServerConfigParam m_server_ip_ban_list
         SERVER_CFG_DEFAULT(StringToUIntServerConfigParam("server-ip-ban-list",
-        "ip: IP in X.X.X.X/Y (CIDR) format for banning, use Y of 32 for a "
-        "specific ip, expired-time: unix timestamp to expire, "
+        "ip: IP in X.X.X.X/Y or IPv6 (CIDR) format for banning, use Y of 32 "
+        "for a specific ip, ranges may overlap, expired-time: unix timestamp "
+        "to expire, "
         "-1 (uint32_t max) for a permanent ban.",
         {{ "ban", "ip", "expired-time" }},
         { { "0.0.0.0/0", 0u } }));
@@ -313,7 +395,7 @@ namespace ServerConfig
 
     // ========================================================================
     /** Server version, will be advanced if there are protocol changes. */
-    static const uint32_t m_server_version = 4;
+    static const uint32_t m_server_version = 5;
     // ========================================================================
     void loadServerConfig(const std::string& path = "");
     // ------------------------------------------------------------------------
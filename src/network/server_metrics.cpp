@@ -0,0 +1,231 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "network/server_metrics.hpp"
+
+#include "network/protocol_manager.hpp"
+#include "network/server_config.hpp"
+#include "network/stk_host.hpp"
+#include "network/stk_peer.hpp"
+#include "network/transport_address.hpp"
+#include "utils/log.hpp"
+#include "utils/server_room.hpp"
+#include "utils/time.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool                  ServerMetrics::m_enabled = false;
+std::string           ServerMetrics::m_file;
+uint64_t              ServerMetrics::m_next_write_time = 0;
+std::vector<uint32_t> ServerMetrics::m_tick_times;
+std::atomic<uint64_t> ServerMetrics::m_messages_received[PROTOCOL_MAX];
+std::atomic<uint64_t> ServerMetrics::m_messages_sent[PROTOCOL_MAX];
+std::atomic<uint64_t> ServerMetrics::m_encrypted_packets(0);
+std::atomic<uint64_t> ServerMetrics::m_encryption_time(0);
+uint64_t              ServerMetrics::m_states = 0;
+uint64_t              ServerMetrics::m_state_bytes = 0;
+uint64_t              ServerMetrics::m_sent_state_bytes = 0;
+unsigned              ServerMetrics::m_max_state_bytes = 0;
+
+/** Names of the protocol types in the metrics file. */
+static const char* g_protocol_names[PROTOCOL_MAX] =
+{
+    "none", "connection", "lobby_room", "game_events", "controller_events",
+    "silent"
+};
+
+// ----------------------------------------------------------------------------
+/** Enables the metrics if a metrics file is set in the server config. Must
+ *  be called after the server config is loaded.
+ */
+void ServerMetrics::init()
+{
+    std::string file = ServerConfig::m_metrics_file;
+    if (file.empty())
+        return;
+
+    const bool absolute = file[0] == '/' || file[0] == '\\' ||
+        file.find(':') != std::string::npos;
+    const std::string dir = ServerConfig::getConfigDirectory();
+    if (!absolute && !dir.empty())
+        file = dir + "/" + file;
+
+    for (unsigned i = 0; i < PROTOCOL_MAX; i++)
+    {
+        m_messages_received[i].store(0);
+        m_messages_sent[i].store(0);
+    }
+    m_file = file;
+    m_enabled = true;
+    m_next_write_time = StkTime::getRealTimeMs() +
+        (uint64_t)(ServerConfig::m_metrics_interval * 1000.0f);
+    Log::info("ServerMetrics", "Writing server metrics to '%s'.",
+        m_file.c_str());
+}   // init
+
+// ----------------------------------------------------------------------------
+/** Writes the metrics file if the metrics interval has passed. Called once
+ *  per frame from the main thread.
+ */
+void ServerMetrics::update()
+{
+    if (!m_enabled || StkTime::getRealTimeMs() < m_next_write_time)
+        return;
+    const float interval = std::max(1.0f,
+        (float)ServerConfig::m_metrics_interval);
+    m_next_write_time = StkTime::getRealTimeMs() +
+        (uint64_t)(interval * 1000.0f);
+    writeFile();
+    m_tick_times.clear();
+    m_max_state_bytes = 0;
+}   // update
+
+// ----------------------------------------------------------------------------
+/** Writes the metrics to a temporary file, which then replaces the metrics
+ *  file, so a reader never sees a partly written file.
+ */
+void ServerMetrics::writeFile()
+{
+    const std::string tmp = m_file + ".tmp";
+    {
+        std::ofstream out(tmp.c_str(), std::ios::out | std::ios::trunc);
+        if (!out.is_open())
+        {
+            Log::warn("ServerMetrics", "Failed to open '%s'.", tmp.c_str());
+            return;
+        }
+        out << toJson();
+    }
+#ifdef WIN32
+    // rename does not replace an existing file on windows, elsewhere it
+    // replaces it atomically
+    std::remove(m_file.c_str());
+#endif
+    if (std::rename(tmp.c_str(), m_file.c_str()) != 0)
+    {
+        Log::warn("ServerMetrics", "Failed to write '%s'.",
+            m_file.c_str());
+    }
+}   // writeFile
+
+// ----------------------------------------------------------------------------
+/** Returns the current metrics in JSON format. Must be called from the main
+ *  thread.
+ */
+std::string ServerMetrics::toJson()
+{
+    std::ostringstream json;
+    json << "{\n  \"time\": " << (uint64_t)StkTime::getTimeSinceEpoch()
+        << ",\n";
+
+    std::vector<uint32_t> ticks = m_tick_times;
+    std::sort(ticks.begin(), ticks.end());
+    auto percentile = [&ticks](unsigned p) -> uint32_t
+    {
+        if (ticks.empty())
+            return 0;
+        return ticks[(ticks.size() - 1) * p / 100];
+    };
+    json << "  \"ticks\": " << ticks.size() << ",\n"
+        << "  \"tick_time_us\": { \"p50\": " << percentile(50)
+        << ", \"p90\": " << percentile(90) << ", \"p99\": "
+        << percentile(99) << ", \"max\": " << percentile(100) << " },\n";
+
+    json << "  \"states\": { \"count\": " << m_states << ", \"bytes\": "
+        << m_state_bytes << ", \"sent_bytes\": " << m_sent_state_bytes
+        << ", \"max_bytes\": " << m_max_state_bytes << " },\n";
+
+    json << "  \"encryption\": { \"packets\": " << m_encrypted_packets.load()
+        << ", \"time_us\": " << m_encryption_time.load() << " },\n";
+
+    // Each room has its own protocol manager, the events of all rooms are
+    // summed up and the queue depths are the largest of all rooms
+    uint64_t events[2] = { 0, 0 }, overflows[2] = { 0, 0 };
+    uint32_t max_depth[2] = { 0, 0 };
+    bool has_protocol_manager = false;
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+    {
+        ServerRoomScope scope(room);
+        auto pm = ProtocolManager::lock();
+        if (!pm)
+            continue;
+        has_protocol_manager = true;
+        for (unsigned i = 0; i < 2; i++)
+        {
+            const bool sync = i == 0;
+            events[i] += pm->getEventCount(sync);
+            overflows[i] += pm->getEventOverflowCount(sync);
+            max_depth[i] = std::max(max_depth[i],
+                pm->getAndResetMaxEventQueueDepth(sync));
+        }
+    }
+    if (has_protocol_manager)
+    {
+        json << "  \"events\": { \"sync\": " << events[0]
+            << ", \"async\": " << events[1]
+            << ", \"sync_overflows\": " << overflows[0]
+            << ", \"async_overflows\": " << overflows[1]
+            << ", \"max_sync_queue_depth\": " << max_depth[0]
+            << ", \"max_async_queue_depth\": " << max_depth[1] << " },\n";
+    }
+
+    for (int received = 1; received >= 0; received--)
+    {
+        json << (received ? "  \"messages_received\": {" :
+            "  \"messages_sent\": {");
+        for (unsigned i = 0; i < PROTOCOL_MAX; i++)
+        {
+            json << (i == 0 ? " \"" : ", \"") << g_protocol_names[i]
+                << "\": " << (received ? m_messages_received[i].load() :
+                m_messages_sent[i].load());
+        }
+        json << " },\n";
+    }
+
+    json << "  \"peers\": [";
+    if (STKHost::existHost())
+    {
+        bool first = true;
+        std::vector<std::shared_ptr<STKPeer> > peers;
+        for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+        {
+            ServerRoomScope scope(room);
+            auto room_peers = STKHost::get()->getPeers();
+            peers.insert(peers.end(), room_peers.begin(), room_peers.end());
+        }
+        for (auto& peer : peers)
+        {
+            json << (first ? "\n" : ",\n") << "    { \"host_id\": "
+                << peer->getHostId() << ", \"address\": \""
+                << peer->getAddress().toString() << "\", \"ping\": "
+                << peer->getAveragePing() << ", \"packets_received\": "
+                << peer->getPacketsReceived() << ", \"bytes_received\": "
+                << peer->getBytesReceived() << ", \"packets_sent\": "
+                << peer->getPacketsSent() << ", \"bytes_sent\": "
+                << peer->getBytesSent() << " }";
+            first = false;
+        }
+        if (!first)
+            json << "\n  ";
+    }
+    json << "]\n}\n";
+    return json.str();
+}   // toJson
@@ -0,0 +1,128 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SERVER_METRICS_HPP
+#define HEADER_SERVER_METRICS_HPP
+
+#include "network/protocol.hpp"
+#include "utils/types.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/** \ingroup network
+ *  Collects metrics of a running server and writes them periodically to
+ *  the metrics-file of the server config in JSON format, so a dedicated
+ *  server can be monitored without graphics or the network console.
+ *  Counters which are updated from the listening thread or the encryption
+ *  threads are atomic, everything else is only accessed from the main
+ *  thread. Counters are totals since the server started, except the tick
+ *  times and the maximum state size, which are reset after each write.
+ */
+class ServerMetrics
+{
+private:
+    /** True if a metrics file is written. */
+    static bool m_enabled;
+
+    /** Full path of the metrics file. */
+    static std::string m_file;
+
+    /** Real time in ms at which the metrics file is written next. */
+    static uint64_t m_next_write_time;
+
+    /** Duration of each tick (in microseconds) since the last write. */
+    static std::vector<uint32_t> m_tick_times;
+
+    /** Number of messages received and sent for each protocol type. */
+    static std::atomic<uint64_t> m_messages_received[PROTOCOL_MAX];
+    static std::atomic<uint64_t> m_messages_sent[PROTOCOL_MAX];
+
+    /** Number of encrypted packets and the time spent encrypting them, in
+     *  microseconds. */
+    static std::atomic<uint64_t> m_encrypted_packets;
+    static std::atomic<uint64_t> m_encryption_time;
+
+    /** Number of game states, their size before per-client encoding, the
+     *  size actually sent to all clients, and the largest state since the
+     *  last write. */
+    static uint64_t m_states;
+    static uint64_t m_state_bytes;
+    static uint64_t m_sent_state_bytes;
+    static unsigned m_max_state_bytes;
+
+    // ------------------------------------------------------------------------
+    static void writeFile();
+
+public:
+    static void init();
+    // ------------------------------------------------------------------------
+    static void update();
+    // ------------------------------------------------------------------------
+    static std::string toJson();
+    // ------------------------------------------------------------------------
+    /** Returns if metrics are collected. */
+    static bool isEnabled()                                { return m_enabled; }
+    // ------------------------------------------------------------------------
+    /** Adds the duration of one server tick, in microseconds. Must be called
+     *  from the main thread. */
+    static void addTickTime(uint32_t us)
+    {
+        // Keep memory bounded with a very long interval
+        if (m_tick_times.size() < 100000)
+            m_tick_times.push_back(us);
+    }   // addTickTime
+    // ------------------------------------------------------------------------
+    /** Counts a received message of the given protocol. */
+    static void addMessageReceived(ProtocolType type)
+    {
+        if (type < PROTOCOL_MAX)
+            m_messages_received[type].fetch_add(1, std::memory_order_relaxed);
+    }   // addMessageReceived
+    // ------------------------------------------------------------------------
+    /** Counts a sent message of the given protocol. */
+    static void addMessageSent(ProtocolType type)
+    {
+        if (type < PROTOCOL_MAX)
+            m_messages_sent[type].fetch_add(1, std::memory_order_relaxed);
+    }   // addMessageSent
+    // ------------------------------------------------------------------------
+    /** Adds the time needed to encrypt one packet, in microseconds. */
+    static void addEncryptionTime(uint64_t us)
+    {
+        m_encrypted_packets.fetch_add(1, std::memory_order_relaxed);
+        m_encryption_time.fetch_add(us, std::memory_order_relaxed);
+    }   // addEncryptionTime
+    // ------------------------------------------------------------------------
+    /** Adds a game state sent to the clients. Must be called from the main
+     *  thread.
+     *  \param size Size of the complete state.
+     *  \param sent_size Bytes sent for this state to all clients. */
+    static void addState(unsigned size, unsigned sent_size)
+    {
+        m_states++;
+        m_state_bytes += size;
+        m_sent_state_bytes += sent_size;
+        if (size > m_max_state_bytes)
+            m_max_state_bytes = size;
+    }   // addState
+
+};   // ServerMetrics
+
+#endif
@@ -22,6 +22,7 @@
 #include "config/user_config.hpp"
 #include "io/file_manager.hpp"
 #include "network/event.hpp"
+#include "network/flood_filter.hpp"
 #include "network/game_setup.hpp"
 #include "network/network_config.hpp"
 #include "network/network_console.hpp"
@@ -32,11 +33,15 @@
 #include "network/protocols/server_lobby.hpp"
 #include "network/protocol_manager.hpp"
 #include "network/server_config.hpp"
+#include "network/server_metrics.hpp"
 #include "network/stk_peer.hpp"
 #include "utils/log.hpp"
 #include "utils/separate_process.hpp"
+#include "utils/server_room.hpp"
 #include "utils/time.hpp"
 #include "utils/vs.hpp"
+#include "utils/worker_pool.hpp"
+#include "main_loop.hpp"
 
 #include <string.h>
 #if defined(WIN32)
@@ -261,10 +266,36 @@ STKHost::STKHost(bool server)
         addr.port = ServerConfig::m_server_port;
         if (addr.port == 0 && !UserConfigParams::m_random_server_port)
             addr.port = stk_config->m_server_port;
-        // Reserve 1 peer to deliver full server message
-        m_network = new Network(ServerConfig::m_server_max_players + 1,
+        // Reserve 1 peer to deliver full server message, all rooms share
+        // this host
+        m_network = new Network(
+            ServerConfig::m_server_max_players * ServerRoom::getCount() + 1,
             /*channel_limit*/EVENT_CHANNEL_COUNT, /*max_in_bandwidth*/0,
             /*max_out_bandwidth*/ 0, &addr, true/*change_port_if_bound*/);
+        // The calling thread encrypts as well, and a few threads are
+        // enough to hide the encryption cost for the maximum player count
+        const unsigned threads =
+            std::min(std::thread::hardware_concurrency(), 4u);
+        if (threads > 1)
+        {
+            m_encryption_pool.reset(new WorkerPool(threads - 1,
+                "STKHostEncrypt"));
+        }
+        // Allow a burst of one second worth of packets
+        if (ServerConfig::m_max_packets_per_second > 0)
+        {
+            m_packet_filter.reset(new FloodFilter(
+                ServerConfig::m_max_packets_per_second,
+                ServerConfig::m_max_packets_per_second));
+            m_network->getENetHost()->intercept =
+                STKHost::floodFilterCallback;
+        }
+        if (ServerConfig::m_max_requests_per_second > 0)
+        {
+            m_request_filter.reset(new FloodFilter(
+                ServerConfig::m_max_requests_per_second,
+                ServerConfig::m_max_requests_per_second));
+        }
     }
     else
     {
@@ -299,6 +330,8 @@ void STKHost::init()
     m_network          = NULL;
     m_exit_timeout.store(std::numeric_limits<uint64_t>::max());
     m_client_ping.store(0);
+    m_wakeup_socket    = ENET_SOCKET_NULL;
+    m_waiting_for_packets.store(false);
 
     // Start with initialising ENet
     // ============================
@@ -342,11 +375,16 @@ STKHost::~STKHost()
 
 //-----------------------------------------------------------------------------
 /** Called from the main thread when the network infrastructure is to be shut
- *  down.
+ *  down. Stops the protocols of all server rooms.
  */
 void STKHost::shutdown()
 {
-    ProtocolManager::lock()->abort();
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+    {
+        ServerRoomScope scope(room);
+        if (auto pm = ProtocolManager::lock())
+            pm->abort();
+    }
     destroy();
 }   // shutdown
 
@@ -657,6 +695,29 @@ bool STKHost::connect(const TransportAddress& address)
 void STKHost::startListening()
 {
     m_exit_timeout.store(std::numeric_limits<uint64_t>::max());
+    m_waiting_for_packets.store(false);
+    m_wakeup_socket = ENET_SOCKET_NULL;
+    if (NetworkConfig::get()->isServer() && ServerConfig::m_low_power_idle)
+    {
+        m_wakeup_socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+        enet_address_set_host(&m_wakeup_address, "127.0.0.1");
+        m_wakeup_address.port = 0;
+        if (m_wakeup_socket != ENET_SOCKET_NULL &&
+            (enet_socket_bind(m_wakeup_socket, &m_wakeup_address) != 0 ||
+             enet_socket_get_address(m_wakeup_socket, &m_wakeup_address)
+             != 0 ||
+             enet_socket_set_option(m_wakeup_socket, ENET_SOCKOPT_NONBLOCK,
+                                    1) != 0))
+        {
+            enet_socket_destroy(m_wakeup_socket);
+            m_wakeup_socket = ENET_SOCKET_NULL;
+        }
+        if (m_wakeup_socket == ENET_SOCKET_NULL)
+        {
+            Log::warn("STKHost", "Can not create wakeup socket, "
+                "low-power-idle is disabled.");
+        }
+    }
     m_listening_thread = std::thread(std::bind(&STKHost::mainLoop, this));
 }   // startListening
 
@@ -668,10 +729,88 @@ void STKHost::stopListening()
 {
     if (m_exit_timeout.load() == std::numeric_limits<uint64_t>::max())
         m_exit_timeout.store(0);
+    wakeUpListening();
     if (m_listening_thread.joinable())
         m_listening_thread.join();
+    if (m_wakeup_socket != ENET_SOCKET_NULL)
+    {
+        enet_socket_destroy(m_wakeup_socket);
+        m_wakeup_socket = ENET_SOCKET_NULL;
+    }
 }   // stopListening
 
+// ----------------------------------------------------------------------------
+/** Returns the server room a new peer is added to: the first room whose
+ *  lobby waits for players and is not full, otherwise the room with the
+ *  fewest peers (whose lobby then handles the peer like the lobby of a full
+ *  or racing server with one room).
+ */
+unsigned STKHost::getRoomForNewPeer() const
+{
+    const unsigned rooms = ServerRoom::getCount();
+    if (rooms == 1)
+        return 0;
+
+    std::vector<unsigned> peer_count(rooms, 0);
+    std::unique_lock<std::mutex> lock(m_peers_mutex);
+    for (auto& p : m_peers)
+        peer_count[p.second->getRoom()]++;
+    lock.unlock();
+
+    unsigned fewest_peers = 0;
+    for (unsigned room = 0; room < rooms; room++)
+    {
+        auto sl = LobbyProtocol::get<ServerLobby>(room);
+        if (sl &&
+            sl->getCurrentState() == ServerLobby::WAITING_FOR_START_GAME &&
+            peer_count[room] < (unsigned)ServerConfig::m_server_max_players)
+            return room;
+        if (peer_count[room] < peer_count[fewest_peers])
+            fewest_peers = room;
+    }
+    return fewest_peers;
+}   // getRoomForNewPeer
+
+// ----------------------------------------------------------------------------
+/** Creates the packet with the network timer, the pings of all peers of a
+ *  server room and the progress of its game, which is sent regularly to the
+ *  peers of the room. Must be called with m_peers_mutex locked.
+ *  \param room The server room.
+ *  \param sl The lobby of this room.
+ */
+ENetPacket* STKHost::createPingPacket(unsigned room,
+                                      std::shared_ptr<ServerLobby> sl) const
+{
+    std::vector<std::pair<uint32_t, uint32_t> > pings;
+    for (auto& p : m_peers)
+    {
+        if (p.second->getRoom() == room)
+            pings.emplace_back(p.second->getHostId(), p.second->getPing());
+    }
+    BareNetworkString ping_packet;
+    uint64_t network_timer = getNetworkTimer();
+    ping_packet.addUInt64(network_timer);
+    ping_packet.addUInt8((uint8_t)pings.size());
+    for (auto& p : pings)
+        ping_packet.addUInt32(p.first).addUInt32(p.second);
+    if (sl)
+    {
+        auto progress = sl->getGameStartedProgress();
+        ping_packet.addUInt32(progress.first)
+            .addUInt32(progress.second);
+    }
+    else
+    {
+        ping_packet.addUInt32(std::numeric_limits<uint32_t>::max())
+            .addUInt32(std::numeric_limits<uint32_t>::max());
+    }
+    ping_packet.getBuffer().insert(
+        ping_packet.getBuffer().begin(), g_ping_packet.begin(),
+        g_ping_packet.end());
+    return enet_packet_create(ping_packet.getData(),
+        ping_packet.getTotalSize(), ENET_PACKET_FLAG_RELIABLE);
+}   // createPingPacket
+
 // ----------------------------------------------------------------------------
 /** \brief Thread function checking if data is received.
  *  This function tries to get data from network low-level functions as
@@ -706,9 +845,25 @@ void STKHost::mainLoop()
 
     uint64_t last_ping_time = StkTime::getRealTimeMs();
     uint64_t last_ping_time_update_for_client = StkTime::getRealTimeMs();
+    uint64_t last_flood_log_time = StkTime::getRealTimeMs();
     std::map<std::string, uint64_t> ctp;
     while (m_exit_timeout.load() > StkTime::getRealTimeMs())
     {
+        // Report dropped packets at most every 10 seconds
+        if (last_flood_log_time + 10000 < StkTime::getRealTimeMs())
+        {
+            last_flood_log_time = StkTime::getRealTimeMs();
+            const uint32_t packets = m_packet_filter ?
+                m_packet_filter->getAndResetDropped() : 0;
+            const uint32_t requests = m_request_filter ?
+                m_request_filter->getAndResetDropped() : 0;
+            if (packets > 0 || requests > 0)
+            {
+                Log::warn("STKHost", "Dropped %u packets and %u direct "
+                    "requests from flooding addresses.", packets, requests);
+            }
+        }
+
         // Clear outdated connect to peer list every 15 seconds
         for (auto it = ctp.begin(); it != ctp.end();)
         {
@@ -718,6 +873,25 @@ void STKHost::mainLoop()
                 it++;
         }
 
+        // Without peers a server only needs to react to incoming packets,
+        // so wait for them instead of polling
+        if (is_server && m_wakeup_socket != ENET_SOCKET_NULL &&
+            getTotalPeerCount() == 0)
+        {
+            // Set before testing for commands, so that either the command
+            // is found here, or addEnetCommand() wakes up the select
+            m_waiting_for_packets.store(true);
+            std::unique_lock<std::mutex> lock(m_enet_cmd_mutex);
+            const bool no_cmd = m_enet_cmd.empty();
+            lock.unlock();
+            if (no_cmd && m_exit_timeout.load() > StkTime::getRealTimeMs())
+                waitForPackets(host, direct_socket);
+            m_waiting_for_packets.store(false);
+        }
+
+        // LAN requests are answered by the server room in which a new peer
+        // would be added
+        ServerRoom::setCurrent(is_server ? getRoomForNewPeer() : 0);
         auto sl = LobbyProtocol::get<ServerLobby>();
         if (direct_socket && sl && sl->waitingForPlayers())
         {
@@ -734,23 +908,36 @@ void STKHost::mainLoop()
 
         if (is_server)
         {
+            const unsigned rooms = ServerRoom::getCount();
+            std::vector<std::shared_ptr<ServerLobby> > lobbies(rooms);
+            for (unsigned room = 0; room < rooms; room++)
+                lobbies[room] = LobbyProtocol::get<ServerLobby>(room);
             std::unique_lock<std::mutex> peer_lock(m_peers_mutex);
             const float timeout = ServerConfig::m_validation_timeout;
-            bool need_ping = false;
-            if (sl && (!sl->isRacing() || sl->allowJoinedPlayersWaiting()) &&
-                last_ping_time < StkTime::getRealTimeMs())
+            std::vector<bool> need_ping(rooms, false);
+            bool any_ping = false;
+            if (last_ping_time < StkTime::getRealTimeMs())
+            {
+                for (unsigned room = 0; room < rooms; room++)
+                {
+                    need_ping[room] = lobbies[room] &&
+                        (!lobbies[room]->isRacing() ||
+                        lobbies[room]->allowJoinedPlayersWaiting());
+                    any_ping |= need_ping[room];
+                }
+            }
+            if (any_ping)
             {
                 // If not racing, send an reliable packet at the same rate with
                 // state exchange to keep enet ping accurate
                 last_ping_time = StkTime::getRealTimeMs() +
                     (uint64_t)((1.0f /
                     (float)(stk_config->m_network_state_frequeny)) * 1000.0f);
-                need_ping = true;
             }
 
-            ENetPacket* packet = NULL;
-            bool need_destroy_packet = true;
-            if (need_ping)
+            std::vector<ENetPacket*> packets(rooms, NULL);
+            std::vector<bool> need_destroy_packet(rooms, true);
+            if (any_ping)
             {
                 m_peer_pings.getData().clear();
                 for (auto& p : m_peers)
@@ -790,38 +977,24 @@ void STKHost::mainLoop()
                         }
                     }
                 }
-                BareNetworkString ping_packet;
-                uint64_t network_timer = getNetworkTimer();
-                ping_packet.addUInt64(network_timer);
-                ping_packet.addUInt8((uint8_t)m_peer_pings.getData().size());
-                for (auto& p : m_peer_pings.getData())
-                    ping_packet.addUInt32(p.first).addUInt32(p.second);
-                if (sl)
-                {
-                    auto progress = sl->getGameStartedProgress();
-                    ping_packet.addUInt32(progress.first)
-                        .addUInt32(progress.second);
-                }
-                else
+                for (unsigned room = 0; room < rooms; room++)
                 {
-                    ping_packet.addUInt32(std::numeric_limits<uint32_t>::max())
-                        .addUInt32(std::numeric_limits<uint32_t>::max());
+                    if (need_ping[room])
+                        packets[room] = createPingPacket(room, lobbies[room]);
                 }
-                ping_packet.getBuffer().insert(
-                    ping_packet.getBuffer().begin(), g_ping_packet.begin(),
-                    g_ping_packet.end());
-                packet = enet_packet_create(ping_packet.getData(),
-                    ping_packet.getTotalSize(), ENET_PACKET_FLAG_RELIABLE);
             }
 
             for (auto it = m_peers.begin(); it != m_peers.end();)
             {
-                if (need_ping &&
-                    (!sl->allowJoinedPlayersWaiting() ||
-                    !sl->isRacing() || it->second->isWaitingForGame()))
+                const unsigned room = it->second->getRoom();
+                auto& room_sl = lobbies[room];
+                if (packets[room] &&
+                    (!room_sl->allowJoinedPlayersWaiting() ||
+                    !room_sl->isRacing() || it->second->isWaitingForGame()))
                 {
-                    need_destroy_packet = false;
-                    enet_peer_send(it->first, EVENT_CHANNEL_UNENCRYPTED, packet);
+                    need_destroy_packet[room] = false;
+                    enet_peer_send(it->first, EVENT_CHANNEL_UNENCRYPTED,
+                        packets[room]);
                 }
 
                 // Remove peer which has not been validated after a specific time
@@ -843,8 +1016,11 @@ void STKHost::mainLoop()
                 }
             }
             peer_lock.unlock();
-            if (need_destroy_packet && packet != NULL)
-                enet_packet_destroy(packet);
+            for (unsigned room = 0; room < rooms; room++)
+            {
+                if (need_destroy_packet[room] && packets[room] != NULL)
+                    enet_packet_destroy(packets[room]);
+            }
         }
 
         std::list<std::tuple<ENetPeer*, ENetPacket*, uint32_t,
@@ -903,14 +1079,19 @@ void STKHost::mainLoop()
             if (event.type == ENET_EVENT_TYPE_CONNECT)
             {
                 auto stk_peer = std::make_shared<STKPeer>
-                    (event.peer, this, m_next_unique_host_id++);
+                    (event.peer, this, m_next_unique_host_id++,
+                    is_server ? getRoomForNewPeer() : 0);
                 std::unique_lock<std::mutex> lock(m_peers_mutex);
                 m_peers[event.peer] = stk_peer;
                 lock.unlock();
                 stk_event = new Event(&event, stk_peer);
                 TransportAddress addr(event.peer->address);
-                Log::info("STKHost", "%s has just connected. There are "
-                    "now %u peers.", addr.toString().c_str(), getPeerCount());
+                Log::info("STKHost", "%s has just connected to room %u. "
+                    "There are now %u peers.", addr.toString().c_str(),
+                    stk_peer->getRoom(), getTotalPeerCount());
+                // Let an idle main loop continue at full frame rate
+                if (is_server && main_loop)
+                    main_loop->wakeUp();
                 // Client always trust the server
                 if (!is_server)
                     stk_peer->setValidated();
@@ -936,12 +1117,14 @@ void STKHost::mainLoop()
                 }
                 TransportAddress addr(event.peer->address);
                 Log::info("STKHost", "%s has just disconnected. There are "
-                    "now %u peers.", addr.toString().c_str(), getPeerCount());
+                    "now %u peers.", addr.toString().c_str(),
+                    getTotalPeerCount());
             }   // ENET_EVENT_TYPE_DISCONNECT
 
             if (!stk_event && m_peers.find(event.peer) != m_peers.end())
             {
                 auto& peer = m_peers.at(event.peer);
+                peer->addReceivedPacket(event.packet->dataLength);
                 if (isPingPacket(event.packet->data, event.packet->dataLength))
                 {
                     if (!is_server)
@@ -1015,6 +1198,11 @@ void STKHost::mainLoop()
             }
             if (stk_event->getType() == EVENT_TYPE_MESSAGE)
             {
+                if (ServerMetrics::isEnabled())
+                {
+                    ServerMetrics::addMessageReceived(
+                        stk_event->data().getProtocolType());
+                }
                 Network::logPacket(stk_event->data(), true);
 #ifdef DEBUG_MESSAGE_CONTENT
                 Log::verbose("NetworkManager",
@@ -1027,7 +1215,8 @@ void STKHost::mainLoop()
 #endif
             }   // if message event
 
-            // notify for the event now.
+            // notify for the event now (to the room of the peer).
+            ServerRoom::setCurrent(stk_event->getPeer()->getRoom());
             auto pm = ProtocolManager::lock();
             if (pm && !pm->isExiting())
                 pm->propagateEvent(stk_event);
@@ -1039,6 +1228,70 @@ void STKHost::mainLoop()
     Log::info("STKHost", "Listening has been stopped.");
 }   // mainLoop
 
+// ----------------------------------------------------------------------------
+/** Used by the listening thread of a server without peers: blocks until a
+ *  packet arrives on the enet socket or the direct socket, or for at most a
+ *  second, so that an idle server does not use cpu.
+ *  \param host The enet host of this server.
+ *  \param direct_socket The socket for LAN requests, or NULL.
+ */
+void STKHost::waitForPackets(ENetHost* host, Network* direct_socket)
+{
+    ENetSocketSet read_set;
+    ENET_SOCKETSET_EMPTY(read_set);
+    ENET_SOCKETSET_ADD(read_set, host->socket);
+    ENET_SOCKETSET_ADD(read_set, m_wakeup_socket);
+    ENetSocket max_socket = std::max(host->socket, m_wakeup_socket);
+    if (direct_socket)
+    {
+        ENetSocket s = direct_socket->getENetHost()->socket;
+        ENET_SOCKETSET_ADD(read_set, s);
+        max_socket = std::max(max_socket, s);
+    }
+    enet_socketset_select(max_socket, &read_set, NULL, 1000);
+
+    // Discard all wakeup datagrams
+    uint8_t data[16];
+    ENetBuffer buffer;
+    buffer.data = data;
+    buffer.dataLength = sizeof(data);
+    ENetAddress address;
+    while (enet_socket_receive(m_wakeup_socket, &address, &buffer, 1) > 0);
+}   // waitForPackets
+
+// ----------------------------------------------------------------------------
+/** Wakes up the listening thread if it waits for packets in
+ *  waitForPackets(), so that a queued enet command or a shutdown is handled
+ *  immediately.
+ */
+void STKHost::wakeUpListening()
+{
+    if (m_wakeup_socket == ENET_SOCKET_NULL ||
+        !m_waiting_for_packets.load())
+        return;
+    uint8_t data = 0;
+    ENetBuffer buffer;
+    buffer.data = &data;
+    buffer.dataLength = 1;
+    enet_socket_send(m_wakeup_socket, &m_wakeup_address, &buffer, 1);
+}   // wakeUpListening
+
+// ----------------------------------------------------------------------------
+/** Called by enet in the listening thread for each raw packet received by
+ *  the server, before enet processes it. Drops the packet if its source
+ *  has sent too many packets, so a flood from one address never reaches
+ *  the protocols.
+ *  \return 1 to drop the packet, 0 to let enet handle it.
+ */
+int STKHost::floodFilterCallback(ENetHost* host, ENetEvent* event)
+{
+    TransportAddress addr(host->receivedAddress);
+    if (m_stk_host->m_packet_filter->allow(addr.getIP(),
+        StkTime::getRealTimeMs()))
+        return 0;
+    return 1;
+}   // floodFilterCallback
+
 // ----------------------------------------------------------------------------
 /** Handles a direct request given to a socket. This is typically a LAN 
  *  request, but can also be used if the server is public (i.e. not behind
@@ -1058,6 +1311,9 @@ void STKHost::handleDirectSocketRequest(Network* direct_socket,
     TransportAddress sender;
     int len = direct_socket->receiveRawPacket(buffer, LEN, &sender, 1);
     if(len<=0) return;
+    if (m_request_filter &&
+        !m_request_filter->allow(sender.getIP(), StkTime::getRealTimeMs()))
+        return;
     BareNetworkString message(buffer, len);
     std::string command;
     message.decodeString(&command);
@@ -1166,6 +1422,35 @@ bool STKHost::isConnectedTo(const TransportAddress& peer)
     return false;
 }   // isConnectedTo
 
+//-----------------------------------------------------------------------------
+/** Returns a copied list of the peers in the current server room. */
+std::vector<std::shared_ptr<STKPeer> > STKHost::getPeers() const
+{
+    std::lock_guard<std::mutex> lock(m_peers_mutex);
+    std::vector<std::shared_ptr<STKPeer> > peers;
+    for (auto p : m_peers)
+    {
+        if (p.second->getRoom() == ServerRoom::getCurrent())
+            peers.push_back(p.second);
+    }
+    return peers;
+}   // getPeers
+
+//-----------------------------------------------------------------------------
+/** Returns the number of currently connected peers in the current server
+ *  room. */
+unsigned int STKHost::getPeerCount() const
+{
+    std::lock_guard<std::mutex> lock(m_peers_mutex);
+    unsigned int count = 0;
+    for (auto p : m_peers)
+    {
+        if (p.second->getRoom() == ServerRoom::getCurrent())
+            count++;
+    }
+    return count;
+}   // getPeerCount
+
 //-----------------------------------------------------------------------------
 /** Sends data to all validated peers currently in server
  *  \param data Data to sent.
@@ -1174,11 +1459,14 @@ bool STKHost::isConnectedTo(const TransportAddress& peer)
 void STKHost::sendPacketToAllPeersInServer(NetworkString *data, bool reliable)
 {
     std::lock_guard<std::mutex> lock(m_peers_mutex);
+    std::vector<STKPeer*> peers;
     for (auto p : m_peers)
     {
-        if (p.second->isValidated())
-            p.second->sendPacket(data, reliable);
+        if (p.second->isValidated() &&
+            p.second->getRoom() == ServerRoom::getCurrent())
+            peers.push_back(p.second.get());
     }
+    sendPacketToPeers(peers, data, reliable);
 }   // sendPacketToAllPeersInServer
 
 //-----------------------------------------------------------------------------
@@ -1189,11 +1477,14 @@ void STKHost::sendPacketToAllPeersInServer(NetworkString *data, bool reliable)
 void STKHost::sendPacketToAllPeers(NetworkString *data, bool reliable)
 {
     std::lock_guard<std::mutex> lock(m_peers_mutex);
+    std::vector<STKPeer*> peers;
     for (auto p : m_peers)
     {
-        if (p.second->isValidated() && !p.second->isWaitingForGame())
-            p.second->sendPacket(data, reliable);
+        if (p.second->isValidated() && !p.second->isWaitingForGame() &&
+            p.second->getRoom() == ServerRoom::getCurrent())
+            peers.push_back(p.second.get());
     }
+    sendPacketToPeers(peers, data, reliable);
 }   // sendPacketToAllPeers
 
 //-----------------------------------------------------------------------------
@@ -1206,15 +1497,18 @@ void STKHost::sendPacketExcept(STKPeer* peer, NetworkString *data,
                                bool reliable)
 {
     std::lock_guard<std::mutex> lock(m_peers_mutex);
+    std::vector<STKPeer*> peers;
     for (auto p : m_peers)
     {
         STKPeer* stk_peer = p.second.get();
         if (!stk_peer->isSamePeer(peer) && p.second->isValidated() &&
-            !p.second->isWaitingForGame())
+            !p.second->isWaitingForGame() &&
+            stk_peer->getRoom() == ServerRoom::getCurrent())
         {
-            stk_peer->sendPacket(data, reliable);
+            peers.push_back(stk_peer);
         }
     }
+    sendPacketToPeers(peers, data, reliable);
 }   // sendPacketExcept
 
 //-----------------------------------------------------------------------------
@@ -1227,14 +1521,50 @@ void STKHost::sendPacketToAllPeersWith(std::function<bool(STKPeer*)> predicate,
                                        NetworkString* data, bool reliable)
 {
     std::lock_guard<std::mutex> lock(m_peers_mutex);
+    std::vector<STKPeer*> peers;
     for (auto p : m_peers)
     {
         STKPeer* stk_peer = p.second.get();
-        if (predicate(stk_peer))
-            stk_peer->sendPacket(data, reliable);
+        if (stk_peer->getRoom() == ServerRoom::getCurrent() &&
+            predicate(stk_peer))
+            peers.push_back(stk_peer);
     }
+    sendPacketToPeers(peers, data, reliable);
 }   // sendPacketToAllPeersWith
 
+//-----------------------------------------------------------------------------
+/** Sends the same data to all given peers. The packets (which are encrypted
+ *  with a different key for each peer) are created in parallel if more than
+ *  one peer is used, and then handed to the listening thread in the order
+ *  of the peers, so the order of packets sent to one peer is unchanged.
+ *  Must be called with m_peers_mutex locked.
+ *  \param peers The peers to send the data to.
+ *  \param data Data to sent.
+ *  \param reliable If the data should be sent reliable or now.
+ */
+void STKHost::sendPacketToPeers(const std::vector<STKPeer*>& peers,
+                                NetworkString *data, bool reliable)
+{
+    if (!m_encryption_pool || peers.size() < 2)
+    {
+        for (STKPeer* peer : peers)
+            peer->sendPacket(data, reliable);
+        return;
+    }
+
+    std::vector<ENetPacket*> packets(peers.size(), NULL);
+    m_encryption_pool->parallelFor((unsigned)peers.size(),
+        [&peers, &packets, data, reliable](unsigned i)
+        {
+            packets[i] = peers[i]->createPacket(data, reliable);
+        });
+    for (unsigned i = 0; i < peers.size(); i++)
+    {
+        if (packets[i])
+            peers[i]->sendCreatedPacket(packets[i]);
+    }
+}   // sendPacketToPeers
+
 //-----------------------------------------------------------------------------
 /** Sends a message from a client to the server. */
 void STKHost::sendToServer(NetworkString *data, bool reliable)
@@ -1254,7 +1584,8 @@ std::vector<std::shared_ptr<NetworkPlayerProfile> >
     std::unique_lock<std::mutex> lock(m_peers_mutex);
     for (auto peer : m_peers)
     {
-        if (peer.second->isDisconnected())
+        if (peer.second->isDisconnected() ||
+            peer.second->getRoom() != ServerRoom::getCurrent())
             continue;
         auto peer_profile = peer.second->getPlayerProfiles();
         p.insert(p.end(), peer_profile.begin(), peer_profile.end());
@@ -1287,14 +1618,16 @@ void STKHost::initClientNetwork(ENetEvent& event, Network* new_network)
         m_network = new_network;
     }
     auto stk_peer = std::make_shared<STKPeer>(event.peer, this,
-        m_next_unique_host_id++);
+        m_next_unique_host_id++, /*room*/0);
     stk_peer->setValidated();
     m_peers[event.peer] = stk_peer;
     setPrivatePort();
-    startListening();
+    // Propagate the connect event before the listening thread is started,
+    // which is the only other thread adding events to the ProtocolManager
     auto pm = ProtocolManager::lock();
     if (pm && !pm->isExiting())
         pm->propagateEvent(new Event(&event, stk_peer));
+    startListening();
 }   // replaceNetwork
 
 // ----------------------------------------------------------------------------
@@ -44,7 +44,9 @@
 #include <mutex>
 #include <thread>
 #include <tuple>
+#include <vector>
 
+class FloodFilter;
 class GameSetup;
 class LobbyProtocol;
 class NetworkPlayerProfile;
@@ -52,6 +54,7 @@ class NetworkTimerSynchronizer;
 class Server;
 class ServerLobby;
 class SeparateProcess;
+class WorkerPool;
 
 enum ENetCommandType : unsigned int
 {
@@ -98,6 +101,17 @@ private:
     /** Protect \ref m_enet_cmd from multiple threads usage. */
     std::mutex m_enet_cmd_mutex;
 
+    /** A loopback socket which is part of the select() of an idle server
+     *  (see waitForPackets()), a datagram sent to it wakes up the listening
+     *  thread. ENET_SOCKET_NULL if not used. */
+    ENetSocket m_wakeup_socket;
+
+    /** The address of m_wakeup_socket. */
+    ENetAddress m_wakeup_address;
+
+    /** Set while the listening thread may wait in waitForPackets(). */
+    std::atomic_bool m_waiting_for_packets;
+
     /** The list of peers connected to this instance. */
     std::map<ENetPeer*, std::shared_ptr<STKPeer> > m_peers;
 
@@ -144,6 +158,18 @@ private:
 
     std::unique_ptr<NetworkTimerSynchronizer> m_nts;
 
+    /** Worker threads used by a server to encrypt a broadcast packet for
+     *  all peers in parallel, NULL if only one cpu core is available. */
+    std::unique_ptr<WorkerPool> m_encryption_pool;
+
+    /** Limits the packets per source IP received by the enet host of a
+     *  server, used in the listening thread only, NULL if disabled. */
+    std::unique_ptr<FloodFilter> m_packet_filter;
+
+    /** Limits the requests per source IP received by the direct socket,
+     *  used in the listening thread only, NULL if disabled. */
+    std::unique_ptr<FloodFilter> m_request_filter;
+
     // ------------------------------------------------------------------------
     STKHost(bool server);
     // ------------------------------------------------------------------------
@@ -156,6 +182,20 @@ private:
                                    std::map<std::string, uint64_t>& ctp);
     // ------------------------------------------------------------------------
     void mainLoop();
+    // ------------------------------------------------------------------------
+    static int floodFilterCallback(ENetHost* host, ENetEvent* event);
+    // ------------------------------------------------------------------------
+    void waitForPackets(ENetHost* host, Network* direct_socket);
+    // ------------------------------------------------------------------------
+    void wakeUpListening();
+    // ------------------------------------------------------------------------
+    void sendPacketToPeers(const std::vector<STKPeer*>& peers,
+                           NetworkString *data, bool reliable);
+    // ------------------------------------------------------------------------
+    unsigned getRoomForNewPeer() const;
+    // ------------------------------------------------------------------------
+    ENetPacket* createPingPacket(unsigned room,
+                                 std::shared_ptr<ServerLobby> sl) const;
 
 public:
     /** If a network console should be started. */
@@ -256,8 +296,10 @@ public:
     void addEnetCommand(ENetPeer* peer, ENetPacket* packet, uint32_t i,
                         ENetCommandType ect)
     {
-        std::lock_guard<std::mutex> lock(m_enet_cmd_mutex);
+        std::unique_lock<std::mutex> lock(m_enet_cmd_mutex);
         m_enet_cmd.emplace_back(peer, packet, i, ect);
+        lock.unlock();
+        wakeUpListening();
     }
     // ------------------------------------------------------------------------
     /** Returns the last error (or "" if no error has happened). */
@@ -283,17 +325,7 @@ public:
     // ------------------------------------------------------------------------
     Network* getNetwork() const                           { return m_network; }
     // ------------------------------------------------------------------------
-    /** Returns a copied list of peers. */
-    std::vector<std::shared_ptr<STKPeer> > getPeers() const
-    {
-        std::lock_guard<std::mutex> lock(m_peers_mutex);
-        std::vector<std::shared_ptr<STKPeer> > peers;
-        for (auto p : m_peers)
-        {
-            peers.push_back(p.second);
-        }
-        return peers;
-    }
+    std::vector<std::shared_ptr<STKPeer> > getPeers() const;
     // ------------------------------------------------------------------------
     /** Returns the next (unique) host id. */
     unsigned int getNextHostId() const
@@ -302,8 +334,11 @@ public:
         return m_next_unique_host_id;
     }
     // ------------------------------------------------------------------------
-    /** Returns the number of currently connected peers. */
-    unsigned int getPeerCount() const
+    unsigned int getPeerCount() const;
+    // ------------------------------------------------------------------------
+    /** Returns the number of currently connected peers in all server rooms.
+     */
+    unsigned int getTotalPeerCount() const
     {
         std::lock_guard<std::mutex> lock(m_peers_mutex);
         return (unsigned)m_peers.size();
@@ -23,17 +23,20 @@
 #include "network/event.hpp"
 #include "network/network_config.hpp"
 #include "network/network_string.hpp"
+#include "network/server_metrics.hpp"
 #include "network/stk_host.hpp"
 #include "network/transport_address.hpp"
 #include "utils/log.hpp"
 #include "utils/time.hpp"
 
+#include <chrono>
 #include <string.h>
 
 /** Constructor for an empty peer.
  */
-STKPeer::STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id)
-       : m_peer_address(enet_peer->address), m_host(host)
+STKPeer::STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id,
+                 unsigned room)
+       : m_room(room), m_peer_address(enet_peer->address), m_host(host)
 {
     m_enet_peer           = enet_peer;
     m_host_id             = host_id;
@@ -44,6 +47,10 @@ STKPeer::STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id)
     m_disconnected.store(false);
     m_warned_for_high_ping.store(false);
     m_last_activity.store((int64_t)StkTime::getRealTimeMs());
+    m_packets_sent.store(0);
+    m_bytes_sent.store(0);
+    m_packets_received.store(0);
+    m_bytes_received.store(0);
 }   // STKPeer
 
 //-----------------------------------------------------------------------------
@@ -101,43 +108,75 @@ void STKPeer::reset()
  *  \param encrypted If the data is sent encrypted or not.
  */
 void STKPeer::sendPacket(NetworkString *data, bool reliable, bool encrypted)
+{
+    ENetPacket* packet = createPacket(data, reliable, encrypted);
+    if (packet)
+        sendCreatedPacket(packet, encrypted);
+}   // sendPacket
+
+//-----------------------------------------------------------------------------
+/** Creates the (encrypted if needed) enet packet for this host, without
+ *  sending it. This only uses data of this peer, so it can be called for
+ *  different peers in parallel (which is used when broadcasting a packet).
+ *  \param data The data to send.
+ *  \param reliable If the data is sent reliable or not.
+ *  \param encrypted If the data is sent encrypted or not.
+ *  \return The packet, or NULL if this peer is disconnected.
+ */
+ENetPacket* STKPeer::createPacket(NetworkString *data, bool reliable,
+                                  bool encrypted)
 {
     if (m_disconnected.load())
-        return;
+        return NULL;
     TransportAddress a(m_enet_peer->address);
     // Enet will reuse a disconnected peer so we check here to avoid sending
     // to wrong peer
     if (m_enet_peer->state != ENET_PEER_STATE_CONNECTED ||
         a != m_peer_address)
-        return;
+        return NULL;
+
+    if (ServerMetrics::isEnabled())
+        ServerMetrics::addMessageSent(data->getProtocolType());
 
-    ENetPacket* packet = NULL;
     if (m_crypto && encrypted)
     {
-        packet = m_crypto->encryptSend(*data, reliable);
-    }
-    else
-    {
-        packet = enet_packet_create(data->getData(),
-            data->getTotalSize(), (reliable ?
-            ENET_PACKET_FLAG_RELIABLE :
-            (ENET_PACKET_FLAG_UNSEQUENCED |
-            ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT)));
+        if (!ServerMetrics::isEnabled())
+            return m_crypto->encryptSend(*data, reliable);
+        const auto start = std::chrono::steady_clock::now();
+        ENetPacket* packet = m_crypto->encryptSend(*data, reliable);
+        ServerMetrics::addEncryptionTime(
+            std::chrono::duration_cast<std::chrono::microseconds>
+            (std::chrono::steady_clock::now() - start).count());
+        return packet;
     }
 
-    if (packet)
+    return enet_packet_create(data->getData(),
+        data->getTotalSize(), (reliable ?
+        ENET_PACKET_FLAG_RELIABLE :
+        (ENET_PACKET_FLAG_UNSEQUENCED |
+        ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT)));
+}   // createPacket
+
+//-----------------------------------------------------------------------------
+/** Hands a packet created by createPacket to the listening thread, which
+ *  will send it.
+ *  \param packet The packet to send.
+ *  \param encrypted If the packet was created encrypted or not.
+ */
+void STKPeer::sendCreatedPacket(ENetPacket* packet, bool encrypted)
+{
+    if (Network::m_connection_debug)
     {
-        if (Network::m_connection_debug)
-        {
-            Log::verbose("STKPeer", "sending packet of size %d to %s at %lf",
-                packet->dataLength, a.toString().c_str(),
-                StkTime::getRealTime());
-        }
-        m_host->addEnetCommand(m_enet_peer, packet,
-                encrypted ? EVENT_CHANNEL_NORMAL : EVENT_CHANNEL_UNENCRYPTED,
-                ECT_SEND_PACKET);
+        Log::verbose("STKPeer", "sending packet of size %d to %s at %lf",
+            packet->dataLength, m_peer_address.toString().c_str(),
+            StkTime::getRealTime());
     }
-}   // sendPacket
+    m_packets_sent.fetch_add(1, std::memory_order_relaxed);
+    m_bytes_sent.fetch_add(packet->dataLength, std::memory_order_relaxed);
+    m_host->addEnetCommand(m_enet_peer, packet,
+            encrypted ? EVENT_CHANNEL_NORMAL : EVENT_CHANNEL_UNENCRYPTED,
+            ECT_SEND_PACKET);
+}   // sendCreatedPacket
 
 //-----------------------------------------------------------------------------
 /** Returns if the peer is connected or not.
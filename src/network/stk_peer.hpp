@@ -75,6 +75,9 @@ protected:
     /** Host id of this peer. */
     uint32_t m_host_id;
 
+    /** The server room this peer belongs to, 0 on clients. */
+    const unsigned m_room;
+
     TransportAddress m_peer_address;
 
     STKHost* m_host;
@@ -98,14 +101,27 @@ protected:
 
     std::string m_user_version;
 
+    /** Number of packets and bytes sent to and received from this peer,
+     *  used for the server metrics. */
+    std::atomic<uint64_t> m_packets_sent;
+    std::atomic<uint64_t> m_bytes_sent;
+    std::atomic<uint64_t> m_packets_received;
+    std::atomic<uint64_t> m_bytes_received;
+
 public:
-    STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id);
+    STKPeer(ENetPeer *enet_peer, STKHost* host, uint32_t host_id,
+            unsigned room);
     // ------------------------------------------------------------------------
     ~STKPeer();
     // ------------------------------------------------------------------------
     void sendPacket(NetworkString *data, bool reliable = true,
                     bool encrypted = true);
     // ------------------------------------------------------------------------
+    ENetPacket* createPacket(NetworkString *data, bool reliable,
+                             bool encrypted = true);
+    // ------------------------------------------------------------------------
+    void sendCreatedPacket(ENetPacket* packet, bool encrypted = true);
+    // ------------------------------------------------------------------------
     void disconnect();
     // ------------------------------------------------------------------------
     void kick();
@@ -135,6 +151,9 @@ public:
     /** Returns the host id of this peer. */
     uint32_t getHostId() const                            { return m_host_id; }
     // ------------------------------------------------------------------------
+    /** Returns the server room this peer belongs to. */
+    unsigned getRoom() const                                 { return m_room; }
+    // ------------------------------------------------------------------------
     float getConnectedTime() const
        { return float(StkTime::getRealTimeMs() - m_connected_time) / 1000.0f; }
     // ------------------------------------------------------------------------
@@ -211,6 +230,22 @@ public:
     // ------------------------------------------------------------------------
     const std::string& getUserVersion() const        { return m_user_version; }
     // ------------------------------------------------------------------------
+    /** Counts a packet received from this peer, called from the listening
+     *  thread. */
+    void addReceivedPacket(size_t size)
+    {
+        m_packets_received.fetch_add(1, std::memory_order_relaxed);
+        m_bytes_received.fetch_add(size, std::memory_order_relaxed);
+    }   // addReceivedPacket
+    // ------------------------------------------------------------------------
+    uint64_t getPacketsSent() const          { return m_packets_sent.load(); }
+    // ------------------------------------------------------------------------
+    uint64_t getBytesSent() const              { return m_bytes_sent.load(); }
+    // ------------------------------------------------------------------------
+    uint64_t getPacketsReceived() const  { return m_packets_received.load(); }
+    // ------------------------------------------------------------------------
+    uint64_t getBytesReceived() const      { return m_bytes_received.load(); }
+    // ------------------------------------------------------------------------
     void updateLastActivity()
                   { m_last_activity.store((int64_t)StkTime::getRealTimeMs()); }
     // ------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 
 #include "config/user_config.hpp"
 #include "online/request_manager.hpp"
+#include "utils/server_room.hpp"
 
 #ifdef WIN32
 #  include <winsock2.h>
@@ -38,7 +39,8 @@ namespace Online
      *         RequestManager
      */
     Request::Request(bool manage_memory, int priority, int type)
-        : m_type(type), m_manage_memory(manage_memory), m_priority(priority)
+        : m_type(type), m_manage_memory(manage_memory), m_priority(priority),
+          m_room(ServerRoom::getCurrent())
     {
         m_cancel.setAtomic(false);
         m_state.setAtomic(S_PREPARING);
@@ -60,6 +62,7 @@ namespace Online
     void Request::execute()
     {
         assert(isBusy());
+        ServerRoomScope room(m_room);
         // Abort as early as possible if abort is requested
         if (RequestManager::get()->getAbort() && isAbortable()) return;
         prepareOperation();
@@ -77,6 +77,10 @@ namespace Online
         important this request is. */
         const int m_priority;
 
+        /** The server room which created this request. The operation and
+         *  callbacks are executed in this room. */
+        const unsigned m_room;
+
         /** The different state of the requst:
          *  - S_PREPARING:\n The request is created and can be configured, it
          *      is not yet started.
@@ -162,6 +166,10 @@ namespace Online
         /** Returns the priority of this request. */
         int getPriority() const   { return m_priority; }
 
+        // --------------------------------------------------------------------
+        /** Returns the server room which created this request. */
+        unsigned getRoom() const  { return m_room; }
+
         // --------------------------------------------------------------------
         /** Signals that this request should be canceled. */
         void cancel() { m_cancel.setAtomic(true); }
@@ -23,6 +23,7 @@
 #include "config/player_manager.hpp"
 #include "config/user_config.hpp"
 #include "states_screens/state_manager.hpp"
+#include "utils/server_room.hpp"
 #include "utils/vs.hpp"
 
 #include <iostream>
@@ -281,6 +282,7 @@ namespace Online
         m_result_queue.unlock();
         if (request != NULL)
         {
+            ServerRoomScope room(request->getRoom());
             request->callback();
             if(request->manageMemory())
             {
@@ -26,10 +26,13 @@
 #include "karts/kart.hpp"
 #include "karts/kart_model.hpp"
 #include "karts/kart_properties.hpp"
+#include "physics/btKartRaycast.hpp"
 #include "physics/triangle_mesh.hpp"
 #include "tracks/terrain_info.hpp"
 #include "tracks/track.hpp"
 
+#include <cstring>
+
 #define ROLLING_INFLUENCE_FIX
 
 
@@ -42,7 +45,7 @@ btRigidBody& btKart::getFixedBody()
 }
 
 // ============================================================================
-btKart::btKart(btRigidBody* chassis, btVehicleRaycaster* raycaster,
+btKart::btKart(btRigidBody* chassis, btKartRaycaster* raycaster,
                Kart *kart)
       : m_vehicleRaycaster(raycaster)
 {
@@ -117,6 +120,7 @@ void btKart::reset()
         updateWheelTransform(i, true);
     }
     m_visual_wheels_touch_ground = false;
+    m_wheel_rays_cast            = false;
     m_allow_sliding              = false;
     m_num_wheels_on_ground       = 0;
     m_additional_impulse         = btVector3(0,0,0);
@@ -248,6 +252,78 @@ void btKart::updateAllWheelTransformsWS()
     }
 }   // updateAllWheelTransformsWS
 
+// ----------------------------------------------------------------------------
+/** Casts the rays of all wheels for the next physics step in advance. The
+ *  physics world calls this for all karts after the new positions of all
+ *  bodies are computed and before any vehicle is updated, so the rays of
+ *  all karts are cast together (and can be cast in parallel, since this
+ *  only modifies the wheels of this kart). The next updateVehicle call
+ *  then uses these results instead of casting the rays again.
+ */
+void btKart::castWheelRays()
+{
+    updateAllWheelTransformsWS();
+    m_wheel_rays_cast = true;
+}   // castWheelRays
+
+// ----------------------------------------------------------------------------
+/** Returns the number of bytes this vehicle needs in a physics checkpoint.
+ */
+unsigned int btKart::getCheckpointSize() const
+{
+    return (unsigned int)(m_wheelInfo.size()*sizeof(btWheelInfo) +
+                          sizeof(Checkpoint));
+}   // getCheckpointSize
+
+// ----------------------------------------------------------------------------
+/** Saves the wheels (including the suspension and the last ray cast
+ *  results) and the timed impulse and rotation of this vehicle, which are
+ *  not part of the rigid body of the chassis.
+ *  \param data Where to store the data, must have getCheckpointSize() bytes.
+ */
+void btKart::saveCheckpoint(uint8_t *data) const
+{
+    const size_t wheels_size = m_wheelInfo.size()*sizeof(btWheelInfo);
+    if (wheels_size > 0)
+        memcpy(data, static_cast<const void*>(&m_wheelInfo[0]), wheels_size);
+
+    Checkpoint c;
+    c.m_additional_impulse         = m_additional_impulse;
+    c.m_additional_rotation        = m_additional_rotation;
+    c.m_min_speed                  = m_min_speed;
+    c.m_max_speed                  = m_max_speed;
+    c.m_num_wheels_on_ground       = m_num_wheels_on_ground;
+    c.m_ticks_additional_impulse   = m_ticks_additional_impulse;
+    c.m_ticks_additional_rotation  = m_ticks_additional_rotation;
+    c.m_allow_sliding              = m_allow_sliding;
+    c.m_visual_wheels_touch_ground = m_visual_wheels_touch_ground;
+    memcpy(data + wheels_size, static_cast<const void*>(&c), sizeof(c));
+}   // saveCheckpoint
+
+// ----------------------------------------------------------------------------
+/** Restores the data saved with saveCheckpoint.
+ *  \param data The data, must have getCheckpointSize() bytes.
+ */
+void btKart::restoreCheckpoint(const uint8_t *data)
+{
+    const size_t wheels_size = m_wheelInfo.size()*sizeof(btWheelInfo);
+    if (wheels_size > 0)
+        memcpy(static_cast<void*>(&m_wheelInfo[0]), data, wheels_size);
+
+    Checkpoint c;
+    memcpy(static_cast<void*>(&c), data + wheels_size, sizeof(c));
+    m_additional_impulse         = c.m_additional_impulse;
+    m_additional_rotation        = c.m_additional_rotation;
+    m_min_speed                  = c.m_min_speed;
+    m_max_speed                  = c.m_max_speed;
+    m_num_wheels_on_ground       = c.m_num_wheels_on_ground;
+    m_ticks_additional_impulse   = c.m_ticks_additional_impulse;
+    m_ticks_additional_rotation  = c.m_ticks_additional_rotation;
+    m_allow_sliding              = c.m_allow_sliding;
+    m_visual_wheels_touch_ground = c.m_visual_wheels_touch_ground;
+    m_wheel_rays_cast            = false;
+}   // restoreCheckpoint
+
 // ----------------------------------------------------------------------------
 /**
  */
@@ -255,18 +331,6 @@ btScalar btKart::rayCast(unsigned int index, float fraction)
 {
     btWheelInfo &wheel = m_wheelInfo[index];
 
-    // Work around a bullet problem: when using a convex hull the raycast
-    // would sometimes hit the chassis (which does not happen when using a
-    // box shape). Therefore set the collision mask in the chassis body so
-    // that it is not hit anymore.
-    short int old_group=0;
-    if(m_chassisBody->getBroadphaseHandle())
-    {
-        old_group = m_chassisBody->getBroadphaseHandle()
-                                 ->m_collisionFilterGroup;
-        m_chassisBody->getBroadphaseHandle()->m_collisionFilterGroup = 0;
-    }
-
     updateWheelTransformsWS(wheel, getChassisWorldTransform(), false, fraction);
 
     btScalar max_susp_len = wheel.getSuspensionRestLength()
@@ -286,7 +350,11 @@ btScalar btKart::rayCast(unsigned int index, float fraction)
 
     btAssert(m_vehicleRaycaster);
 
-    void* object = m_vehicleRaycaster->castRay(source,target,rayResults);
+    // Work around a bullet problem: when using a convex hull the raycast
+    // would sometimes hit the chassis (which does not happen when using a
+    // box shape). Therefore the chassis is ignored by the ray.
+    void* object = m_vehicleRaycaster->castRay(source, target, rayResults,
+                                               m_chassisBody);
 
     wheel.m_raycastInfo.m_groundObject = 0;
 
@@ -354,12 +422,6 @@ btScalar btKart::rayCast(unsigned int index, float fraction)
         wheel.m_clippedInvContactDotSuspension = btScalar(1.0);
     }
 
-    if(m_chassisBody->getBroadphaseHandle())
-    {
-        m_chassisBody->getBroadphaseHandle()->m_collisionFilterGroup
-            = old_group;
-    }
-
     return depth;
 
 }   // rayCast
@@ -433,7 +495,10 @@ void btKart::updateAllWheelPositions()
 // ----------------------------------------------------------------------------
 void btKart::updateVehicle( btScalar step )
 {
-    updateAllWheelTransformsWS();
+    // The rays are usually cast for all karts in advance, see castWheelRays
+    if(!m_wheel_rays_cast)
+        updateAllWheelTransformsWS();
+    m_wheel_rays_cast = false;
 
     for(int i=0; i<m_wheelInfo.size(); i++)
         m_wheelInfo[i].m_was_on_ground = m_wheelInfo[i].m_raycastInfo.m_isInContact;
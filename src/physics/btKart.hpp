@@ -21,6 +21,7 @@ class btDynamicsWorld;
 
 #include "config/stk_config.hpp"
 
+class btKartRaycaster;
 class btVehicleTuning;
 class Kart;
 struct btWheelContactPoint;
@@ -69,7 +70,7 @@ private:
     btScalar calcRollingFriction(btWheelContactPoint& contactPoint);
 
     btScalar            m_damping;
-    btVehicleRaycaster *m_vehicleRaycaster;
+    btKartRaycaster    *m_vehicleRaycaster;
 
     /** Sliding (skidding) will only be permited when this is true. Also check
      *  the friction parameter in the wheels since friction directly affects
@@ -119,8 +120,27 @@ private:
     /** True if the visual wheels touch the ground. */
     bool m_visual_wheels_touch_ground;
 
+    /** Set when the wheel rays for the next updateVehicle call were already
+     *  cast by castWheelRays(). */
+    bool m_wheel_rays_cast;
+
     btAlignedObjectArray<btWheelInfo> m_wheelInfo;
 
+    /** The state of this vehicle besides its wheels which is stored in
+     *  a physics checkpoint. */
+    struct Checkpoint
+    {
+        btVector3 m_additional_impulse;
+        btScalar  m_additional_rotation;
+        btScalar  m_min_speed;
+        btScalar  m_max_speed;
+        int       m_num_wheels_on_ground;
+        uint16_t  m_ticks_additional_impulse;
+        uint16_t  m_ticks_additional_rotation;
+        bool      m_allow_sliding;
+        bool      m_visual_wheels_touch_ground;
+    };   // Checkpoint
+
     void     defaultInit();
     btScalar rayCast(btWheelInfo& wheel, const btVector3& ray);
     void     updateWheelTransformsWS(btWheelInfo& wheel,
@@ -137,7 +157,7 @@ public:
      *         (this is used to get access to the kart properties).
      */
                        btKart(btRigidBody* chassis,
-                              btVehicleRaycaster* raycaster,
+                              btKartRaycaster* raycaster,
                               Kart *kart);
      virtual          ~btKart();
     void               reset();
@@ -162,6 +182,10 @@ public:
     const btWheelInfo& getWheelInfo(int index) const;
     btWheelInfo&       getWheelInfo(int index);
     void               updateAllWheelTransformsWS();
+    void               castWheelRays();
+    unsigned int       getCheckpointSize() const;
+    void               saveCheckpoint(uint8_t *data) const;
+    void               restoreCheckpoint(const uint8_t *data);
     void               setAllBrakes(btScalar brake);
     void               updateSuspension(btScalar deltaTime);
     virtual void       updateFriction(btScalar timeStep);
@@ -19,23 +19,46 @@
 #include "physics/triangle_mesh.hpp"
 #include "tracks/track.hpp"
 
+/** Casts a ray into the physics world and returns the rigid body hit.
+ *  Only the physics world is read, so several rays can be cast in parallel.
+ *  \param from, to Start and end point of the ray.
+ *  \param result On return the hit point, normal and triangle index.
+ *  \param ignore A collision object which is not hit by the ray (e.g. the
+ *         chassis of the kart the ray is cast for), or NULL.
+ */
 void* btKartRaycaster::castRay(const btVector3& from, const btVector3& to,
-                               btVehicleRaycasterResult& result)
+                               btVehicleRaycasterResult& result,
+                               const btCollisionObject* ignore) const
 {
     // ========================================================================
     class ClosestWithNormal : public btCollisionWorld::ClosestRayResultCallback
     {
     private:
         int m_triangle_index;
+        /** An object that is not hit by this ray. */
+        const btCollisionObject *m_ignore;
     public:
         /** Constructor, initialises the triangle index. */
         ClosestWithNormal(const btVector3 &from,
-                          const btVector3 &to)
+                          const btVector3 &to,
+                          const btCollisionObject *ignore)
                           : btCollisionWorld::ClosestRayResultCallback(from,to)
         {
             m_triangle_index = -1;
+            m_ignore         = ignore;
         }   // CloestWithNormal
         // --------------------------------------------------------------------
+        /** Skips the ignored object. This has the same effect as setting the
+         *  collision filter group of that object to 0, but does not modify
+         *  the object, which could be tested by a ray in another thread. */
+        virtual bool needsCollision(btBroadphaseProxy* proxy) const
+        {
+            if (m_ignore && proxy->m_clientObject == m_ignore)
+                return false;
+            return btCollisionWorld::ClosestRayResultCallback
+                                   ::needsCollision(proxy);
+        }   // needsCollision
+        // --------------------------------------------------------------------
         /** Stores the index of the triangle hit. */
         virtual    btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult,
                                          bool normalInWorldSpace)
@@ -57,7 +80,7 @@ void* btKartRaycaster::castRay(const btVector3& from, const btVector3& to,
     };   // CloestWithNormal
     // ========================================================================
 
-    ClosestWithNormal rayCallback(from,to);
+    ClosestWithNormal rayCallback(from, to, ignore);
 
     m_dynamicsWorld->rayTest(from, to, rayCallback);
 
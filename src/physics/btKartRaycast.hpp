@@ -14,6 +14,7 @@
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
 #include "BulletDynamics/Vehicle/btVehicleRaycaster.h"
+class btCollisionObject;
 class btDynamicsWorld;
 #include "LinearMath/btAlignedObjectArray.h"
 #include "BulletDynamics/Vehicle/btWheelInfo.h"
@@ -34,7 +35,13 @@ public:
     }
 
     virtual void* castRay(const btVector3& from,const btVector3& to,
-                          btVehicleRaycasterResult& result);
+                          btVehicleRaycasterResult& result)
+    {
+        return castRay(from, to, result, NULL);
+    }
+    void* castRay(const btVector3& from, const btVector3& to,
+                  btVehicleRaycasterResult& result,
+                  const btCollisionObject* ignore) const;
 
 };
 
@@ -29,6 +29,7 @@
 #include "karts/kart_properties.hpp"
 #include "karts/rescue_animation.hpp"
 #include "karts/controller/local_player_controller.hpp"
+#include "modes/profile_world.hpp"
 #include "modes/soccer_world.hpp"
 #include "modes/world.hpp"
 #include "network/network_config.hpp"
@@ -42,7 +43,12 @@
 #include "scriptengine/script_engine.hpp"
 #include "tracks/track.hpp"
 #include "tracks/track_object.hpp"
+#include "utils/benchmark.hpp"
 #include "utils/profiler.hpp"
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <thread>
 
 // ----------------------------------------------------------------------------
 /** Initialise physics.
@@ -52,6 +58,18 @@ Physics::Physics() : btSequentialImpulseConstraintSolver()
 {
     m_collision_conf      = new btDefaultCollisionConfiguration();
     m_dispatcher          = new btCollisionDispatcher(m_collision_conf);
+
+    // Rendering needs the other cores, so by default only cast rays in
+    // parallel without graphics.
+    unsigned threads = std::max((int)UserConfigParams::m_physics_threads, 0);
+    if (threads == 0)
+    {
+        threads = ProfileWorld::isNoGraphics() ?
+            std::min(std::thread::hardware_concurrency(), 4u) : 1;
+    }
+    // The calling thread works on the jobs as well
+    m_worker_pool = threads > 1 ? new WorkerPool(threads - 1, "PhysicsRays")
+                                : NULL;
 }   // Physics
 
 //-----------------------------------------------------------------------------
@@ -66,7 +84,8 @@ void Physics::init(const Vec3 &world_min, const Vec3 &world_max)
     m_dynamics_world      = new STKDynamicsWorld(m_dispatcher,
                                                  m_axis_sweep,
                                                  this,
-                                                 m_collision_conf);
+                                                 m_collision_conf,
+                                                 m_worker_pool);
     m_karts_to_delete.clear();
     m_dynamics_world->setGravity(
         btVector3(0.0f,
@@ -95,6 +114,7 @@ Physics::~Physics()
     delete m_axis_sweep;
     delete m_dispatcher;
     delete m_collision_conf;
+    delete m_worker_pool;
 }   // ~Physics
 
 // ----------------------------------------------------------------------------
@@ -114,7 +134,7 @@ void Physics::addKart(const AbstractKart *kart)
             return;
     }
     m_dynamics_world->addRigidBody(kart->getBody());
-    m_dynamics_world->addVehicle(kart->getVehicle());
+    m_dynamics_world->addKart(kart->getVehicle());
 }   // addKart
 
 //-----------------------------------------------------------------------------
@@ -141,7 +161,7 @@ void Physics::removeKart(const AbstractKart *kart)
     else
     {
         m_dynamics_world->removeRigidBody(kart->getBody());
-        m_dynamics_world->removeVehicle(kart->getVehicle());
+        m_dynamics_world->removeKart(kart->getVehicle());
     }
 }   // removeKart
 
@@ -151,6 +171,7 @@ void Physics::removeKart(const AbstractKart *kart)
  */
 void Physics::update(int ticks)
 {
+    Benchmark::Timer benchmark_timer(Benchmark::BS_PHYSICS);
     PROFILER_PUSH_CPU_MARKER("Physics", 0, 0, 0);
 
     m_physics_loop_active = true;
@@ -37,12 +37,13 @@
 class AbstractKart;
 class STKDynamicsWorld;
 class Vec3;
+class WorkerPool;
 
 /**
   * \ingroup physics
   */
 class Physics : public btSequentialImpulseConstraintSolver
-              , public AbstractSingleton<Physics>
+              , public AbstractSingleton<Physics, /*per_room*/true>
 {
 private:
     /** Bullet can report the same collision more than once (up to 4
@@ -144,6 +145,10 @@ private:
     /** Used in physics debugging to draw the physics world. */
     IrrDebugDrawer                  *m_debug_drawer;
 
+    /** Used to cast the rays of all karts in parallel, NULL if all rays
+     *  are cast in the main thread. */
+    WorkerPool                      *m_worker_pool;
+
     btCollisionDispatcher           *m_dispatcher;
     btBroadphaseInterface           *m_axis_sweep;
     btDefaultCollisionConfiguration *m_collision_conf;
@@ -156,7 +161,7 @@ private:
     virtual ~Physics();
 
     // Give the singleton access to the constructor
-    friend class AbstractSingleton<Physics>;
+    friend class AbstractSingleton<Physics, /*per_room*/true>;
 
 public:
     void  init             (const Vec3 &min_world, const Vec3 &max_world);
@@ -177,6 +182,8 @@ public:
     /** Returns true if the debug drawer is enabled. */
     bool  isDebug() const     {return m_debug_drawer->debugEnabled(); }
     IrrDebugDrawer* getDebugDrawer() { return m_debug_drawer; }
+    /** Returns the pool to cast rays in parallel, or NULL. */
+    WorkerPool* getWorkerPool() const { return m_worker_pool; }
     virtual btScalar solveGroup(btCollisionObject** bodies, int numBodies,
                                 btPersistentManifold** manifold,int numManifolds,
                                 btTypedConstraint** constraints,int numConstraints,
@@ -0,0 +1,427 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "physics/stk_dynamics_world.hpp"
+
+#include "physics/btKart.hpp"
+#include "utils/profiler.hpp"
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    /** The header of a physics checkpoint. */
+    struct CheckpointHeader
+    {
+        btScalar m_local_time;
+        uint32_t m_num_bodies;
+        uint32_t m_num_karts;
+        uint32_t m_num_manifolds;
+    };   // CheckpointHeader
+
+    /** Identifies the data of a kart in a checkpoint by the unique id of its
+     *  chassis body. */
+    struct KartCheckpointHeader
+    {
+        uint32_t m_body_id;
+        uint32_t m_size;
+    };   // KartCheckpointHeader
+}   // namespace
+
+// ----------------------------------------------------------------------------
+/** Assigns a new unique id to a rigid body added to this world. */
+void STKDynamicsWorld::assignBodyId(btRigidBody *body)
+{
+    m_body_ids[body] = m_next_body_id++;
+}   // assignBodyId
+
+// ----------------------------------------------------------------------------
+/** Returns the unique id of a rigid body in this world, or the maximum
+ *  value of uint32_t if the body is not in this world.
+ */
+uint32_t STKDynamicsWorld::getBodyId(const btRigidBody *body) const
+{
+    std::map<const btRigidBody*, uint32_t>::const_iterator id =
+        m_body_ids.find(body);
+    if (id == m_body_ids.end())
+        return std::numeric_limits<uint32_t>::max();
+    return id->second;
+}   // getBodyId
+
+// ----------------------------------------------------------------------------
+void STKDynamicsWorld::addRigidBody(btRigidBody *body)
+{
+    btDiscreteDynamicsWorld::addRigidBody(body);
+    assignBodyId(body);
+}   // addRigidBody
+
+// ----------------------------------------------------------------------------
+void STKDynamicsWorld::addRigidBody(btRigidBody *body, short group,
+                                    short mask)
+{
+    btDiscreteDynamicsWorld::addRigidBody(body, group, mask);
+    assignBodyId(body);
+}   // addRigidBody
+
+// ----------------------------------------------------------------------------
+void STKDynamicsWorld::removeRigidBody(btRigidBody *body)
+{
+    btDiscreteDynamicsWorld::removeRigidBody(body);
+    m_body_ids.erase(body);
+}   // removeRigidBody
+
+// ----------------------------------------------------------------------------
+/** Adds a kart (i.e. its vehicle) to this world.
+ *  \param kart The vehicle to add.
+ */
+void STKDynamicsWorld::addKart(btKart *kart)
+{
+    addVehicle(kart);
+    m_karts.push_back(kart);
+}   // addKart
+
+// ----------------------------------------------------------------------------
+/** Removes a kart (i.e. its vehicle) from this world.
+ *  \param kart The vehicle to remove.
+ */
+void STKDynamicsWorld::removeKart(btKart *kart)
+{
+    removeVehicle(kart);
+    m_karts.erase(std::remove(m_karts.begin(), m_karts.end(), kart),
+                  m_karts.end());
+}   // removeKart
+
+// ----------------------------------------------------------------------------
+/** Moves all bodies to their new positions, and then casts the wheel rays
+ *  of all karts, which are needed when the karts are updated next in
+ *  updateActions.
+ *  \param time_step The time step to integrate.
+ */
+void STKDynamicsWorld::integrateTransforms(btScalar time_step)
+{
+    btDiscreteDynamicsWorld::integrateTransforms(time_step);
+    castWheelRays();
+}   // integrateTransforms
+
+// ----------------------------------------------------------------------------
+/** Casts the wheel rays of all karts. Bullet only traverses its trees one
+ *  ray at a time, so instead of interleaving the rays with the vehicle
+ *  updates all rays are cast in one go, which keeps the track tree in the
+ *  cache, and is done in parallel if a worker pool is available. Each ray
+ *  only reads the physics world and each job only writes the wheels of its
+ *  own kart, so the result does not depend on the number of threads.
+ *  Note that all rays now see the world before any kart is updated, while
+ *  before a ray could see the additional rotation that an earlier kart
+ *  applied to its chassis in the same step.
+ */
+void STKDynamicsWorld::castWheelRays()
+{
+    PROFILER_PUSH_CPU_MARKER("Physics (wheel rays)", 0x80, 0x40, 0x00);
+    if (m_worker_pool)
+    {
+        m_worker_pool->parallelFor((unsigned)m_karts.size(),
+            [this](unsigned i) { m_karts[i]->castWheelRays(); });
+    }
+    else
+    {
+        for (btKart *kart : m_karts)
+            kart->castWheelRays();
+    }
+    PROFILER_POP_CPU_MARKER();
+}   // castWheelRays
+
+// ----------------------------------------------------------------------------
+/** Saves the state of this world in one contiguous block of memory: the
+ *  left over time, the transforms, velocities and activation state of all
+ *  dynamic bodies, the wheels and timed impulses of all karts and the
+ *  contact points (including the impulses used for warm starting the
+ *  solver) of all contact manifolds. Static and kinematic bodies are not
+ *  saved, since they are not moved by the physics. This must be called
+ *  between two physics steps, when no forces are applied to any body.
+ *  \param data The vector to store the checkpoint in.
+ */
+void STKDynamicsWorld::saveCheckpoint(std::vector<uint8_t> *data) const
+{
+    CheckpointHeader header;
+    header.m_local_time    = m_localTime;
+    header.m_num_bodies    = 0;
+    header.m_num_karts     = (uint32_t)m_karts.size();
+    header.m_num_manifolds = 0;
+
+    size_t size = sizeof(CheckpointHeader);
+    for (int i = 0; i < m_nonStaticRigidBodies.size(); i++)
+    {
+        if (!m_nonStaticRigidBodies[i]->isStaticOrKinematicObject())
+            header.m_num_bodies++;
+    }
+    size += header.m_num_bodies * sizeof(BodyCheckpoint);
+    for (const btKart *kart : m_karts)
+        size += sizeof(KartCheckpointHeader) + kart->getCheckpointSize();
+    for (int i = 0; i < m_dispatcher1->getNumManifolds(); i++)
+    {
+        const btPersistentManifold *manifold =
+            m_dispatcher1->getManifoldByIndexInternal(i);
+        if (manifold->getNumContacts() == 0)
+            continue;
+        header.m_num_manifolds++;
+        size += sizeof(ManifoldCheckpoint) +
+                manifold->getNumContacts() * sizeof(btManifoldPoint);
+    }
+
+    data->resize(size);
+    uint8_t *p = data->data();
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+
+    for (int i = 0; i < m_nonStaticRigidBodies.size(); i++)
+    {
+        btRigidBody *body = m_nonStaticRigidBodies[i];
+        if (body->isStaticOrKinematicObject())
+            continue;
+        BodyCheckpoint b;
+        b.m_transform                      = body->getWorldTransform();
+        b.m_interpolation_transform        =
+            body->getInterpolationWorldTransform();
+        b.m_linear_velocity                = body->getLinearVelocity();
+        b.m_angular_velocity               = body->getAngularVelocity();
+        b.m_interpolation_linear_velocity  =
+            body->getInterpolationLinearVelocity();
+        b.m_interpolation_angular_velocity =
+            body->getInterpolationAngularVelocity();
+        b.m_body                           = body;
+        b.m_id                             = getBodyId(body);
+        b.m_activation_state               = body->getActivationState();
+        b.m_deactivation_time              = body->getDeactivationTime();
+        b.m_hit_fraction                   = body->getHitFraction();
+        memcpy(p, static_cast<const void*>(&b), sizeof(b));
+        p += sizeof(b);
+    }
+
+    for (const btKart *kart : m_karts)
+    {
+        KartCheckpointHeader k;
+        k.m_body_id = getBodyId(kart->getRigidBody());
+        k.m_size    = kart->getCheckpointSize();
+        memcpy(p, &k, sizeof(k));
+        p += sizeof(k);
+        kart->saveCheckpoint(p);
+        p += k.m_size;
+    }
+
+    for (int i = 0; i < m_dispatcher1->getNumManifolds(); i++)
+    {
+        const btPersistentManifold *manifold =
+            m_dispatcher1->getManifoldByIndexInternal(i);
+        if (manifold->getNumContacts() == 0)
+            continue;
+        ManifoldCheckpoint m;
+        m.m_manifold     = manifold;
+        m.m_body0        = manifold->getBody0();
+        m.m_body1        = manifold->getBody1();
+        m.m_num_contacts = manifold->getNumContacts();
+        memcpy(p, &m, sizeof(m));
+        p += sizeof(m);
+        for (int j = 0; j < m.m_num_contacts; j++)
+        {
+            memcpy(p, static_cast<const void*>(&manifold->getContactPoint(j)),
+                   sizeof(btManifoldPoint));
+            p += sizeof(btManifoldPoint);
+        }
+    }
+    assert(p == data->data() + data->size());
+}   // saveCheckpoint
+
+// ----------------------------------------------------------------------------
+/** Restores a checkpoint saved with saveCheckpoint. Bodies and karts which
+ *  were removed from the world since then are ignored, and bodies added
+ *  since then keep their current state. Contact manifolds which did not
+ *  exist (or had no contacts) in the checkpoint are cleared, they will be
+ *  rebuilt by the collision detection in the next physics step.
+ *  \param data The checkpoint.
+ *  \param skip_bodies Bodies which are not restored, because they are
+ *         restored from a network state afterwards anyway. The wheels of
+ *         a kart are restored even if its chassis is skipped.
+ */
+void STKDynamicsWorld::restoreCheckpoint(const std::vector<uint8_t> &data,
+                               const std::set<const btRigidBody*> &skip_bodies)
+{
+    const uint8_t *p = data.data();
+    CheckpointHeader header;
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+    m_localTime = header.m_local_time;
+
+    for (uint32_t i = 0; i < header.m_num_bodies; i++)
+    {
+        BodyCheckpoint b;
+        memcpy(static_cast<void*>(&b), p, sizeof(b));
+        p += sizeof(b);
+        if (getBodyId(b.m_body) != b.m_id ||
+            skip_bodies.find(b.m_body) != skip_bodies.end())
+            continue;
+
+        btRigidBody *body = b.m_body;
+        body->setCenterOfMassTransform(b.m_transform);
+        body->setInterpolationWorldTransform(b.m_interpolation_transform);
+        body->setLinearVelocity(b.m_linear_velocity);
+        body->setAngularVelocity(b.m_angular_velocity);
+        body->setInterpolationLinearVelocity(
+                                           b.m_interpolation_linear_velocity);
+        body->setInterpolationAngularVelocity(
+                                          b.m_interpolation_angular_velocity);
+        body->clearForces();
+        body->forceActivationState(b.m_activation_state);
+        body->setDeactivationTime(b.m_deactivation_time);
+        body->setHitFraction(b.m_hit_fraction);
+        synchronizeSingleMotionState(body);
+        if (body->getBroadphaseHandle())
+            updateSingleAabb(body);
+    }
+
+    for (uint32_t i = 0; i < header.m_num_karts; i++)
+    {
+        KartCheckpointHeader k;
+        memcpy(&k, p, sizeof(k));
+        p += sizeof(k);
+        for (btKart *kart : m_karts)
+        {
+            if (getBodyId(kart->getRigidBody()) == k.m_body_id &&
+                kart->getCheckpointSize() == k.m_size)
+            {
+                kart->restoreCheckpoint(p);
+                break;
+            }
+        }
+        p += k.m_size;
+    }
+
+    m_restored_manifolds.clear();
+    for (uint32_t i = 0; i < header.m_num_manifolds; i++)
+    {
+        ManifoldCheckpoint m;
+        memcpy(&m, p, sizeof(m));
+        m_restored_manifolds.emplace_back(m.m_manifold, p);
+        p += sizeof(m) + m.m_num_contacts * sizeof(btManifoldPoint);
+    }
+    assert(p == data.data() + data.size());
+    std::sort(m_restored_manifolds.begin(), m_restored_manifolds.end());
+
+    for (int i = 0; i < m_dispatcher1->getNumManifolds(); i++)
+    {
+        btPersistentManifold *manifold =
+            m_dispatcher1->getManifoldByIndexInternal(i);
+        manifold->clearManifold();
+        std::vector<std::pair<const btPersistentManifold*,
+            const uint8_t*> >::const_iterator saved =
+            std::lower_bound(m_restored_manifolds.begin(),
+                             m_restored_manifolds.end(),
+                             std::make_pair((const btPersistentManifold*)
+                                            manifold, (const uint8_t*)NULL));
+        if (saved == m_restored_manifolds.end() || saved->first != manifold)
+            continue;
+        ManifoldCheckpoint m;
+        memcpy(&m, saved->second, sizeof(m));
+        if (m.m_body0 != manifold->getBody0() ||
+            m.m_body1 != manifold->getBody1()    )
+            continue;
+        const uint8_t *point = saved->second + sizeof(m);
+        for (int j = 0; j < m.m_num_contacts; j++)
+        {
+            btManifoldPoint pt;
+            memcpy(static_cast<void*>(&pt), point, sizeof(pt));
+            pt.m_userPersistentData = NULL;
+            manifold->addManifoldPoint(pt);
+            point += sizeof(pt);
+        }
+    }
+}   // restoreCheckpoint
+
+// ----------------------------------------------------------------------------
+/** Tests that restoring a checkpoint reproduces the simulation exactly.
+ */
+void STKDynamicsWorld::unitTesting()
+{
+    btDefaultCollisionConfiguration configuration;
+    btCollisionDispatcher dispatcher(&configuration);
+    btDbvtBroadphase broadphase;
+    btSequentialImpulseConstraintSolver solver;
+    STKDynamicsWorld world(&dispatcher, &broadphase, &solver,
+                           &configuration);
+    world.setGravity(btVector3(0, -9.8f, 0));
+
+    btBoxShape ground_shape(btVector3(50, 1, 50));
+    btRigidBody ground(0, NULL, &ground_shape);
+    world.addRigidBody(&ground);
+
+    btBoxShape box_shape(btVector3(0.5f, 0.5f, 0.5f));
+    btVector3 inertia;
+    box_shape.calculateLocalInertia(1.0f, inertia);
+    btTransform start(btQuaternion(btVector3(1, 0, 1), 0.3f),
+                      btVector3(0, 3, 0));
+    btDefaultMotionState motion_state(start);
+    btRigidBody box(1.0f, &motion_state, &box_shape, inertia);
+    box.setAngularVelocity(btVector3(0, 2, 0));
+    world.addRigidBody(&box);
+
+    // Let the box hit the ground, so that contacts are saved, too
+    const float dt = 1.0f / 120.0f;
+    for (int i = 0; i < 120; i++)
+        world.stepSimulation(dt, 1, dt);
+    assert(dispatcher.getNumManifolds() > 0);
+
+    std::vector<uint8_t> checkpoint;
+    world.saveCheckpoint(&checkpoint);
+    for (int i = 0; i < 60; i++)
+        world.stepSimulation(dt, 1, dt);
+    const btTransform expected_transform = box.getWorldTransform();
+    const btVector3 expected_velocity    = box.getLinearVelocity();
+
+    // A body added after the checkpoint keeps its state
+    btDefaultMotionState other_state(btTransform(btQuaternion(0, 0, 0, 1),
+                                                 btVector3(20, 5, 20)));
+    btRigidBody other(1.0f, &other_state, &box_shape, inertia);
+    world.addRigidBody(&other);
+
+    world.restoreCheckpoint(checkpoint);
+    assert(other.getWorldTransform().getOrigin() == btVector3(20, 5, 20));
+    world.removeRigidBody(&other);
+    for (int i = 0; i < 60; i++)
+        world.stepSimulation(dt, 1, dt);
+    assert(box.getWorldTransform().getOrigin() ==
+           expected_transform.getOrigin());
+    assert(box.getWorldTransform().getBasis() ==
+           expected_transform.getBasis());
+    assert(box.getLinearVelocity() == expected_velocity);
+
+    // A skipped body keeps its state
+    std::set<const btRigidBody*> skip_bodies;
+    skip_bodies.insert(&box);
+    world.restoreCheckpoint(checkpoint, skip_bodies);
+    assert(box.getWorldTransform().getOrigin() ==
+           expected_transform.getOrigin());
+
+    // A removed body is ignored
+    world.removeRigidBody(&box);
+    world.restoreCheckpoint(checkpoint);
+    assert(box.getWorldTransform().getOrigin() ==
+           expected_transform.getOrigin());
+    world.removeRigidBody(&ground);
+}   // unitTesting
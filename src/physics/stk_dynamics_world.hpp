@@ -21,25 +21,116 @@
 
 #include "btBulletDynamicsCommon.h"
 
+#include "utils/cpp2011.hpp"
+#include "utils/types.hpp"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+class btKart;
+class WorkerPool;
+
 /** A thin wrapper around bullet's btDiscreteDynamicsWorld. Used to
  *  be able to query and set the 'left over' time from a previous
  *  time step, which is needed for more precise rewind/replays.
+ *  It also casts the wheel rays of all karts together in each physics
+ *  step, before the karts are updated, and can save and restore the state
+ *  of all dynamic bodies, karts and contacts in a checkpoint.
  */
 class STKDynamicsWorld : public btDiscreteDynamicsWorld
 {
+private:
+    /** All karts in this world, in the order in which they were added. */
+    std::vector<btKart*> m_karts;
+
+    /** If not NULL the wheel rays of the karts are cast in parallel with
+     *  this pool. Not owned by this object. */
+    WorkerPool *m_worker_pool;
+
+    /** A unique id for each rigid body in this world. A checkpoint only
+     *  restores bodies (and karts, identified by their chassis) whose
+     *  address and id are unchanged, so that a body which was allocated at
+     *  the address of a removed body is ignored. */
+    std::map<const btRigidBody*, uint32_t> m_body_ids;
+
+    /** The id for the next rigid body added. */
+    uint32_t m_next_body_id;
+
+    /** The state of a dynamic rigid body in a checkpoint. */
+    struct BodyCheckpoint
+    {
+        btTransform      m_transform;
+        btTransform      m_interpolation_transform;
+        btVector3        m_linear_velocity;
+        btVector3        m_angular_velocity;
+        btVector3        m_interpolation_linear_velocity;
+        btVector3        m_interpolation_angular_velocity;
+        btRigidBody     *m_body;
+        uint32_t         m_id;
+        int              m_activation_state;
+        btScalar         m_deactivation_time;
+        btScalar         m_hit_fraction;
+    };   // BodyCheckpoint
+
+    /** Identifies a contact manifold in a checkpoint. It is followed by the
+     *  m_num_contacts contact points. */
+    struct ManifoldCheckpoint
+    {
+        const btPersistentManifold *m_manifold;
+        const void                 *m_body0;
+        const void                 *m_body1;
+        int                         m_num_contacts;
+    };   // ManifoldCheckpoint
+
+    /** The manifolds of the checkpoint being restored, sorted by address.
+     *  A member so that its memory is reused by the next restore. */
+    std::vector<std::pair<const btPersistentManifold*, const uint8_t*> >
+        m_restored_manifolds;
+
+    void castWheelRays();
+    void assignBodyId(btRigidBody *body);
+    uint32_t getBodyId(const btRigidBody *body) const;
+
+protected:
+    virtual void integrateTransforms(btScalar time_step) OVERRIDE;
+
 public:
     /** The standard constructor which just created a btDiscreteDynamicsWorld. */
     STKDynamicsWorld(btDispatcher*             dispatcher,
                      btBroadphaseInterface*    pairCache,
                      btConstraintSolver*       constraintSolver,
-                     btCollisionConfiguration* collisionConfiguration)
+                     btCollisionConfiguration* collisionConfiguration,
+                     WorkerPool*               worker_pool = NULL)
 
                    : btDiscreteDynamicsWorld(dispatcher, pairCache,
                                              constraintSolver,
                                              collisionConfiguration)
     {
+        m_worker_pool  = worker_pool;
+        m_next_body_id = 0;
     }
-
+    // ------------------------------------------------------------------------
+    virtual void addRigidBody(btRigidBody *body) OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual void addRigidBody(btRigidBody *body, short group,
+                              short mask) OVERRIDE;
+    // ------------------------------------------------------------------------
+    virtual void removeRigidBody(btRigidBody *body) OVERRIDE;
+    // ------------------------------------------------------------------------
+    void addKart(btKart *kart);
+    // ------------------------------------------------------------------------
+    void removeKart(btKart *kart);
+    // ------------------------------------------------------------------------
+    void saveCheckpoint(std::vector<uint8_t> *data) const;
+    // ------------------------------------------------------------------------
+    void restoreCheckpoint(const std::vector<uint8_t> &data,
+                           const std::set<const btRigidBody*> &skip_bodies =
+                           std::set<const btRigidBody*>());
+    // ------------------------------------------------------------------------
+    static void unitTesting();
+    // ------------------------------------------------------------------------
     /** Resets m_localTime to 0. This allows more precise replay of
      *  physics, which is important for replaying histories. */
     void resetLocalTime() { m_localTime = 0; }
@@ -52,4 +143,3 @@ public:
 };   // STKDynamicsWorld
 #endif
 /* EOF */
-
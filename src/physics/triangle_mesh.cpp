@@ -19,13 +19,17 @@
 #include "physics/triangle_mesh.hpp"
 
 #include "config/stk_config.hpp"
+#include "config/user_config.hpp"
+#include "io/file_manager.hpp"
 #include "physics/physics.hpp"
 #include "utils/constants.hpp"
+#include "utils/log.hpp"
+#include "utils/string_utils.hpp"
 #include "utils/time.hpp"
 
 #include "btBulletDynamicsCommon.h"
 
-#include <fstream>
+#include <cstdio>
 
 // -----------------------------------------------------------------------------
 /** Constructor: Initialises all data structures with zero.
@@ -43,6 +47,7 @@ TriangleMesh::TriangleMesh(bool can_be_transformed) : m_mesh()
     // (and m_mesh->m_weldingThreshold at m_normals
     m_collision_shape  = NULL;
     m_collision_object = NULL;
+    m_bvh_buffer       = NULL;
     m_user_pointer.set(this);
 }   // TriangleMesh
 
@@ -85,13 +90,204 @@ void TriangleMesh::addTriangle(const btVector3 &t1, const btVector3 &t2,
     m_p1p2p3.push_back(edge1.cross(edge2).length2());
 }   // addTriangle
 
+// -----------------------------------------------------------------------------
+/** Returns a hash of the triangle data of this mesh, which is used to
+ *  identify the cached bvh of this mesh.
+ */
+uint64_t TriangleMesh::getContentHash() const
+{
+    // 64 bit FNV-1a hash
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const void* data, size_t size)
+    {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    const IndexedMeshArray &meshes = m_mesh.getIndexedMeshArray();
+    for (int i = 0; i < meshes.size(); i++)
+    {
+        const btIndexedMesh &m = meshes[i];
+        add(&m.m_numTriangles, sizeof(m.m_numTriangles));
+        add(&m.m_numVertices, sizeof(m.m_numVertices));
+        // Only use x, y and z of each vertex, the 4th component is unused
+        for (int j = 0; j < m.m_numVertices; j++)
+        {
+            add(m.m_vertexBase + j * m.m_vertexStride,
+                3 * sizeof(btScalar));
+        }
+        add(m.m_triangleIndexBase,
+            m.m_numTriangles * m.m_triangleIndexStride);
+    }
+    return hash;
+}   // getContentHash
+
+// -----------------------------------------------------------------------------
+/** Returns the full path of the cached bvh file for this mesh. The bullet
+ *  version and the size of the bvh class are part of the name, since the
+ *  serialized bvh depends on both.
+ */
+std::string TriangleMesh::getCachedBvhFile() const
+{
+    char hash[17];
+    snprintf(hash, 17, "%016llx", (unsigned long long)getContentHash());
+    return file_manager->getCachedBVHDir() + hash + getCachedBvhSuffix();
+}   // getCachedBvhFile
+
+// -----------------------------------------------------------------------------
+/** Returns the end of the name of all cached bvh files that can be used by
+ *  this executable, i.e. bullet version and size of the bvh class.
+ */
+std::string TriangleMesh::getCachedBvhSuffix()
+{
+    return StringUtils::insertValues("-%d-%d.bvh", BT_BULLET_VERSION,
+                                     (int)sizeof(btOptimizedBvh));
+}   // getCachedBvhSuffix
+
+// -----------------------------------------------------------------------------
+/** Removes files from the bvh cache after a new bvh was saved: all files of
+ *  other bullet versions or bvh layouts (which can never be loaded by this
+ *  executable), temporary files left over by a crash, and then the least
+ *  recently used files if the cache is larger than max-cached-bvh-size.
+ *  The bvh of a changed track is not found anymore (since the hash of its
+ *  triangles changed), so its old file is removed by the size limit.
+ */
+void TriangleMesh::pruneCachedBvh()
+{
+    const std::string dir = file_manager->getCachedBVHDir();
+    const std::string suffix = getCachedBvhSuffix();
+    // A temporary file could still be written by another process
+    const uint64_t max_tmp_age = 3600 * 1000;
+    const uint64_t now = StkTime::getRealTimeMs();
+
+    std::set<std::string> files;
+    file_manager->listFiles(files, dir, /*make_full_path*/false);
+    for (const std::string& file : files)
+    {
+        if (StringUtils::hasSuffix(file, ".tmp"))
+        {
+            // The name contains the time at which it was written
+            std::vector<std::string> parts = StringUtils::split(file, '.');
+            uint64_t time = 0;
+            if (parts.size() >= 3 &&
+                StringUtils::fromString(parts[parts.size() - 2], time) &&
+                time + max_tmp_age < now)
+                file_manager->removeFile(dir + file);
+        }
+        else if (StringUtils::hasSuffix(file, ".bvh") &&
+                 !StringUtils::hasSuffix(file, suffix))
+        {
+            file_manager->removeFile(dir + file);
+        }
+    }
+    if (UserConfigParams::m_max_cached_bvh_size > 0)
+    {
+        file_manager->limitDirectorySize(dir,
+            (uint64_t)UserConfigParams::m_max_cached_bvh_size * 1024 * 1024);
+    }
+}   // pruneCachedBvh
+
+// -----------------------------------------------------------------------------
+/** Tries to load the bvh of this mesh from the cache. The bvh is
+ *  deserialized in place, the loaded buffer is stored in m_bvh_buffer.
+ *  \return The collision shape using the cached bvh, or NULL if there is no
+ *          (valid) cached bvh.
+ */
+btBvhTriangleMeshShape* TriangleMesh::loadCachedBvh()
+{
+    const std::string file = getCachedBvhFile();
+    FILE *f = fopen(file.c_str(), "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < (long)sizeof(btOptimizedBvh))
+    {
+        fclose(f);
+        Log::warn("TriangleMesh", "Ignoring invalid cached bvh '%s'.",
+                  file.c_str());
+        return NULL;
+    }
+
+    void* bytes = btAlignedAlloc(size, 16);
+    const bool success = fread(bytes, size, 1, f) == 1;
+    fclose(f);
+    btOptimizedBvh* bvh = NULL;
+    if (success)
+    {
+        bvh = btOptimizedBvh::deSerializeInPlace(bytes, (unsigned)size,
+                                                 !IS_LITTLE_ENDIAN);
+    }
+    if (bvh == NULL || !bvh->isQuantized())
+    {
+        btAlignedFree(bytes);
+        Log::warn("TriangleMesh", "Failed to load cached bvh '%s'.",
+                  file.c_str());
+        return NULL;
+    }
+    // Do *NOT* free the bytes now, 'deSerializeInPlace' makes the
+    // btOptimizedBvh object directly at this memory location
+    m_bvh_buffer = bytes;
+    // Keep the modification time as time of last use for pruneCachedBvh
+    file_manager->touchFile(file);
+    btBvhTriangleMeshShape* shape =
+        new btBvhTriangleMeshShape(&m_mesh,
+                                   true  /* useQuantizedAabbCompression */,
+                                   false /* buildBvh */);
+    shape->setOptimizedBvh(bvh);
+    return shape;
+}   // loadCachedBvh
+
+// -----------------------------------------------------------------------------
+/** Saves the bvh of the given shape in the cache. The file is written under
+ *  a temporary name first, so that processes loading the same track at the
+ *  same time never read a partially written file.
+ *  \param shape The shape with the bvh to save.
+ */
+void TriangleMesh::saveCachedBvh(btBvhTriangleMeshShape* shape) const
+{
+    btOptimizedBvh* bvh = shape->getOptimizedBvh();
+    unsigned int size = bvh->calculateSerializeBufferSize();
+    void* buffer = btAlignedAlloc(size, 16);
+    bool success = bvh->serializeInPlace(buffer, size, !IS_LITTLE_ENDIAN);
+
+    const std::string file = getCachedBvhFile();
+    const std::string tmp_file = file + "." +
+        StringUtils::toString(StkTime::getRealTimeMs()) + ".tmp";
+    FILE *f = success ? fopen(tmp_file.c_str(), "wb") : NULL;
+    if (f)
+    {
+        success = fwrite(buffer, size, 1, f) == 1;
+        success = fclose(f) == 0 && success;
+        if (!success || rename(tmp_file.c_str(), file.c_str()) != 0)
+        {
+            success = false;
+            file_manager->removeFile(tmp_file);
+        }
+    }
+    else
+        success = false;
+    btAlignedFree(buffer);
+    if (success)
+        pruneCachedBvh();
+    else
+        Log::warn("TriangleMesh", "Failed to save bvh to '%s'.", file.c_str());
+}   // saveCachedBvh
+
 // -----------------------------------------------------------------------------
 /** Creates a collision body only, which can be used for raycasting, but
  *  has no physical properties.
- *  @param serialized_bhv if non-null, load the serialized bhv from file instead
- *                        of builing it on the fly
+ *  \param create_collision_object If a collision object should be created.
+ *  \param cache_bvh If true, the bvh is loaded from the cache if it exists,
+ *         otherwise it is built and saved in the cache (used for track
+ *         meshes, for which building the bvh takes a noticeable time).
  */
-void TriangleMesh::createCollisionShape(bool create_collision_object, const char* serialized_bhv)
+void TriangleMesh::createCollisionShape(bool create_collision_object,
+                                        bool cache_bvh)
 {
     if(m_triangleIndex2Material.size()==0)
     {
@@ -102,55 +298,15 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
         return;
     }
     // Now convert the triangle mesh into a static rigid body
-    btBvhTriangleMeshShape* bhv_triangle_mesh;
-
-    if (serialized_bhv != NULL)
-    {
-        FILE *f = fopen(serialized_bhv, "rb");
-        fseek(f, 0, SEEK_END);
-        long pos = ftell(f);
-        assert(pos != -1L);
-        fseek(f, 0, SEEK_SET);
-
-        void* bytes = btAlignedAlloc(pos, 16);
-        fread(bytes, pos, 1, f);
-        fclose(f);
-
-        btOptimizedBvh* bhv = btOptimizedBvh::deSerializeInPlace(bytes, pos, !IS_LITTLE_ENDIAN);
-        if (bhv == NULL)
-        {
-            Log::warn("TriangleMesh", "Failed to load serialized BHV");
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
-        }
-        else
-        {
-            bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */,
-                                                           false /* buildBvh */);
-            bhv_triangle_mesh->setOptimizedBvh( bhv );
-        }
-        // Do *NOT* free the bytes, 'deSerializeInPlace' makes the btOptimizedBvh object
-        // directly at this memory location
-        //free(bytes);
+    btBvhTriangleMeshShape* bhv_triangle_mesh =
+        cache_bvh ? loadCachedBvh() : NULL;
 
-    }
-    else
+    if (bhv_triangle_mesh == NULL)
     {
-        bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh, false /* useQuantizedAabbCompression */);
-
-        /*
-         // code to serialize triangle mesh
-        btOptimizedBvh* bvh = bhv_triangle_mesh->getOptimizedBvh();
-        unsigned int ssize = bvh->calculateSerializeBufferSize();
-        char* buffer = (char*)btAlignedAlloc(ssize, 16);
-        bool success = bvh->serialize(buffer, ssize, !IS_LITTLE_ENDIAN);
-        printf("serialization success = %i\n", success);
-
-        std::ofstream fileout("/tmp/btOptimizedBvh");
-        fileout.write(buffer, ssize);
-        fileout.close();
-
-        btAlignedFree(buffer);
-         */
+        bhv_triangle_mesh = new btBvhTriangleMeshShape(&m_mesh,
+            true /* useQuantizedAabbCompression */);
+        if (cache_bvh)
+            saveCachedBvh(bhv_triangle_mesh);
     }
 
     m_collision_shape = bhv_triangle_mesh;
@@ -177,16 +333,17 @@ void TriangleMesh::createCollisionShape(bool create_collision_object, const char
  *  for height of terrain detection).
  *  \param friction Friction to be used for this TriangleMesh.
  *  \param flags Additional collision flags (default 0).
- *  \param serializedBhv if non-NULL, the bhv is deserialized instead of
- *                       being calculated on the fly
+ *  \param cache_bvh If the bvh should be loaded from or saved to the cache.
+ *  If the collision shape still exists (see removeBody), it is reused.
  */
 void TriangleMesh::createPhysicalBody(float friction,
                                       btCollisionObject::CollisionFlags flags,
-                                      const char* serializedBhv)
+                                      bool cache_bvh)
 {
     // We need the collision shape, but not the collision object (since
     // this will be created when the dynamics body is anyway).
-    createCollisionShape(/*create_collision_object*/false, serializedBhv);
+    if (!m_collision_shape)
+        createCollisionShape(/*create_collision_object*/false, cache_bvh);
     btTransform startTransform;
     startTransform.setIdentity();
     m_motion_state = new btDefaultMotionState(startTransform);
@@ -212,6 +369,29 @@ void TriangleMesh::createPhysicalBody(float friction,
  *  again.
  */
 void TriangleMesh::removeAll()
+{
+    removeBody();
+    if(m_collision_object)
+    {
+        delete m_collision_object;
+        m_collision_object = NULL;
+    }
+    delete m_collision_shape;
+    m_collision_shape = NULL;
+    if (m_bvh_buffer)
+    {
+        btAlignedFree(m_bvh_buffer);
+        m_bvh_buffer = NULL;
+    }
+}   // removeAll
+
+// ----------------------------------------------------------------------------
+/** Removes only the physical body from the physics world, but keeps the
+ *  triangles and the collision shape (including its bvh). This allows a
+ *  cached track mesh to be added to the physics world of a later race by
+ *  calling createPhysicalBody again.
+ */
+void TriangleMesh::removeBody()
 {
     // Don't free the physical body if it was created outside this object.
     if(m_body && m_free_body)
@@ -222,14 +402,23 @@ void TriangleMesh::removeAll()
         m_body         = NULL;
         m_motion_state = NULL;
     }
-    if(m_collision_object)
+}   // removeBody
+
+// ----------------------------------------------------------------------------
+/** Returns true if any triangle of this mesh uses one of the given
+ *  materials.
+ *  \param materials The materials to test for.
+ */
+bool TriangleMesh::usesAnyMaterial(const std::set<const Material*> &materials)
+                                                                          const
+{
+    for (const Material* m : m_triangleIndex2Material)
     {
-        delete m_collision_object;
-        m_collision_object = NULL;
+        if (materials.find(m) != materials.end())
+            return true;
     }
-    delete m_collision_shape;
-    m_collision_shape = NULL;
-}   // removeAll
+    return false;
+}   // usesAnyMaterial
 
 // -----------------------------------------------------------------------------
 /** Interpolates the normal at the given position for the triangle with
@@ -19,6 +19,9 @@
 #ifndef HEADER_TRIANGLE_MESH_HPP
 #define HEADER_TRIANGLE_MESH_HPP
 
+#include <set>
+#include <stdint.h>
+#include <string>
 #include <vector>
 #include "btBulletDynamicsCommon.h"
 
@@ -57,6 +60,18 @@ private:
      *  to the current transform of the body. */
     bool m_can_be_transformed;
 
+    /** The buffer of a bvh loaded from the cache. The bvh is deserialized in
+     *  place, so the buffer must be kept till the collision shape is
+     *  deleted. */
+    void                        *m_bvh_buffer;
+
+    uint64_t getContentHash() const;
+    std::string getCachedBvhFile() const;
+    btBvhTriangleMeshShape* loadCachedBvh();
+    void saveCachedBvh(btBvhTriangleMeshShape* shape) const;
+    static std::string getCachedBvhSuffix();
+    static void pruneCachedBvh();
+
 public:
     class RigidBodyTriangleMesh : public btRigidBody
     {
@@ -76,12 +91,15 @@ public:
                      const btVector3 &t3, const btVector3 &n1,
                      const btVector3 &n2, const btVector3 &n3,
                      const Material* m);
-    void createCollisionShape(bool create_collision_object=true, const char* serialized_bhv=NULL);
+    void createCollisionShape(bool create_collision_object=true,
+                              bool cache_bvh=false);
     void createPhysicalBody(float friction,
                             btCollisionObject::CollisionFlags flags=
                                (btCollisionObject::CollisionFlags)0,
-                            const char* serializedBhv = NULL);
+                            bool cache_bvh=false);
     void removeAll();
+    void removeBody();
+    bool usesAnyMaterial(const std::set<const Material*> &materials) const;
     void removeCollisionObject();
     btVector3 getInterpolatedNormal(unsigned int index,
                                     const btVector3 &position) const;
@@ -60,7 +60,7 @@
 #include "tracks/track_manager.hpp"
 #include "utils/ptr_vector.hpp"
 
-RaceManager* race_manager= NULL;
+PerRoom<RaceManager*> race_manager;
 
 /** Constructs the race manager.
  */
@@ -32,6 +32,7 @@
 
 #include "network/remote_kart_info.hpp"
 #include "race/grand_prix_data.hpp"
+#include "utils/server_room.hpp"
 #include "utils/translation.hpp"
 #include "utils/vec3.hpp"
 
@@ -899,7 +900,7 @@ public:
 
 };   // RaceManager
 
-extern RaceManager *race_manager;
+extern PerRoom<RaceManager*> race_manager;
 #endif
 
 /* EOF */
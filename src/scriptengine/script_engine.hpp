@@ -56,13 +56,14 @@ namespace Scripting
         ~PendingTimeout();
     };
 
-    class ScriptEngine : public AbstractSingleton<ScriptEngine>
+    class ScriptEngine
+        : public AbstractSingleton<ScriptEngine, /*per_room*/true>
     {
          ScriptEngine();
         ~ScriptEngine();
 
         // Give the singleton access to the constructor.
-        friend class AbstractSingleton<ScriptEngine>;
+        friend class AbstractSingleton<ScriptEngine, /*per_room*/true>;
 
     public:
 
@@ -20,7 +20,7 @@
 #include "config/user_config.hpp"
 #include "input/device_manager.hpp"
 #include "network/network_config.hpp"
-#include "network/protocols/lobby_protocol.hpp"
+#include "network/protocols/client_lobby.hpp"
 #include "network/stk_host.hpp"
 #include "states_screens/state_manager.hpp"
 #include "states_screens/online/tracks_screen.hpp"
@@ -78,15 +78,11 @@ void NetworkKartSelectionScreen::allPlayersDone()
             ->incrementUseFrequency();
     }
 
-    const uint8_t kart_count = (uint8_t)m_kart_widgets.size();
+    std::vector<std::string> karts;
+    for (unsigned n = 0; n < m_kart_widgets.size(); n++)
+        karts.push_back(m_kart_widgets[n].m_kart_internal_name);
     NetworkString kart(PROTOCOL_LOBBY_ROOM);
-    kart.addUInt8(LobbyProtocol::LE_KART_SELECTION).addUInt8(kart_count);
-    for (unsigned n = 0; n < kart_count; n++)
-    {
-        // If server recieve an invalid name, it will auto correct to a random
-        // kart
-        kart.encodeString(m_kart_widgets[n].m_kart_internal_name);
-    }
+    ClientLobby::encodeKartSelection(&kart, karts);
     STKHost::get()->sendToServer(&kart, true);
 
     // ---- Switch to assign mode
@@ -359,8 +359,7 @@ void TracksScreen::init()
     {
         assert(!m_random_track_list.empty());
         NetworkString vote(PROTOCOL_LOBBY_ROOM);
-        vote.addUInt8(LobbyProtocol::LE_VOTE);
-        vote.encodeString(m_random_track_list[0]).addUInt8(1).addUInt8(0);
+        ClientLobby::encodeVote(&vote, m_random_track_list[0], 1, false);
         STKHost::get()->sendToServer(&vote, true);
     }
 }   // init
@@ -477,23 +476,21 @@ void TracksScreen::voteForPlayer()
         UserConfigParams::m_random_arena_item = m_reversed->getState();
 
     NetworkString vote(PROTOCOL_LOBBY_ROOM);
-    vote.addUInt8(LobbyProtocol::LE_VOTE);
     if (race_manager->getMinorMode() == RaceManager::MINOR_MODE_FREE_FOR_ALL)
     {
-        vote.encodeString(m_selected_track->getIdent())
-            .addUInt8(0).addUInt8(m_reversed->getState() ? 1 : 0);
+        ClientLobby::encodeVote(&vote, m_selected_track->getIdent(), 0,
+            m_reversed->getState());
     }
     else if (race_manager->getMinorMode() ==
         RaceManager::MINOR_MODE_CAPTURE_THE_FLAG)
     {
-        vote.encodeString(m_selected_track->getIdent())
-            .addUInt8(0).addUInt8(0);
+        ClientLobby::encodeVote(&vote, m_selected_track->getIdent(), 0,
+            false);
     }
     else
     {
-        vote.encodeString(m_selected_track->getIdent())
-            .addUInt8(m_laps->getValue())
-            .addUInt8(m_reversed->getState() ? 1 : 0);
+        ClientLobby::encodeVote(&vote, m_selected_track->getIdent(),
+            (uint8_t)m_laps->getValue(), m_reversed->getState());
     }
     STKHost::get()->sendToServer(&vote, true);
 }   // voteForPlayer
@@ -66,7 +66,8 @@ private:
     virtual void differentNodeColor(int n, video::SColor* c) const OVERRIDE;
 
 public:
-    static ArenaGraph* get()     { return dynamic_cast<ArenaGraph*>(m_graph); }
+    static ArenaGraph* get()
+                         { return dynamic_cast<ArenaGraph*>(m_graph.get()); }
     // ------------------------------------------------------------------------
     static void unitTesting();
     // ------------------------------------------------------------------------
@@ -32,7 +32,7 @@
 #include "tracks/drive_graph.hpp"
 #include "utils/log.hpp"
 
-CheckManager *CheckManager::m_check_manager = NULL;
+PerRoom<CheckManager*> CheckManager::m_check_manager;
 
 /** Loads all check structure informaiton from the specified xml file.
  */
@@ -105,7 +105,7 @@ CheckManager::~CheckManager()
     {
         delete m_all_checks[i];
     }
-    m_check_manager = NULL;
+    m_check_manager.get() = NULL;
 }   // ~CheckManager
 
 // ----------------------------------------------------------------------------
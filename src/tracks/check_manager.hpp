@@ -20,6 +20,7 @@
 #define HEADER_CHECK_MANAGER_HPP
 
 #include "utils/no_copy.hpp"
+#include "utils/server_room.hpp"
 
 #include <assert.h>
 #include <string>
@@ -40,7 +41,7 @@ class CheckManager : public NoCopy
 {
 private:
     std::vector<CheckStructure*> m_all_checks;
-    static CheckManager         *m_check_manager;
+    static PerRoom<CheckManager*> m_check_manager;
            /** Private constructor, to make sure it is only called via
             *  the static create function. */
            CheckManager()       {m_all_checks.clear();};
@@ -59,15 +60,19 @@ public:
     /** Creates an instance of the check manager. */
     static void create()
     {
-        assert(!m_check_manager);
-        m_check_manager = new CheckManager();
+        assert(!m_check_manager.get());
+        m_check_manager.get() = new CheckManager();
     }   // create
     // ------------------------------------------------------------------------
     /** Returns the instance of the check manager. */
-    static CheckManager* get() { return m_check_manager; }
+    static CheckManager* get() { return m_check_manager.get(); }
     // ------------------------------------------------------------------------
     /** Destroys the check manager. */
-    static void destroy() { delete m_check_manager; m_check_manager = NULL; }
+    static void destroy()
+    {
+        delete m_check_manager.get();
+        m_check_manager.get() = NULL;
+    }   // destroy
     // ------------------------------------------------------------------------
     /** Returns the number of check structures defined. */
     unsigned int getCheckStructureCount() const { return (unsigned int) m_all_checks.size(); }
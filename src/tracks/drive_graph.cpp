@@ -276,6 +276,9 @@ unsigned int DriveGraph::getStartNode() const
  */
 void DriveGraph::computeChecklineRequirements()
 {
+    // The graph can be cached by the track and used in more than one race
+    for (unsigned int i = 0; i < getNumNodes(); i++)
+        getNode(i)->resetChecklineRequirements();
     computeChecklineRequirements(getNode(0),
                                  CheckManager::get()->getLapLineIndex());
 }   // computeChecklineRequirements
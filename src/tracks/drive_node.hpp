@@ -115,6 +115,9 @@ public:
     // ------------------------------------------------------------------------
     void         setChecklineRequirements(int latest_checkline);
     // ------------------------------------------------------------------------
+    void         resetChecklineRequirements()
+                                          { m_checkline_requirements.clear(); }
+    // ------------------------------------------------------------------------
     void         setDirectionData(unsigned int successor, DirectionType dir,
                                   unsigned int last_node_index);
     // ------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #define HEADER_GRAPH_HPP
 
 #include "utils/no_copy.hpp"
+#include "utils/server_room.hpp"
 #include "utils/vec3.hpp"
 
 #include <dimension2d.h>
@@ -52,7 +53,7 @@ class RenderTarget;
 class Graph : public NoCopy
 {
 protected:
-    static Graph* m_graph;
+    static PerRoom<Graph*> m_graph;
 
     std::vector<Quad*> m_all_nodes;
 
@@ -116,13 +117,13 @@ public:
     /** Returns the one instance of this object. It is possible that there
      *  is no instance created (e.g. arena without navmesh) so we don't assert
      *  that an instance exist. */
-    static Graph* get() { return m_graph; }
+    static Graph* get() { return m_graph.get(); }
     // ------------------------------------------------------------------------
     /** Set the graph (either drive or arena graph for now). */
     static void setGraph(Graph* graph)
     {
-        assert(m_graph == NULL);
-        m_graph = graph;
+        assert(m_graph.get() == NULL);
+        m_graph.get() = graph;
     }   // setGraph
     // ------------------------------------------------------------------------
     /** Cleans up the graph. It is possible that this function is called even
@@ -130,13 +131,17 @@ public:
      *  error if there is no instance. */
     static void destroy()
     {
-        if (m_graph)
+        if (m_graph.get())
         {
-            delete m_graph;
-            m_graph = NULL;
+            delete m_graph.get();
+            m_graph.get() = NULL;
         }
     }   // destroy
     // ------------------------------------------------------------------------
+    /** Removes the current graph without deleting it, which is used when
+     *  the graph is cached by the track for the next race. */
+    static void unsetGraph()                         { m_graph.get() = NULL; }
+    // ------------------------------------------------------------------------
     Graph();
     // ------------------------------------------------------------------------
     virtual ~Graph();
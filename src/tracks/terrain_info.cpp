@@ -33,6 +33,7 @@ TerrainInfo::TerrainInfo()
 {
     m_last_material = NULL;
     m_material      = NULL;
+    m_prefetched    = false;
 }   // TerrainInfo
 
 //-----------------------------------------------------------------------------
@@ -44,6 +45,7 @@ TerrainInfo::TerrainInfo(const Vec3 &pos)
     // initialise HoT
     m_last_material = NULL;
     m_material = NULL;
+    m_prefetched = false;
     update(pos);
 }   // TerrainInfo
 
@@ -54,6 +56,7 @@ TerrainInfo::TerrainInfo(const Vec3 &pos)
 void TerrainInfo::update(const Vec3 &from)
 {
     m_last_material = m_material;
+    m_prefetched    = false;
     btVector3 to(from);
     to.setY(-10000.0f);
 
@@ -67,31 +70,79 @@ void TerrainInfo::update(const Vec3 &from)
 }   // update
 
 //-----------------------------------------------------------------------------
-/** Update the terrain information based on the latest position.
- *  \param tran The transform ov the kart
+/** Casts a ray downwards (relative to the given rotation) against the track
+ *  and all driveable track objects. This only reads the track, so it can be
+ *  called for several objects in parallel.
+ *  \param rotation Rotation of the object.
  *  \param from World coordinates from which to start the raycast.
+ *  \param hit_point Unchanged if nothing is hit, otherwise the hit point.
+ *  \param material On return the material hit, or NULL.
+ *  \param normal On return the normal of the terrain.
  */
-void TerrainInfo::update(const btMatrix3x3 &rotation, const Vec3 &from)
+void TerrainInfo::castRay(const btMatrix3x3 &rotation, const Vec3 &from,
+                          Vec3 *hit_point, const Material **material,
+                          Vec3 *normal)
 {
-    m_last_material = m_material;
-    // Save the origin for debug drawing
-    m_origin_ray    = from;
-
     // Compute the 'to' vector by rotating a long 'down' vectory by the
     // kart rotation, and adding the start point to it.
     btVector3 to(0, -10000.0f, 0);
     to = from + rotation*to;
 
     const TriangleMesh &tm = Track::getCurrentTrack()->getTriangleMesh();
-    tm.castRay(from, to, &m_hit_point, &m_material, &m_normal,
-               /*interpolate*/true);
+    tm.castRay(from, to, hit_point, material, normal, /*interpolate*/true);
     // Now also raycast against all track objects (that are driveable). If
     // there should be a closer result (than the one against the main track 
     // mesh), its data will be returned.
     Track::getCurrentTrack()->getTrackObjectManager()
-                            ->castRay(from, to, &m_hit_point, &m_material,
-                                      &m_normal, /*interpolate*/true);
+                            ->castRay(from, to, hit_point, material,
+                                      normal, /*interpolate*/true);
+}   // castRay
+
+//-----------------------------------------------------------------------------
+/** Update the terrain information based on the latest position.
+ *  \param tran The transform ov the kart
+ *  \param from World coordinates from which to start the raycast.
+ */
+void TerrainInfo::update(const btMatrix3x3 &rotation, const Vec3 &from)
+{
+    m_last_material = m_material;
+    // Save the origin for debug drawing
+    m_origin_ray    = from;
+
+    if (m_prefetched && from == m_prefetch_from &&
+        rotation == m_prefetch_rotation)
+    {
+        m_hit_point  = m_prefetch_hit_point;
+        m_material   = m_prefetch_material;
+        m_normal     = m_prefetch_normal;
+        m_prefetched = false;
+        return;
+    }
+    m_prefetched = false;
+    castRay(rotation, from, &m_hit_point, &m_material, &m_normal);
 }   // update
+
+//-----------------------------------------------------------------------------
+/** Does the raycast of update(rotation, from) in advance, without changing
+ *  the current terrain information. This allows to cast the rays of all
+ *  karts together (and in parallel) before the karts are updated. If the
+ *  next update() is called with a different rotation or origin (e.g. since
+ *  an animation moved the kart), the ray is cast again.
+ *  \param rotation Expected rotation of the object in the next update().
+ *  \param from Expected origin of the raycast in the next update().
+ */
+void TerrainInfo::prefetch(const btMatrix3x3 &rotation, const Vec3 &from)
+{
+    m_prefetch_rotation  = rotation;
+    m_prefetch_from      = from;
+    // Nothing hit leaves the hit point unchanged, as in update()
+    m_prefetch_hit_point = m_hit_point;
+    m_prefetch_normal    = m_normal;
+    castRay(rotation, from, &m_prefetch_hit_point, &m_prefetch_material,
+            &m_prefetch_normal);
+    m_prefetched         = true;
+}   // prefetch
+
 //-----------------------------------------------------------------------------
 /** Update the terrain information based on the latest position.
 *  \param Position from which to start the rayast from.
@@ -99,6 +150,7 @@ void TerrainInfo::update(const btMatrix3x3 &rotation, const Vec3 &from)
 void TerrainInfo::update(const Vec3 &from, const Vec3 &towards)
 {
     m_last_material = m_material;
+    m_prefetched    = false;
     Vec3 direction = towards.normalized();
     btVector3 to = from + 10000.0f*direction;
 
@@ -43,6 +43,21 @@ private:
     /** DEBUG only: origin of raycast. */
     Vec3 m_origin_ray;
 
+    /** True if the result of a raycast done in advance by prefetch() is
+     *  available. It is only used if update() is called with the same
+     *  rotation and origin. */
+    bool              m_prefetched;
+    btMatrix3x3       m_prefetch_rotation;
+    Vec3              m_prefetch_from;
+    /** The result of the prefetched raycast. */
+    Vec3              m_prefetch_hit_point;
+    Vec3              m_prefetch_normal;
+    const Material   *m_prefetch_material;
+
+    static void castRay(const btMatrix3x3 &rotation, const Vec3 &from,
+                        Vec3 *hit_point, const Material **material,
+                        Vec3 *normal);
+
 public:
              TerrainInfo();
              TerrainInfo(const Vec3 &pos);
@@ -53,6 +68,7 @@ public:
     virtual void update(const btMatrix3x3 &rotation, const Vec3 &from);
     virtual void update(const Vec3 &from);
     virtual void update(const Vec3 &from, const Vec3 &towards);
+    void     prefetch(const btMatrix3x3 &rotation, const Vec3 &from);
 
     // ------------------------------------------------------------------------
     /** Simple wrapper with no offset. */
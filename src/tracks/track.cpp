@@ -60,6 +60,7 @@
 #include "modes/easter_egg_hunt.hpp"
 #include "modes/profile_world.hpp"
 #include "network/network_config.hpp"
+#include "network/server_config.hpp"
 #include "physics/physical_object.hpp"
 #include "physics/physics.hpp"
 #include "physics/triangle_mesh.hpp"
@@ -87,6 +88,7 @@
 #include <ISceneManager.h>
 #include <SMeshBuffer.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
@@ -97,7 +99,8 @@ using namespace irr;
 
 const float Track::NOHIT               = -99999.9f;
 bool        Track::m_dont_load_navmesh = false;
-Track      *Track::m_current_track = NULL;
+PerRoom<Track*> Track::m_current_track;
+std::list<Track*> Track::m_cached_tracks;
 
 // ----------------------------------------------------------------------------
 Track::Track(const std::string &filename)
@@ -160,8 +163,16 @@ Track::Track(const std::string &filename)
     m_godrays_color         = video::SColor(255, 255, 255, 255);
     m_weather_lightning      = false;
     m_weather_sound         = "";
+#ifdef SERVER_ONLY
+    // A server usually uses the same tracks again and again, so keep the
+    // data of all tracks that have been used
+    m_cache_track           = true;
+#else
     m_cache_track           = UserConfigParams::m_cache_overworld &&
                               m_ident=="overworld";
+#endif
+    m_is_clone              = false;
+    m_current_cached_physics = NULL;
     m_render_target         = NULL;
     m_minimap_x_scale       = 1.0f;
     m_minimap_y_scale       = 1.0f;
@@ -187,8 +198,144 @@ Track::~Track()
     assert(m_magic_number == 0x17AC3802);
     m_magic_number = 0xDEADBEEF;
 #endif
+    freeCachedPhysics();
+    m_cached_tracks.remove(this);
 }   // ~Track
 
+//-----------------------------------------------------------------------------
+/** Frees all collision meshes and graphs that are cached by this track.
+ */
+void Track::freeCachedPhysics()
+{
+    for (auto& cp : m_cached_physics)
+    {
+        delete cp.second.m_track_mesh;
+        delete cp.second.m_gfx_effect_mesh;
+        delete cp.second.m_graph[0];
+        delete cp.second.m_graph[1];
+    }
+    m_cached_physics.clear();
+}   // freeCachedPhysics
+
+//-----------------------------------------------------------------------------
+/** Returns true if any cached collision mesh of this track uses one of the
+ *  given materials.
+ */
+bool Track::cachedPhysicsUsesAnyMaterial(
+                              const std::set<const Material*> &materials) const
+{
+    for (auto& cp : m_cached_physics)
+    {
+        if ((cp.second.m_track_mesh &&
+             cp.second.m_track_mesh->usesAnyMaterial(materials)) ||
+            (cp.second.m_gfx_effect_mesh &&
+             cp.second.m_gfx_effect_mesh->usesAnyMaterial(materials)))
+            return true;
+    }
+    return false;
+}   // cachedPhysicsUsesAnyMaterial
+
+//-----------------------------------------------------------------------------
+/** Returns true if a server room races on this track (or on a copy of it),
+ *  or on a track whose collision meshes use materials of this track.
+ */
+bool Track::isUsedByAnyRoom() const
+{
+    std::set<const Material*> materials(m_permanent_materials.begin(),
+                                        m_permanent_materials.end());
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+    {
+        const Track* track = m_current_track.get(room);
+        if (!track)
+            continue;
+        if (track->m_ident == m_ident)
+            return true;
+        if (!materials.empty() &&
+            ((track->m_track_mesh &&
+              track->m_track_mesh->usesAnyMaterial(materials)) ||
+             (track->m_gfx_effect_mesh &&
+              track->m_gfx_effect_mesh->usesAnyMaterial(materials))))
+            return true;
+    }
+    return false;
+}   // isUsedByAnyRoom
+
+//-----------------------------------------------------------------------------
+/** Called on a server when this track is loaded: marks it as the most
+ *  recently used track, and removes the least recently used tracks from the
+ *  cache if more than max-cached-tracks tracks are cached. Tracks which are
+ *  used by another server room are kept.
+ */
+void Track::updateTrackCache()
+{
+    m_cached_tracks.remove(this);
+    m_cached_tracks.push_front(this);
+    const unsigned max_tracks =
+        std::max((int)ServerConfig::m_max_cached_tracks, 1);
+    auto it = m_cached_tracks.end();
+    while (m_cached_tracks.size() > max_tracks &&
+           --it != m_cached_tracks.begin())
+    {
+        Track* track = *it;
+        if (track->isUsedByAnyRoom())
+            continue;
+        it = m_cached_tracks.erase(it);
+        track->removeFromTrackCache();
+    }
+}   // updateTrackCache
+
+//-----------------------------------------------------------------------------
+/** Frees the cached collision meshes, graphs and materials of this track.
+ *  The cached meshes of other tracks can use materials of this track (if
+ *  they use a texture with the same name), so their cached physics is freed
+ *  as well in this case.
+ */
+void Track::removeFromTrackCache()
+{
+    Log::info("Track", "Removing '%s' from the track cache.",
+              m_ident.c_str());
+    freeCachedPhysics();
+    if (!m_permanent_materials.empty())
+    {
+        std::set<const Material*> materials(m_permanent_materials.begin(),
+                                            m_permanent_materials.end());
+        for (Track* track : m_cached_tracks)
+        {
+            if (track->cachedPhysicsUsesAnyMaterial(materials))
+                track->freeCachedPhysics();
+        }
+        material_manager->removePermanentMaterials(m_permanent_materials);
+        m_permanent_materials.clear();
+    }
+    m_materials_loaded = false;
+}   // removeFromTrackCache
+
+//-----------------------------------------------------------------------------
+/** Creates a copy of this track for a server room, which is used if another
+ *  room already races on this track. The copy uses the materials loaded by
+ *  this track, which updateTrackCache keeps while the copy is in use.
+ */
+Track* Track::clone() const
+{
+    Track* track = new Track(m_filename);
+    track->m_is_clone         = true;
+    track->m_cache_track      = true;
+    track->m_materials_loaded = true;
+    return track;
+}   // clone
+
+//-----------------------------------------------------------------------------
+/** Returns true if any server room currently races on this track object. */
+bool Track::isInUse() const
+{
+    for (unsigned room = 0; room < ServerRoom::getCount(); room++)
+    {
+        if (m_current_track.get(room) == this)
+            return true;
+    }
+    return false;
+}   // isInUse
+
 //-----------------------------------------------------------------------------
 /** A < comparison of tracks. This is used to sort the tracks when displaying
  *  them in the gui.
@@ -311,7 +458,10 @@ void Track::cleanup()
     file_manager->popTextureSearchPath();
     file_manager->popModelSearchPath();
 
-    Graph::destroy();
+    if (m_current_cached_physics)
+        Graph::unsetGraph();
+    else
+        Graph::destroy();
     ItemManager::destroy();
 #ifndef SERVER_ONLY
     if (CVS->isGLSL())
@@ -362,11 +512,21 @@ void Track::cleanup()
     if (CVS->isGLSL())
         m_sun->drop();
 #endif
-    delete m_track_mesh;
+    if (m_current_cached_physics &&
+        m_current_cached_physics->m_track_mesh == m_track_mesh)
+    {
+        // Keep the triangles and bvh of a cached track, only the body
+        // needs to be removed from the physics world
+        m_track_mesh->removeBody();
+    }
+    else
+    {
+        delete m_track_mesh;
+        delete m_gfx_effect_mesh;
+    }
     m_track_mesh = NULL;
-
-    delete m_gfx_effect_mesh;
     m_gfx_effect_mesh = NULL;
+    m_current_cached_physics = NULL;
 
 #ifndef SERVER_ONLY
     if (CVS->isGLSL())
@@ -425,7 +585,7 @@ void Track::cleanup()
     m_spherical_harmonics_textures.clear();
 
     if(m_cache_track)
-        material_manager->makeMaterialsPermanent();
+        material_manager->makeMaterialsPermanent(&m_permanent_materials);
     else
     {
         // remove temporary materials loaded by the material manager
@@ -503,7 +663,7 @@ void Track::cleanup()
     m_meta_library.clear();
     Scripting::ScriptEngine::getInstance()->cleanupCache();
 
-    m_current_track = NULL;
+    m_current_track.get() = NULL;
 }   // cleanup
 
 //-----------------------------------------------------------------------------
@@ -850,12 +1010,17 @@ void Track::createPhysicsModel(unsigned int main_track_count)
         return;
     }
 
+    // A cached track mesh already contains all triangles and the bvh, so
+    // only the physical body needs to be added to the physics world.
+    const bool cached_physics = m_current_cached_physics &&
+        m_current_cached_physics->m_track_mesh == m_track_mesh;
 
     // Now convert all objects that are only used for the physics
     // (like invisible walls).
     for (unsigned int i = 0; i<m_static_physics_only_nodes.size(); i++)
     {
-        convertTrackToBullet(m_static_physics_only_nodes[i]);
+        if (!cached_physics)
+            convertTrackToBullet(m_static_physics_only_nodes[i]);
         if (UserConfigParams::m_physics_debug &&
             m_static_physics_only_nodes[i]->getType() == scene::ESNT_MESH)
         {
@@ -879,21 +1044,36 @@ void Track::createPhysicsModel(unsigned int main_track_count)
 
     for (unsigned int i = 0; i<m_object_physics_only_nodes.size(); i++)
     {
-        convertTrackToBullet(m_object_physics_only_nodes[i]);
+        if (!cached_physics)
+            convertTrackToBullet(m_object_physics_only_nodes[i]);
         m_object_physics_only_nodes[i]->setVisible(false);
         m_object_physics_only_nodes[i]->grab();
         irr_driver->removeNode(m_object_physics_only_nodes[i]);
     }
 
-    m_track_mesh->removeAll();
-    m_gfx_effect_mesh->removeAll();
+    if (!cached_physics)
+    {
+        m_track_mesh->removeAll();
+        m_gfx_effect_mesh->removeAll();
+    }
     for(unsigned int i=main_track_count; i<m_all_nodes.size(); i++)
     {
-        convertTrackToBullet(m_all_nodes[i]);
+        if (!cached_physics)
+            convertTrackToBullet(m_all_nodes[i]);
         uploadNodeVertexBuffer(m_all_nodes[i]);
     }
-    m_track_mesh->createPhysicalBody(m_friction);
-    m_gfx_effect_mesh->createCollisionShape();
+    m_track_mesh->createPhysicalBody(m_friction,
+        (btCollisionObject::CollisionFlags)0, /*cache_bvh*/true);
+    if (cached_physics)
+        return;
+
+    m_gfx_effect_mesh->createCollisionShape(/*create_collision_object*/true,
+                                            /*cache_bvh*/true);
+    if (m_current_cached_physics)
+    {
+        m_current_cached_physics->m_track_mesh      = m_track_mesh;
+        m_current_cached_physics->m_gfx_effect_mesh = m_gfx_effect_mesh;
+    }
 }   // createPhysicsModel
 
 // -----------------------------------------------------------------------------
@@ -1169,8 +1349,18 @@ bool Track::loadMainTrack(const XMLNode &root)
 
     m_challenges.clear();
 
-    m_track_mesh      = new TriangleMesh(/*can_be_transformed*/false);
-    m_gfx_effect_mesh = new TriangleMesh(/*can_be_transformed*/false);
+    const bool cached_physics = m_current_cached_physics &&
+        m_current_cached_physics->m_track_mesh;
+    if (cached_physics)
+    {
+        m_track_mesh      = m_current_cached_physics->m_track_mesh;
+        m_gfx_effect_mesh = m_current_cached_physics->m_gfx_effect_mesh;
+    }
+    else
+    {
+        m_track_mesh      = new TriangleMesh(/*can_be_transformed*/false);
+        m_gfx_effect_mesh = new TriangleMesh(/*can_be_transformed*/false);
+    }
 
     const XMLNode *track_node = root.getNode("track");
     std::string model_name;
@@ -1436,7 +1626,8 @@ bool Track::loadMainTrack(const XMLNode &root)
     // This will (at this stage) only convert the main track model.
     for(unsigned int i=0; i<m_all_nodes.size(); i++)
     {
-        convertTrackToBullet(m_all_nodes[i]);
+        if (!cached_physics)
+            convertTrackToBullet(m_all_nodes[i]);
         uploadNodeVertexBuffer(m_all_nodes[i]);
     }
     // Free the tangent (track mesh) after converting to physics
@@ -1448,7 +1639,8 @@ bool Track::loadMainTrack(const XMLNode &root)
         Log::fatal("track", "m_track_mesh == NULL, cannot loadMainTrack\n");
     }
 
-    m_gfx_effect_mesh->createCollisionShape();
+    if (!cached_physics)
+        m_gfx_effect_mesh->createCollisionShape();
     scene_node->setMaterialFlag(video::EMF_LIGHTING, true);
     scene_node->setMaterialFlag(video::EMF_GOURAUD_SHADING, true);
 
@@ -1736,7 +1928,7 @@ static void recursiveUpdatePhysics(std::vector<TrackObject*>& tos)
  */
 void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
 {
-    assert(!m_current_track);
+    assert(!m_current_track.get());
 
     // Use m_filename to also get the path, not only the identifier
     STKTexManager::getInstance()
@@ -1745,6 +1937,18 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
     {
         reverse_track = false;
     }
+    // The rooms of a server load and clean up tracks in any order, which the
+    // stack of temporary materials can not handle
+    if (ServerRoom::getCount() > 1)
+        m_cache_track = true;
+#ifdef SERVER_ONLY
+    // The map creates a zero-initialised entry if this mode was not used yet
+    if (m_cache_track && !m_is_clone)
+    {
+        updateTrackCache();
+        m_current_cached_physics = &m_cached_physics[mode_id];
+    }
+#endif
     CheckManager::create();
     assert(m_all_cached_meshes.size()==0);
     if(UserConfigParams::logMemory())
@@ -1798,7 +2002,8 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         if(m_cache_track)
         {
             if(!m_materials_loaded)
-                material_manager->addSharedMaterial(materials_file);
+                material_manager->addSharedMaterial(materials_file,
+                    /*deprecated*/false, &m_permanent_materials);
             m_materials_loaded = true;
         }
         else
@@ -1826,7 +2031,7 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         throw std::runtime_error(msg.str());
     }
 
-    m_current_track = this;
+    m_current_track.get() = this;
 
     // Load the graph only now: this function is called from world, after
     // the race gui was created. The race gui is needed since it stores
@@ -1851,10 +2056,19 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         }   // for i<root->getNumNodes()
     }
 
-    if (!m_is_arena && !m_is_soccer && !m_is_cutscene) 
+    // An arena graph does not depend on the direction (and the soccer goal
+    // nodes are always loaded, since soccer fields are only used in soccer
+    // mode), so only the drive graph is cached per direction.
+    Graph** cached_graph = m_current_cached_physics ?
+        &m_current_cached_physics->m_graph[reverse_track ? 1 : 0] : NULL;
+    if (cached_graph && *cached_graph)
+        Graph::setGraph(*cached_graph);
+    else if (!m_is_arena && !m_is_soccer && !m_is_cutscene)
         loadDriveGraph(mode_id, reverse_track);
     else if ((m_is_arena || m_is_soccer) && !m_is_cutscene && m_has_navmesh)
         loadArenaGraph(*root);
+    if (cached_graph)
+        *cached_graph = Graph::get();
 
     if (NetworkConfig::get()->isNetworking())
         NetworkItemManager::create();
@@ -2164,6 +2378,11 @@ void Track::loadTrackModel(bool reverse_track, unsigned int mode_id)
         easter_world->readData(dir+"/easter_eggs.xml");
     }
 
+    // Keep the materials created while loading with this track, before
+    // another server room loads its track
+    if (m_cache_track)
+        material_manager->makeMaterialsPermanent(&m_permanent_materials);
+
     STKTexManager::getInstance()->unsetTextureErrorMessage();
 #ifndef SERVER_ONLY
     if (CVS->isGLSL())
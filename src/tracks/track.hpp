@@ -26,6 +26,9 @@
   * objects.
   */
 
+#include <list>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -39,11 +42,14 @@ using namespace irr;
 #include "utils/translation.hpp"
 #include "utils/vec3.hpp"
 #include "utils/ptr_vector.hpp"
+#include "utils/server_room.hpp"
 
 class AbstractKart;
 class AnimationManager;
 class BezierCurve;
 class CheckManager;
+class Graph;
+class Material;
 class ModelDefinitionLoader;
 class MovingTexture;
 class MusicInformation;
@@ -96,9 +102,13 @@ class Track
 {
 private:
 
-    /** If a race is in progress, this stores the active track object.
-     *  NULL otherwise. */
-    static Track *m_current_track;
+    /** If a race is in progress, this stores the active track object (of
+     *  each server room). NULL otherwise. */
+    static PerRoom<Track*> m_current_track;
+
+    /** The tracks whose data is cached on a server, the most recently used
+     *  track first. */
+    static std::list<Track*> m_cached_tracks;
 
 #ifdef DEBUG
     unsigned int             m_magic_number;
@@ -168,9 +178,20 @@ private:
     bool m_materials_loaded;
 
     /** True if this track (textures and track data) should be cached. Used
-     *  for the overworld. */
+     *  for the overworld, and for all tracks on a server only build. */
     bool m_cache_track;
 
+    /** True if this is a copy of a track of the track manager, which is
+     *  used by a server room while another room races on the original
+     *  track. A copy uses the materials of the original, and caches
+     *  nothing itself. */
+    bool m_is_clone;
+
+    /** The materials of this track that were made permanent because the
+     *  track is cached. They are freed if the track is removed from the
+     *  cache of a server. */
+    std::vector<Material*> m_permanent_materials;
+
 
 #ifdef DEBUG
     /** A list of textures that were cached before the track is loaded.
@@ -196,6 +217,23 @@ private:
      *  allowing the kart to drive in/partly under water), but the
      *  actual surface position is needed for the water splash effect. */
     TriangleMesh*            m_gfx_effect_mesh;
+
+    /** The collision meshes and graphs of one mode of this track, which are
+     *  kept after a race if the track is cached. This avoids converting the
+     *  meshes and rebuilding the bvh and graphs each time this track is
+     *  used. */
+    struct CachedPhysics
+    {
+        TriangleMesh* m_track_mesh;
+        TriangleMesh* m_gfx_effect_mesh;
+        /** The graph of the normal and reverse direction. */
+        Graph*        m_graph[2];
+    };
+    /** The cached collision meshes and graphs, indexed by mode id. */
+    std::map<unsigned int, CachedPhysics> m_cached_physics;
+    /** The cached data used by the current race, or NULL if this track is
+     *  not cached. */
+    CachedPhysics*           m_current_cached_physics;
     /** Minimum coordinates of this track. */
     Vec3                     m_aabb_min;
     /** Maximum coordinates of this track. */
@@ -403,11 +441,17 @@ private:
     void loadCurves(const XMLNode &node);
     void handleSky(const XMLNode &root, const std::string &filename);
     void freeCachedMeshVertexBuffer();
+    void freeCachedPhysics();
+    void updateTrackCache();
+    void removeFromTrackCache();
+    bool cachedPhysicsUsesAnyMaterial(
+                             const std::set<const Material*> &materials) const;
+    bool isUsedByAnyRoom() const;
 public:
 
     /** Static function to get the current track. NULL if no current
      *  track is defined (i.e. no race is active atm) */
-    static Track* getCurrentTrack() { return m_current_track;  }
+    static Track* getCurrentTrack() { return m_current_track.get(); }
     // ------------------------------------------------------------------------
     void handleAnimatedTextures(scene::ISceneNode *node, const XMLNode &xml);
 
@@ -683,6 +727,10 @@ public:
     // ------------------------------------------------------------------------
     bool operator<(const Track &other) const;
     // ------------------------------------------------------------------------
+    Track* clone() const;
+    // ------------------------------------------------------------------------
+    bool isInUse() const;
+    // ------------------------------------------------------------------------
     /** Adds mesh to cleanup list */
     void addCachedMesh(scene::IMesh* mesh) { m_all_cached_meshes.push_back(mesh); }
     // ------------------------------------------------------------------------
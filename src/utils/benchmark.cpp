@@ -0,0 +1,155 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/benchmark.hpp"
+
+#include "utils/log.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+
+bool                  Benchmark::m_enabled = false;
+uint64_t              Benchmark::m_current_tick[BS_COUNT];
+std::vector<uint64_t> Benchmark::m_samples[BS_COUNT];
+
+// ----------------------------------------------------------------------------
+/** Enables benchmarking, i.e. the timers start to collect data. */
+void Benchmark::enable()
+{
+    m_enabled = true;
+    for (unsigned i = 0; i < BS_COUNT; i++)
+    {
+        m_current_tick[i] = 0;
+        m_samples[i].clear();
+    }
+}   // enable
+
+// ----------------------------------------------------------------------------
+/** Stores the time of all sections of the current tick and starts a new
+ *  tick. */
+void Benchmark::endTick()
+{
+    for (unsigned i = 0; i < BS_COUNT; i++)
+    {
+        m_samples[i].push_back(m_current_tick[i]);
+        m_current_tick[i] = 0;
+    }
+}   // endTick
+
+// ----------------------------------------------------------------------------
+/** Returns the name of a section as used in the output. */
+const char* Benchmark::getSectionName(Section section)
+{
+    switch (section)
+    {
+    case BS_KART_UPDATE:   return "Kart::update";
+    case BS_PHYSICS:       return "Physics::update";
+    case BS_PROJECTILES:   return "ProjectileManager::update";
+    case BS_ITEMS:         return "ItemManager::update";
+    case BS_RACE_POSITION: return "LinearWorld::updateRacePosition";
+    case BS_TICK:          return "tick";
+    default:               return "";
+    }
+}   // getSectionName
+
+// ----------------------------------------------------------------------------
+/** Returns a percentile (nearest rank) of the samples.
+ *  \param samples The samples (a copy, since it is sorted).
+ *  \param percentile The percentile, between 0 and 1.
+ */
+uint64_t Benchmark::getPercentile(std::vector<uint64_t> samples,
+                                  double percentile)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    int rank = (int)std::ceil(percentile * samples.size()) - 1;
+    rank = std::min(std::max(rank, 0), (int)samples.size() - 1);
+    return samples[rank];
+}   // getPercentile
+
+// ----------------------------------------------------------------------------
+/** Prints the number of ticks per second (only counting the time spent in
+ *  the world updates) and the median and 99th percentile of the time spent
+ *  in each section per tick. Optionally the results are written as JSON.
+ *  \param track Identifier of the track used.
+ *  \param num_karts Number of karts in the race.
+ *  \param json_file Name of the file to write the JSON results to, or empty.
+ */
+void Benchmark::printResults(const std::string &track, unsigned num_karts,
+                             const std::string &json_file)
+{
+    const unsigned ticks = getNumTicks();
+    uint64_t total = 0;
+    for (uint64_t t : m_samples[BS_TICK])
+        total += t;
+    const double ticks_per_second = total > 0 ? ticks * 1.0e9 / total : 0.0;
+
+    Log::info("Benchmark", "Track %s, %d karts, %d ticks: %.1f ticks/s",
+              track.c_str(), num_karts, ticks, ticks_per_second);
+    for (unsigned i = 0; i < BS_COUNT; i++)
+    {
+        Log::info("Benchmark", "%-32s p50 %8.1f us  p99 %8.1f us",
+            getSectionName(Section(i)),
+            getPercentile(m_samples[i], 0.5) * 0.001f,
+            getPercentile(m_samples[i], 0.99) * 0.001f);
+    }
+
+    if (json_file.empty())
+        return;
+    std::ofstream json(json_file.c_str());
+    if (!json.is_open())
+    {
+        Log::error("Benchmark", "Cannot open '%s'.", json_file.c_str());
+        return;
+    }
+    json << "{\n"
+         << "  \"track\": \"" << track << "\",\n"
+         << "  \"karts\": " << num_karts << ",\n"
+         << "  \"ticks\": " << ticks << ",\n"
+         << "  \"ticks_per_second\": " << ticks_per_second << ",\n"
+         << "  \"sections\": {\n";
+    for (unsigned i = 0; i < BS_COUNT; i++)
+    {
+        json << "    \"" << getSectionName(Section(i)) << "\": { "
+             << "\"p50_us\": "
+             << getPercentile(m_samples[i], 0.5) * 0.001 << ", "
+             << "\"p99_us\": "
+             << getPercentile(m_samples[i], 0.99) * 0.001 << " }"
+             << (i + 1 < BS_COUNT ? "," : "") << "\n";
+    }
+    json << "  }\n}\n";
+    Log::info("Benchmark", "Results written to '%s'.", json_file.c_str());
+}   // printResults
+
+// ----------------------------------------------------------------------------
+void Benchmark::unitTesting()
+{
+    std::vector<uint64_t> samples;
+    assert(getPercentile(samples, 0.5) == 0);
+    for (uint64_t i = 100; i > 0; i--)
+        samples.push_back(i);
+    assert(getPercentile(samples, 0.5)  == 50);
+    assert(getPercentile(samples, 0.99) == 99);
+    assert(getPercentile(samples, 1.0)  == 100);
+    assert(getPercentile(samples, 0.0)  == 1);
+    samples.resize(1);
+    assert(getPercentile(samples, 0.99) == 100);
+}   // unitTesting
@@ -0,0 +1,111 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_BENCHMARK_HPP
+#define HEADER_BENCHMARK_HPP
+
+#include "utils/no_copy.hpp"
+#include "utils/types.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/** Collects the time spent in the main updates of each physics tick when
+ *  running with --benchmark, and computes percentiles of them at the end.
+ *  The sections are timed with a Benchmark::Timer object at the beginning
+ *  of the corresponding function, which does nothing if benchmarking is
+ *  not enabled. All timed functions must be called from the main thread.
+ */
+class Benchmark : public NoCopy
+{
+public:
+    /** The timed sections. */
+    enum Section
+    {
+        BS_KART_UPDATE,       //!< Kart::update of all karts
+        BS_PHYSICS,           //!< Physics::update
+        BS_PROJECTILES,       //!< ProjectileManager::update
+        BS_ITEMS,             //!< ItemManager::update
+        BS_RACE_POSITION,     //!< LinearWorld::updateRacePosition
+        BS_TICK,              //!< The whole world update of a tick
+        BS_COUNT
+    };
+
+    /** Adds the time from its creation to its destruction to a section. */
+    class Timer : public NoCopy
+    {
+    private:
+        Section m_section;
+        bool    m_active;
+        std::chrono::steady_clock::time_point m_start;
+    public:
+        Timer(Section section)
+        {
+            m_section = section;
+            m_active  = Benchmark::isEnabled();
+            if (m_active)
+                m_start = std::chrono::steady_clock::now();
+        }   // Timer
+        // --------------------------------------------------------------------
+        ~Timer()
+        {
+            if (!m_active) return;
+            Benchmark::addTime(m_section,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - m_start).count());
+        }   // ~Timer
+    };   // Timer
+
+private:
+    static bool m_enabled;
+
+    /** Time spent in each section in the current tick, in ns. */
+    static uint64_t m_current_tick[BS_COUNT];
+
+    /** Time spent in each section for each finished tick, in ns. */
+    static std::vector<uint64_t> m_samples[BS_COUNT];
+
+    static const char* getSectionName(Section section);
+
+public:
+    static void enable();
+    static void endTick();
+    static void printResults(const std::string &track, unsigned num_karts,
+                             const std::string &json_file);
+    static uint64_t getPercentile(std::vector<uint64_t> samples,
+                                  double percentile);
+    static void unitTesting();
+    // ------------------------------------------------------------------------
+    /** Returns true if --benchmark is used. */
+    static bool isEnabled() { return m_enabled; }
+    // ------------------------------------------------------------------------
+    /** Adds time to a section in the current tick.
+     *  \param section The section.
+     *  \param ns The time in nanoseconds. */
+    static void addTime(Section section, int64_t ns)
+    {
+        m_current_tick[section] += (uint64_t)ns;
+    }   // addTime
+    // ------------------------------------------------------------------------
+    /** Returns the number of ticks measured so far. */
+    static unsigned getNumTicks()
+                             { return (unsigned)m_samples[BS_TICK].size(); }
+};   // Benchmark
+
+#endif
@@ -0,0 +1,126 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SERVER_ROOM_HPP
+#define HEADER_SERVER_ROOM_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <cassert>
+
+/** A server can host several independent rooms (each with its own lobby,
+ *  race and world) in one process. They share the ENet socket and all data
+ *  which is only read after loading (tracks, karts, materials, config).
+ *  The state that differs between rooms is stored in PerRoom objects, which
+ *  select the value of the room the calling thread currently works on.
+ *  Threads that never set a room work on room 0, so clients and servers
+ *  with a single room behave as if rooms did not exist.
+ */
+class ServerRoom
+{
+public:
+    /** Maximum number of rooms a server can host. */
+    static const unsigned MAX_ROOMS = 16;
+
+private:
+    /** The room the calling thread currently works on. */
+    static thread_local unsigned m_current;
+
+    /** Number of rooms hosted by this process. */
+    static unsigned m_count;
+
+public:
+    // ------------------------------------------------------------------------
+    static void setCurrent(unsigned room)
+    {
+        assert(room < MAX_ROOMS);
+        m_current = room;
+    }   // setCurrent
+    // ------------------------------------------------------------------------
+    static unsigned getCurrent()                          { return m_current; }
+    // ------------------------------------------------------------------------
+    static void setCount(unsigned count)
+    {
+        assert(count > 0 && count <= MAX_ROOMS);
+        m_count = count;
+    }   // setCount
+    // ------------------------------------------------------------------------
+    static unsigned getCount()                              { return m_count; }
+};   // ServerRoom
+
+// ============================================================================
+/** Switches the calling thread to a room for the lifetime of this object,
+ *  and restores the previous room afterwards.
+ */
+class ServerRoomScope : public NoCopy
+{
+private:
+    const unsigned m_previous;
+
+public:
+    ServerRoomScope(unsigned room) : m_previous(ServerRoom::getCurrent())
+    {
+        ServerRoom::setCurrent(room);
+    }
+    // ------------------------------------------------------------------------
+    ~ServerRoomScope()                 { ServerRoom::setCurrent(m_previous); }
+};   // ServerRoomScope
+
+// ============================================================================
+/** One value of type T for each room. Pointers stored in it can be used
+ *  like the plain pointer of the current room, so a global or static
+ *  pointer can be turned into a PerRoom one without changing its users.
+ *  With ROOMS set to 1 the single value is shared by all rooms.
+ */
+template <typename T, unsigned ROOMS = ServerRoom::MAX_ROOMS>
+class PerRoom : public NoCopy
+{
+private:
+    T m_values[ROOMS];
+
+    // ------------------------------------------------------------------------
+    static unsigned getIndex()
+                       { return ROOMS == 1 ? 0 : ServerRoom::getCurrent(); }
+
+public:
+    PerRoom() : m_values() {}
+    // ------------------------------------------------------------------------
+    /** Returns the value of the room the calling thread works on. */
+    T& get()                                  { return m_values[getIndex()]; }
+    // ------------------------------------------------------------------------
+    const T& get() const                      { return m_values[getIndex()]; }
+    // ------------------------------------------------------------------------
+    /** Returns the value of the given room. */
+    T& get(unsigned room)
+    {
+        assert(room < ROOMS);
+        return m_values[room];
+    }   // get
+    // ------------------------------------------------------------------------
+    T operator->() const                                  { return get(); }
+    // ------------------------------------------------------------------------
+    operator T() const                                    { return get(); }
+    // ------------------------------------------------------------------------
+    PerRoom& operator=(const T& value)
+    {
+        get() = value;
+        return *this;
+    }   // operator=
+};   // PerRoom
+
+#endif
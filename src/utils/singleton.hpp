@@ -23,19 +23,21 @@
 #define SINGLETON_HPP
 
 #include "utils/log.hpp"
+#include "utils/server_room.hpp"
 
 /*! \class AbstractSingleton
  *  \brief Manages the abstract singleton at runtime.
  *  This has been designed to allow multi-inheritance. This is advised to
  *  re-declare getInstance, but whithout templates parameters in the inheriting
- *  classes.
+ *  classes. Singletons which belong to a race set PER_ROOM to have one
+ *  instance in each server room.
  */
-template <typename T>
+template <typename T, bool PER_ROOM = false>
 class AbstractSingleton
 {
     protected:
         /*! \brief Constructor */
-        AbstractSingleton() { m_singleton = NULL; }
+        AbstractSingleton() { m_singleton.get() = NULL; }
         /*! \brief Destructor */
         virtual ~AbstractSingleton()
         {
@@ -52,10 +54,10 @@ class AbstractSingleton
         template<typename S>
         static S *getInstance ()
         {
-            if (m_singleton == NULL)
-                m_singleton = new S;
+            if (m_singleton.get() == NULL)
+                m_singleton.get() = new S;
 
-            S* result = (dynamic_cast<S*> (m_singleton));
+            S* result = (dynamic_cast<S*> (m_singleton.get()));
             if (result == NULL)
                 Log::debug("Singleton", "THE SINGLETON HAS NOT BEEN REALOCATED, IT IS NOT OF THE REQUESTED TYPE.");
             return result;
@@ -63,24 +65,27 @@ class AbstractSingleton
         /*! \brief Used to get the instance. */
         static T *getInstance()
         {
-            return m_singleton;
+            return m_singleton.get();
         }
 
         /*! \brief Used to kill the singleton, if needed. */
         static void kill ()
         {
-            if (m_singleton)
+            if (m_singleton.get())
             {
-                delete m_singleton;
-                m_singleton = NULL;
+                delete m_singleton.get();
+                m_singleton.get() = NULL;
             }
         }
 
     private:
-        static T *m_singleton;
+        /*! \brief The instance, one for each server room if PER_ROOM. */
+        static PerRoom<T*, PER_ROOM ? ServerRoom::MAX_ROOMS : 1> m_singleton;
 };
 
-template <typename T> T *AbstractSingleton<T>::m_singleton = NULL;
+template <typename T, bool PER_ROOM>
+PerRoom<T*, PER_ROOM ? ServerRoom::MAX_ROOMS : 1>
+    AbstractSingleton<T, PER_ROOM>::m_singleton;
 
 template <typename T>
 class Singleton
@@ -0,0 +1,155 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_SPSC_QUEUE_HPP
+#define HEADER_SPSC_QUEUE_HPP
+
+#include "utils/synchronised.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/** A bounded lock-free queue to hand over data from exactly one producer
+ *  thread to exactly one consumer thread (e.g. from the network listening
+ *  thread or a ProtocolManager thread to the main thread). The data is stored in a ring buffer, and the producer and
+ *  consumer each only modify their own index. If the ring buffer is full
+ *  the producer falls back to a mutex-protected overflow list (which keeps
+ *  the order of the data), so data is never dropped and the producer never
+ *  has to wait for the consumer. The consumer only takes the mutex if the
+ *  overflow list is in use. The number of pushes and the number of times
+ *  the overflow list had to be used are counted, to detect if SIZE is too
+ *  small.
+ */
+template<typename TYPE, unsigned SIZE = 1024>
+class SPSCQueue
+{
+private:
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of 2.");
+
+    /** The ring buffer. */
+    TYPE m_ring[SIZE];
+
+    /** Index of the next slot to write, only modified by the producer. It
+     *  is not wrapped, the slot is computed using SIZE. */
+    std::atomic<unsigned> m_head;
+
+    /** Keeps the two indices in separate cache lines, so that producer and
+     *  consumer do not invalidate each other's cache line on every access.
+     */
+    char m_padding[64];
+
+    /** Index of the next slot to read, only modified by the consumer. */
+    std::atomic<unsigned> m_tail;
+
+    /** Set by the producer if data was added to m_overflow. While it is
+     *  set, the producer adds all data to m_overflow to keep the order. */
+    std::atomic_bool m_use_overflow;
+
+    /** Data that did not fit into the ring buffer. */
+    Synchronised<std::vector<TYPE> > m_overflow;
+
+    /** Number of push calls. */
+    std::atomic<uint64_t> m_push_count;
+
+    /** Number of push calls that had to use the locked overflow list. */
+    std::atomic<uint64_t> m_overflow_count;
+
+    // ------------------------------------------------------------------------
+    /** Moves all data in the ring buffer to the end of the given vector. */
+    void drainRing(std::vector<TYPE> *out)
+    {
+        unsigned tail = m_tail.load(std::memory_order_relaxed);
+        const unsigned head = m_head.load(std::memory_order_acquire);
+        while (tail != head)
+        {
+            out->push_back(m_ring[tail & (SIZE - 1)]);
+            tail++;
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }   // drainRing
+
+public:
+    // ------------------------------------------------------------------------
+    SPSCQueue()
+    {
+        m_head.store(0);
+        m_tail.store(0);
+        m_use_overflow.store(false);
+        m_push_count.store(0);
+        m_overflow_count.store(0);
+    }   // SPSCQueue
+    // ------------------------------------------------------------------------
+    /** Adds data to the queue. Must only be called from the producer thread.
+     */
+    void push(const TYPE &data)
+    {
+        m_push_count.fetch_add(1, std::memory_order_relaxed);
+        if (!m_use_overflow.load(std::memory_order_acquire))
+        {
+            const unsigned head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) < SIZE)
+            {
+                m_ring[head & (SIZE - 1)] = data;
+                m_head.store(head + 1, std::memory_order_release);
+                return;
+            }
+        }
+        m_overflow_count.fetch_add(1, std::memory_order_relaxed);
+        m_overflow.lock();
+        m_overflow.getData().push_back(data);
+        m_use_overflow.store(true, std::memory_order_release);
+        m_overflow.unlock();
+    }   // push
+    // ------------------------------------------------------------------------
+    /** Moves all data in this queue to the end of the given vector (in the
+     *  order in which it was pushed). Must only be called from the consumer
+     *  thread. */
+    void popAll(std::vector<TYPE> *out)
+    {
+        drainRing(out);
+        if (!m_use_overflow.load(std::memory_order_acquire))
+            return;
+        m_overflow.lock();
+        // While the overflow list is in use the producer does not add to the
+        // ring buffer anymore, but it might have done so just before the
+        // overflow list was used.
+        drainRing(out);
+        std::vector<TYPE> &overflow = m_overflow.getData();
+        out->insert(out->end(), overflow.begin(), overflow.end());
+        overflow.clear();
+        m_use_overflow.store(false, std::memory_order_release);
+        m_overflow.unlock();
+    }   // popAll
+    // ------------------------------------------------------------------------
+    /** Returns the number of push calls. */
+    uint64_t getPushCount() const
+    {
+        return m_push_count.load(std::memory_order_relaxed);
+    }   // getPushCount
+    // ------------------------------------------------------------------------
+    /** Returns the number of push calls which found the ring buffer full and
+     *  had to use the locked overflow list. */
+    uint64_t getOverflowCount() const
+    {
+        return m_overflow_count.load(std::memory_order_relaxed);
+    }   // getOverflowCount
+
+};   // SPSCQueue
+
+#endif
@@ -0,0 +1,135 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#include "utils/worker_pool.hpp"
+#include "utils/server_room.hpp"
+#include "utils/vs.hpp"
+
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+/** Creates the pool and starts the worker threads.
+ *  \param num_threads Number of worker threads to start.
+ *  \param name Name of the worker threads.
+ */
+WorkerPool::WorkerPool(unsigned num_threads, const std::string& name)
+{
+    m_name         = name;
+    m_job          = NULL;
+    m_job_count    = 0;
+    m_job_room     = 0;
+    m_next_index.store(0);
+    m_busy_workers = 0;
+    m_generation   = 0;
+    m_exit         = false;
+    for (unsigned i = 0; i < num_threads; i++)
+        m_threads.emplace_back(&WorkerPool::workerLoop, this);
+}   // WorkerPool
+
+// ----------------------------------------------------------------------------
+/** Stops and joins all worker threads. */
+WorkerPool::~WorkerPool()
+{
+    std::unique_lock<std::mutex> ul(m_mutex);
+    m_exit = true;
+    ul.unlock();
+    m_work_cv.notify_all();
+    for (std::thread& t : m_threads)
+        t.join();
+}   // ~WorkerPool
+
+// ----------------------------------------------------------------------------
+/** Executes job indices of the current job until all are taken. */
+void WorkerPool::runJobs()
+{
+    while (true)
+    {
+        const unsigned i = m_next_index.fetch_add(1);
+        if (i >= m_job_count)
+            return;
+        (*m_job)(i);
+    }
+}   // runJobs
+
+// ----------------------------------------------------------------------------
+/** The main loop of a worker thread: waits for a new job, helps to execute
+ *  it, and then signals the caller that it is done. */
+void WorkerPool::workerLoop()
+{
+    VS::setThreadName(m_name.c_str());
+    uint64_t generation = 0;
+    while (true)
+    {
+        std::unique_lock<std::mutex> ul(m_mutex);
+        m_work_cv.wait(ul, [this, generation]()
+            {
+                return m_exit || m_generation != generation;
+            });
+        if (m_exit)
+            return;
+        generation = m_generation;
+        ServerRoom::setCurrent(m_job_room);
+        ul.unlock();
+
+        runJobs();
+
+        ul.lock();
+        if (--m_busy_workers == 0)
+            m_done_cv.notify_one();
+    }
+}   // workerLoop
+
+// ----------------------------------------------------------------------------
+/** Calls job(i) for all i in [0, count), distributed over the worker threads
+ *  and the calling thread, and returns once all calls are finished. The
+ *  order in which the indices are executed is undefined, so the jobs must
+ *  be independent of each other.
+ *  \param count Number of job indices.
+ *  \param job The function to call for each index.
+ */
+void WorkerPool::parallelFor(unsigned count,
+                             const std::function<void(unsigned)>& job)
+{
+    if (count == 0)
+        return;
+    if (m_threads.empty() || count == 1)
+    {
+        for (unsigned i = 0; i < count; i++)
+            job(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> caller_lock(m_caller_mutex);
+    std::unique_lock<std::mutex> ul(m_mutex);
+    assert(m_busy_workers == 0);
+    m_job          = &job;
+    m_job_count    = count;
+    m_job_room     = ServerRoom::getCurrent();
+    m_next_index.store(0);
+    m_busy_workers = (unsigned)m_threads.size();
+    m_generation++;
+    ul.unlock();
+    m_work_cv.notify_all();
+
+    runJobs();
+
+    // All workers must have left runJobs before the job can be destroyed
+    ul.lock();
+    m_done_cv.wait(ul, [this]() { return m_busy_workers == 0; });
+    m_job = NULL;
+}   // parallelFor
@@ -0,0 +1,103 @@
+//
+//  SuperTuxKart - a fun racing game with go-kart
+//  Copyright (C) 2018 SuperTuxKart-Team
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 3
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+#ifndef HEADER_WORKER_POOL_HPP
+#define HEADER_WORKER_POOL_HPP
+
+#include "utils/no_copy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** A small fixed size pool of worker threads, which is used to run a number
+ *  of independent jobs in parallel and wait for all of them to finish (like
+ *  a parallel for loop). The calling thread works on the jobs as well, so a
+ *  pool with 0 threads simply runs all jobs in the calling thread.
+ *  parallelFor can be called from several threads (the calls will be
+ *  serialised), but must not be called from inside a job.
+ */
+class WorkerPool : public NoCopy
+{
+private:
+    /** The worker threads. */
+    std::vector<std::thread> m_threads;
+
+    /** Name of the worker threads (for debugging). */
+    std::string m_name;
+
+    /** Only one parallelFor can be executed at the same time. */
+    std::mutex m_caller_mutex;
+
+    /** Protects the job data below. */
+    std::mutex m_mutex;
+
+    /** Signals the workers that a new job is available (or that they should
+     *  exit). */
+    std::condition_variable m_work_cv;
+
+    /** Signals the caller that all workers are done. */
+    std::condition_variable m_done_cv;
+
+    /** The current job, only valid during parallelFor. */
+    const std::function<void(unsigned)>* m_job;
+
+    /** Number of job indices of the current job. */
+    unsigned m_job_count;
+
+    /** The server room of the caller, which the workers switch to for the
+     *  current job. */
+    unsigned m_job_room;
+
+    /** Next job index to execute. */
+    std::atomic<unsigned> m_next_index;
+
+    /** Number of workers which have not finished the current job. */
+    unsigned m_busy_workers;
+
+    /** Increased for each job, so that workers can detect a new job. */
+    uint64_t m_generation;
+
+    /** Set when the pool is destroyed. */
+    bool m_exit;
+
+    // ------------------------------------------------------------------------
+    void runJobs();
+    // ------------------------------------------------------------------------
+    void workerLoop();
+
+public:
+    // ------------------------------------------------------------------------
+    WorkerPool(unsigned num_threads, const std::string& name);
+    // ------------------------------------------------------------------------
+    ~WorkerPool();
+    // ------------------------------------------------------------------------
+    void parallelFor(unsigned count,
+                     const std::function<void(unsigned)>& job);
+    // ------------------------------------------------------------------------
+    /** Returns the number of worker threads (not including the calling
+     *  thread). */
+    unsigned getNumThreads() const         { return (unsigned)m_threads.size(); }
+
+};   // WorkerPool
+
+#endif
@@ -30,7 +30,7 @@ import sys
 characteristics = """Suspension: stiffness, rest, travel, expSpringResponse(bool), maxForce
 Stability: rollInfluence, chassisLinearDamping, chassisAngularDamping, downwardImpulseFactor, trackConnectionAccel, angularFactor(std::vector<float>/floatVector), smoothFlyingImpulse
 Turn: radius(InterpolationArray), timeResetSteer, timeFullSteer(InterpolationArray)
-Engine: power, maxSpeed, brakeFactor, brakeTimeIncrease, maxSpeedReverseRatio
+Engine: power, maxSpeed, genericMaxSpeed, brakeFactor, brakeTimeIncrease, maxSpeedReverseRatio
 Gear: switchRatio(std::vector<float>/floatVector), powerIncrease(std::vector<float>/floatVector)
 Mass
 Wheels: dampingRelaxation, dampingCompression
@@ -38,23 +38,28 @@ Camera: distance, forwardUpAngle, backwardUpAngle
 Jump: animationTime
 Lean: max, speed
 Anvil: duration, weight, speedFactor
-Parachute: friction, duration, durationOther, durationRankMult, durationSpeedMult, lboundFraction, uboundFraction, maxSpeed
+Parachute: friction, duration(ticks), durationOther(ticks), durationRankMult, durationSpeedMult, lboundFraction, uboundFraction, maxSpeed
 Friction: kartFriction
-Bubblegum: duration, speedFraction, torque, fadeInTime, shieldDuration
+Bubblegum: duration, speedFraction, torque, fadeInTime(timeToTicks), shieldDuration
 Zipper: duration, force, speedGain, maxSpeedIncrease, fadeOutTime
 Swatter: duration, distance, squashDuration, squashSlowdown
-Plunger: bandMaxLength, bandForce, bandDuration, bandSpeedIncrease, bandFadeOutTime, inFaceTime
+Plunger: bandMaxLength, bandForce, bandDuration, bandSpeedIncrease, bandFadeOutTime(timeToTicks), inFaceTime
 Startup: time(std::vector<float>/floatVector), boost(std::vector<float>/floatVector)
 Rescue: duration, vertOffset, height
 Explosion: duration, radius, invulnerabilityTime
-Nitro: duration, engineForce, consumption, smallContainer, bigContainer, maxSpeedIncrease, fadeOutTime, max
-Slipstream: durationFactor, baseSpeed, length, width, innerFactor, minCollectTime, maxCollectTime, addPower, minSpeed, maxSpeedIncrease, fadeOutTime
+Nitro: duration, engineForce, engineMult, consumption, smallContainer, bigContainer, maxSpeedIncrease, fadeOutTime, max
+Slipstream: durationFactor, baseSpeed, length, width, innerFactor, minCollectTime, maxCollectTime, addPower, minSpeed, maxSpeedIncrease, fadeOutTime(timeToTicks)
 Skid: increase, decrease, max, timeTillMax, visual, visualTime, revertVisualTime, minSpeed, timeTillBonus(std::vector<float>/floatVector), bonusSpeed(std::vector<float>/floatVector), bonusTime(std::vector<float>/floatVector), bonusForce(std::vector<float>/floatVector), physicalJumpTime, graphicalJumpTime, postSkidRotateFactor, reduceTurnMin, reduceTurnMax, enabled(bool)"""
 
 """ A GroupMember is an attribute of a group.
     In the xml files, a value will be assigned to it.
     If the name of the attribute is 'value', the getter method will only
-    contain the group name and 'value' will be omitted (e.g. used for mass). """
+    contain the group name and 'value' will be omitted (e.g. used for mass).
+    The special type 'ticks' is a float time in the xml files, but the
+    getter converts it to physics ticks and returns an int.
+    The special type 'timeToTicks' is a float time everywhere except in
+    KartProperties, whose getter converts it to ticks and ends with 'Ticks'
+    instead of 'Time'. """
 class GroupMember:
     def __init__(self, name, typeC, typeStr):
         self.name = name
@@ -62,11 +67,38 @@ class GroupMember:
             self.getName = ""
         else:
             self.getName = name
+        self.ticks = typeC == "ticks"
+        if self.ticks:
+            typeC = "int"
+            typeStr = "float"
+        self.kpTicks = typeC == "timeToTicks"
+        if self.kpTicks:
+            typeC = "float"
+            typeStr = "float"
         self.typeC = typeC
         self.typeStr = typeStr
+        # The type that is used to save the value
+        self.typeSave = "float" if self.ticks else typeC
+
+    """ Returns true if the value is small enough to be returned by value
+        instead of by reference. """
+    def isScalar(self):
+        return self.typeC in ("float", "bool", "int")
+
+    """ The return type of getters that return the cached value. """
+    def getRefType(self):
+        if self.isScalar():
+            return self.typeC
+        return "const {0}&".format(self.typeC)
+
+    """ The member of the AbstractCharacteristic::Value union for this type. """
+    def getUnionMember(self):
+        return { "float": "f", "bool": "b", "floatVector": "fv",
+                 "InterpolationArray": "ia" }[self.typeStr]
 
     """ E.g. power(std::vector<float>/floatVector)
         or speed(InterpolationArray)
+        or duration(ticks)
         The default type is float
         The name 'value' is special: Only the group name will be used to access
             the member but in the xml file it will be still value (because we
@@ -117,6 +149,12 @@ class Group:
                 group.addMember(m)
             return group
 
+""" The name of the KartProperties getter of a 'timeToTicks' member, e.g.
+    BubblegumFadeInTicks for BubblegumFadeInTime """
+def toTicksName(nameTitle):
+    assert nameTitle.endswith("Time")
+    return nameTitle[:-len("Time")] + "Ticks"
+
 """ Creates a list of words from a titlecase string """
 def toList(name):
     result = []
@@ -168,6 +206,8 @@ def createAcGetter(groups):
             nameUnderscore = joinSubName(g, m, False)
             typeC = m.typeC
             result = "result"
+            if m.ticks:
+                result = "stk_config->time2Ticks(result)"
 
             print("""// ----------------------------------------------------------------------------
 {3} AbstractCharacteristic::get{1}() const
@@ -180,7 +220,7 @@ def createAcGetter(groups):
                     getName({2}).c_str());
     return {4};
 }}  // get{1}
-""".format(m.typeC, nameTitle, nameUnderscore.upper(), typeC, result))
+""".format(m.typeSave, nameTitle, nameUnderscore.upper(), typeC, result))
 
 def createKpDefs(groups):
     for g in groups:
@@ -188,7 +228,10 @@ def createKpDefs(groups):
         for m in g.members:
             nameTitle = joinSubName(g, m, True)
             nameUnderscore = joinSubName(g, m, False)
-            typeC = m.typeC
+            typeC = m.getRefType()
+            if m.kpTicks:
+                typeC = "int"
+                nameTitle = toTicksName(nameTitle)
 
             print("    {0} get{1}() const;".
                 format(typeC, nameTitle, nameUnderscore))
@@ -198,8 +241,16 @@ def createKpGetter(groups):
         for m in g.members:
             nameTitle = joinSubName(g, m, True)
             nameUnderscore = joinSubName(g, m, False)
-            typeC = m.typeC
-            result = "result"
+            typeC = m.getRefType()
+            if m.kpTicks:
+                print("""// ----------------------------------------------------------------------------
+int KartProperties::get{1}() const
+{{
+    return stk_config->time2Ticks(m_cached_characteristic
+                                  ->get{0}());
+}}  // get{1}
+""".format(nameTitle, toTicksName(nameTitle)))
+                continue
 
             print("""// ----------------------------------------------------------------------------
 {1} KartProperties::get{0}() const
@@ -236,6 +287,43 @@ def createLoadXml(groups):
                 format(nameMinus, nameUnderscore.upper()))
         print("    }\n")
 
+def createCachedValues(groups):
+    for g in groups:
+        print()
+        for m in g.members:
+            nameUnderscore = joinSubName(g, m, False)
+            print("        {0} m_{1};".format(m.typeSave, nameUnderscore))
+            if m.ticks:
+                print("        int m_{0}_ticks;".format(nameUnderscore))
+
+def createCachedDefs(groups):
+    for g in groups:
+        print()
+        for m in g.members:
+            nameTitle = joinSubName(g, m, True)
+            nameUnderscore = joinSubName(g, m, False)
+            if m.ticks:
+                nameUnderscore += "_ticks"
+            print("    {0} get{1}() const\n        {{ return m_values.m_{2}; }}".
+                format(m.getRefType(), nameTitle, nameUnderscore))
+
+def createCachedUpdate(groups):
+    for g in groups:
+        for m in g.members:
+            nameUnderscore = joinSubName(g, m, False)
+            print("    cacheValue({0}, &m_values.m_{1});".
+                format(nameUnderscore.upper(), nameUnderscore))
+            if m.ticks:
+                print("""    m_values.m_{0}_ticks =
+        stk_config->time2Ticks(m_values.m_{0});""".format(nameUnderscore))
+
+def createCachedProcess(groups):
+    for g in groups:
+        for m in g.members:
+            nameUnderscore = joinSubName(g, m, False)
+            print("    case {0}:\n        *value.{1} = m_values.m_{2};\n        break;".
+                format(nameUnderscore.upper(), m.getUnionMember(), nameUnderscore))
+
 # Dicionary that maps an argument string to a tupel of
 # a generator function, a help string and a filename
 functions = {
@@ -247,6 +335,10 @@ functions = {
     "kpdefs":   (createKpDefs,   "Create the header function definitions for the getters", "karts/kart_properties.hpp"),
     "kpgetter": (createKpGetter, "Implement the getters",                                  "karts/kart_properties.cpp"),
     "loadXml":  (createLoadXml,  "Code to load the characteristics from an xml file",      "karts/xml_characteristic.cpp"),
+    "cachedvalues":  (createCachedValues,  "Create the members of the cached values",     "karts/cached_characteristic.hpp"),
+    "cacheddefs":    (createCachedDefs,    "Create the getters for the cached values",    "karts/cached_characteristic.hpp"),
+    "cachedupdate":  (createCachedUpdate,  "Code to update the cached values",            "karts/cached_characteristic.cpp"),
+    "cachedprocess": (createCachedProcess, "Implement the process function of the cache", "karts/cached_characteristic.cpp"),
 }
 
 def main():